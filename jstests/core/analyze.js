@@ -0,0 +1,60 @@
+// Test the analyze command, and that the index statistics it gathers are used by the planner.
+
+var t = db.jstests_analyze;
+t.drop();
+
+for (var i = 0; i < 1000; ++i) {
+    t.save({a: i, b: i % 10});
+}
+t.ensureIndex({a: 1});
+t.ensureIndex({b: 1});
+
+// Bad arguments
+assert.commandFailed(db.runCommand({analyze: "jstests_analyze_missing"}));
+assert.commandFailed(db.runCommand({analyze: t.getName(), index: "nonexistent"}));
+assert.commandFailed(db.runCommand({analyze: t.getName(), buckets: 0}));
+
+var res = db.runCommand({analyze: t.getName()});
+// CommandNotSupported: this storage engine doesn't keep index statistics
+var supported = res.ok || res.code != 115;
+if (supported) {
+    assert.commandWorked(res);
+    assert.eq(1000, res.indexes.a_1.numKeys);
+    assert.eq(1000, res.indexes.b_1.numKeys);
+    assert.eq(1000, res.indexes._id_.numKeys);
+
+    // Explain reports the estimate alongside the number of keys actually examined
+    var explain = t.find({a: {$gte: 100, $lt: 200}}).hint({a: 1}).explain("executionStats");
+    var ixscan = explain.queryPlanner.winningPlan.inputStage;
+    assert.eq("IXSCAN", ixscan.stage);
+    assert.lte(Math.abs(ixscan.keysEstimated - 100), 20, tojson(ixscan));
+    assert.lte(Math.abs(explain.executionStats.executionStages.inputStage.keysExamined - 100), 1);
+
+    // Pruning is off by default, so every plan is raced
+    explain = t.find({a: {$gte: 0, $lt: 5}, b: 5}).explain();
+    assert.eq(1, explain.queryPlanner.rejectedPlans.length, tojson(explain));
+
+    // The plan on {b: 1} examines twenty times as many keys as the one on {a: 1}, so isn't raced
+    var oldRatio = db.adminCommand({getParameter: 1, internalQueryPlannerStatsPruneRatio: 1})
+                     .internalQueryPlannerStatsPruneRatio;
+    assert.commandWorked(db.adminCommand({setParameter: 1,
+                                          internalQueryPlannerStatsPruneRatio: 10}));
+    explain = t.find({a: {$gte: 0, $lt: 5}, b: 5}).explain();
+    assert.eq(0, explain.queryPlanner.rejectedPlans.length, tojson(explain));
+    assert.eq({a: 1}, explain.queryPlanner.winningPlan.inputStage.keyPattern);
+
+    // Statistics are ignored once the collection has changed a lot since they were gathered
+    for (var i = 1000; i < 1500; ++i) {
+        t.save({a: i, b: i % 10});
+    }
+    explain = t.find({a: {$gte: 0, $lt: 5}, b: 5}).explain();
+    assert.eq(1, explain.queryPlanner.rejectedPlans.length, tojson(explain));
+    assert.commandWorked(db.adminCommand({setParameter: 1,
+                                          internalQueryPlannerStatsPruneRatio: oldRatio}));
+
+    // Re-analyzing just one index replaces its statistics
+    res = db.runCommand({analyze: t.getName(), index: "b_1", buckets: 5});
+    assert.commandWorked(res);
+    assert.eq(["b_1"], Object.keySet(res.indexes));
+    assert.lte(res.indexes.b_1.numBuckets, 10);
+}
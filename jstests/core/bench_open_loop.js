@@ -0,0 +1,50 @@
+// Tests benchRun's open-loop mode, latency percentiles, and skewed key generators
+
+t = db.bench_open_loop;
+t.drop();
+
+var opsPerSecond = 200;
+var seconds = 2;
+
+benchArgs = { ops : [ { ns : t.getFullName() ,
+                        op : "update" ,
+                        upsert : true ,
+                        query : { _id : { "#ZIPF_INT" : [ 0 , 1000 ] } } ,
+                        update : { $inc : { x : 1 } } } ,
+                      { ns : t.getFullName() ,
+                        op : "findOne" ,
+                        query : { _id : { "#HOTSPOT_INT" : [ 0 , 1000 , 0.1 , 0.9 ] } } } ] ,
+              parallel : 2 ,
+              seconds : seconds ,
+              opsPerSecond : opsPerSecond ,
+              host : db.getMongo().host }
+
+if (jsTest.options().auth) {
+    benchArgs['db'] = 'admin';
+    benchArgs['username'] = jsTest.options().adminUser;
+    benchArgs['password'] = jsTest.options().adminPassword;
+}
+
+res = benchRun( benchArgs );
+printjson( res );
+
+assert.eq( opsPerSecond , res.targetOpsPerSecond , "A1" );
+
+// The schedule caps the number of ops sent, half of which are updates
+var updates = res.latency.update;
+assert( updates , "B1" );
+assert.gt( updates.count , 0 , "B2" );
+assert.lte( updates.count , opsPerSecond * seconds , "B3" );
+assert.lte( updates.minMicros , updates.p50Micros , "B4" );
+assert.lte( updates.p50Micros , updates.p99Micros , "B5" );
+assert.lte( updates.p99Micros , updates.p999Micros , "B6" );
+assert.lte( updates.p999Micros , updates.maxMicros , "B7" );
+assert( res.latency.findOne , "B8" );
+
+// Zipfian keys make the lowest _id the most updated
+var first = t.findOne( { _id : 0 } );
+assert( first , "C1" );
+assert.eq( first.x , t.find().sort( { x : -1 } ).limit( 1 ).next().x , "C2" );
+
+assert.throws( function() { benchRun( { ops : [] , opsPerSecond : -1 ,
+                                        host : db.getMongo().host } ); } , [] , "D1" );
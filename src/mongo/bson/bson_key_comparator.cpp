@@ -0,0 +1,121 @@
+// bson_key_comparator.cpp
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/bson_key_comparator.h"
+
+namespace mongo {
+
+    namespace {
+
+        // Skips the type byte and field name of the element at 'elem'.  Index and sort keys have
+        // empty field names, so this is normally a single byte check.
+        inline const char* valueOf(const char* elem) {
+            const char* name = elem + 1;
+            return *name ? name + strlen(name) + 1 : name + 1;
+        }
+
+        /**
+         * Compares the elements at 'l' and 'r' and advances both past them.  Reads values
+         * straight out of the buffers for the common key types, so the element sizes never need
+         * to be computed through BSONElement::size().
+         */
+        inline int compareAndAdvance(const char*& l, const char*& r) {
+            const char type = *l;
+            if (type == *r) {
+                const char* lv = valueOf(l);
+                const char* rv = valueOf(r);
+
+                switch (type) {
+                case NumberInt:
+                    l = lv + sizeof(int);
+                    r = rv + sizeof(int);
+                    return compareInts(ConstDataView(lv).readLE<int>(),
+                                       ConstDataView(rv).readLE<int>());
+                case NumberLong:
+                    l = lv + sizeof(long long);
+                    r = rv + sizeof(long long);
+                    return compareLongs(ConstDataView(lv).readLE<long long>(),
+                                        ConstDataView(rv).readLE<long long>());
+                case NumberDouble:
+                    l = lv + sizeof(double);
+                    r = rv + sizeof(double);
+                    return compareDoubles(ConstDataView(lv).readLE<double>(),
+                                          ConstDataView(rv).readLE<double>());
+                case jstOID:
+                    l = lv + OID::kOIDSize;
+                    r = rv + OID::kOIDSize;
+                    return memcmp(lv, rv, OID::kOIDSize);
+                case String: {
+                    // Sizes include the terminating NUL, as in compareElementValues().
+                    const int lsz = ConstDataView(lv).readLE<int>();
+                    const int rsz = ConstDataView(rv).readLE<int>();
+                    l = lv + 4 + lsz;
+                    r = rv + 4 + rsz;
+                    const int res = memcmp(lv + 4, rv + 4, std::min(lsz, rsz));
+                    return res ? res : lsz - rsz;
+                }
+                default:
+                    break;
+                }
+            }
+
+            const BSONElement le(l);
+            const BSONElement re(r);
+            l += le.size();
+            r += re.size();
+            return le.woCompare(re, false);
+        }
+
+    } // namespace
+
+    int BSONKeyComparator::compare(const BSONObj& lhs, const BSONObj& rhs) const {
+        if (lhs.isEmpty())
+            return rhs.isEmpty() ? 0 : -1;
+        if (rhs.isEmpty())
+            return 1;
+
+        // Skip the object sizes; both objects end with an EOO byte.
+        const char* l = lhs.objdata() + 4;
+        const char* r = rhs.objdata() + 4;
+
+        for (unsigned mask = 1; ; mask <<= 1) {
+            if (*l == EOO)
+                return *r == EOO ? 0 : -1;
+            if (*r == EOO)
+                return 1;
+
+            const int x = compareAndAdvance(l, r);
+            if (x != 0)
+                return _ordering.descending(mask) ? -x : x;
+        }
+    }
+
+} // namespace mongo
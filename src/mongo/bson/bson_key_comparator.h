@@ -0,0 +1,104 @@
+// bson_key_comparator.h
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+
+#include "mongo/base/compare_numbers.h"
+#include "mongo/base/data_view.h"
+#include "mongo/bson/bsonelement.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/ordering.h"
+
+namespace mongo {
+
+    /**
+     * Compares keys laid out according to a fixed key pattern, such as index keys or sort keys.
+     *
+     * compare() gives the same ordering as BSONObj::woCompare(r, ordering, false), but the
+     * directions of the fields are resolved once up front, and when both sides of a field have
+     * the same NumberInt, NumberLong, NumberDouble, String or jstOID type the values are compared
+     * in place, without the canonical type lookup and type switch of the generic path.  Any other
+     * combination of types falls back to BSONElement::woCompare().
+     *
+     * Only the sign of the result is meaningful.
+     */
+    class BSONKeyComparator {
+    public:
+        // The most fields an Ordering can describe.
+        static const int kMaxFields = 32;
+
+        explicit BSONKeyComparator(const Ordering& ordering) : _ordering(ordering) { }
+
+        /**
+         * 'keyPattern' must have at most kMaxFields fields.
+         */
+        explicit BSONKeyComparator(const BSONObj& keyPattern)
+            : _ordering(Ordering::make(keyPattern)) { }
+
+        int compare(const BSONObj& lhs, const BSONObj& rhs) const;
+
+        bool operator()(const BSONObj& lhs, const BSONObj& rhs) const {
+            return compare(lhs, rhs) < 0;
+        }
+
+        /**
+         * Same as l.woCompare(r, false), with the fast paths described above.
+         */
+        static int compareElements(const BSONElement& l, const BSONElement& r) {
+            if (l.type() == r.type()) {
+                switch (l.type()) {
+                case NumberInt:
+                    return compareInts(l._numberInt(), r._numberInt());
+                case NumberLong:
+                    return compareLongs(l._numberLong(), r._numberLong());
+                case NumberDouble:
+                    return compareDoubles(l._numberDouble(), r._numberDouble());
+                case jstOID:
+                    return memcmp(l.value(), r.value(), OID::kOIDSize);
+                case String: {
+                    const int lsz = l.valuestrsize();
+                    const int rsz = r.valuestrsize();
+                    const int res = memcmp(l.valuestr(), r.valuestr(), std::min(lsz, rsz));
+                    return res ? res : lsz - rsz;
+                }
+                default:
+                    break;
+                }
+            }
+            return l.woCompare(r, false);
+        }
+
+    private:
+        Ordering _ordering;
+    };
+
+} // namespace mongo
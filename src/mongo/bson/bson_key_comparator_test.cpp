@@ -0,0 +1,198 @@
+// bson_key_comparator_test.cpp
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kDefault
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include "mongo/bson/bson_key_comparator.h"
+#include "mongo/config.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/platform/random.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/timer.h"
+
+namespace {
+    using namespace mongo;
+
+    int sign(int x) {
+        return x < 0 ? -1 : x > 0 ? 1 : 0;
+    }
+
+    // Appends a value drawn from a small domain, so that equal values and mixed types are common.
+    void appendRandomValue(PseudoRandom& rand, BSONObjBuilder& bob) {
+        const int v = rand.nextInt32(8) - 4;
+        switch (rand.nextInt32(10)) {
+        case 0: bob.append("", v); break;
+        case 1: bob.append("", static_cast<long long>(v)); break;
+        case 2: bob.append("", v / 2.0); break;
+        case 3: bob.append("", std::numeric_limits<double>::quiet_NaN()); break;
+        case 4: bob.append("", std::string("ab").substr(0, v & 3)); break;
+        case 5: bob.append("", std::string("a\0b", 3).substr(0, v & 3)); break;
+        case 6: {
+            unsigned char buf[OID::kOIDSize] = { 0 };
+            buf[OID::kOIDSize - 1] = static_cast<unsigned char>(v);
+            bob.append("", OID::from(buf));
+            break;
+        }
+        case 7: bob.appendNull(""); break;
+        case 8: bob.appendBool("", v > 0); break;
+        default: bob.append("", BSON("a" << v)); break;
+        }
+    }
+
+    BSONObj randomKey(PseudoRandom& rand, int nFields) {
+        BSONObjBuilder bob;
+        for (int i = 0; i < nFields; i++) {
+            appendRandomValue(rand, bob);
+        }
+        return bob.obj();
+    }
+
+    BSONObj randomKeyPattern(PseudoRandom& rand, int nFields) {
+        BSONObjBuilder bob;
+        for (int i = 0; i < nFields; i++) {
+            bob.append(std::string(str::stream() << "f" << i), rand.nextInt32(2) ? 1 : -1);
+        }
+        return bob.obj();
+    }
+
+    TEST(BSONKeyComparator, Basic) {
+        const BSONKeyComparator cmp(BSON("a" << 1 << "b" << -1));
+
+        ASSERT_EQUALS(0, cmp.compare(BSONObj(), BSONObj()));
+        ASSERT_LESS_THAN(cmp.compare(BSONObj(), BSON("" << 1)), 0);
+        ASSERT_LESS_THAN(cmp.compare(BSON("" << 1), BSON("" << 2)), 0);
+        ASSERT_GREATER_THAN(cmp.compare(BSON("" << 1 << "" << 1), BSON("" << 1 << "" << 2)), 0);
+        ASSERT_LESS_THAN(cmp.compare(BSON("" << 1), BSON("" << 1 << "" << 2)), 0);
+        ASSERT_EQUALS(0, cmp.compare(BSON("" << 1 << "" << "x"), BSON("" << 1.0 << "" << "x")));
+        ASSERT_LESS_THAN(cmp.compare(BSON("" << 1 << "" << "xy"), BSON("" << 1 << "" << "x")), 0);
+
+        ASSERT(cmp(BSON("" << 1), BSON("" << 2)));
+        ASSERT_FALSE(cmp(BSON("" << 2), BSON("" << 2)));
+    }
+
+    TEST(BSONKeyComparator, FieldNamesAreIgnored) {
+        const BSONKeyComparator cmp(BSON("a" << 1));
+        ASSERT_EQUALS(0, cmp.compare(BSON("a" << 1), BSON("b" << 1)));
+        ASSERT_LESS_THAN(cmp.compare(BSON("zzz" << "a"), BSON("" << "b")), 0);
+    }
+
+    TEST(BSONKeyComparator, MatchesWoCompare) {
+        PseudoRandom rand(12345);
+
+        for (int i = 0; i < 20 * 1000; i++) {
+            const int nFields = 1 + rand.nextInt32(4);
+            const BSONObj pattern = randomKeyPattern(rand, nFields);
+            const Ordering ordering = Ordering::make(pattern);
+            const BSONKeyComparator cmp(ordering);
+
+            // Keys are occasionally shorter than the pattern.
+            const BSONObj l = randomKey(rand, nFields - rand.nextInt32(2));
+            const BSONObj r = randomKey(rand, nFields - rand.nextInt32(2));
+
+            ASSERT_EQUALS(sign(l.woCompare(r, ordering, false)), sign(cmp.compare(l, r)))
+                << l << " " << r << " " << pattern;
+            ASSERT_EQUALS(sign(l.woCompare(r, pattern, false)), sign(cmp.compare(l, r)))
+                << l << " " << r << " " << pattern;
+
+            if (!l.isEmpty() && !r.isEmpty()) {
+                ASSERT_EQUALS(sign(l.firstElement().woCompare(r.firstElement(), false)),
+                              sign(BSONKeyComparator::compareElements(l.firstElement(),
+                                                                      r.firstElement())))
+                    << l << " " << r;
+            }
+        }
+    }
+
+#ifndef MONGO_CONFIG_DEBUG_BUILD
+    struct GenericOrderingLess {
+        explicit GenericOrderingLess(const Ordering& o) : ordering(o) { }
+        bool operator()(const BSONObj& l, const BSONObj& r) const {
+            return l.woCompare(r, ordering, false) < 0;
+        }
+        Ordering ordering;
+    };
+
+    void runSortBenchmark(const char* name, const std::vector<BSONObj>& keys,
+                          const BSONObj& pattern) {
+        const Ordering ordering = Ordering::make(pattern);
+        const int iterations = 10;
+
+        long long genericMicros = 0;
+        long long specializedMicros = 0;
+        for (int i = 0; i < iterations; i++) {
+            std::vector<BSONObj> generic(keys);
+            std::vector<BSONObj> specialized(keys);
+
+            Timer t;
+            std::sort(generic.begin(), generic.end(), GenericOrderingLess(ordering));
+            genericMicros += t.micros();
+
+            t.reset();
+            std::sort(specialized.begin(), specialized.end(), BSONKeyComparator(ordering));
+            specializedMicros += t.micros();
+        }
+
+        log() << "BSONKeyComparator: sorting " << keys.size() << " " << name << " keys took "
+              << specializedMicros / iterations << " us, woCompare took "
+              << genericMicros / iterations << " us";
+    }
+
+    TEST(BSONKeyComparator, PerformanceSort) {
+        const int numKeys = 100 * 1000;
+        PseudoRandom rand(1);
+
+        std::vector<BSONObj> ints;
+        std::vector<BSONObj> doubles;
+        std::vector<BSONObj> strings;
+        std::vector<BSONObj> compound;
+        for (int i = 0; i < numKeys; i++) {
+            const int v = rand.nextInt32(numKeys);
+            ints.push_back(BSON("" << v));
+            doubles.push_back(BSON("" << v / 3.0));
+            strings.push_back(BSON("" << std::string(str::stream() << "user" << v)));
+            compound.push_back(BSON("" << v % 100 << "" << static_cast<long long>(v)
+                                       << "" << std::string(str::stream() << "user" << v)));
+        }
+
+        runSortBenchmark("int", ints, BSON("a" << 1));
+        runSortBenchmark("double", doubles, BSON("a" << -1));
+        runSortBenchmark("string", strings, BSON("a" << 1));
+        runSortBenchmark("compound", compound, BSON("a" << 1 << "b" << -1 << "c" << 1));
+    }
+#endif
+
+} // namespace
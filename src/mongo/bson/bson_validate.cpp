@@ -28,13 +28,20 @@
  */
 
 #include <cstring>
-#include <deque>
 #include <limits>
+#include <vector>
 
 #include "mongo/base/data_view.h"
 #include "mongo/bson/bson_validate.h"
 #include "mongo/bson/oid.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/platform/bits.h"
+
+// SSE2 is part of the x86-64 baseline, so there is nothing to detect at runtime.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MONGO_BSON_VALIDATE_SSE2
+#endif
 
 namespace mongo {
 
@@ -54,6 +61,28 @@ namespace mongo {
             return Status(ErrorCodes::InvalidBSON, baseMsg);
         }
 
+        /**
+         * Returns a pointer to the first NUL in [begin, begin + length), or NULL if there is none.
+         *
+         * Every element's field name is found this way. Field names are short, so compare them
+         * 16 bytes at a time inline rather than paying for a call to memchr. The loads never
+         * extend past the end of the range.
+         */
+        inline const char* findNul(const char* begin, uint64_t length) {
+#if defined(MONGO_BSON_VALIDATE_SSE2)
+            const __m128i zero = _mm_setzero_si128();
+            while (length >= 16) {
+                const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+                const unsigned mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, zero));
+                if (mask)
+                    return begin + countTrailingZeros64(mask);
+                begin += 16;
+                length -= 16;
+            }
+#endif
+            return static_cast<const char*>(memchr(begin, 0, length));
+        }
+
         class Buffer {
         public:
             Buffer( const char* buffer, uint64_t maxLength )
@@ -72,10 +101,10 @@ namespace mongo {
             }
 
             Status readCString( StringData* out ) {
-                const void* x = memchr( _buffer + _position, 0, _maxLength - _position );
+                const char* x = findNul( _buffer + _position, _maxLength - _position );
                 if ( !x )
                     return makeError("no end of c-string", _idElem);
-                uint64_t len = static_cast<uint64_t>( static_cast<const char*>(x) - ( _buffer + _position ) );
+                uint64_t len = static_cast<uint64_t>( x - ( _buffer + _position ) );
 
                 StringData data( _buffer + _position, len );
                 _position += len + 1;
@@ -173,6 +202,44 @@ namespace mongo {
             int _startPosition;
         };
 
+        /**
+         * The stack of objects being validated, with the interface of the std::deque it replaces.
+         * The first frames are stored inline so that validating a typical document does not
+         * allocate. References returned by back() are invalidated by push_back().
+         */
+        class FrameStack {
+        public:
+            FrameStack() : _size(0) {}
+
+            void push_back(const ValidationObjectFrame& frame) {
+                if (_size < kInlineFrames)
+                    _inline[_size] = frame;
+                else
+                    _overflow.push_back(frame);
+                _size++;
+            }
+
+            void pop_back() {
+                _size--;
+                if (_size >= kInlineFrames)
+                    _overflow.pop_back();
+            }
+
+            ValidationObjectFrame& back() {
+                return _size > kInlineFrames ? _overflow.back() : _inline[_size - 1];
+            }
+
+            size_t size() const { return _size; }
+            bool empty() const { return _size == 0; }
+
+        private:
+            static const size_t kInlineFrames = 32;
+
+            size_t _size;
+            ValidationObjectFrame _inline[kInlineFrames];
+            std::vector<ValidationObjectFrame> _overflow;
+        };
+
         /**
          * WARNING: only pass in a non-EOO idElem if it has been fully validated already!
          */
@@ -275,7 +342,7 @@ namespace mongo {
         }
 
         Status validateBSONIterative(Buffer* buffer) {
-            std::deque<ValidationObjectFrame> frames;
+            FrameStack frames;
             ValidationObjectFrame* curr = NULL;
             ValidationState::State state = ValidationState::BeginObj;
 
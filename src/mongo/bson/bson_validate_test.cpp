@@ -30,11 +30,13 @@
 #include <boost/scoped_array.hpp>
 
 #include "mongo/base/data_view.h"
+#include "mongo/config.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/platform/random.h"
 #include "mongo/bson/bson_validate.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace {
 
@@ -308,4 +310,72 @@ namespace {
         ASSERT_NOT_OK(validateBSON(x.objdata(), x.objsize()));
     }
 
+    TEST(BSONValidateFast, FieldNameLengths) {
+        // Field names shorter and longer than a vector register, with the terminator in every
+        // position relative to the end of the buffer.
+        for (int len = 0; len < 70; len++) {
+            const std::string name(len, 'a');
+            const BSONObj x = BSON(name << 1 << "b" << "c");
+            ASSERT_OK(validateBSON(x.objdata(), x.objsize()));
+            for (int truncated = 0; truncated < x.objsize(); truncated++) {
+                ASSERT_NOT_OK(validateBSON(x.objdata(), truncated));
+            }
+
+            // A field name which runs off the end of the buffer
+            BufBuilder bb;
+            bb.appendNum(4 + 1 + len);
+            bb.appendChar(NumberInt);
+            bb.appendStr(name, /*withNUL*/false);
+            ASSERT_NOT_OK(validateBSON(bb.buf(), bb.len()));
+        }
+    }
+
+    TEST(BSONValidateFast, DeeplyNested) {
+        BSONObj x = BSON("_id" << 1);
+        for (int i = 0; i < 100; i++) {
+            x = BSON("a" << x << "b" << BSON_ARRAY(i));
+        }
+        ASSERT_OK(validateBSON(x.objdata(), x.objsize()));
+        ASSERT_NOT_OK(validateBSON(x.objdata(), x.objsize() - 1));
+
+        // Corrupt the innermost object's length
+        std::string copy(x.objdata(), x.objsize());
+        const size_t innermost = copy.find("_id") - 5;
+        DataView(&copy[innermost]).writeLE<int>(100);
+        ASSERT_NOT_OK(validateBSON(copy.data(), copy.size()));
+    }
+
+#ifndef MONGO_CONFIG_DEBUG_BUILD
+    TEST(BSONValidateFast, PerformanceValidate) {
+        // Documents shaped like typical inserts: an ObjectId, short scalar fields, a string, a
+        // small subdocument and an array.
+        const int numDocs = 1000;
+        const int numPasses = 1000;
+
+        std::vector<BSONObj> docs;
+        for (int i = 0; i < numDocs; i++) {
+            docs.push_back(BSON("_id" << OID::gen()
+                                << "userId" << i
+                                << "createdAt" << Date_t(1000LL * i)
+                                << "score" << i * 0.5
+                                << "active" << (i % 2 == 0)
+                                << "name" << std::string(10 + i % 40, 'n')
+                                << "address" << BSON("street" << "1 Main Street"
+                                                     << "city" << "New York"
+                                                     << "zip" << 10001)
+                                << "tags" << BSON_ARRAY("alpha" << "beta" << "gamma")));
+        }
+
+        Timer t;
+        for (int pass = 0; pass < numPasses; pass++) {
+            for (int i = 0; i < numDocs; i++) {
+                ASSERT_OK(validateBSON(docs[i].objdata(), docs[i].objsize()));
+            }
+        }
+        const long long micros = std::max(t.micros(), 1LL);
+        log() << "validateBSON: " << numDocs * numPasses << " documents took " << micros / 1000
+              << " ms (" << 1000LL * 1000 * numDocs * numPasses / micros << " docs/sec)";
+    }
+#endif
+
 }
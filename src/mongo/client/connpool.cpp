@@ -35,6 +35,8 @@
 #include "mongo/platform/basic.h"
 
 #include "mongo/client/connpool.h"
+
+#include <limits>
 #include "mongo/client/replica_set_monitor.h"
 #include "mongo/client/syncclusterconnection.h"
 #include "mongo/util/exit.h"
@@ -55,7 +57,38 @@ namespace mongo {
         clear();
     }
 
+    int PoolForHost::getMaxPoolSize() {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        return _maxPoolSize;
+    }
+
+    void PoolForHost::setMaxPoolSize(int maxPoolSize) {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        _maxPoolSize = maxPoolSize;
+    }
+
+    int PoolForHost::numAvailable() {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        return (int)_pool.size();
+    }
+
+    long long PoolForHost::numCreated() {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        return _created;
+    }
+
+    ConnectionString::ConnectionType PoolForHost::type() {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        verify(_created);
+        return _type;
+    }
+
     void PoolForHost::clear() {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        _clear();
+    }
+
+    void PoolForHost::_clear() {
         while ( ! _pool.empty() ) {
             StoredConnection sc = _pool.top();
             delete sc.conn;
@@ -64,11 +97,12 @@ namespace mongo {
     }
 
     void PoolForHost::done(DBConnectionPool* pool, DBClientBase* c) {
+        boost::lock_guard<boost::mutex> lk(_mutex);
 
         bool isFailed = c->isFailed();
 
         // Remember that this host had a broken connection for later
-        if (isFailed) reportBadConnectionAt(c->getSockCreationMicroSec());
+        if (isFailed) _reportBadConnectionAt(c->getSockCreationMicroSec());
 
         if (isFailed ||
             // Another (later) connection was reported as broken to this host
@@ -85,25 +119,33 @@ namespace mongo {
     }
 
     void PoolForHost::reportBadConnectionAt(uint64_t microSec) {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        _reportBadConnectionAt(microSec);
+    }
+
+    void PoolForHost::_reportBadConnectionAt(uint64_t microSec) {
         if (microSec != DBClientBase::INVALID_SOCK_CREATION_TIME &&
                 microSec > _minValidCreationTimeMicroSec) {
             _minValidCreationTimeMicroSec = microSec;
             log() << "Detected bad connection created at " << _minValidCreationTimeMicroSec
                     << " microSec, clearing pool for " << _hostName
                     << " of " << _pool.size() << " connections" << endl;
-            clear();
+            _clear();
         }
     }
 
     bool PoolForHost::isBadSocketCreationTime(uint64_t microSec) {
+        boost::lock_guard<boost::mutex> lk(_mutex);
         return microSec != DBClientBase::INVALID_SOCK_CREATION_TIME &&
                 microSec <= _minValidCreationTimeMicroSec;
     }
 
     DBClientBase * PoolForHost::get( DBConnectionPool * pool , double socketTimeout ) {
 
+        boost::lock_guard<boost::mutex> lk(_mutex);
+
         time_t now = time(0);
-        
+
         while ( ! _pool.empty() ) {
             StoredConnection sc = _pool.top();
             _pool.pop();
@@ -124,6 +166,7 @@ namespace mongo {
     }
 
     void PoolForHost::flush() {
+        boost::lock_guard<boost::mutex> lk(_mutex);
         while (!_pool.empty()) {
             StoredConnection c = _pool.top();
             _pool.pop();
@@ -131,9 +174,15 @@ namespace mongo {
         }
     }
 
-    void PoolForHost::getStaleConnections( vector<DBClientBase*>& stale ) {
+    void PoolForHost::getStaleConnections( time_t idleCutoff,
+                                           int minPoolSize,
+                                           int numInUse,
+                                           vector<DBClientBase*>& stale ) {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+
         time_t now = time(0);
 
+        // The stack top is the most recently used connection, so idle ones are at the bottom
         vector<StoredConnection> all;
         while ( ! _pool.empty() ) {
             StoredConnection c = _pool.top();
@@ -145,11 +194,47 @@ namespace mongo {
                 stale.push_back( c.conn );
         }
 
-        for ( size_t i=0; i<all.size(); i++ ) {
+        int numKept = static_cast<int>(all.size()) + numInUse;
+        for ( size_t i=all.size(); i-- > 0; ) {
+            if ( all[i].when < idleCutoff && numKept > minPoolSize ) {
+                stale.push_back( all[i].conn );
+                numKept--;
+                _reapedIdle++;
+                continue;
+            }
             _pool.push( all[i] );
         }
     }
 
+    int PoolForHost::numToWarm( int minPoolSize , int numInUse ) {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        if ( _created == 0 ) return 0;
+        return std::max( 0, minPoolSize - static_cast<int>(_pool.size()) - numInUse );
+    }
+
+    void PoolForHost::addWarmed( DBConnectionPool * pool , DBClientBase * c ) {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+
+        if ( _created == 0 )
+            _type = c->type();
+        _created++;
+        _warmed++;
+
+        if (_maxPoolSize >= 0 && static_cast<int>(_pool.size()) >= _maxPoolSize) {
+            pool->onDestroy(c);
+            delete c;
+            return;
+        }
+        _pool.push(c);
+    }
+
+    void PoolForHost::appendInfo( BSONObjBuilder& b ) {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        b.append( "available" , static_cast<int>(_pool.size()) );
+        b.appendNumber( "created" , static_cast<long long>(_created) );
+        b.appendNumber( "reapedIdle" , _reapedIdle );
+        b.appendNumber( "warmed" , _warmed );
+    }
 
     PoolForHost::StoredConnection::StoredConnection( DBClientBase * c ) {
         conn = c;
@@ -162,17 +247,86 @@ namespace mongo {
     }
 
     void PoolForHost::createdOne( DBClientBase * base) {
+        boost::lock_guard<boost::mutex> lk(_mutex);
         if ( _created == 0 )
             _type = base->type();
         _created++;
     }
 
     void PoolForHost::initializeHostName(const std::string& hostName) {
+        boost::lock_guard<boost::mutex> lk(_mutex);
         if (_hostName.empty()) {
             _hostName = hostName;
         }
     }
 
+    // ------ HostInUseLimit ------
+
+    const double HostInUseLimit::kDefaultWaitSecs(60);
+
+    HostInUseLimit::HostInUseLimit(const std::string& hostName)
+        : _hostName(hostName),
+          _maxInUse(PoolForHost::kPoolSizeUnlimited),
+          _inUse(0),
+          _waiting(0),
+          _timedOutWaiting(0) {
+    }
+
+    void HostInUseLimit::setMaxInUse(int maxInUse) {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        if (maxInUse == _maxInUse) return;
+        _maxInUse = maxInUse;
+        _released.notify_all();
+    }
+
+    void HostInUseLimit::acquire(double socketTimeout) {
+        boost::unique_lock<boost::mutex> lk(_mutex);
+
+        if (_maxInUse >= 0 && _inUse >= _maxInUse) {
+            // Queue behind the requests already using this host, rather than adding to the load
+            // with yet another connection.  Shard connections have no socket timeout, and must
+            // not wait forever on connections which are never given back.
+            const double waitSecs = socketTimeout > 0 ? socketTimeout : kDefaultWaitSecs;
+            const boost::system_time deadline = boost::get_system_time() +
+                boost::posix_time::milliseconds(static_cast<long long>(waitSecs * 1000));
+
+            _waiting++;
+            while (_maxInUse >= 0 && _inUse >= _maxInUse) {
+                if (!_released.timed_wait(lk, deadline) &&
+                        _maxInUse >= 0 && _inUse >= _maxInUse) {
+                    _waiting--;
+                    _timedOutWaiting++;
+                    uasserted(ErrorCodes::ExceededTimeLimit,
+                              str::stream() << "too many connections to " << _hostName
+                                            << " in use (" << _inUse
+                                            << "), timed out waiting for one");
+                }
+            }
+            _waiting--;
+        }
+
+        _inUse++;
+    }
+
+    void HostInUseLimit::release() {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        invariant(_inUse > 0);
+        _inUse--;
+        _released.notify_one();
+    }
+
+    int HostInUseLimit::numInUse() {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        return _inUse;
+    }
+
+    void HostInUseLimit::appendInfo(BSONObjBuilder& b) {
+        boost::lock_guard<boost::mutex> lk(_mutex);
+        b.append( "inUse" , _inUse );
+        b.append( "waiting" , _waiting );
+        b.appendNumber( "timedOutWaiting" , _timedOutWaiting );
+    }
+
     // ------ DBConnectionPool ------
 
     DBConnectionPool pool;
@@ -182,33 +336,76 @@ namespace mongo {
     DBConnectionPool::DBConnectionPool()
         : _name( "dbconnectionpool" ) , 
           _maxPoolSize(PoolForHost::kPoolSizeUnlimited) ,
+          _maxInUse(PoolForHost::kPoolSizeUnlimited) ,
+          _minPoolSize(0) ,
+          _idleTimeoutSecs(0) ,
           _hooks( new list<DBConnectionHook*>() ) {
     }
 
-    DBClientBase* DBConnectionPool::_get(const string& ident , double socketTimeout ) {
-        uassert(17382, "Can't use connection pool during shutdown",
-                !inShutdown());
+    DBConnectionPool::PoolForHostPtr DBConnectionPool::_getPool( const string& ident ,
+                                                                 double socketTimeout ) {
+        PoolForHostPtr p;
+        {
+            boost::lock_guard<boost::mutex> L(_mutex);
+            PoolForHostPtr& slot = _pools[PoolKey(ident,socketTimeout)];
+            if ( !slot ) slot.reset( new PoolForHost() );
+            p = slot;
+        }
+
+        p->setMaxPoolSize(_maxPoolSize);
+        p->initializeHostName(ident);
+        return p;
+    }
+
+    void DBConnectionPool::_getAllPools( vector<std::pair<PoolKey, PoolForHostPtr> >* pools ) {
         boost::lock_guard<boost::mutex> L(_mutex);
-        PoolForHost& p = _pools[PoolKey(ident,socketTimeout)];
-        p.setMaxPoolSize(_maxPoolSize);
-        p.initializeHostName(ident);
-        return p.get( this , socketTimeout );
+        pools->assign( _pools.begin(), _pools.end() );
     }
 
-    DBClientBase* DBConnectionPool::_finishCreate( const string& host , double socketTimeout , DBClientBase* conn ) {
+    DBConnectionPool::HostInUseLimitPtr DBConnectionPool::_getInUseLimit( const string& ident ) {
+        HostInUseLimitPtr l;
         {
             boost::lock_guard<boost::mutex> L(_mutex);
-            PoolForHost& p = _pools[PoolKey(host,socketTimeout)];
-            p.setMaxPoolSize(_maxPoolSize);
-            p.initializeHostName(host);
-            p.createdOne( conn );
+            HostInUseLimitPtr& slot = _inUse[ident];
+            if ( !slot ) slot.reset( new HostInUseLimit( ident ) );
+            l = slot;
+        }
+
+        l->setMaxInUse(_maxInUse);
+        return l;
+    }
+
+    void DBConnectionPool::_getAllInUseLimits(
+            vector<std::pair<string, HostInUseLimitPtr> >* limits ) {
+        boost::lock_guard<boost::mutex> L(_mutex);
+        limits->assign( _inUse.begin(), _inUse.end() );
+    }
+
+    DBClientBase* DBConnectionPool::_get(const string& ident , double socketTimeout ) {
+        uassert(17382, "Can't use connection pool during shutdown",
+                !inShutdown());
+
+        // Counts the connection we return, or the one the caller creates
+        HostInUseLimitPtr inUse = _getInUseLimit( ident );
+        inUse->acquire( socketTimeout );
+        try {
+            return _getPool( ident , socketTimeout )->get( this , socketTimeout );
         }
+        catch ( ... ) {
+            inUse->release();
+            throw;
+        }
+    }
+
+    DBClientBase* DBConnectionPool::_finishCreate( const string& host , double socketTimeout , DBClientBase* conn ) {
+        _getPool( host , socketTimeout )->createdOne( conn );
         
         try {
             onCreate( conn );
             onHandedOut( conn );
         }
         catch ( std::exception & ) {
+            decrementEgress( host );
             delete conn;
             throw;
         }
@@ -223,6 +420,7 @@ namespace mongo {
                 onHandedOut( c );
             }
             catch ( std::exception& ) {
+                decrementEgress( url.toString() );
                 delete c;
                 throw;
             }
@@ -231,6 +429,10 @@ namespace mongo {
 
         string errmsg;
         c = url.connect( errmsg, socketTimeout );
+        if ( ! c ) {
+            // Give back the in-use slot _get() reserved for the new connection
+            decrementEgress( url.toString() );
+        }
         uassert( 13328 ,  _name + ": connect failed " + url.toString() + " : " + errmsg , c );
 
         return _finishCreate( url.toString() , socketTimeout , c );
@@ -243,19 +445,24 @@ namespace mongo {
                 onHandedOut( c );
             }
             catch ( std::exception& ) {
+                decrementEgress( host );
                 delete c;
                 throw;
             }
             return c;
         }
 
+        // Give back the in-use slot _get() reserved if we fail to create the connection
         string errmsg;
         ConnectionString cs = ConnectionString::parse( host , errmsg );
+        if ( ! cs.isValid() ) decrementEgress( host );
         uassert( 13071 , (string)"invalid hostname [" + host + "]" + errmsg , cs.isValid() );
 
         c = cs.connect( errmsg, socketTimeout );
-        if ( ! c )
+        if ( ! c ) {
+            decrementEgress( host );
             throw SocketException( SocketException::CONNECT_ERROR , host , 11002 , str::stream() << _name << " error: " << errmsg );
+        }
         return _finishCreate( host , socketTimeout , c );
     }
 
@@ -270,10 +477,21 @@ namespace mongo {
     }
 
     void DBConnectionPool::release(const string& host, DBClientBase *c) {
-        onRelease(c);
+        decrementEgress( host );
+        releaseIdle( host , c );
+    }
 
-        boost::lock_guard<boost::mutex> L(_mutex);
-        _pools[PoolKey(host,c->getSoTimeout())].done(this,c);
+    void DBConnectionPool::decrementEgress(const string& host) {
+        _getInUseLimit( host )->release();
+    }
+
+    void DBConnectionPool::incrementEgress(const string& host, double socketTimeout) {
+        _getInUseLimit( host )->acquire( socketTimeout );
+    }
+
+    void DBConnectionPool::releaseIdle(const string& host, DBClientBase* c) {
+        onRelease(c);
+        _getPool( host , c->getSoTimeout() )->done( this , c );
     }
 
 
@@ -282,29 +500,31 @@ namespace mongo {
     }
 
     void DBConnectionPool::flush() {
-        boost::lock_guard<boost::mutex> L(_mutex);
-        for ( PoolMap::iterator i = _pools.begin(); i != _pools.end(); i++ ) {
-            PoolForHost& p = i->second;
-            p.flush();
+        vector<std::pair<PoolKey, PoolForHostPtr> > pools;
+        _getAllPools( &pools );
+        for ( size_t i = 0; i < pools.size(); i++ ) {
+            pools[i].second->flush();
         }
     }
 
     void DBConnectionPool::clear() {
-        boost::lock_guard<boost::mutex> L(_mutex);
         LOG(2) << "Removing connections on all pools owned by " << _name  << endl;
-        for (PoolMap::iterator iter = _pools.begin(); iter != _pools.end(); ++iter) {
-            iter->second.clear();
+        vector<std::pair<PoolKey, PoolForHostPtr> > pools;
+        _getAllPools( &pools );
+        for ( size_t i = 0; i < pools.size(); i++ ) {
+            pools[i].second->clear();
         }
     }
 
     void DBConnectionPool::removeHost( const string& host ) {
-        boost::lock_guard<boost::mutex> L(_mutex);
         LOG(2) << "Removing connections from all pools for host: " << host << endl;
-        for ( PoolMap::iterator i = _pools.begin(); i != _pools.end(); ++i ) {
-            const string& poolHost = i->first.ident;
+        vector<std::pair<PoolKey, PoolForHostPtr> > pools;
+        _getAllPools( &pools );
+        for ( size_t i = 0; i < pools.size(); i++ ) {
+            const string& poolHost = pools[i].first.ident;
             if ( !serverNameCompare()(host, poolHost) && !serverNameCompare()(poolHost, host) ) {
                 // hosts are the same
-                i->second.clear();
+                pools[i].second->clear();
             }
         }
     }
@@ -350,26 +570,45 @@ namespace mongo {
         
         BSONObjBuilder bb( b.subobjStart( "hosts" ) );
         {
-            boost::lock_guard<boost::mutex> lk( _mutex );
-            for ( PoolMap::iterator i=_pools.begin(); i!=_pools.end(); ++i ) {
-                if ( i->second.numCreated() == 0 )
+            vector<std::pair<PoolKey, PoolForHostPtr> > pools;
+            _getAllPools( &pools );
+            for ( size_t i = 0; i < pools.size(); i++ ) {
+                PoolForHost& p = *pools[i].second;
+                if ( p.numCreated() == 0 )
                     continue;
 
-                string s = str::stream() << i->first.ident << "::" << i->first.timeout;
+                string s = str::stream() << pools[i].first.ident << "::" << pools[i].first.timeout;
 
                 BSONObjBuilder temp( bb.subobjStart( s ) );
-                temp.append( "available" , i->second.numAvailable() );
-                temp.appendNumber( "created" , i->second.numCreated() );
+                p.appendInfo( temp );
                 temp.done();
 
-                avail += i->second.numAvailable();
-                created += i->second.numCreated();
+                avail += p.numAvailable();
+                created += p.numCreated();
 
-                long long& x = createdByType[i->second.type()];
-                x += i->second.numCreated();
+                long long& x = createdByType[p.type()];
+                x += p.numCreated();
             }
         }
         bb.done();
+
+        int inUse = 0;
+
+        BSONObjBuilder inUseBuilder( b.subobjStart( "inUseByHost" ) );
+        {
+            vector<std::pair<string, HostInUseLimitPtr> > limits;
+            _getAllInUseLimits( &limits );
+            for ( size_t i = 0; i < limits.size(); i++ ) {
+                HostInUseLimit& l = *limits[i].second;
+
+                BSONObjBuilder temp( inUseBuilder.subobjStart( limits[i].first ) );
+                l.appendInfo( temp );
+                temp.done();
+
+                inUse += l.numInUse();
+            }
+        }
+        inUseBuilder.done();
         
         // Always report all replica sets being tracked
         set<string> replicaSets = ReplicaSetMonitor::getAllTrackedSets();
@@ -398,6 +637,7 @@ namespace mongo {
         }
 
         b.append( "totalAvailable" , avail );
+        b.append( "totalInUse" , inUse );
         b.appendNumber( "totalCreated" , created );
     }
 
@@ -446,12 +686,9 @@ namespace mongo {
             return false;
         }
 
-        {
-            boost::lock_guard<boost::mutex> sl(_mutex);
-            PoolForHost& pool = _pools[PoolKey(hostName, conn->getSoTimeout())];
-            if (pool.isBadSocketCreationTime(conn->getSockCreationMicroSec())) {
-                return false;
-            }
+        if (_getPool(hostName, conn->getSoTimeout())->isBadSocketCreationTime(
+                conn->getSockCreationMicroSec())) {
+            return false;
         }
 
         return true;
@@ -459,13 +696,20 @@ namespace mongo {
 
     void DBConnectionPool::taskDoWork() { 
         vector<DBClientBase*> toDelete;
-        
+
+        // Connections unused since before this are closed, down to the minimum pool size
+        const time_t idleCutoff = _idleTimeoutSecs > 0 ?
+                time(0) - _idleTimeoutSecs : std::numeric_limits<time_t>::min();
+
         {
-            // we need to get the connections inside the lock
+            // we need to get the connections inside the host locks
             // but we can actually delete them outside
-            boost::lock_guard<boost::mutex> lk( _mutex );
-            for ( PoolMap::iterator i=_pools.begin(); i!=_pools.end(); ++i ) {
-                i->second.getStaleConnections( toDelete );
+            vector<std::pair<PoolKey, PoolForHostPtr> > pools;
+            _getAllPools( &pools );
+            for ( size_t i = 0; i < pools.size(); i++ ) {
+                const int numInUse = _getInUseLimit( pools[i].first.ident )->numInUse();
+                pools[i].second->getStaleConnections( idleCutoff, _minPoolSize, numInUse,
+                                                      toDelete );
             }
         }
 
@@ -478,6 +722,47 @@ namespace mongo {
                 // we don't care if there was a socket error
             }
         }
+
+        _warmPools();
+    }
+
+    void DBConnectionPool::_warmPools() {
+        if ( _minPoolSize <= 0 || inShutdown() )
+            return;
+
+        vector<std::pair<PoolKey, PoolForHostPtr> > pools;
+        _getAllPools( &pools );
+
+        for ( size_t i = 0; i < pools.size(); i++ ) {
+            const string& host = pools[i].first.ident;
+            const double socketTimeout = pools[i].first.timeout;
+            PoolForHost& p = *pools[i].second;
+
+            // Connect outside of the host lock, so requests can keep using the pool meanwhile
+            const int numInUse = _getInUseLimit( host )->numInUse();
+            for ( int n = p.numToWarm( _minPoolSize , numInUse ); n > 0 && !inShutdown(); n-- ) {
+                string errmsg;
+                ConnectionString cs = ConnectionString::parse( host , errmsg );
+                DBClientBase* c = cs.isValid() ? cs.connect( errmsg, socketTimeout ) : NULL;
+                if ( !c ) {
+                    LOG(1) << _name << ": could not pre-warm connection to " << host
+                           << causedBy( errmsg );
+                    break;
+                }
+
+                try {
+                    onCreate( c );
+                }
+                catch ( const std::exception& e ) {
+                    LOG(1) << _name << ": could not pre-warm connection to " << host
+                           << causedBy( e );
+                    delete c;
+                    break;
+                }
+
+                p.addWarmed( this, c );
+            }
+        }
     }
 
     // ------ ScopedDbConnection ------
@@ -30,8 +30,12 @@
 #pragma once
 
 #include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
 #include <stack>
 
+#include "mongo/base/disallow_copying.h"
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/platform/cstdint.h"
@@ -43,10 +47,13 @@ namespace mongo {
     class DBConnectionPool;
 
     /**
-     * not thread safe
-     * thread safety is handled by DBConnectionPool
+     * The pooled connections to a single host, for a single socket timeout.
+     *
+     * Thread safe.  Each host has its own lock, so traffic to one host does not contend with
+     * traffic to any other.
      */
     class PoolForHost {
+        MONGO_DISALLOW_COPYING(PoolForHost);
     public:
 
         // Sentinel value indicating pool has no cleanup limit
@@ -56,16 +63,9 @@ namespace mongo {
             _created(0),
             _minValidCreationTimeMicroSec(0),
             _type(ConnectionString::INVALID),
-            _maxPoolSize(kPoolSizeUnlimited) {
-        }
-
-        PoolForHost(const PoolForHost& other) :
-            _created(other._created),
-            _minValidCreationTimeMicroSec(other._minValidCreationTimeMicroSec),
-            _type(other._type),
-            _maxPoolSize(other._maxPoolSize) {
-            verify(_created == 0);
-            verify(other._pool.size() == 0);
+            _maxPoolSize(kPoolSizeUnlimited),
+            _reapedIdle(0),
+            _warmed(0) {
         }
 
         ~PoolForHost();
@@ -73,22 +73,22 @@ namespace mongo {
         /**
          * Returns the maximum number of connections stored in the pool
          */
-        int getMaxPoolSize() { return _maxPoolSize; }
+        int getMaxPoolSize();
 
         /**
          * Sets the maximum number of connections stored in the pool
          */
-        void setMaxPoolSize( int maxPoolSize ) { _maxPoolSize = maxPoolSize; }
+        void setMaxPoolSize( int maxPoolSize );
 
-        int numAvailable() const { return (int)_pool.size(); }
+        int numAvailable();
 
         void createdOne( DBClientBase * base );
-        long long numCreated() const { return _created; }
+        long long numCreated();
 
-        ConnectionString::ConnectionType type() const { verify(_created); return _type; }
+        ConnectionString::ConnectionType type();
 
         /**
-         * gets a connection or return NULL
+         * Returns a pooled connection, or NULL if the caller has to create one.
          */
         DBClientBase * get( DBConnectionPool * pool , double socketTimeout );
 
@@ -99,7 +99,26 @@ namespace mongo {
 
         void flush();
 
-        void getStaleConnections( std::vector<DBClientBase*>& stale );
+        /**
+         * Removes connections which are no longer connected, and connections which have been
+         * idle since before 'idleCutoff' as long as 'minPoolSize' connections are left, counting
+         * the 'numInUse' connections to the host which are handed out.
+         */
+        void getStaleConnections( time_t idleCutoff,
+                                  int minPoolSize,
+                                  int numInUse,
+                                  std::vector<DBClientBase*>& stale );
+
+        /**
+         * Returns how many connections must be created to have 'minPoolSize' connections to this
+         * host, counting both the pooled ones and the 'numInUse' handed out ones.
+         */
+        int numToWarm( int minPoolSize , int numInUse );
+
+        /**
+         * Stores a connection created ahead of demand by the pool maintenance task.
+         */
+        void addWarmed( DBConnectionPool * pool , DBClientBase * c );
 
         /**
          * Sets the lower bound for creation times that can be considered as
@@ -118,6 +137,8 @@ namespace mongo {
          */
         void initializeHostName(const std::string& hostName);
 
+        void appendInfo( BSONObjBuilder& b );
+
     private:
 
         struct StoredConnection {
@@ -129,6 +150,12 @@ namespace mongo {
             time_t when;
         };
 
+        // Must hold _mutex for all of the below
+        void _clear();
+        void _reportBadConnectionAt(uint64_t microSec);
+
+        boost::mutex _mutex;
+
         std::string _hostName;
         std::stack<StoredConnection> _pool;
 
@@ -138,6 +165,63 @@ namespace mongo {
 
         // The maximum number of connections we'll save in the pool
         int _maxPoolSize;
+
+        // Stats for connPoolStats
+        long long _reapedIdle;
+        long long _warmed;
+    };
+
+    /**
+     * Counts the connections to a single host which are handed out by a DBConnectionPool, over
+     * all socket timeouts, and makes callers queue for a connection once a limit is reached.
+     * Connections sitting in a pool, or kept idle by their owner, are not counted.
+     *
+     * Thread safe.
+     */
+    class HostInUseLimit {
+        MONGO_DISALLOW_COPYING(HostInUseLimit);
+    public:
+
+        // How long acquire() waits for a slot when the caller has no socket timeout
+        static const double kDefaultWaitSecs;
+
+        explicit HostInUseLimit( const std::string& hostName );
+
+        /**
+         * Sets the maximum number of connections which may be handed out at once.
+         * PoolForHost::kPoolSizeUnlimited means no limit.
+         */
+        void setMaxInUse( int maxInUse );
+
+        /**
+         * Takes an in-use slot, waiting up to 'socketTimeout' seconds (kDefaultWaitSecs if 0)
+         * for one to be released.  Throws an ExceededTimeLimit UserException if none was.
+         */
+        void acquire( double socketTimeout );
+
+        /**
+         * Gives back a slot taken by acquire().
+         */
+        void release();
+
+        int numInUse();
+
+        void appendInfo( BSONObjBuilder& b );
+
+    private:
+        boost::mutex _mutex;
+
+        // Signaled whenever a slot is released, or the limit changes
+        boost::condition_variable _released;
+
+        const std::string _hostName;
+
+        int _maxInUse;
+        int _inUse;
+
+        // Stats for connPoolStats
+        int _waiting;
+        long long _timedOutWaiting;
     };
 
     class DBConnectionHook {
@@ -189,6 +273,27 @@ namespace mongo {
          */
         void setMaxPoolSize( int maxPoolSize ) { _maxPoolSize = maxPoolSize; }
 
+        /**
+         * Sets the maximum number of connections per-host which may be handed out at once.
+         * PoolForHost::kPoolSizeUnlimited means no limit.  Beyond the limit get() waits for a
+         * connection to be released, up to the requested socket timeout or
+         * HostInUseLimit::kDefaultWaitSecs without one, so that a burst of requests queues
+         * rather than opening a burst of new connections.
+         */
+        void setMaxInUse( int maxInUse ) { _maxInUse = maxInUse; }
+
+        /**
+         * Sets the number of connections per-host the periodic pool task creates ahead of demand,
+         * for hosts we have connected to before.  Idle connections are not reaped below this.
+         */
+        void setMinPoolSize( int minPoolSize ) { _minPoolSize = minPoolSize; }
+
+        /**
+         * Pooled connections idle for longer than this are closed by the periodic pool task.
+         * 0 keeps idle connections open.
+         */
+        void setIdleTimeoutSecs( int idleTimeoutSecs ) { _idleTimeoutSecs = idleTimeoutSecs; }
+
         void onCreate( DBClientBase * conn );
         void onHandedOut( DBClientBase * conn );
         void onDestroy( DBClientBase * conn );
@@ -201,6 +306,23 @@ namespace mongo {
 
         void release(const std::string& host, DBClientBase *c);
 
+        /**
+         * Gives back the in-use slot of a connection handed out for 'host' which was destroyed
+         * rather than released, or which the caller keeps idle for later reuse.
+         */
+        void decrementEgress(const std::string& host);
+
+        /**
+         * Takes an in-use slot again for a connection to 'host' kept idle after
+         * decrementEgress(), before the caller uses it.  Waits like get() does.
+         */
+        void incrementEgress(const std::string& host, double socketTimeout);
+
+        /**
+         * Returns a connection kept idle after decrementEgress() to the pool.
+         */
+        void releaseIdle(const std::string& host, DBClientBase* c);
+
         void addHook( DBConnectionHook * hook ); // we take ownership
         void appendInfo( BSONObjBuilder& b );
 
@@ -238,6 +360,11 @@ namespace mongo {
 
         DBClientBase* _finishCreate( const std::string& ident , double socketTimeout, DBClientBase* conn );
 
+        /**
+         * Creates connections to hosts which have fewer than _minPoolSize.
+         */
+        void _warmPools();
+
         struct PoolKey {
             PoolKey( const std::string& i , double t ) : ident( i ) , timeout( t ) {}
             std::string ident;
@@ -248,8 +375,30 @@ namespace mongo {
             bool operator()( const PoolKey& a , const PoolKey& b ) const;
         };
 
-        typedef std::map<PoolKey,PoolForHost,poolKeyCompare> PoolMap; // servername -> pool
+        typedef boost::shared_ptr<PoolForHost> PoolForHostPtr;
+        typedef std::map<PoolKey,PoolForHostPtr,poolKeyCompare> PoolMap; // servername -> pool
+
+        typedef boost::shared_ptr<HostInUseLimit> HostInUseLimitPtr;
+        typedef std::map<std::string,HostInUseLimitPtr,serverNameCompare> InUseLimitMap;
 
+        /**
+         * Returns the pool for the host, creating it if needed, with the current limits applied.
+         */
+        PoolForHostPtr _getPool( const std::string& ident , double socketTimeout );
+
+        // Returns all host pools, so they can be visited without holding _mutex
+        void _getAllPools( std::vector<std::pair<PoolKey, PoolForHostPtr> >* pools );
+
+        /**
+         * Returns the in-use counter for the host, creating it if needed, with the current limit
+         * applied.
+         */
+        HostInUseLimitPtr _getInUseLimit( const std::string& ident );
+
+        // Same as _getAllPools(), for the in-use counters
+        void _getAllInUseLimits( std::vector<std::pair<std::string, HostInUseLimitPtr> >* limits );
+
+        // Only protects _pools and _inUse, each PoolForHost and HostInUseLimit has its own lock
         mongo::mutex _mutex;
         std::string _name;
 
@@ -258,7 +407,13 @@ namespace mongo {
         // 0 effectively disables the pool
         int _maxPoolSize;
 
+        // See setMaxInUse(), setMinPoolSize() and setIdleTimeoutSecs()
+        int _maxInUse;
+        int _minPoolSize;
+        int _idleTimeoutSecs;
+
         PoolMap _pools;
+        InUseLimitMap _inUse;
 
         // pointers owned by me, right now they leak on shutdown
         // _hooks itself also leaks because it creates a shutdown race condition
@@ -345,6 +500,7 @@ namespace mongo {
             a bad state.  Destructor will do this too, but it is verbose.
         */
         void kill() {
+            if ( _conn ) pool.decrementEgress(_host);
             delete _conn;
             _conn = 0;
         }
@@ -182,6 +182,10 @@ namespace {
         if (_lastSlaveOkConn.get() == _master.get()) {
             _lastSlaveOkConn.release();
         }
+        else if (_lastSlaveOkConn.get() != NULL) {
+            // Destroyed with us rather than returned to the pool
+            pool.decrementEgress(_lastSlaveOkHost.toString());
+        }
     }
 
     ReplicaSetMonitorPtr DBClientReplicaSet::_getMonitor() const {
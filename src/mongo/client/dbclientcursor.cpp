@@ -33,14 +33,20 @@
 
 #include "mongo/client/dbclientcursor.h"
 
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/mutex.hpp>
+
 #include "mongo/client/connpool.h"
 #include "mongo/db/dbmessage.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/s/shard.h"
 #include "mongo/s/stale_exception.h"  // for RecvStaleConfigException
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/debug_util.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -154,25 +160,36 @@ namespace mongo {
         return ok;
     }
 
+    void DBClientCursor::_assembleGetMore( Message& toSend ) {
+        BufBuilder b;
+        b.appendNum(opts);
+        b.appendStr(ns);
+        b.appendNum(nextBatchSize());
+        b.appendNum(cursorId);
+        toSend.setData(dbGetMore, b.buf(), b.len());
+    }
+
     void DBClientCursor::requestMore() {
         verify( cursorId && batch.pos == batch.nReturned );
 
+        if ( _prefetch ) {
+            receivePrefetched();
+            return;
+        }
+
         if (haveLimit) {
             nToReturn -= batch.nReturned;
             verify(nToReturn > 0);
         }
-        BufBuilder b;
-        b.appendNum(opts);
-        b.appendStr(ns);
-        b.appendNum(nextBatchSize());
-        b.appendNum(cursorId);
 
         Message toSend;
-        toSend.setData(dbGetMore, b.buf(), b.len());
+        _assembleGetMore( toSend );
         auto_ptr<Message> response(new Message());
 
+        Timer waitTimer;
         if ( _client ) {
             _client->call( toSend, *response );
+            _microsWaitingForMore += waitTimer.micros();
             this->batch.m = response;
             dataReceived();
         }
@@ -180,6 +197,7 @@ namespace mongo {
             verify( _scopedHost.size() );
             ScopedDbConnection conn(_scopedHost);
             conn->call( toSend , *response );
+            _microsWaitingForMore += waitTimer.micros();
             _client = conn.get();
             this->batch.m = response;
             dataReceived();
@@ -188,6 +206,125 @@ namespace mongo {
         }
     }
 
+    /**
+     * Shared between a cursor and the pool thread running its prefetched getMore.  Whichever of
+     * the two sets 'started' first runs the request, so a cursor never waits on a request which
+     * is still queued behind other cursors' prefetches.
+     */
+    struct DBClientCursor::PrefetchState {
+        PrefetchState() : started( false ), done( false ), status( Status::OK() ) {}
+
+        boost::mutex mutex;
+        boost::condition_variable doneCondition;
+        bool started;
+        bool done;
+
+        // Set before the request is scheduled, then only read
+        std::string host;
+        Message toSend;
+
+        // Set by the runner, valid once 'done'
+        auto_ptr<Message> response;
+        Status status;
+    };
+
+    bool DBClientCursor::prefetchMore( threadpool::ThreadPool* pool ) {
+        if ( _prefetch ) {
+            return true;
+        }
+
+        if ( _client || _scopedHost.empty() || !cursorId || !_ownCursor || haveLimit ||
+             ( opts & ( QueryOption_CursorTailable | QueryOption_Exhaust ) ) ) {
+            return false;
+        }
+
+        boost::shared_ptr<PrefetchState> state( new PrefetchState() );
+        state->host = _scopedHost;
+        _assembleGetMore( state->toSend );
+
+        _prefetch = state;
+        pool->schedule( &DBClientCursor::runPrefetch, state );
+        return true;
+    }
+
+    void DBClientCursor::runPrefetch( boost::shared_ptr<PrefetchState> state ) {
+        {
+            boost::lock_guard<boost::mutex> lk( state->mutex );
+            if ( state->started ) return;
+            state->started = true;
+        }
+
+        auto_ptr<Message> response( new Message() );
+        Status status = Status::OK();
+        try {
+            ScopedDbConnection conn( state->host );
+            conn->call( state->toSend, *response );
+            uassert( 28638, "empty response to getMore", !response->empty() );
+
+            // The cursor has no connection to check the reply against once we return it
+            QueryResult::View qr = response->singleData().view2ptr();
+            bool retry;
+            string host;
+            conn->checkResponse( qr.data(), qr.getNReturned(), &retry, &host );
+
+            conn.done();
+        }
+        catch ( const DBException& e ) {
+            status = e.toStatus();
+        }
+        catch ( const std::exception& e ) {
+            status = Status( ErrorCodes::UnknownError, e.what() );
+        }
+
+        boost::lock_guard<boost::mutex> lk( state->mutex );
+        state->response = response;
+        state->status = status;
+        state->done = true;
+        state->doneCondition.notify_all();
+    }
+
+    void DBClientCursor::receivePrefetched() {
+        boost::shared_ptr<PrefetchState> state;
+        state.swap( _prefetch );
+
+        Timer waitTimer;
+
+        // Runs the request here if no pool thread has started it yet
+        runPrefetch( state );
+
+        boost::unique_lock<boost::mutex> lk( state->mutex );
+        while ( !state->done ) {
+            state->doneCondition.wait( lk );
+        }
+        _microsWaitingForMore += waitTimer.micros();
+
+        uassert( 28637,
+                 str::stream() << "error prefetching more results for cursor " << cursorId
+                               << " from " << state->host << causedBy( state->status ),
+                 state->status.isOK() );
+
+        batch.m = state->response;
+        dataReceived();
+    }
+
+    void DBClientCursor::cancelPrefetch() {
+        if ( !_prefetch ) return;
+
+        boost::shared_ptr<PrefetchState> state;
+        state.swap( _prefetch );
+
+        // Keep a queued request from running at all, or wait for a running one so that it does
+        // not race with our killCursors
+        boost::unique_lock<boost::mutex> lk( state->mutex );
+        if ( !state->started ) {
+            state->started = true;
+            return;
+        }
+        while ( !state->done ) {
+            state->doneCondition.wait( lk );
+        }
+    }
+
     /** with QueryOption_Exhaust, the server just blasts data at us (marked at end with cursorid==0). */
     void DBClientCursor::exhaustReceiveMore() {
         verify( cursorId && batch.pos == batch.nReturned );
@@ -233,7 +370,10 @@ namespace mongo {
         batch.pos = 0;
         batch.data = qr.data();
 
-        _client->checkResponse( batch.data, batch.nReturned, &retry, &host ); // watches for "not master"
+        // Prefetched batches were already checked against the connection they came from
+        if ( _client ) {
+            _client->checkResponse( batch.data, batch.nReturned, &retry, &host ); // watches for "not master"
+        }
 
         if( qr.getResultFlags() & ResultFlag_ShardConfigStale ) {
             BSONObj error;
@@ -364,6 +504,8 @@ namespace mongo {
     DBClientCursor::~DBClientCursor() {
         DESTRUCTOR_GUARD (
 
+        cancelPrefetch();
+
         if ( cursorId && _ownCursor && ! inShutdown() ) {
             BufBuilder b;
             b.appendNum( (int)0 ); // reserved
@@ -30,6 +30,7 @@
 #pragma once
 
 #include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
 #include <stack>
 
 #include "mongo/client/dbclientinterface.h"
@@ -41,6 +42,10 @@ namespace mongo {
 
     class AScopedConnection;
 
+    namespace threadpool {
+        class ThreadPool;
+    }
+
     /** for mock purposes only -- do not create variants of DBClientCursor, nor hang code here
         @see DBClientMockCursor
      */
@@ -149,7 +154,8 @@ namespace mongo {
             resultFlags(0),
             cursorId(),
             _ownCursor( true ),
-            wasError( false ) {
+            wasError( false ),
+            _microsWaitingForMore( 0 ) {
             _finishConsInit();
         }
 
@@ -165,7 +171,8 @@ namespace mongo {
             resultFlags(0),
             cursorId(_cursorId),
             _ownCursor(true),
-            wasError(false) {
+            wasError(false),
+            _microsWaitingForMore(0) {
             _finishConsInit();
         }
 
@@ -180,6 +187,25 @@ namespace mongo {
 
         void attach( AScopedConnection * conn );
 
+        /**
+         * Starts fetching the next batch on 'pool' while the current batch is consumed, so that
+         * more() does not wait a full round-trip when the current batch runs out.  At most one
+         * batch is prefetched at a time.  If no pool thread has picked the request up by the
+         * time more() needs it, more() runs it itself.
+         *
+         * Only cursors detached from their connection by attach() can prefetch, since the
+         * getMore runs on its own pooled connection.  Cursors with a limit, tailable, exhaust
+         * and decoupled cursors are never prefetched.
+         *
+         * Returns true if a getMore is now in flight.
+         */
+        bool prefetchMore( threadpool::ThreadPool* pool );
+
+        /**
+         * Microseconds more() has spent blocked waiting for getMore responses.
+         */
+        long long getMicrosWaitingForMore() const { return _microsWaitingForMore; }
+
         std::string originalHost() const { return _originalHost; }
 
         std::string getns() const { return ns; }
@@ -240,9 +266,17 @@ namespace mongo {
         std::string _lazyHost;
         bool wasError;
 
+        // A getMore started by prefetchMore(), see dbclientcursor.cpp
+        struct PrefetchState;
+        boost::shared_ptr<PrefetchState> _prefetch;
+        long long _microsWaitingForMore;
+
         void dataReceived() { bool retry; std::string lazyHost; dataReceived( retry, lazyHost ); }
         void dataReceived( bool& retry, std::string& lazyHost );
         void requestMore();
+        void receivePrefetched();
+        void cancelPrefetch();
+        static void runPrefetch( boost::shared_ptr<PrefetchState> state );
         void exhaustReceiveMore(); // for exhaust
 
         // Don't call from a virtual function
@@ -254,6 +288,7 @@ namespace mongo {
 
         // init pieces
         void _assembleInit( Message& toSend );
+        void _assembleGetMore( Message& toSend );
     };
 
     /** iterate over objects in current batch only - will not cause a network call
@@ -42,11 +42,13 @@
 #include "mongo/client/dbclient_rs.h"
 #include "mongo/client/replica_set_monitor.h"
 #include "mongo/db/query/lite_parsed_query.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/chunk_manager.h"
 #include "mongo/s/config.h"
 #include "mongo/s/grid.h"
 #include "mongo/s/stale_exception.h"
 #include "mongo/s/version_manager.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -62,6 +64,23 @@ namespace mongo {
 
     LabeledLevel pc( "pcursor", 2 );
 
+    // Threads shared by all parallel cursors for fetching the next batch of each shard cursor
+    // while its current batch is merged.  0 disables prefetching.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(parallelCursorPrefetchThreads, int, 16);
+
+    /**
+     * The pool is created on first use and never destroyed or joined, like the global connection
+     * pools its tasks take connections from.  This is safe because a task only references the
+     * PrefetchState it shares with its cursor, never the cursor itself, and a cursor's destructor
+     * cancels its queued prefetch or waits for its running one.  Joining at exit would instead
+     * hold up shutdown behind getMores waiting on slow shards.
+     */
+    static threadpool::ThreadPool* prefetchPool() {
+        static threadpool::ThreadPool* pool =
+            new threadpool::ThreadPool( parallelCursorPrefetchThreads, "pcursorPrefetch" );
+        return pool;
+    }
+
     void ParallelSortClusteredCursor::init() {
         if ( _didInit )
             return;
@@ -242,6 +261,7 @@ namespace mongo {
                   : 0 );
         b.append( "numQueries" , (int)numExplains );
         b.append( "numShards" , (int)out.size() );
+        b.appendNumber( "millisBlockedOnShards" , getMicrosWaitingOnShards() / 1000 );
 
         if ( out.size() == 1 ) {
             b.append( "indexBounds" , indexBounds );
@@ -455,6 +475,7 @@ namespace mongo {
 
         stateB.append( "count", count );
         stateB.append( "done", done );
+        if ( cursor ) stateB.appendNumber( "microsWaiting", cursor->getMicrosWaitingForMore() );
 
         return stateB.obj().getOwned();
     }
@@ -1501,6 +1522,11 @@ namespace mongo {
             _needToSkip = n;
         }
 
+        if ( !_sortKey.isEmpty() ) {
+            _initMerge();
+            return !_merge->empty();
+        }
+
         for ( int i=0; i<_numServers; i++ ) {
             if (_cursors[i].get() && _cursors[i].get()->more())
                 return true;
@@ -1509,6 +1535,10 @@ namespace mongo {
     }
 
     BSONObj ParallelSortClusteredCursor::next() {
+        if ( !_sortKey.isEmpty() ) {
+            return _nextMerged();
+        }
+
         BSONObj best = BSONObj();
         int bestFrom = -1;
 
@@ -1559,9 +1589,63 @@ namespace mongo {
         if (_cursors[bestFrom].getMData())
             _cursors[bestFrom].getMData()->pcState->count++;
 
+        _prefetch( bestFrom );
+
+        return best;
+    }
+
+    void ParallelSortClusteredCursor::_initMerge() {
+        if ( _merge )
+            return;
+
+        _merge.reset( new SortedCursorMerge<DBClientCursor>( _sortKey ) );
+        for ( int i = 0; i < _numServers; i++ ) {
+            _addToMerge( i );
+        }
+    }
+
+    void ParallelSortClusteredCursor::_addToMerge( int index ) {
+        if ( !_merge->add( index, _cursors[index].get() ) ) {
+            if (_cursors[index].getMData())
+                _cursors[index].getMData()->pcState->done = true;
+        }
+    }
+
+    BSONObj ParallelSortClusteredCursor::_nextMerged() {
+        _initMerge();
+
+        int from;
+        BSONObj best = _merge->next( &from );
+
+        if (_cursors[from].getMData())
+            _cursors[from].getMData()->pcState->count++;
+
+        _lastFrom = from;
+        _prefetch( from );
+        _addToMerge( from );
+
         return best;
     }
 
+    void ParallelSortClusteredCursor::_prefetch( int index ) {
+        if ( parallelCursorPrefetchThreads <= 0 )
+            return;
+
+        DBClientCursor* cursor = _cursors[index].get();
+        if ( cursor ) {
+            cursor->prefetchMore( prefetchPool() );
+        }
+    }
+
+    long long ParallelSortClusteredCursor::getMicrosWaitingOnShards() {
+        long long micros = 0;
+        for ( int i = 0; _cursors && i < _numServers; i++ ) {
+            if (_cursors[i].get())
+                micros += _cursors[i].get()->getMicrosWaitingForMore();
+        }
+        return micros;
+    }
+
     void ParallelSortClusteredCursor::_explain( map< string,list<BSONObj> >& out ) {
 
         set<Shard> shards;
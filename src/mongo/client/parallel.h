@@ -34,6 +34,7 @@
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
 
+#include "mongo/client/sorted_cursor_merge.h"
 #include "mongo/db/matcher/matcher.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/s/client/shard_connection.h"
@@ -241,9 +242,22 @@ namespace mongo {
 
         void explain(BSONObjBuilder& b);
 
+        /**
+         * Returns the total microseconds spent blocked waiting for more results from the shards.
+         */
+        long long getMicrosWaitingOnShards();
+
     private:
         void _finishCons();
 
+        // Sorted merge of the shard cursors, see SortedCursorMerge
+        void _initMerge();
+        void _addToMerge( int index );
+        BSONObj _nextMerged();
+
+        // Starts fetching the next batch of the shard cursor at 'index' in the background
+        void _prefetch( int index );
+
         void _explain( std::map< std::string,std::list<BSONObj> >& out );
 
         void _markStaleNS( const NamespaceString& staleNS, const StaleConfigException& e, bool& forceReload, bool& fullReload );
@@ -270,6 +284,9 @@ namespace mongo {
         DBClientCursorHolder * _cursors;
         int _needToSkip;
 
+        // Created on the first more() or next() of a sorted query
+        boost::scoped_ptr<SortedCursorMerge<DBClientCursor> > _merge;
+
         /**
          * Setups the shard version of the connection. When using a replica
          * set connection and the primary cannot be reached, the version
@@ -244,6 +244,7 @@ namespace mongo_test {
             delete _dummyServer;
 
             mongo::pool.setMaxPoolSize(_maxPoolSizePerHost);
+            mongo::pool.setMaxInUse(mongo::PoolForHost::kPoolSizeUnlimited);
         }
 
     protected:
@@ -428,4 +429,64 @@ namespace mongo_test {
 
         conn1Again.done();
     }
+
+    TEST_F(DummyServerFixture, MaxInUseQueuesUntilRelease) {
+        mongo::pool.setMaxInUse(1);
+
+        ScopedDbConnection conn1(TARGET_HOST, 1);
+
+        // The only slot is taken, so this waits out its socket timeout
+        mongo::Timer timer;
+        ASSERT_THROWS(ScopedDbConnection(TARGET_HOST, 1), mongo::UserException);
+        ASSERT_GREATER_THAN_OR_EQUALS(timer.millis(), 900);
+
+        conn1.done();
+
+        // Released connections free their slot, and so do killed ones
+        ScopedDbConnection conn2(TARGET_HOST, 1);
+        conn2.kill();
+
+        ScopedDbConnection conn3(TARGET_HOST, 1);
+        conn3.done();
+    }
+
+    TEST_F(DummyServerFixture, MaxInUseCountsAllSocketTimeouts) {
+        mongo::pool.setMaxInUse(1);
+
+        ScopedDbConnection conn1(TARGET_HOST, 1);
+
+        // Another socket timeout means another pool, but the same host limit
+        ASSERT_THROWS(ScopedDbConnection(TARGET_HOST, 2), mongo::UserException);
+
+        conn1.done();
+    }
+
+    TEST_F(DummyServerFixture, IdleConnectionsDoNotCountAsInUse) {
+        mongo::pool.setMaxInUse(1);
+
+        DBClientBase* idle = mongo::pool.get(TARGET_HOST, 1);
+        mongo::pool.decrementEgress(TARGET_HOST);
+
+        // The idle connection gave back its slot
+        ScopedDbConnection conn1(TARGET_HOST, 1);
+        conn1.done();
+
+        mongo::pool.incrementEgress(TARGET_HOST, 1);
+        mongo::pool.release(TARGET_HOST, idle);
+    }
+
+    TEST_F(DummyServerFixture, ReportsInUseConnections) {
+        ScopedDbConnection conn1(TARGET_HOST);
+        ScopedDbConnection conn2(TARGET_HOST);
+        conn2.done();
+
+        mongo::BSONObjBuilder b;
+        mongo::pool.appendInfo(b);
+        const mongo::BSONObj info = b.obj();
+
+        ASSERT_EQUALS(1, info["totalInUse"].numberInt());
+        ASSERT_EQUALS(1, info["totalAvailable"].numberInt());
+
+        conn1.done();
+    }
 }
@@ -0,0 +1,130 @@
+// sorted_cursor_merge.h
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+    /**
+     * Merges the results of several cursors which each return results in the order of the same
+     * sort key.  The cursors with more results are kept in a binary heap ordered by their next
+     * result, so each merged result costs O(log n) comparisons for n cursors.  Ties go to the
+     * cursor with the lower index.
+     *
+     * 'Cursor' needs more(), next(), peekFirst() and moreInCurrentBatch() as on DBClientCursor.
+     * The cursors are not owned.
+     */
+    template <typename Cursor>
+    class SortedCursorMerge {
+        MONGO_DISALLOW_COPYING(SortedCursorMerge);
+    public:
+        explicit SortedCursorMerge( const BSONObj& sortKey ) : _sortKey( sortKey ) {}
+
+        /**
+         * Puts 'cursor' into the merge under 'index' if it has more results.  Calls more() on the
+         * cursor, so it may wait for and throw on fetching the cursor's next batch.  Returns
+         * false if the cursor is exhausted.
+         */
+        bool add( int index, Cursor* cursor ) {
+            if ( !cursor || !cursor->more() ) {
+                return false;
+            }
+
+            _heap.push_back( Entry( index, cursor ) );
+            std::push_heap( _heap.begin(), _heap.end(), Order( _sortKey ) );
+            return true;
+        }
+
+        bool empty() const { return _heap.empty(); }
+
+        /**
+         * Takes the cursor with the first result in sort order out of the merge, and returns that
+         * result after moving the cursor past it.  '*from' is set to the index of the cursor.
+         *
+         * The result stays valid after the cursor fetches its next batch, or fails to, so the
+         * caller can add() the cursor back before it is done with the result.
+         */
+        BSONObj next( int* from ) {
+            uassert( 10019, "no more elements", !_heap.empty() );
+
+            std::pop_heap( _heap.begin(), _heap.end(), Order( _sortKey ) );
+            const Entry top = _heap.back();
+            _heap.pop_back();
+
+            BSONObj result = top.head;
+            top.cursor->next();
+
+            // The head points into the cursor's current batch, which goes away with the next one
+            if ( !top.cursor->moreInCurrentBatch() ) {
+                result = result.getOwned();
+            }
+
+            *from = top.index;
+            return result;
+        }
+
+    private:
+        struct Entry {
+            Entry( int index, Cursor* cursor )
+                : index( index ), cursor( cursor ), head( cursor->peekFirst() ) {
+            }
+
+            int index;
+            Cursor* cursor;
+
+            // The cursor's next result, which is only read while it stays in its current batch
+            BSONObj head;
+        };
+
+        // Puts the entry whose head sorts first at the top of the heap
+        class Order {
+        public:
+            explicit Order( const BSONObj& sortKey ) : _sortKey( sortKey ) {}
+
+            bool operator()( const Entry& a, const Entry& b ) const {
+                const int cmp = a.head.woSortOrder( b.head, _sortKey, true );
+                return cmp > 0 || ( cmp == 0 && a.index > b.index );
+            }
+
+        private:
+            const BSONObj& _sortKey;
+        };
+
+        const BSONObj _sortKey;
+        std::vector<Entry> _heap;
+    };
+
+} // namespace mongo
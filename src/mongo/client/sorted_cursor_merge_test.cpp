@@ -0,0 +1,285 @@
+// sorted_cursor_merge_test.cpp
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <vector>
+
+#include "mongo/client/sorted_cursor_merge.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+    using namespace mongo;
+    using std::vector;
+
+    /**
+     * A cursor over a list of batches, which like DBClientCursor hands out results pointing into
+     * its current batch.  Every batch is copied into the same buffer, so results which were not
+     * copied in time read the next batch's data.  Fetching a batch can be made to fail, as a
+     * prefetched getMore can.
+     */
+    class BatchCursor {
+    public:
+        explicit BatchCursor( const vector<BSONArray>& batches )
+            : _batches( batches ),
+              _nextBatch( 0 ),
+              _pos( 0 ),
+              _failNextFetch( false ) {
+            _buffer.reserve( 4096 );
+        }
+
+        void failNextFetch() { _failNextFetch = true; }
+
+        bool more() {
+            if ( moreInCurrentBatch() ) {
+                return true;
+            }
+            if ( _nextBatch == _batches.size() ) {
+                return false;
+            }
+
+            if ( _failNextFetch ) {
+                uasserted( ErrorCodes::HostUnreachable, "mock getMore failure" );
+            }
+            _loadBatch( _batches[_nextBatch++] );
+            return moreInCurrentBatch();
+        }
+
+        bool moreInCurrentBatch() const { return _pos < _offsets.size(); }
+
+        BSONObj peekFirst() const { return BSONObj( &_buffer[_offsets[_pos]] ); }
+
+        BSONObj next() {
+            BSONObj result = peekFirst();
+            _pos++;
+            return result;
+        }
+
+    private:
+        void _loadBatch( const BSONArray& batch ) {
+            _buffer.clear();
+            _offsets.clear();
+            _pos = 0;
+
+            BSONObjIterator it( batch );
+            while ( it.more() ) {
+                BSONObj obj = it.next().Obj();
+                _offsets.push_back( _buffer.size() );
+                _buffer.insert( _buffer.end(), obj.objdata(), obj.objdata() + obj.objsize() );
+            }
+
+            // Results of the previous batch must not be read from the buffer any more
+            invariant( _buffer.capacity() == 4096 );
+        }
+
+        const vector<BSONArray> _batches;
+        size_t _nextBatch;
+
+        vector<char> _buffer;
+        vector<size_t> _offsets;
+        size_t _pos;
+
+        bool _failNextFetch;
+    };
+
+    vector<BSONArray> oneBatch( const BSONArray& batch ) {
+        return vector<BSONArray>( 1, batch );
+    }
+
+    /**
+     * Merges all results of 'cursors', returning the cursor index each one came from in
+     * 'fromOut'.
+     */
+    vector<BSONObj> mergeAll( const BSONObj& sortKey,
+                              vector<BatchCursor*> cursors,
+                              vector<int>* fromOut ) {
+        SortedCursorMerge<BatchCursor> merge( sortKey );
+        for ( size_t i = 0; i < cursors.size(); i++ ) {
+            merge.add( i, cursors[i] );
+        }
+
+        vector<BSONObj> results;
+        while ( !merge.empty() ) {
+            int from;
+            results.push_back( merge.next( &from ).getOwned() );
+            fromOut->push_back( from );
+            merge.add( from, cursors[from] );
+        }
+        return results;
+    }
+
+    TEST(SortedCursorMergeTest, Ascending) {
+        BatchCursor a( oneBatch( BSON_ARRAY( BSON( "x" << 1 ) << BSON( "x" << 4 ) ) ) );
+        BatchCursor b( oneBatch( BSON_ARRAY( BSON( "x" << 2 ) << BSON( "x" << 3 ) ) ) );
+        BatchCursor c( oneBatch( BSONArray() ) );
+
+        vector<BatchCursor*> cursors;
+        cursors.push_back( &a );
+        cursors.push_back( &b );
+        cursors.push_back( &c );
+
+        vector<int> from;
+        vector<BSONObj> results = mergeAll( BSON( "x" << 1 ), cursors, &from );
+
+        ASSERT_EQUALS( 4U, results.size() );
+        for ( int i = 0; i < 4; i++ ) {
+            ASSERT_EQUALS( BSON( "x" << i + 1 ), results[i] );
+        }
+        ASSERT_EQUALS( 0, from[0] );
+        ASSERT_EQUALS( 1, from[1] );
+        ASSERT_EQUALS( 1, from[2] );
+        ASSERT_EQUALS( 0, from[3] );
+    }
+
+    TEST(SortedCursorMergeTest, Descending) {
+        BatchCursor a( oneBatch( BSON_ARRAY( BSON( "x" << 5 ) << BSON( "x" << 1 ) ) ) );
+        BatchCursor b( oneBatch( BSON_ARRAY( BSON( "x" << 4 ) << BSON( "x" << 3 ) ) ) );
+        BatchCursor c( oneBatch( BSON_ARRAY( BSON( "x" << 2 ) ) ) );
+
+        vector<BatchCursor*> cursors;
+        cursors.push_back( &a );
+        cursors.push_back( &b );
+        cursors.push_back( &c );
+
+        vector<int> from;
+        vector<BSONObj> results = mergeAll( BSON( "x" << -1 ), cursors, &from );
+
+        ASSERT_EQUALS( 5U, results.size() );
+        for ( int i = 0; i < 5; i++ ) {
+            ASSERT_EQUALS( BSON( "x" << 5 - i ), results[i] );
+        }
+    }
+
+    TEST(SortedCursorMergeTest, TiesGoToLowerCursor) {
+        // Equal sort keys come out by cursor index, whatever order the cursors were added in
+        BatchCursor a( oneBatch( BSON_ARRAY( BSON( "x" << 1 << "c" << 0 ) ) ) );
+        BatchCursor b( oneBatch( BSON_ARRAY( BSON( "x" << 1 << "c" << 1 )
+                                             << BSON( "x" << 2 << "c" << 1 ) ) ) );
+        BatchCursor c( oneBatch( BSON_ARRAY( BSON( "x" << 1 << "c" << 2 )
+                                             << BSON( "x" << 2 << "c" << 2 ) ) ) );
+
+        SortedCursorMerge<BatchCursor> merge( BSON( "x" << 1 ) );
+        merge.add( 2, &c );
+        merge.add( 0, &a );
+        merge.add( 1, &b );
+
+        const int expectedFrom[] = { 0, 1, 2, 1, 2 };
+        for ( int i = 0; i < 5; i++ ) {
+            int from;
+            BSONObj result = merge.next( &from );
+            ASSERT_EQUALS( expectedFrom[i], from );
+            ASSERT_EQUALS( from, result["c"].numberInt() );
+
+            BatchCursor* cursors[] = { &a, &b, &c };
+            merge.add( from, cursors[from] );
+        }
+        ASSERT( merge.empty() );
+    }
+
+    TEST(SortedCursorMergeTest, CompoundSortWithMixedDirections) {
+        BatchCursor a( oneBatch( BSON_ARRAY( BSON( "x" << 1 << "y" << 2 )
+                                             << BSON( "x" << 2 << "y" << 9 ) ) ) );
+        BatchCursor b( oneBatch( BSON_ARRAY( BSON( "x" << 1 << "y" << 3 )
+                                             << BSON( "x" << 1 << "y" << 1 ) ) ) );
+
+        vector<BatchCursor*> cursors;
+        cursors.push_back( &a );
+        cursors.push_back( &b );
+
+        vector<int> from;
+        vector<BSONObj> results = mergeAll( BSON( "x" << 1 << "y" << -1 ), cursors, &from );
+
+        ASSERT_EQUALS( 4U, results.size() );
+        ASSERT_EQUALS( BSON( "x" << 1 << "y" << 3 ), results[0] );
+        ASSERT_EQUALS( BSON( "x" << 1 << "y" << 2 ), results[1] );
+        ASSERT_EQUALS( BSON( "x" << 1 << "y" << 1 ), results[2] );
+        ASSERT_EQUALS( BSON( "x" << 2 << "y" << 9 ), results[3] );
+    }
+
+    TEST(SortedCursorMergeTest, ResultSurvivesNextBatch) {
+        vector<BSONArray> batches;
+        batches.push_back( BSON_ARRAY( BSON( "x" << 1 ) ) );
+        batches.push_back( BSON_ARRAY( BSON( "x" << 3 << "padding" << "overwrites x:1" ) ) );
+        BatchCursor a( batches );
+        BatchCursor b( oneBatch( BSON_ARRAY( BSON( "x" << 2 ) ) ) );
+
+        SortedCursorMerge<BatchCursor> merge( BSON( "x" << 1 ) );
+        merge.add( 0, &a );
+        merge.add( 1, &b );
+
+        // The last result of a's batch, then a's next batch arrives in the same buffer
+        int from;
+        BSONObj first = merge.next( &from );
+        ASSERT_EQUALS( 0, from );
+        ASSERT( merge.add( 0, &a ) );
+        ASSERT_EQUALS( BSON( "x" << 1 ), first );
+
+        // b's head was not disturbed by a's new batch
+        BSONObj second = merge.next( &from );
+        ASSERT_EQUALS( 1, from );
+        ASSERT_EQUALS( BSON( "x" << 2 ), second );
+        ASSERT_FALSE( merge.add( 1, &b ) );
+
+        BSONObj third = merge.next( &from );
+        ASSERT_EQUALS( 0, from );
+        ASSERT_EQUALS( 3, third["x"].numberInt() );
+        ASSERT_FALSE( merge.add( 0, &a ) );
+        ASSERT( merge.empty() );
+    }
+
+    TEST(SortedCursorMergeTest, ResultSurvivesFailedFetch) {
+        vector<BSONArray> batches;
+        batches.push_back( BSON_ARRAY( BSON( "x" << 1 ) ) );
+        batches.push_back( BSON_ARRAY( BSON( "x" << 3 ) ) );
+        BatchCursor a( batches );
+        BatchCursor b( oneBatch( BSON_ARRAY( BSON( "x" << 2 ) ) ) );
+
+        SortedCursorMerge<BatchCursor> merge( BSON( "x" << 1 ) );
+        merge.add( 0, &a );
+        merge.add( 1, &b );
+
+        int from;
+        BSONObj first = merge.next( &from );
+        ASSERT_EQUALS( 0, from );
+
+        a.failNextFetch();
+        ASSERT_THROWS( merge.add( 0, &a ), UserException );
+        ASSERT_EQUALS( BSON( "x" << 1 ), first );
+
+        // The other cursors can still be merged
+        BSONObj second = merge.next( &from );
+        ASSERT_EQUALS( 1, from );
+        ASSERT_EQUALS( BSON( "x" << 2 ), second );
+        ASSERT_FALSE( merge.add( 1, &b ) );
+        ASSERT( merge.empty() );
+    }
+
+} // namespace
@@ -30,6 +30,7 @@
 
 #pragma once
 
+#include "mongo/base/status.h"
 #include "mongo/base/string_data.h"
 #include "mongo/db/catalog/collection_options.h"
 #include "mongo/db/namespace_string.h"
@@ -82,6 +83,26 @@ namespace mongo {
         virtual bool isIndexReady( OperationContext* txn,
                                    StringData indexName ) const = 0;
 
+        /**
+         * Returns the statistics stored for the index by setIndexStats(), or an empty object if
+         * there are none.
+         */
+        virtual BSONObj getIndexStats( OperationContext* txn,
+                                       StringData indexName ) const {
+            return BSONObj();
+        }
+
+        /**
+         * Stores 'stats' (see IndexStats) with the index, replacing any already there.  Not every
+         * storage engine can.
+         */
+        virtual Status setIndexStats( OperationContext* txn,
+                                      StringData indexName,
+                                      const BSONObj& stats ) {
+            return Status( ErrorCodes::CommandNotSupported,
+                           "storage engine does not store index statistics" );
+        }
+
         virtual Status removeIndex( OperationContext* txn,
                                     StringData indexName ) = 0;
 
@@ -39,6 +39,7 @@
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/index/index_stats.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/operation_context.h"
@@ -114,6 +115,20 @@ namespace mongo {
                    << _ns << " " << _descriptor->indexName()
                    << " " << filter;
         }
+
+        BSONObj statsObj = _collection->getIndexStats( txn, _descriptor->indexName() );
+        if ( !statsObj.isEmpty() ) {
+            boost::shared_ptr<IndexStats> stats( new IndexStats() );
+            Status status = IndexStats::parse( statsObj, stats.get() );
+            if ( status.isOK() ) {
+                _stats = stats;
+            }
+            else {
+                // Statistics are only a planning aid, so don't refuse to open the index
+                warning() << "ignoring statistics for index " << _descriptor->indexName()
+                          << " on " << _ns << ": " << status;
+            }
+        }
     }
 
     const RecordId& IndexCatalogEntry::head( OperationContext* txn ) const {
@@ -157,6 +172,37 @@ namespace mongo {
         _head = newHead;
     }
 
+    class IndexCatalogEntry::SetStatsChange : public RecoveryUnit::Change {
+    public:
+        SetStatsChange(IndexCatalogEntry* ice, boost::shared_ptr<const IndexStats> oldStats)
+            : _ice(ice), _oldStats(oldStats) {
+        }
+
+        virtual void commit() {}
+        virtual void rollback() { _ice->_stats = _oldStats; }
+
+        IndexCatalogEntry* _ice;
+        const boost::shared_ptr<const IndexStats> _oldStats;
+    };
+
+    Status IndexCatalogEntry::setStats( OperationContext* txn, const IndexStats& stats ) {
+        Status status = _collection->setIndexStats( txn,
+                                                    _descriptor->indexName(),
+                                                    stats.toBSON() );
+        if ( !status.isOK() ) {
+            return status;
+        }
+
+        txn->recoveryUnit()->registerChange(new SetStatsChange(this, _stats));
+        _stats.reset( new IndexStats( stats ) );
+
+        if ( _infoCache ) {
+            // Plans cached before the index was analyzed were chosen without its statistics
+            _infoCache->clearQueryCache();
+        }
+        return Status::OK();
+    }
+
 
     /**
      * RAII class, which associates a new RecoveryUnit with an OperationContext for the purposes
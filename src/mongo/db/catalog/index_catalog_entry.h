@@ -30,9 +30,11 @@
 
 #pragma once
 
+#include <boost/shared_ptr.hpp>
 #include <string>
 
 #include "mongo/base/owned_pointer_vector.h"
+#include "mongo/base/status.h"
 #include "mongo/bson/ordering.h"
 #include "mongo/db/record_id.h"
 
@@ -43,6 +45,7 @@ namespace mongo {
     class HeadManager;
     class IndexAccessMethod;
     class IndexDescriptor;
+    class IndexStats;
     class MatchExpression;
     class OperationContext;
 
@@ -90,10 +93,25 @@ namespace mongo {
         // if this ready is ready for queries
         bool isReady( OperationContext* txn ) const;
 
+        // --
+
+        /**
+         * The statistics gathered by the last analyze of this index, or NULL if it has never been
+         * analyzed.
+         */
+        boost::shared_ptr<const IndexStats> getStats() const { return _stats; }
+
+        /**
+         * Replaces this index's statistics, both in the catalog and in the cached copy returned
+         * by getStats().  The caller must hold the collection lock in MODE_X.
+         */
+        Status setStats( OperationContext* txn, const IndexStats& stats );
+
     private:
 
         class SetMultikeyChange;
         class SetHeadChange;
+        class SetStatsChange;
 
         bool _catalogIsReady( OperationContext* txn ) const;
         RecordId _catalogHead( OperationContext* txn ) const;
@@ -121,6 +139,7 @@ namespace mongo {
         bool _isReady; // cache of NamespaceDetails info
         RecordId _head; // cache of IndexDetails
         bool _isMultikey; // cache of NamespaceDetails info
+        boost::shared_ptr<const IndexStats> _stats; // cache of the catalog's index statistics
     };
 
     class IndexCatalogEntryContainer {
@@ -0,0 +1,268 @@
+// analyze.cpp
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kCommand
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/catalog/index_catalog_entry.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/dbhelpers.h"
+#include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/index/index_stats.h"
+#include "mongo/db/index_names.h"
+#include "mongo/db/keypattern.h"
+#include "mongo/db/query/internal_plans.h"
+#include "mongo/util/log.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+    using std::auto_ptr;
+    using std::string;
+    using std::stringstream;
+    using std::vector;
+
+    namespace {
+
+        /**
+         * Scans the whole of the index 'desc', yielding as it goes, and builds its statistics.
+         */
+        Status gatherStats(OperationContext* txn,
+                           Collection* collection,
+                           const IndexDescriptor* desc,
+                           size_t maxBuckets,
+                           IndexStats* out) {
+            KeyPattern kp(desc->keyPattern());
+            BSONObj min = Helpers::toKeyFormat(kp.extendRangeBound(BSONObj(), false));
+            BSONObj max = Helpers::toKeyFormat(kp.extendRangeBound(BSONObj(), true));
+
+            auto_ptr<PlanExecutor> exec(InternalPlanner::indexScan(txn, collection, desc,
+                                                                   min, max, true,
+                                                                   InternalPlanner::FORWARD));
+            exec->setYieldPolicy(PlanExecutor::YIELD_AUTO);
+
+            IndexStatsBuilder builder(desc->keyPattern(), maxBuckets);
+            builder.setCollectionRecords(collection->numRecords(txn));
+            BSONObj key;
+            RecordId loc;
+            PlanExecutor::ExecState state;
+            while (PlanExecutor::ADVANCED == (state = exec->getNext(&key, &loc))) {
+                builder.addKey(key, loc);
+            }
+
+            if (PlanExecutor::IS_EOF != state) {
+                // The index or its collection went away while we yielded
+                return Status(ErrorCodes::OperationFailed,
+                              str::stream() << "scan of index " << desc->indexName()
+                                            << " did not finish: "
+                                            << WorkingSetCommon::toStatusString(key));
+            }
+
+            *out = builder.done();
+            return Status::OK();
+        }
+
+    }  // namespace
+
+    /**
+     * { analyze: "collection" [, index: "name"] [, buckets: <int>] }
+     *
+     * Scans the indexes of a collection, or just the named one, and stores statistics about their
+     * keys in the catalog for the query planner.  The statistics are local to this node and are
+     * not updated as the collection changes, so analyze should be run again after large changes.
+     */
+    class AnalyzeCmd : public Command {
+    public:
+        AnalyzeCmd() : Command("analyze") {}
+
+        virtual bool slaveOk() const {
+            return true;
+        }
+
+        virtual void help(stringstream& h) const {
+            h << "Gather statistics about the keys of a collection's indexes for the query "
+                 "planner.  Scans each index in full.\n"
+                 "{ analyze: <collection> [, index: <name>] [, buckets: <int>] }";
+        }
+
+        virtual bool isWriteCommandForConfigServer() const { return false; }
+
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::planCacheWrite);
+            out->push_back(Privilege(parseResourcePattern(dbname, cmdObj), actions));
+        }
+
+        bool run(OperationContext* txn,
+                 const string& dbname,
+                 BSONObj& cmdObj,
+                 int,
+                 string& errmsg,
+                 BSONObjBuilder& result,
+                 bool fromRepl) {
+            const NamespaceString nss(parseNs(dbname, cmdObj));
+            if (!nss.isValid()) {
+                errmsg = "invalid namespace";
+                return false;
+            }
+
+            const string indexName = cmdObj["index"].str();
+
+            long long maxBuckets = IndexStats::kDefaultMaxBuckets;
+            BSONElement bucketsElt = cmdObj["buckets"];
+            if (!bucketsElt.eoo()) {
+                if (!bucketsElt.isNumber() || bucketsElt.numberLong() < 1
+                        || bucketsElt.numberLong() > 10000) {
+                    errmsg = "buckets must be a number between 1 and 10000";
+                    return false;
+                }
+                maxBuckets = bucketsElt.numberLong();
+            }
+
+            LOG(0) << "CMD: analyze " << nss.ns();
+
+            // Scan the indexes under a read lock, which we give up from time to time
+            Timer timer;
+            vector<std::pair<string, IndexStats> > gathered;
+            {
+                AutoGetCollectionForRead ctx(txn, nss);
+                Collection* collection = ctx.getCollection();
+                if (!collection) {
+                    errmsg = "ns not found";
+                    return false;
+                }
+
+                vector<string> names;
+                IndexCatalog::IndexIterator ii =
+                    collection->getIndexCatalog()->getIndexIterator(txn, false);
+                while (ii.more()) {
+                    const IndexDescriptor* desc = ii.next();
+                    if (!indexName.empty() && desc->indexName() != indexName) {
+                        continue;
+                    }
+                    if (IndexNames::BTREE != IndexNames::findPluginName(desc->keyPattern())) {
+                        // Only btree indexes have key values we know how to summarize
+                        if (!indexName.empty()) {
+                            errmsg = "can only analyze btree indexes";
+                            return false;
+                        }
+                        continue;
+                    }
+                    names.push_back(desc->indexName());
+                }
+
+                if (!indexName.empty() && names.empty()) {
+                    errmsg = "index not found";
+                    return false;
+                }
+
+                for (size_t i = 0; i < names.size(); ++i) {
+                    const IndexDescriptor* desc =
+                        collection->getIndexCatalog()->findIndexByName(txn, names[i]);
+                    if (!desc) {
+                        continue;
+                    }
+
+                    IndexStats stats;
+                    Status status = gatherStats(txn, collection, desc, maxBuckets, &stats);
+                    if (!status.isOK()) {
+                        return appendCommandStatus(result, status);
+                    }
+                    gathered.push_back(std::make_pair(names[i], stats));
+                }
+            }
+
+            // Save them, for any index which is still there
+            AutoGetDb autoDb(txn, nss.db(), MODE_IX);
+            Lock::CollectionLock collLock(txn->lockState(), nss.ns(), MODE_X);
+            Collection* collection = autoDb.getDb() ? autoDb.getDb()->getCollection(nss) : NULL;
+            if (!collection) {
+                errmsg = "collection dropped during analyze";
+                return false;
+            }
+
+            BSONObjBuilder indexesBuilder;
+            for (size_t i = 0; i < gathered.size(); ++i) {
+                const string& name = gathered[i].first;
+                const IndexStats& stats = gathered[i].second;
+
+                IndexCatalogEntry* entry = NULL;
+                IndexCatalog::IndexIterator ii =
+                    collection->getIndexCatalog()->getIndexIterator(txn, false);
+                while (ii.more()) {
+                    const IndexDescriptor* desc = ii.next();
+                    if (desc->indexName() == name) {
+                        entry = ii.catalogEntry(desc);
+                        break;
+                    }
+                }
+                if (!entry) {
+                    continue;
+                }
+
+                Status status = Status::OK();
+                MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
+                    WriteUnitOfWork wunit(txn);
+                    status = entry->setStats(txn, stats);
+                    if (status.isOK()) {
+                        wunit.commit();
+                    }
+                } MONGO_WRITE_CONFLICT_RETRY_LOOP_END(txn, "analyze", nss.ns());
+                if (!status.isOK()) {
+                    return appendCommandStatus(result, status);
+                }
+
+                BSONObjBuilder indexBuilder(indexesBuilder.subobjStart(name));
+                indexBuilder.appendNumber("numKeys", stats.numKeys());
+                indexBuilder.appendNumber("numRecords", stats.numRecords());
+                indexBuilder.appendNumber("numBuckets",
+                                          static_cast<long long>(stats.histogram().size()));
+                indexBuilder.doneFast();
+            }
+
+            result.append("indexes", indexesBuilder.obj());
+            result.appendNumber("millis", timer.millis());
+            return true;
+        }
+
+    } analyzeCmd;
+
+}  // namespace mongo
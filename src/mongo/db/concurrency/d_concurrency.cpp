@@ -67,6 +67,9 @@ namespace {
 
 
     RWLockRecursive Lock::ParallelBatchWriterMode::_batchLock("special");
+    AtomicUInt32 Lock::ParallelBatchWriterMode::_active;
+    Counter64 Lock::ParallelBatchWriterMode::blockedAcquisitions;
+    Counter64 Lock::ParallelBatchWriterMode::blockedMicros;
 
 
     Lock::TempRelease::TempRelease(Locker* lockState)
@@ -87,7 +90,16 @@ namespace {
     void Lock::GlobalLock::_lock(LockMode lockMode, unsigned timeoutMs) {
         if (!_locker->isBatchWriter()) {
             AcquiringParallelWriter a(_locker);
-            _pbws_lk.reset(new RWLockRecursive::Shared(ParallelBatchWriterMode::_batchLock));
+
+            if (ParallelBatchWriterMode::isActive()) {
+                Timer t;
+                _pbws_lk.reset(new RWLockRecursive::Shared(ParallelBatchWriterMode::_batchLock));
+                ParallelBatchWriterMode::blockedAcquisitions.increment();
+                ParallelBatchWriterMode::blockedMicros.increment(t.micros());
+            }
+            else {
+                _pbws_lk.reset(new RWLockRecursive::Shared(ParallelBatchWriterMode::_batchLock));
+            }
         }
 
         _result = _locker->lockGlobalBegin(lockMode);
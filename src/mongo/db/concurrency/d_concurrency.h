@@ -31,7 +31,9 @@
 #include <boost/scoped_ptr.hpp>
 #include <climits> // For UINT_MAX
 
+#include "mongo/base/counter.h"
 #include "mongo/db/concurrency/locker.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/util/concurrency/rwlock.h"
 #include "mongo/util/timer.h"
 
@@ -72,11 +74,30 @@ namespace mongo {
         class ParallelBatchWriterMode {
             MONGO_DISALLOW_COPYING(ParallelBatchWriterMode);
         public:
-            ParallelBatchWriterMode() : _lk(_batchLock) { }
+            ParallelBatchWriterMode() : _lk(_batchLock) {
+                _active.store(1);
+            }
+
+            ~ParallelBatchWriterMode() {
+                _active.store(0);
+            }
+
+            /**
+             * Whether a batch writer currently holds the lock. Only meant for statistics, since
+             * the value may change as soon as it has been read.
+             */
+            static bool isActive() { return _active.load() != 0; }
 
             static RWLockRecursive _batchLock;
 
+            // Number of global lock acquisitions, which found a batch in progress and the total
+            // time they spent waiting for it to complete.
+            static Counter64 blockedAcquisitions;
+            static Counter64 blockedMicros;
+
         private:
+            static AtomicUInt32 _active;
+
             RWLockRecursive::Exclusive _lk;
         };
 
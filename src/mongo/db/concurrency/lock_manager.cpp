@@ -30,6 +30,8 @@
 
 #include "mongo/platform/basic.h"
 
+#include <boost/thread/thread.hpp>
+#include <new>
 #include <vector>
 
 #include "mongo/db/concurrency/lock_manager.h"
@@ -429,13 +431,17 @@ namespace {
     // Have more buckets than CPUs to reduce contention on lock and caches
     const unsigned LockManager::_numLockBuckets(128);
 
-    // Balance scalability of intent locks against potential added cost of conflicting locks.
-    // The exact value doesn't appear very important, but should be power of two
-    const unsigned LockManager::_numPartitions = 32;
-
-    LockManager::LockManager() {
+    LockManager::LockManager() : _numPartitions(_computeNumPartitions()) {
         _lockBuckets = new LockBucket[_numLockBuckets];
-        _partitions = new Partition[_numPartitions];
+
+        _partitionsBuffer = new char[sizeof(Partition) * _numPartitions + kPartitionAlignment];
+        const uintptr_t aligned =
+            (reinterpret_cast<uintptr_t>(_partitionsBuffer) + kPartitionAlignment - 1) &
+            ~(kPartitionAlignment - 1);
+        _partitions = reinterpret_cast<Partition*>(aligned);
+        for (unsigned i = 0; i < _numPartitions; i++) {
+            new (&_partitions[i]) Partition();
+        }
     }
 
     LockManager::~LockManager() {
@@ -447,7 +453,11 @@ namespace {
         }
 
         delete[] _lockBuckets;
-        delete[] _partitions;
+
+        for (unsigned i = 0; i < _numPartitions; i++) {
+            _partitions[i].~Partition();
+        }
+        delete[] _partitionsBuffer;
     }
 
     LockResult LockManager::lock(ResourceId resId, LockRequest* request, LockMode mode) {
@@ -810,8 +820,28 @@ namespace {
         return &_lockBuckets[resId % _numLockBuckets];
     }
 
+    unsigned LockManager::_computeNumPartitions() {
+        // Balance scalability of intent locks against potential added cost of conflicting locks.
+        // With fewer partitions than concurrently running lockers, intent requests from different
+        // threads start colliding on the same partition mutex, so scale with the number of
+        // hardware threads. Conflicting requests only visit the partitions which were actually
+        // used for a resource, so the upper bound mostly limits memory usage.
+        const unsigned minPartitions = 32;
+        const unsigned maxPartitions = 1024;
+
+        const unsigned hardwareThreads = boost::thread::hardware_concurrency();
+
+        unsigned numPartitions = minPartitions;
+        while ((numPartitions < 2 * hardwareThreads) && (numPartitions < maxPartitions)) {
+            numPartitions <<= 1;
+        }
+
+        return numPartitions;
+    }
+
     LockManager::Partition* LockManager::_getPartition(LockRequest* request) const {
-        return &_partitions[request->locker->getId() % _numPartitions];
+        // _numPartitions is always a power of two
+        return &_partitions[request->locker->getId() & (_numPartitions - 1)];
     }
 
     void LockManager::dump() const {
@@ -138,10 +138,14 @@ namespace mongo {
             LockHead* findOrInsert(ResourceId resId);
         };
 
+        // Partitions are aligned so that lockers on different partitions do not false-share
+        // their mutexes.
+        static const size_t kPartitionAlignment = 128;
+
         // Each locker maps to a partition that is used for resources acquired in intent modes
-        // modes and potentially other modes that don't conflict with themselves. This avoids
+        // and potentially other modes that don't conflict with themselves. This avoids
         // contention on the regular LockHead in the lock manager.
-        struct Partition {
+        struct MONGO_COMPILER_ALIGN_TYPE(128) Partition {
             Partition() : mutex("LockManager") { }
             PartitionedLockHead* find(ResourceId resId);
             PartitionedLockHead* findOrInsert(ResourceId resId);
@@ -157,6 +161,11 @@ namespace mongo {
         LockBucket* _getBucket(ResourceId resId) const;
 
 
+        /**
+         * Returns the number of intent lock partitions to use on this machine.
+         */
+        static unsigned _computeNumPartitions();
+
         /**
          * Retrieves the Partition that a particular LockRequest should use for intent locking.
          */
@@ -183,8 +192,14 @@ namespace mongo {
         static const unsigned _numLockBuckets;
         LockBucket* _lockBuckets;
 
-        static const unsigned _numPartitions;
+        // Chosen at construction time based on the number of hardware threads, always a power of
+        // two. See _computeNumPartitions.
+        const unsigned _numPartitions;
         Partition* _partitions;
+
+        // Backing storage for _partitions. Array new does not honour the over-alignment of
+        // Partition, so the partitions are constructed in this buffer at an aligned offset.
+        char* _partitionsBuffer;
     };
 
 
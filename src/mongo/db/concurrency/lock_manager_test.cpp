@@ -26,8 +26,20 @@
  *    it in the license file.
  */
 
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kDefault
+
+#include "mongo/platform/basic.h"
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <vector>
+
+#include "mongo/config.h"
 #include "mongo/db/concurrency/lock_manager_test_help.h"
+#include "mongo/stdx/functional.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -819,4 +831,66 @@ namespace mongo {
         ASSERT(lockMgr.unlock(&requestX));
     }
 
+    // These tests measure the throughput of uncontended intent lock acquisitions on a single
+    // resource at increasing thread counts. It is not practical to run them on debug builds.
+#ifndef MONGO_CONFIG_DEBUG_BUILD
+
+namespace {
+
+    const int NUM_PERF_ITERS_PER_THREAD = 200 * 1000;
+
+    void lockUnlockLoop(LockManager* lockMgr, ResourceId resId, LockMode mode) {
+        DefaultLockerImpl locker;
+        TrackingLockGrantNotification notify;
+        LockRequest request;
+
+        for (int i = 0; i < NUM_PERF_ITERS_PER_THREAD; i++) {
+            request.initNew(&locker, &notify);
+            invariant(LOCK_OK == lockMgr->lock(resId, &request, mode));
+            lockMgr->unlock(&request);
+        }
+    }
+
+    void measureIntentLockThroughput(LockMode mode) {
+        const ResourceId resId(RESOURCE_GLOBAL, 1);
+
+        for (int numThreads = 1; numThreads <= 64; numThreads = numThreads * 2) {
+            LockManager lockMgr;
+
+            // Do some warm-up loops
+            lockUnlockLoop(&lockMgr, resId, mode);
+
+            Timer t;
+
+            std::vector<boost::shared_ptr<boost::thread> > threads;
+            for (int i = 0; i < numThreads; i++) {
+                threads.push_back(boost::shared_ptr<boost::thread>(
+                    new boost::thread(stdx::bind(lockUnlockLoop, &lockMgr, resId, mode))));
+            }
+
+            for (int i = 0; i < numThreads; i++) {
+                threads[i]->join();
+            }
+
+            const double acquisitions =
+                static_cast<double>(numThreads) * static_cast<double>(NUM_PERF_ITERS_PER_THREAD);
+
+            log() << numThreads << " threads " << modeName(mode) << ": "
+                  << acquisitions * 1000.0 * 1000.0 / static_cast<double>(t.micros() + 1)
+                  << " acquisitions/sec";
+        }
+    }
+
+} // namespace
+
+    TEST(LockManager, PerformanceIntentSharedThroughput) {
+        measureIntentLockThroughput(MODE_IS);
+    }
+
+    TEST(LockManager, PerformanceIntentExclusiveThroughput) {
+        measureIntentLockThroughput(MODE_IX);
+    }
+
+#endif  // MONGO_CONFIG_DEBUG_BUILD
+
 } // namespace mongo
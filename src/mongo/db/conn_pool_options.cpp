@@ -39,6 +39,9 @@ namespace mongo {
 
     int ConnPoolOptions::maxConnsPerHost(200);
     int ConnPoolOptions::maxShardedConnsPerHost(200);
+    int ConnPoolOptions::maxInUseConnsPerHost(PoolForHost::kPoolSizeUnlimited);
+    int ConnPoolOptions::minConnsPerHost(0);
+    int ConnPoolOptions::idleTimeoutSecs(0);
 
     namespace {
 
@@ -56,6 +59,27 @@ namespace mongo {
                                         true,
                                         false /* can't change at runtime */);
 
+        ExportedServerParameter<int> //
+        maxInUseConnsPerHostParameter(ServerParameterSet::getGlobal(),
+                                      "connPoolMaxInUseConnsPerHost",
+                                      &ConnPoolOptions::maxInUseConnsPerHost,
+                                      true,
+                                      false /* can't change at runtime */);
+
+        ExportedServerParameter<int> //
+        minConnsPerHostParameter(ServerParameterSet::getGlobal(),
+                                 "connPoolMinConnsPerHost",
+                                 &ConnPoolOptions::minConnsPerHost,
+                                 true,
+                                 false /* can't change at runtime */);
+
+        ExportedServerParameter<int> //
+        idleTimeoutSecsParameter(ServerParameterSet::getGlobal(),
+                                 "connPoolIdleTimeoutSecs",
+                                 &ConnPoolOptions::idleTimeoutSecs,
+                                 true,
+                                 false /* can't change at runtime */);
+
         MONGO_INITIALIZER(InitializeConnectionPools)(InitializerContext* context) {
 
             // Initialize the sharded and unsharded outgoing connection pools
@@ -66,9 +90,15 @@ namespace mongo {
 
             pool.setName("connection pool");
             pool.setMaxPoolSize(ConnPoolOptions::maxConnsPerHost);
+            pool.setMaxInUse(ConnPoolOptions::maxInUseConnsPerHost);
+            pool.setMinPoolSize(ConnPoolOptions::minConnsPerHost);
+            pool.setIdleTimeoutSecs(ConnPoolOptions::idleTimeoutSecs);
 
             shardConnectionPool.setName("sharded connection pool");
             shardConnectionPool.setMaxPoolSize(ConnPoolOptions::maxShardedConnsPerHost);
+            shardConnectionPool.setMaxInUse(ConnPoolOptions::maxInUseConnsPerHost);
+            shardConnectionPool.setMinPoolSize(ConnPoolOptions::minConnsPerHost);
+            shardConnectionPool.setIdleTimeoutSecs(ConnPoolOptions::idleTimeoutSecs);
 
             return Status::OK();
         }
@@ -49,6 +49,21 @@ namespace mongo {
          * Maximum connections per host the sharded conn pool should use
          */
         static int maxShardedConnsPerHost;
+
+        /**
+         * Maximum connections per host either pool hands out at once, -1 for no limit
+         */
+        static int maxInUseConnsPerHost;
+
+        /**
+         * Connections per host either pool keeps open ahead of demand
+         */
+        static int minConnsPerHost;
+
+        /**
+         * Seconds after which idle pooled connections are closed, 0 to keep them
+         */
+        static int idleTimeoutSecs;
     };
 
 }
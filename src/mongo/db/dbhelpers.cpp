@@ -34,6 +34,7 @@
 
 #include "mongo/db/dbhelpers.h"
 
+#include <algorithm>
 #include <boost/filesystem/operations.hpp>
 #include <fstream>
 
@@ -73,9 +74,11 @@ namespace mongo {
     using std::endl;
     using std::ios_base;
     using std::ofstream;
+    using std::pair;
     using std::set;
     using std::string;
     using std::stringstream;
+    using std::vector;
 
     using logger::LogComponent;
 
@@ -320,7 +323,8 @@ namespace mongo {
                                     const WriteConcernOptions& writeConcern,
                                     RemoveSaver* callback,
                                     bool fromMigrate,
-                                    bool onlyRemoveOrphanedDocs )
+                                    bool onlyRemoveOrphanedDocs,
+                                    RemoveRangeThrottle* throttle )
     {
         Timer rangeRemoveTimer;
         const string& ns = range.ns;
@@ -360,6 +364,11 @@ namespace mongo {
         long long millisWaitingForReplication = 0;
 
         while ( 1 ) {
+            const int batchSize = throttle ? std::max( 1, throttle->batchSize() ) : 1;
+            long long batchDocs = 0;
+            long long batchBytes = 0;
+            bool done = false;
+
             // Scoping for write lock.
             {
                 OldClientWriteContext ctx(txn, ns);
@@ -376,35 +385,51 @@ namespace mongo {
                                                                        maxInclusive,
                                                                        InternalPlanner::FORWARD,
                                                                        InternalPlanner::IXSCAN_FETCH));
-                exec->setYieldPolicy(PlanExecutor::YIELD_AUTO);
 
-                RecordId rloc;
-                BSONObj obj;
-                PlanExecutor::ExecState state;
-                // This may yield so we cannot touch nsd after this.
-                state = exec->getNext(&obj, &rloc);
-                exec.reset();
-                if (PlanExecutor::IS_EOF == state) { break; }
+                // A batch is read and deleted under one lock: if the scan yielded, the documents
+                // read before the yield could change before we get to delete them.
+                exec->setYieldPolicy(batchSize > 1 ? PlanExecutor::YIELD_MANUAL
+                                                   : PlanExecutor::YIELD_AUTO);
+
+                vector<pair<RecordId, BSONObj> > batch;
+                while ( static_cast<int>( batch.size() ) < batchSize ) {
+                    RecordId rloc;
+                    BSONObj obj;
+                    PlanExecutor::ExecState state;
+                    // This may yield so we cannot touch nsd after this.
+                    state = exec->getNext(&obj, &rloc);
+
+                    if (PlanExecutor::ADVANCED == state) {
+                        batch.push_back(std::make_pair(rloc, obj.getOwned()));
+                        continue;
+                    }
 
-                if (PlanExecutor::DEAD == state) {
-                    warning(LogComponent::kSharding) << "cursor died: aborting deletion for "
-                              << min << " to " << max << " in " << ns
-                              << endl;
-                    break;
-                }
+                    done = true;
 
-                if (PlanExecutor::FAILURE == state) {
-                    warning(LogComponent::kSharding) << "cursor error while trying to delete "
-                              << min << " to " << max
-                              << " in " << ns << ": "
-                              << WorkingSetCommon::toStatusString(obj) << endl;
+                    if (PlanExecutor::DEAD == state) {
+                        warning(LogComponent::kSharding) << "cursor died: aborting deletion for "
+                                  << min << " to " << max << " in " << ns
+                                  << endl;
+                    }
+                    else if (PlanExecutor::FAILURE == state) {
+                        warning(LogComponent::kSharding) << "cursor error while trying to delete "
+                                  << min << " to " << max
+                                  << " in " << ns << ": "
+                                  << WorkingSetCommon::toStatusString(obj) << endl;
+                    }
+                    else {
+                        verify(PlanExecutor::IS_EOF == state);
+                    }
                     break;
                 }
+                exec.reset();
 
-                verify(PlanExecutor::ADVANCED == state);
+                if ( batch.empty() )
+                    break;
 
                 WriteUnitOfWork wuow(txn);
 
+                CollectionMetadataPtr metadataNow;
                 if ( onlyRemoveOrphanedDocs ) {
                     // Do a final check in the write lock to make absolutely sure that our
                     // collection hasn't been modified in a way that invalidates our migration
@@ -415,26 +440,7 @@ namespace mongo {
                     verify(shardingState.enabled());
 
                     // In write lock, so will be the most up-to-date version
-                    CollectionMetadataPtr metadataNow = shardingState.getCollectionMetadata( ns );
-
-                    bool docIsOrphan;
-                    if ( metadataNow ) {
-                        ShardKeyPattern kp( metadataNow->getKeyPattern() );
-                        BSONObj key = kp.extractShardKeyFromDoc(obj);
-                        docIsOrphan = !metadataNow->keyBelongsToMe( key )
-                            && !metadataNow->keyIsPending( key );
-                    }
-                    else {
-                        docIsOrphan = false;
-                    }
-
-                    if ( !docIsOrphan ) {
-                        warning(LogComponent::kSharding)
-                                  << "aborting migration cleanup for chunk " << min << " to " << max
-                                  << ( metadataNow ? (string) " at document " + obj.toString() : "" )
-                                  << ", collection " << ns << " has changed " << endl;
-                        break;
-                    }
+                    metadataNow = shardingState.getCollectionMetadata( ns );
                 }
 
                 if (!repl::getGlobalReplicationCoordinator()->canAcceptWritesForDatabase(ns)) {
@@ -444,15 +450,49 @@ namespace mongo {
                     return numDeleted;
                 }
 
-                if ( callback )
-                    callback->goingToDelete( obj );
+                for ( size_t i = 0; i < batch.size(); i++ ) {
+                    const RecordId& rloc = batch[i].first;
+                    const BSONObj& obj = batch[i].second;
+
+                    if ( onlyRemoveOrphanedDocs ) {
+                        bool docIsOrphan;
+                        if ( metadataNow ) {
+                            ShardKeyPattern kp( metadataNow->getKeyPattern() );
+                            BSONObj key = kp.extractShardKeyFromDoc(obj);
+                            docIsOrphan = !metadataNow->keyBelongsToMe( key )
+                                && !metadataNow->keyIsPending( key );
+                        }
+                        else {
+                            docIsOrphan = false;
+                        }
+
+                        if ( !docIsOrphan ) {
+                            warning(LogComponent::kSharding)
+                                      << "aborting migration cleanup for chunk " << min
+                                      << " to " << max
+                                      << ( metadataNow ? (string) " at document " + obj.toString()
+                                                       : "" )
+                                      << ", collection " << ns << " has changed " << endl;
+                            // The documents before this one in the batch are still orphans
+                            done = true;
+                            break;
+                        }
+                    }
+
+                    if ( callback )
+                        callback->goingToDelete( obj );
+
+                    BSONObj deletedId;
+                    collection->deleteDocument( txn, rloc, false, false, &deletedId );
+                    // The above throws on failure, and so is not logged
+                    getGlobalServiceContext()->getOpObserver()->onDelete(txn, ns, deletedId,
+                                                                         fromMigrate);
+                    batchDocs++;
+                    batchBytes += obj.objsize();
+                }
 
-                BSONObj deletedId;
-                collection->deleteDocument( txn, rloc, false, false, &deletedId );
-                // The above throws on failure, and so is not logged
-                getGlobalServiceContext()->getOpObserver()->onDelete(txn, ns, deletedId, fromMigrate);
                 wuow.commit();
-                numDeleted++;
+                numDeleted += batchDocs;
             }
 
             // TODO remove once the yielding below that references this timer has been removed
@@ -474,6 +514,12 @@ namespace mongo {
                 }
                 millisWaitingForReplication += replStatus.duration.total_milliseconds();
             }
+
+            if ( throttle && batchDocs > 0 )
+                throttle->batchDeleted( txn, batchDocs, batchBytes );
+
+            if ( done )
+                break;
         }
         
         if (writeConcern.shouldWaitForOtherNodes())
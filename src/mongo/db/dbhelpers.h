@@ -54,6 +54,7 @@ namespace mongo {
     struct Helpers {
 
         class RemoveSaver;
+        class RemoveRangeThrottle;
 
         /* ensure the specified index exists.
 
@@ -166,6 +167,11 @@ namespace mongo {
          * Returns -1 when no usable index exists
          *
          * Does oplog the individual document deletions.
+         *
+         * If 'throttle' is set, documents are deleted in batches of throttle->batchSize(), each
+         * under a single acquisition of the write lock and in a single write unit of work, and
+         * the throttle is told about every batch once the lock is released so it can pace the
+         * deletion.  Otherwise documents are deleted one at a time.
          * // TODO: Refactor this mechanism, it is growing too large
          */
         static long long removeRange( OperationContext* txn,
@@ -174,7 +180,8 @@ namespace mongo {
                                       const WriteConcernOptions& secondaryThrottle,
                                       RemoveSaver* callback = NULL,
                                       bool fromMigrate = false,
-                                      bool onlyRemoveOrphanedDocs = false );
+                                      bool onlyRemoveOrphanedDocs = false,
+                                      RemoveRangeThrottle* throttle = NULL );
 
 
         // TODO: This will supersede Chunk::MaxObjectsPerChunk
@@ -226,6 +233,28 @@ namespace mongo {
             std::ofstream* _out;
         };
 
+        /**
+         * Controls the pace of removeRange.
+         */
+        class RemoveRangeThrottle {
+        public:
+            virtual ~RemoveRangeThrottle() {}
+
+            /**
+             * Maximum number of documents to delete under one acquisition of the write lock.
+             * Called before each batch.
+             */
+            virtual int batchSize() = 0;
+
+            /**
+             * Called without locks after each batch is committed.  May block to slow the
+             * deletion down and may throw, e.g. if the operation is killed, to abort it.
+             */
+            virtual void batchDeleted( OperationContext* txn,
+                                       long long numDocs,
+                                       long long numBytes ) = 0;
+        };
+
     };
 
 } // namespace mongo
@@ -59,6 +59,7 @@ namespace mongo {
         : _collection(collection),
           _ws(ws),
           _filter(filter),
+          _recordIdsOnly(false),
           _hashingChildren(true),
           _currentChild(0),
           _commonStats(kStageType),
@@ -72,6 +73,7 @@ namespace mongo {
         : _collection(collection),
           _ws(ws),
           _filter(filter),
+          _recordIdsOnly(false),
           _hashingChildren(true),
           _currentChild(0),
           _commonStats(kStageType),
@@ -84,6 +86,15 @@ namespace mongo {
 
     void AndHashStage::addChild(PlanStage* child) { _children.push_back(child); }
 
+    void AndHashStage::setRecordIdsOnly() {
+        invariant(_lookAheadResults.empty());
+        _recordIdsOnly = (NULL == _filter);
+    }
+
+    bool AndHashStage::isIntersectionEmpty() const {
+        return _recordIdsOnly ? _bitmap.empty() : _dataMap.empty();
+    }
+
     size_t AndHashStage::getMemUsage() const {
         return _memUsage;
     }
@@ -98,7 +109,7 @@ namespace mongo {
         // Or we're streaming in results from the last child.
 
         // If there's nothing to probe against, we're EOF.
-        if (_dataMap.empty()) { return true; }
+        if (isIntersectionEmpty()) { return true; }
 
         // Otherwise, we're done when the last child is done.
         invariant(_children.size() >= 2);
@@ -207,7 +218,7 @@ namespace mongo {
         // hash map.
 
         // We should be EOF if we're not hashing results and the dataMap is empty.
-        verify(!_dataMap.empty());
+        verify(!isIntersectionEmpty());
 
         // We probe _dataMap with the last child.
         verify(_currentChild == _children.size() - 1);
@@ -228,6 +239,18 @@ namespace mongo {
             return PlanStage::NEED_TIME;
         }
 
+        if (_recordIdsOnly) {
+            // There is no older WSM to merge into, so the child's WSM is the result.
+            if (!_bitmap.erase(member->loc)) {
+                _ws->free(*out);
+                ++_commonStats.needTime;
+                return PlanStage::NEED_TIME;
+            }
+            _memUsage = _bitmap.getMemUsage();
+            ++_commonStats.advanced;
+            return PlanStage::ADVANCED;
+        }
+
         DataMap::iterator it = _dataMap.find(member->loc);
         if (_dataMap.end() == it) {
             // Child's output wasn't in every previous child.  Throw it out.
@@ -287,6 +310,15 @@ namespace mongo {
                 return PlanStage::NEED_TIME;
             }
 
+            if (_recordIdsOnly) {
+                // As below, a repeated loc is a newer copy of a doc we already have.
+                _bitmap.insert(member->loc);
+                _memUsage = _bitmap.getMemUsage();
+                _ws->free(id);
+                ++_commonStats.needTime;
+                return PlanStage::NEED_TIME;
+            }
+
             if (!_dataMap.insert(std::make_pair(member->loc, id)).second) {
                 // Didn't insert because we already had this loc inside the map. This should only
                 // happen if we're seeing a newer copy of the same doc in a more recent snapshot.
@@ -307,13 +339,14 @@ namespace mongo {
             _currentChild = 1;
 
             // If our first child was empty, don't scan any others, no possible results.
-            if (_dataMap.empty()) {
+            if (isIntersectionEmpty()) {
                 _hashingChildren = false;
                 return PlanStage::IS_EOF;
             }
 
             ++_commonStats.needTime;
-            _specificStats.mapAfterChild.push_back(_dataMap.size());
+            _specificStats.mapAfterChild.push_back(_recordIdsOnly ? _bitmap.size()
+                                                                  : _dataMap.size());
 
             return PlanStage::NEED_TIME;
         }
@@ -360,7 +393,14 @@ namespace mongo {
             }
 
             verify(member->hasLoc());
-            if (_dataMap.end() == _dataMap.find(member->loc)) {
+            if (_recordIdsOnly) {
+                // There is no index data to merge, just remember that we saw the loc.
+                if (_bitmap.contains(member->loc)) {
+                    _seenBitmap.insert(member->loc);
+                    _memUsage = _bitmap.getMemUsage() + _seenBitmap.getMemUsage();
+                }
+            }
+            else if (_dataMap.end() == _dataMap.find(member->loc)) {
                 // Ignore.  It's not in any previous child.
             }
             else {
@@ -382,31 +422,40 @@ namespace mongo {
             // Finished with a child.
             ++_currentChild;
 
-            // Keep elements of _dataMap that are in _seenMap.
-            DataMap::iterator it = _dataMap.begin();
-            while (it != _dataMap.end()) {
-                if (_seenMap.end() == _seenMap.find(it->first)) {
-                    DataMap::iterator toErase = it;
-                    ++it;
-
-                    // Update memory stats.
-                    WorkingSetMember* member = _ws->get(toErase->second);
-                    _memUsage -= member->getMemUsage();
-
-                    _ws->free(toErase->second);
-                    _dataMap.erase(toErase);
+            if (_recordIdsOnly) {
+                // Keep elements of _bitmap that are in _seenBitmap.
+                _bitmap.intersectWith(_seenBitmap);
+                _seenBitmap.clear();
+                _memUsage = _bitmap.getMemUsage();
+            }
+            else {
+                // Keep elements of _dataMap that are in _seenMap.
+                DataMap::iterator it = _dataMap.begin();
+                while (it != _dataMap.end()) {
+                    if (_seenMap.end() == _seenMap.find(it->first)) {
+                        DataMap::iterator toErase = it;
+                        ++it;
+
+                        // Update memory stats.
+                        WorkingSetMember* member = _ws->get(toErase->second);
+                        _memUsage -= member->getMemUsage();
+
+                        _ws->free(toErase->second);
+                        _dataMap.erase(toErase);
+                    }
+                    else { ++it; }
                 }
-                else { ++it; }
             }
 
-            _specificStats.mapAfterChild.push_back(_dataMap.size());
+            _specificStats.mapAfterChild.push_back(_recordIdsOnly ? _bitmap.size()
+                                                                  : _dataMap.size());
 
             _seenMap.clear();
 
-            // _dataMap is now the intersection of the first _currentChild nodes.
+            // _dataMap (or _bitmap) is now the intersection of the first _currentChild nodes.
 
             // If we have nothing to AND with after finishing any child, stop.
-            if (_dataMap.empty()) {
+            if (isIntersectionEmpty()) {
                 _hashingChildren = false;
                 return PlanStage::IS_EOF;
             }
@@ -490,6 +539,29 @@ namespace mongo {
         // If it's a mutation the predicates implied by the AND-ing may no longer be true.
         //
         // So, we flag and try to pick it up later.
+        if (_recordIdsOnly) {
+            if (!_bitmap.erase(dl)) { return; }
+            _seenBitmap.erase(dl);
+
+            if (_hashingChildren) {
+                ++_specificStats.flaggedInProgress;
+            }
+            else {
+                ++_specificStats.flaggedButPassed;
+            }
+
+            // We don't hold a WSM for the RecordId, so make one to fetch the doc into.
+            WorkingSetID id = _ws->allocate();
+            WorkingSetMember* member = _ws->get(id);
+            member->loc = dl;
+            member->state = WorkingSetMember::LOC_AND_IDX;
+            WorkingSetCommon::fetchAndInvalidateLoc(txn, member, _collection);
+            _ws->flagForReview(id);
+
+            _memUsage = _bitmap.getMemUsage() + _seenBitmap.getMemUsage();
+            return;
+        }
+
         DataMap::iterator it = _dataMap.find(dl);
         if (_dataMap.end() != it) {
             WorkingSetID id = it->second;
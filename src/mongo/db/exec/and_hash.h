@@ -33,6 +33,7 @@
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/exec/record_id_bitmap.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/record_id.h"
 #include "mongo/platform/unordered_set.h"
@@ -49,6 +50,9 @@ namespace mongo {
      * is fetched and added to the WorkingSet as "flagged for further review."  Because this stage
      * operates with RecordIds, we are unable to evaluate the AND for the invalidated RecordId, and it
      * must be fully matched later.
+     *
+     * If the parent only needs the RecordIds of the intersection, as a FETCH does, see
+     * setRecordIdsOnly().
      */
     class AndHashStage : public PlanStage {
     public:
@@ -68,6 +72,17 @@ namespace mongo {
 
         void addChild(PlanStage* child);
 
+        /**
+         * Tells the stage that its parent only uses the RecordId of each result, so the index data
+         * of all but the last child need not be kept.  The first N-1 children are then
+         * intersected in RecordIdBitmaps rather than hash tables, which is far more compact for
+         * large results, and each result is the last child's own WSM.
+         *
+         * Has no effect if the stage has a filter, which may need the children's index data.  Must
+         * be called before the first call to work().
+         */
+        void setRecordIdsOnly();
+
         /**
          * Returns memory usage.
          * For testing only.
@@ -100,6 +115,9 @@ namespace mongo {
         StageState hashOtherChildren(WorkingSetID* out);
         StageState workChild(size_t childNo, WorkingSetID* out);
 
+        // True if there is nothing left from the first N-1 children to probe against.
+        bool isIntersectionEmpty() const;
+
         // Not owned by us.
         const Collection* _collection;
 
@@ -127,6 +145,16 @@ namespace mongo {
         typedef unordered_set<RecordId, RecordId::Hasher> SeenMap;
         SeenMap _seenMap;
 
+        // If true, _bitmap and _seenBitmap take the place of _dataMap and _seenMap.  Set by
+        // setRecordIdsOnly().
+        bool _recordIdsOnly;
+
+        // The RecordIds in the intersection of the children read so far.
+        RecordIdBitmap _bitmap;
+
+        // The RecordIds from _bitmap which the current child has produced.
+        RecordIdBitmap _seenBitmap;
+
         // True if we're still intersecting _children[0..._children.size()-1].
         bool _hashingChildren;
 
@@ -138,7 +166,7 @@ namespace mongo {
         AndHashStats _specificStats;
 
         // The usage in bytes of all buffered data that we're holding.
-        // Memory usage is calculated from keys held in _dataMap only.
+        // Memory usage is calculated from keys held in _dataMap, or from the bitmaps, only.
         // For simplicity, results in _lookAheadResults do not count towards the limit.
         size_t _memUsage;
 
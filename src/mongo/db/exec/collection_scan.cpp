@@ -65,6 +65,10 @@ namespace mongo {
         // Explain reports the direction of the collection scan.
         _specificStats.direction = params.direction;
 
+        if (_filter) {
+            _compiledFilter.reset(new CompiledMatchExpression(_filter));
+        }
+
         // We pre-allocate a WSM and use it to pass up fetch requests. This should never be used
         // for anything other than passing up NEED_YIELD. We use the loc and owned obj state, but
         // the loc isn't really pointing at any obj. The obj field of the WSM should never be used.
@@ -182,7 +186,7 @@ namespace mongo {
                                                           WorkingSetID* out) {
         ++_specificStats.docsTested;
 
-        if (Filter::passes(member, _filter)) {
+        if (Filter::passes(member, _filter, _compiledFilter.get())) {
             *out = memberID;
             ++_commonStats.advanced;
             return PlanStage::ADVANCED;
@@ -58,7 +58,11 @@ namespace mongo {
           _child(child),
           _filter(filter),
           _idRetrying(WorkingSet::INVALID_ID),
-          _commonStats(kStageType) { }
+          _commonStats(kStageType) {
+        if (_filter) {
+            _compiledFilter.reset(new CompiledMatchExpression(_filter));
+        }
+    }
 
     FetchStage::~FetchStage() { }
 
@@ -209,7 +213,7 @@ namespace mongo {
         // predicate.
         ++_specificStats.docsExamined;
 
-        if (Filter::passes(member, _filter)) {
+        if (Filter::passes(member, _filter, _compiledFilter.get())) {
             if (NULL != _filter) {
                 ++_specificStats.matchTested;
             }
@@ -33,6 +33,7 @@
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression.h"
+#include "mongo/db/matcher/expression_compiled.h"
 #include "mongo/db/record_id.h"
 
 namespace mongo {
@@ -96,6 +97,9 @@ namespace mongo {
         // The filter is not owned by us.
         const MatchExpression* _filter;
 
+        // _filter compiled for matching whole documents, if there is a filter.
+        boost::scoped_ptr<CompiledMatchExpression> _compiledFilter;
+
         // If not Null, we use this rather than asking our child what to do next.
         WorkingSetID _idRetrying;
 
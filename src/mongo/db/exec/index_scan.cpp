@@ -32,6 +32,9 @@
 
 #include "mongo/db/exec/index_scan.h"
 
+#include <algorithm>
+#include <cstring>
+
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/scoped_timer.h"
@@ -51,6 +54,18 @@ namespace {
         return i > 0 ? 1 : -1;
     }
 
+    // Orders encoded keys bytewise, a key before any longer key it is a prefix of.
+    int compareKeyStrings(const char* lhs, size_t lhsSize, const char* rhs, size_t rhsSize) {
+        const int cmp = memcmp(lhs, rhs, std::min(lhsSize, rhsSize));
+        if (cmp != 0) {
+            return cmp;
+        }
+        if (lhsSize == rhsSize) {
+            return 0;
+        }
+        return lhsSize < rhsSize ? -1 : 1;
+    }
+
 }  // namespace
 
 namespace mongo {
@@ -74,7 +89,10 @@ namespace mongo {
           _commonStats(kStageType),
           _keyEltsToUse(0),
           _movePastKeyElts(false),
-          _endKeyInclusive(false) {
+          _endKeyInclusive(false),
+          _ordering(Ordering::make(params.descriptor->keyPattern())),
+          _haveEndKeyString(false),
+          _haveRun(false) {
         _iam = _params.descriptor->getIndexCatalog()->getIndex(_params.descriptor);
         _keyPattern = _params.descriptor->keyPattern().getOwned();
 
@@ -84,6 +102,7 @@ namespace mongo {
         _specificStats.indexName = _params.descriptor->indexName();
         _specificStats.isMultiKey = _params.descriptor->isMultikey(_txn);
         _specificStats.indexVersion = _params.descriptor->version();
+        _specificStats.keysEstimated = _params.estimatedKeys;
     }
 
     void IndexScan::initIndexScan() {
@@ -124,6 +143,26 @@ namespace mongo {
             if (!isEOF()) {
                 _specificStats.keysExamined = 1;
             }
+
+            // A shorter end key sorts before all keys it is a prefix of, whatever its
+            // inclusiveness, as with woCompare().
+            const BSONObj& endKey = _params.bounds.endKey;
+            const int nEndFields = endKey.nFields();
+            if (nEndFields > 0 && nEndFields <= _keyPattern.nFields()) {
+                vector<BSONElement> endValues;
+                BSONObjIterator it(endKey);
+                while (it.more()) {
+                    endValues.push_back(it.next());
+                }
+
+                KeyString::Discriminator discriminator = KeyString::kExclusiveBefore;
+                if (nEndFields == _keyPattern.nFields()
+                        && _params.bounds.endKeyInclusive == (1 == _params.direction)) {
+                    discriminator = KeyString::kExclusiveAfter;
+                }
+                _endKeyString.resetToKey(endValues, _ordering, discriminator);
+                _haveEndKeyString = true;
+            }
         }
         else {
             // For single intervals, we can use an optimized scan which checks against the position
@@ -217,15 +256,21 @@ namespace mongo {
         }
 
         if (GETTING_NEXT == _scanState) {
-            // Grab the next (key, value) from the index.
-            BSONObj keyObj = _indexCursor->getKey();
+            // Grab the next (key, value) from the index.  Don't bother decoding the key of an
+            // entry we are going to drop as a duplicate.
             RecordId loc = _indexCursor->getValue();
-
-            bool filterPasses = Filter::passes(keyObj, _keyPattern, _filter);
-            if ( filterPasses ) {
-                // We must make a copy of the on-disk data since it can mutate during the execution
-                // of this query.
-                keyObj = keyObj.getOwned();
+            const bool isDup = _shouldDedup && _returned.end() != _returned.find(loc);
+
+            BSONObj keyObj;
+            bool filterPasses = false;
+            if (!isDup) {
+                keyObj = _indexCursor->getKey();
+                filterPasses = Filter::passes(keyObj, _keyPattern, _filter);
+                if ( filterPasses ) {
+                    // We must make a copy of the on-disk data since it can mutate during the
+                    // execution of this query.
+                    keyObj = keyObj.getOwned();
+                }
             }
 
             _scanState = CHECKING_END;
@@ -246,7 +291,7 @@ namespace mongo {
 
             if (_shouldDedup) {
                 ++_specificStats.dupsTested;
-                if (_returned.end() != _returned.find(loc)) {
+                if (isDup) {
                     ++_specificStats.dupsDropped;
                     ++_commonStats.needTime;
                     return PlanStage::NEED_TIME;
@@ -417,6 +462,21 @@ namespace mongo {
             // If there is an empty endKey we will scan until we run out of index to scan over.
             if (_params.bounds.endKey.isEmpty()) { return; }
 
+            const char* keyData;
+            size_t keySize;
+            if (_haveEndKeyString && _indexCursor->getKeyString(&keyData, &keySize)) {
+                // The encoded end key never equals a stored key.
+                int cmp = compareKeyStrings(keyData, keySize,
+                                            _endKeyString.getBuffer(), _endKeyString.getSize());
+                if (sgn(cmp) == _params.direction) {
+                    _scanState = HIT_END;
+                }
+                else {
+                    ++_specificStats.keysExamined;
+                }
+                return;
+            }
+
             int cmp = sgn(_params.bounds.endKey.woCompare(_indexCursor->getKey(), _keyPattern));
 
             if ((cmp != 0 && cmp != _params.direction)
@@ -445,6 +505,19 @@ namespace mongo {
             verify(NULL != _indexCursor);
             verify(NULL != _checker.get());
 
+            // Keys within the intervals of the last valid key are valid too, and are cheap to
+            // recognize once those intervals are encoded.
+            const char* keyData;
+            size_t keySize;
+            const bool haveKeyString = _indexCursor->getKeyString(&keyData, &keySize);
+            if (_haveRun && haveKeyString
+                    && keyStringWithin(_runStart, _runEnd, keyData, keySize)) {
+                ++_specificStats.keysExamined;
+                _scanState = GETTING_NEXT;
+                return;
+            }
+            _haveRun = false;
+
             IndexBoundsChecker::KeyState keyState;
             keyState = _checker->checkKey(_indexCursor->getKey(),
                                           &_keyEltsToUse,
@@ -462,6 +535,9 @@ namespace mongo {
 
             if (IndexBoundsChecker::VALID == keyState) {
                 _scanState = GETTING_NEXT;
+                if (haveKeyString) {
+                    _haveRun = buildKeyStringRun();
+                }
                 return;
             }
 
@@ -477,6 +553,49 @@ namespace mongo {
         }
     }
 
+    bool IndexScan::buildKeyStringRun() {
+        const Interval* interval;
+        if (!_checker->getContiguousRun(&_runValues, &interval)) {
+            return false;
+        }
+
+        // Interval starts come first in the direction of the scan.
+        const bool forward = (1 == _params.direction);
+
+        if (NULL == interval) {
+            // Every field is a point, so the run is a single key.
+            _runStart.resetToKey(_runValues, _ordering,
+                                 forward ? KeyString::kExclusiveBefore
+                                         : KeyString::kExclusiveAfter);
+            _runEnd.resetToKey(_runValues, _ordering,
+                               forward ? KeyString::kExclusiveAfter
+                                       : KeyString::kExclusiveBefore);
+            return true;
+        }
+
+        _runValues.push_back(interval->start);
+        _runStart.resetToKey(_runValues, _ordering,
+                             interval->startInclusive == forward ? KeyString::kExclusiveBefore
+                                                                 : KeyString::kExclusiveAfter);
+        _runValues.back() = interval->end;
+        _runEnd.resetToKey(_runValues, _ordering,
+                           interval->endInclusive == forward ? KeyString::kExclusiveAfter
+                                                             : KeyString::kExclusiveBefore);
+        return true;
+    }
+
+    bool IndexScan::keyStringWithin(const KeyString& start, const KeyString& end,
+                                    const char* keyData, size_t keySize) const {
+        const int afterStart = sgn(compareKeyStrings(keyData, keySize,
+                                                     start.getBuffer(), start.getSize()));
+        if (afterStart != _params.direction) {
+            return false;
+        }
+        const int beforeEnd = sgn(compareKeyStrings(end.getBuffer(), end.getSize(),
+                                                    keyData, keySize));
+        return beforeEnd == _params.direction;
+    }
+
     vector<PlanStage*> IndexScan::getChildren() const {
         vector<PlanStage*> empty;
         return empty;
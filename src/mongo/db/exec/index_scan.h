@@ -36,6 +36,7 @@
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/query/index_bounds.h"
 #include "mongo/db/record_id.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/platform/unordered_set.h"
 
 namespace mongo {
@@ -50,7 +51,8 @@ namespace mongo {
                             direction(1),
                             doNotDedup(false),
                             maxScan(0),
-                            addKeyMetadata(false) { }
+                            addKeyMetadata(false),
+                            estimatedKeys(-1) { }
 
         const IndexDescriptor* descriptor;
 
@@ -65,6 +67,9 @@ namespace mongo {
 
         // Do we want to add the key as metadata?
         bool addKeyMetadata;
+
+        // The planner's estimate of how many keys we will look at, or -1 if it has none.
+        long long estimatedKeys;
     };
 
     /**
@@ -128,6 +133,18 @@ namespace mongo {
         /** See if the cursor is pointing at or past _endKey, if _endKey is non-empty. */
         void checkEnd();
 
+        /**
+         * Encodes the bounds of the keys the checker currently accepts into _runStart and _runEnd.
+         * Returns false if those keys are not contiguous in the index.
+         */
+        bool buildKeyStringRun();
+
+        /**
+         * Is the encoded key strictly between 'start' and 'end', in the direction of the scan?
+         */
+        bool keyStringWithin(const KeyString& start, const KeyString& end,
+                             const char* keyData, size_t keySize) const;
+
         // transactional context for read locks. Not owned by us
         OperationContext* _txn;
 
@@ -193,6 +210,24 @@ namespace mongo {
 
         // Is the end key included in the range?
         bool _endKeyInclusive;
+
+        //
+        // If the index stores its keys as KeyStrings, checkEnd() compares them to bounds encoded
+        // the same way with memcmp(), and only the keys which are returned get decoded to BSON.
+        //
+
+        const Ordering _ordering;
+
+        // For a simple range, the encoded endKey.  Keys past it in the scan direction are done.
+        bool _haveEndKeyString;
+        KeyString _endKeyString;
+
+        // For case 1) above, the keys strictly between _runStart and _runEnd are the ones the
+        // checker accepts without changing state.  See IndexBoundsChecker::getContiguousRun().
+        bool _haveRun;
+        KeyString _runStart;
+        KeyString _runEnd;
+        std::vector<BSONElement> _runValues;
     };
 
 }  // namespace mongo
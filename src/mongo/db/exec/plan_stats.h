@@ -369,7 +369,8 @@ namespace mongo {
                            dupsDropped(0),
                            seenInvalidated(0),
                            matchTested(0),
-                           keysExamined(0) { }
+                           keysExamined(0),
+                           keysEstimated(-1) { }
 
         virtual ~IndexScanStats() { }
 
@@ -415,6 +416,10 @@ namespace mongo {
         // Number of entries retrieved from the index during the scan.
         size_t keysExamined;
 
+        // How many entries the planner expected the scan to retrieve, or -1 if the index has no
+        // statistics.
+        long long keysEstimated;
+
     };
 
     struct LimitStats : public SpecificStats {
@@ -0,0 +1,331 @@
+// record_id_bitmap.cpp
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/record_id_bitmap.h"
+
+#include <algorithm>
+
+#include "mongo/platform/bits.h"
+#include "mongo/util/assert_util.h"
+
+// SSE2 is part of the x86-64 baseline, so there is nothing to detect at runtime.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MONGO_RECORD_ID_BITMAP_SSE2
+#endif
+
+namespace mongo {
+
+    namespace {
+
+        const size_t kBitmapWords = (1 << 16) / 64;
+
+        // Rough cost of a std::map node on top of the Container it holds.
+        const size_t kNodeOverhead = 4 * sizeof(void*);
+
+        inline int popCount64(uint64_t x) {
+#if defined(__GNUC__)
+            return __builtin_popcountll(x);
+#else
+            x = x - ((x >> 1) & 0x5555555555555555ULL);
+            x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+            x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+            return static_cast<int>((x * 0x0101010101010101ULL) >> 56);
+#endif
+        }
+
+        /**
+         * dest &= src over kBitmapWords words.  Returns the number of bits left set in dest.
+         */
+        size_t andBitmaps(uint64_t* dest, const uint64_t* src) {
+            size_t count = 0;
+#if defined(MONGO_RECORD_ID_BITMAP_SSE2)
+            for (size_t i = 0; i < kBitmapWords; i += 2) {
+                __m128i* d = reinterpret_cast<__m128i*>(dest + i);
+                const __m128i result =
+                    _mm_and_si128(_mm_loadu_si128(d),
+                                  _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)));
+                _mm_storeu_si128(d, result);
+                count += popCount64(dest[i]) + popCount64(dest[i + 1]);
+            }
+#else
+            for (size_t i = 0; i < kBitmapWords; ++i) {
+                dest[i] &= src[i];
+                count += popCount64(dest[i]);
+            }
+#endif
+            return count;
+        }
+
+    } // namespace
+
+    //
+    // Container
+    //
+
+    bool RecordIdBitmap::Container::insert(uint16_t low) {
+        if (isBitmap()) {
+            uint64_t& word = _bits[low >> 6];
+            const uint64_t bit = 1ULL << (low & 63);
+            if (word & bit) {
+                return false;
+            }
+            word |= bit;
+            ++_cardinality;
+            return true;
+        }
+
+        std::vector<uint16_t>::iterator it = std::lower_bound(_array.begin(), _array.end(), low);
+        if (it != _array.end() && *it == low) {
+            return false;
+        }
+
+        if (_array.size() < kMaxArraySize) {
+            _array.insert(it, low);
+            ++_cardinality;
+            return true;
+        }
+
+        toBitmap();
+        return insert(low);
+    }
+
+    bool RecordIdBitmap::Container::contains(uint16_t low) const {
+        if (isBitmap()) {
+            return _bits[low >> 6] & (1ULL << (low & 63));
+        }
+        return std::binary_search(_array.begin(), _array.end(), low);
+    }
+
+    bool RecordIdBitmap::Container::erase(uint16_t low) {
+        if (isBitmap()) {
+            uint64_t& word = _bits[low >> 6];
+            const uint64_t bit = 1ULL << (low & 63);
+            if (!(word & bit)) {
+                return false;
+            }
+            word &= ~bit;
+            --_cardinality;
+
+            // Leave some slack so that alternating inserts and erases don't convert every time.
+            if (_cardinality <= kMaxArraySize / 2) {
+                toArray();
+            }
+            return true;
+        }
+
+        std::vector<uint16_t>::iterator it = std::lower_bound(_array.begin(), _array.end(), low);
+        if (it == _array.end() || *it != low) {
+            return false;
+        }
+        _array.erase(it);
+        --_cardinality;
+        return true;
+    }
+
+    void RecordIdBitmap::Container::intersectWith(const Container& other) {
+        if (isBitmap() && other.isBitmap()) {
+            _cardinality = andBitmaps(&_bits[0], &other._bits[0]);
+            if (_cardinality <= kMaxArraySize) {
+                toArray();
+            }
+            return;
+        }
+
+        if (isBitmap()) {
+            // The result is no larger than other's array, so keep it as an array.
+            std::vector<uint16_t> result;
+            result.reserve(other._array.size());
+            for (size_t i = 0; i < other._array.size(); ++i) {
+                if (contains(other._array[i])) {
+                    result.push_back(other._array[i]);
+                }
+            }
+            std::vector<uint64_t>().swap(_bits);
+            _array.swap(result);
+            _cardinality = _array.size();
+            return;
+        }
+
+        // Filter our array in place.  Values are only ever moved towards the front.
+        size_t out = 0;
+        if (other.isBitmap()) {
+            for (size_t i = 0; i < _array.size(); ++i) {
+                if (other.contains(_array[i])) {
+                    _array[out++] = _array[i];
+                }
+            }
+        }
+        else {
+            size_t i = 0;
+            size_t j = 0;
+            while (i < _array.size() && j < other._array.size()) {
+                if (_array[i] < other._array[j]) {
+                    ++i;
+                }
+                else if (other._array[j] < _array[i]) {
+                    ++j;
+                }
+                else {
+                    _array[out++] = _array[i];
+                    ++i;
+                    ++j;
+                }
+            }
+        }
+        _array.resize(out);
+        _cardinality = out;
+
+        // Give back memory if the intersection was much smaller.
+        if (_array.capacity() > 2 * _array.size()) {
+            std::vector<uint16_t>(_array).swap(_array);
+        }
+    }
+
+    size_t RecordIdBitmap::Container::getMemUsage() const {
+        return _array.capacity() * sizeof(uint16_t) + _bits.capacity() * sizeof(uint64_t);
+    }
+
+    void RecordIdBitmap::Container::toBitmap() {
+        dassert(!isBitmap());
+        _bits.assign(kBitmapWords, 0);
+        for (size_t i = 0; i < _array.size(); ++i) {
+            _bits[_array[i] >> 6] |= 1ULL << (_array[i] & 63);
+        }
+        std::vector<uint16_t>().swap(_array);
+    }
+
+    void RecordIdBitmap::Container::toArray() {
+        dassert(isBitmap());
+        std::vector<uint16_t> values;
+        values.reserve(_cardinality);
+        for (size_t i = 0; i < kBitmapWords; ++i) {
+            uint64_t word = _bits[i];
+            while (word) {
+                values.push_back(static_cast<uint16_t>((i << 6) + countTrailingZeros64(word)));
+                word &= word - 1;
+            }
+        }
+        dassert(values.size() == _cardinality);
+        _array.swap(values);
+        std::vector<uint64_t>().swap(_bits);
+    }
+
+    //
+    // RecordIdBitmap
+    //
+
+    RecordIdBitmap::RecordIdBitmap() : _size(0), _memUsage(0) {}
+
+    size_t RecordIdBitmap::containerMemUsage(const Container& container) {
+        return sizeof(ContainerMap::value_type) + kNodeOverhead + container.getMemUsage();
+    }
+
+    bool RecordIdBitmap::insert(const RecordId& loc) {
+        const uint64_t high = highBits(loc);
+        ContainerMap::iterator it = _containers.lower_bound(high);
+        if (it == _containers.end() || it->first != high) {
+            it = _containers.insert(it, std::make_pair(high, Container()));
+            _memUsage += containerMemUsage(it->second);
+        }
+
+        const size_t memBefore = it->second.getMemUsage();
+        if (!it->second.insert(lowBits(loc))) {
+            return false;
+        }
+        _memUsage += it->second.getMemUsage() - memBefore;
+        ++_size;
+        return true;
+    }
+
+    bool RecordIdBitmap::contains(const RecordId& loc) const {
+        ContainerMap::const_iterator it = _containers.find(highBits(loc));
+        return it != _containers.end() && it->second.contains(lowBits(loc));
+    }
+
+    bool RecordIdBitmap::erase(const RecordId& loc) {
+        ContainerMap::iterator it = _containers.find(highBits(loc));
+        if (it == _containers.end()) {
+            return false;
+        }
+
+        const size_t memBefore = containerMemUsage(it->second);
+        if (!it->second.erase(lowBits(loc))) {
+            return false;
+        }
+        --_size;
+
+        _memUsage -= memBefore;
+        if (it->second.cardinality() == 0) {
+            _containers.erase(it);
+        }
+        else {
+            _memUsage += containerMemUsage(it->second);
+        }
+        return true;
+    }
+
+    void RecordIdBitmap::intersectWith(const RecordIdBitmap& other) {
+        // Both maps are ordered by the high bits, so walk them together.
+        ContainerMap::iterator it = _containers.begin();
+        ContainerMap::const_iterator otherIt = other._containers.begin();
+
+        _size = 0;
+        _memUsage = 0;
+        while (it != _containers.end()) {
+            while (otherIt != other._containers.end() && otherIt->first < it->first) {
+                ++otherIt;
+            }
+
+            if (otherIt == other._containers.end() || otherIt->first != it->first) {
+                _containers.erase(it++);
+                continue;
+            }
+
+            it->second.intersectWith(otherIt->second);
+            if (it->second.cardinality() == 0) {
+                _containers.erase(it++);
+                continue;
+            }
+
+            _size += it->second.cardinality();
+            _memUsage += containerMemUsage(it->second);
+            ++it;
+        }
+    }
+
+    void RecordIdBitmap::clear() {
+        _containers.clear();
+        _size = 0;
+        _memUsage = 0;
+    }
+
+} // namespace mongo
@@ -0,0 +1,135 @@
+// record_id_bitmap.h
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/record_id.h"
+#include "mongo/platform/cstdint.h"
+
+namespace mongo {
+
+    /**
+     * A compressed set of RecordIds, laid out like a roaring bitmap.
+     *
+     * RecordIds are split into their high 48 bits, which select a container, and their low 16
+     * bits, which are stored in it.  A container holds a sorted array of 16-bit values while it is
+     * sparse and switches to a fixed 8KB bitmap once it holds more than kMaxArraySize values, so
+     * each RecordId costs at most two bytes plus a share of the per-container overhead.
+     * Collections hand out RecordIds that are mostly dense and increasing, which is the case this
+     * representation is good at.
+     *
+     * Intersecting two bitmap containers ANDs them a word at a time (SSE2 when available), which
+     * is much cheaper than probing a hash table per RecordId.
+     */
+    class RecordIdBitmap {
+        MONGO_DISALLOW_COPYING(RecordIdBitmap);
+    public:
+        RecordIdBitmap();
+
+        /**
+         * Returns false if 'loc' was already in the set.
+         */
+        bool insert(const RecordId& loc);
+
+        bool contains(const RecordId& loc) const;
+
+        /**
+         * Returns false if 'loc' was not in the set.
+         */
+        bool erase(const RecordId& loc);
+
+        /**
+         * Removes every RecordId which is not also in 'other'.
+         */
+        void intersectWith(const RecordIdBitmap& other);
+
+        size_t size() const { return _size; }
+
+        bool empty() const { return _size == 0; }
+
+        void clear();
+
+        /**
+         * Approximate number of bytes of memory held by the set.
+         */
+        size_t getMemUsage() const { return _memUsage; }
+
+        // Containers switch to a bitmap once they would hold more values than this.  At this size
+        // the array and the bitmap take the same 8KB.
+        static const size_t kMaxArraySize = 4096;
+
+    private:
+        class Container {
+        public:
+            Container() : _cardinality(0) {}
+
+            bool insert(uint16_t low);
+            bool contains(uint16_t low) const;
+            bool erase(uint16_t low);
+            void intersectWith(const Container& other);
+
+            size_t cardinality() const { return _cardinality; }
+            size_t getMemUsage() const;
+
+        private:
+            bool isBitmap() const { return !_bits.empty(); }
+            void toBitmap();
+            void toArray();
+
+            // Sorted values.  Only used while the container is not a bitmap.
+            std::vector<uint16_t> _array;
+
+            // 1024 words once the container is a bitmap, otherwise empty.
+            std::vector<uint64_t> _bits;
+
+            size_t _cardinality;
+        };
+
+        typedef std::map<uint64_t, Container> ContainerMap;
+
+        static uint64_t highBits(const RecordId& loc) {
+            return static_cast<uint64_t>(loc.repr()) >> 16;
+        }
+
+        static uint16_t lowBits(const RecordId& loc) {
+            return static_cast<uint16_t>(static_cast<uint64_t>(loc.repr()) & 0xFFFF);
+        }
+
+        static size_t containerMemUsage(const Container& container);
+
+        ContainerMap _containers;
+        size_t _size;
+        size_t _memUsage;
+    };
+
+} // namespace mongo
@@ -0,0 +1,240 @@
+// record_id_bitmap_test.cpp
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kDefault
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <set>
+
+#include "mongo/config.h"
+#include "mongo/db/exec/record_id_bitmap.h"
+#include "mongo/platform/random.h"
+#include "mongo/platform/unordered_set.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/log.h"
+#include "mongo/util/timer.h"
+
+namespace {
+    using namespace mongo;
+
+    typedef std::set<RecordId> RecordIdSet;
+
+    void assertSameContents(const RecordIdSet& expected,
+                            const RecordIdBitmap& actual,
+                            const std::vector<RecordId>& probes) {
+        ASSERT_EQUALS(expected.size(), actual.size());
+        for (RecordIdSet::const_iterator it = expected.begin(); it != expected.end(); ++it) {
+            ASSERT(actual.contains(*it));
+        }
+        for (size_t i = 0; i < probes.size(); ++i) {
+            ASSERT_EQUALS(expected.count(probes[i]) == 1, actual.contains(probes[i]));
+        }
+    }
+
+    // Mostly dense RecordIds in a few containers, plus some far apart.
+    RecordId randomLoc(PseudoRandom* rand) {
+        if (rand->nextInt32(10) == 0) {
+            return RecordId(std::abs(rand->nextInt64()) >> 1);
+        }
+        return RecordId(std::abs(rand->nextInt32(4 * 65536)) + 1);
+    }
+
+    TEST(RecordIdBitmapTest, Empty) {
+        RecordIdBitmap bitmap;
+        ASSERT(bitmap.empty());
+        ASSERT_EQUALS(0U, bitmap.size());
+        ASSERT_EQUALS(0U, bitmap.getMemUsage());
+        ASSERT_FALSE(bitmap.contains(RecordId(1)));
+        ASSERT_FALSE(bitmap.erase(RecordId(1)));
+    }
+
+    TEST(RecordIdBitmapTest, InsertContainsErase) {
+        RecordIdBitmap bitmap;
+        ASSERT(bitmap.insert(RecordId(1)));
+        ASSERT(bitmap.insert(RecordId(70000)));
+        ASSERT(bitmap.insert(RecordId(5, 6)));
+        ASSERT_FALSE(bitmap.insert(RecordId(1)));
+        ASSERT_EQUALS(3U, bitmap.size());
+        ASSERT_GREATER_THAN(bitmap.getMemUsage(), 0U);
+
+        ASSERT(bitmap.contains(RecordId(70000)));
+        ASSERT_FALSE(bitmap.contains(RecordId(70001)));
+        ASSERT_FALSE(bitmap.contains(RecordId(2)));
+
+        ASSERT(bitmap.erase(RecordId(70000)));
+        ASSERT_FALSE(bitmap.erase(RecordId(70000)));
+        ASSERT_FALSE(bitmap.contains(RecordId(70000)));
+        ASSERT_EQUALS(2U, bitmap.size());
+
+        bitmap.clear();
+        ASSERT(bitmap.empty());
+        ASSERT_EQUALS(0U, bitmap.getMemUsage());
+    }
+
+    TEST(RecordIdBitmapTest, DenseContainerIsCompact) {
+        RecordIdBitmap bitmap;
+        for (int64_t i = 0; i < 65536; ++i) {
+            ASSERT(bitmap.insert(RecordId(i)));
+        }
+        ASSERT_EQUALS(65536U, bitmap.size());
+        ASSERT_LESS_THAN(bitmap.getMemUsage(), 10 * 1024U);
+
+        // Emptying the bitmap container takes it back through the array representation
+        for (int64_t i = 0; i < 65536; ++i) {
+            ASSERT(bitmap.erase(RecordId(i)));
+            ASSERT_FALSE(bitmap.contains(RecordId(i)));
+        }
+        ASSERT(bitmap.empty());
+        ASSERT_EQUALS(0U, bitmap.getMemUsage());
+    }
+
+    TEST(RecordIdBitmapTest, IntersectAllContainerKinds) {
+        // Container 0 is a bitmap on both sides, container 1 is an array on both sides,
+        // container 2 is a bitmap intersected with an array and container 3 the reverse.
+        RecordIdBitmap a;
+        RecordIdBitmap b;
+        RecordIdSet expected;
+        for (int64_t i = 0; i < 65536; ++i) {
+            if (i % 2 == 0) a.insert(RecordId(i));
+            if (i % 3 == 0) b.insert(RecordId(i));
+            if (i % 6 == 0) expected.insert(RecordId(i));
+        }
+        for (int64_t i = 65536; i < 2 * 65536; i += 100) {
+            a.insert(RecordId(i));
+            if (i % 300 == 0) b.insert(RecordId(i));
+            if (i % 300 == 0) expected.insert(RecordId(i));
+        }
+        for (int64_t i = 2 * 65536; i < 3 * 65536; ++i) {
+            a.insert(RecordId(i));
+            if (i % 50 == 0) b.insert(RecordId(i));
+            if (i % 50 == 0) expected.insert(RecordId(i));
+        }
+        for (int64_t i = 3 * 65536; i < 4 * 65536; ++i) {
+            if (i % 50 == 0) a.insert(RecordId(i));
+            b.insert(RecordId(i));
+            if (i % 50 == 0) expected.insert(RecordId(i));
+        }
+        // A container only present on one side
+        a.insert(RecordId(10 * 65536));
+
+        a.intersectWith(b);
+        assertSameContents(expected, a, std::vector<RecordId>());
+        for (int64_t i = 0; i < 4 * 65536; ++i) {
+            ASSERT_EQUALS(expected.count(RecordId(i)) == 1, a.contains(RecordId(i)));
+        }
+        ASSERT_FALSE(a.contains(RecordId(10 * 65536)));
+    }
+
+    TEST(RecordIdBitmapTest, RandomOpsMatchStdSet) {
+        PseudoRandom rand(12345);
+
+        for (int round = 0; round < 10; ++round) {
+            RecordIdBitmap a;
+            RecordIdBitmap b;
+            RecordIdSet expectedA;
+            RecordIdSet expectedB;
+            std::vector<RecordId> probes;
+
+            // Vary the density so that containers switch representations
+            const int numOps = 1000 + std::abs(rand.nextInt32(40000));
+            for (int i = 0; i < numOps; ++i) {
+                const RecordId loc = randomLoc(&rand);
+                if (i % 100 == 0) probes.push_back(loc);
+
+                switch (std::abs(rand.nextInt32(4))) {
+                case 0:
+                case 1:
+                    ASSERT_EQUALS(expectedA.insert(loc).second, a.insert(loc));
+                    break;
+                case 2:
+                    ASSERT_EQUALS(expectedB.insert(loc).second, b.insert(loc));
+                    break;
+                default:
+                    ASSERT_EQUALS(expectedA.erase(loc) == 1, a.erase(loc));
+                    break;
+                }
+            }
+
+            assertSameContents(expectedA, a, probes);
+            assertSameContents(expectedB, b, probes);
+
+            RecordIdSet expected;
+            std::set_intersection(expectedA.begin(), expectedA.end(),
+                                  expectedB.begin(), expectedB.end(),
+                                  std::inserter(expected, expected.begin()));
+            a.intersectWith(b);
+            assertSameContents(expected, a, probes);
+
+            // The intersection can still be modified
+            const RecordId loc = randomLoc(&rand);
+            ASSERT_EQUALS(expected.insert(loc).second, a.insert(loc));
+            assertSameContents(expected, a, probes);
+        }
+    }
+
+#ifndef MONGO_CONFIG_DEBUG_BUILD
+    TEST(RecordIdBitmapTest, PerformanceIntersection) {
+        const int64_t numLocs = 4 * 1000 * 1000;
+
+        {
+            Timer t;
+            RecordIdBitmap a;
+            RecordIdBitmap b;
+            for (int64_t i = 1; i <= numLocs; ++i) {
+                a.insert(RecordId(i));
+                if (i % 3 == 0) b.insert(RecordId(i));
+            }
+            a.intersectWith(b);
+            log() << "RecordIdBitmap: intersected " << numLocs << " with " << numLocs / 3
+                  << " RecordIds in " << t.millis() << " ms using " << b.getMemUsage()
+                  << " + " << a.getMemUsage() << " bytes";
+        }
+
+        {
+            typedef unordered_set<RecordId, RecordId::Hasher> HashSet;
+            Timer t;
+            HashSet a;
+            HashSet seen;
+            for (int64_t i = 1; i <= numLocs; ++i) {
+                a.insert(RecordId(i));
+            }
+            for (int64_t i = 3; i <= numLocs; i += 3) {
+                if (a.count(RecordId(i))) seen.insert(RecordId(i));
+            }
+            log() << "unordered_set: intersected " << numLocs << " with " << numLocs / 3
+                  << " RecordIds in " << t.millis() << " ms, " << seen.size() << " left";
+        }
+    }
+#endif
+
+} // namespace
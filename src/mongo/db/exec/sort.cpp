@@ -94,6 +94,10 @@ namespace mongo {
         // Our pattern for woComparing keys.
         _comparatorObj = comparatorBob.obj();
 
+        if (_comparatorObj.nFields() <= BSONKeyComparator::kMaxFields) {
+            _keyComparator.reset(new BSONKeyComparator(_comparatorObj));
+        }
+
         // The fake index key pattern used to generate Btree keys.
         _btreeObj = btreeBob.obj();
 
@@ -273,11 +277,15 @@ namespace mongo {
         }
     }
 
-    SortStage::WorkingSetComparator::WorkingSetComparator(BSONObj p) : pattern(p) { }
+    SortStage::WorkingSetComparator::WorkingSetComparator(BSONObj p,
+                                                          const BSONKeyComparator* keyComparator)
+        : pattern(p),
+          keyComparator(keyComparator) { }
 
     bool SortStage::WorkingSetComparator::operator()(const SortableDataItem& lhs, const SortableDataItem& rhs) const {
         // False means ignore field names.
-        int result = lhs.sortKey.woCompare(rhs.sortKey, pattern, false);
+        int result = keyComparator ? keyComparator->compare(lhs.sortKey, rhs.sortKey)
+                                   : lhs.sortKey.woCompare(rhs.sortKey, pattern, false);
         if (0 != result) {
             return result < 0;
         }
@@ -317,7 +325,8 @@ namespace mongo {
         if (NULL == _sortKeyGen) {
             // This is heavy and should be done as part of work().
             _sortKeyGen.reset(new SortStageKeyGenerator(_collection, _pattern, _query));
-            _sortKeyComparator.reset(new WorkingSetComparator(_sortKeyGen->getSortComparator()));
+            _sortKeyComparator.reset(new WorkingSetComparator(_sortKeyGen->getSortComparator(),
+                                                              _sortKeyGen->getKeyComparator()));
             // If limit > 1, we need to initialize _dataSet here to maintain ordered
             // set of data items while fetching from the child stage.
             if (_limit > 1) {
@@ -32,6 +32,7 @@
 #include <vector>
 #include <set>
 
+#include "mongo/bson/bson_key_comparator.h"
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/jsobj.h"
@@ -91,6 +92,14 @@ namespace mongo {
          */
         const BSONObj& getSortComparator() const { return _comparatorObj; }
 
+        /**
+         * Returns a comparator specialized for getSortComparator(), or NULL if the sort has too
+         * many fields for one and the keys must be compared with BSONObj::woCompare().
+         *
+         * Returned pointer lives as long as 'this'.
+         */
+        const BSONKeyComparator* getKeyComparator() const { return _keyComparator.get(); }
+
     private:
         Status getBtreeKey(const BSONObj& memberObj, BSONObj* objOut) const;
 
@@ -112,6 +121,10 @@ namespace mongo {
         // unless we have some $meta expressions.  Each $meta expression has a default sort order.
         BSONObj _comparatorObj;
 
+        // Compares our resulting keys in the same order as _comparatorObj, if it has at most
+        // BSONKeyComparator::kMaxFields fields.
+        boost::scoped_ptr<BSONKeyComparator> _keyComparator;
+
         // The raw object in .sort()
         BSONObj _rawSortSpec;
 
@@ -217,13 +230,17 @@ namespace mongo {
         // Comparison object for data buffers (vector and set).
         // Items are compared on (sortKey, loc). This is also how the items are
         // ordered in the indices.
-        // Keys are compared using BSONObj::woCompare() with RecordId as a tie-breaker.
+        // Keys are compared using 'keyComparator', or BSONObj::woCompare() if there is none,
+        // with RecordId as a tie-breaker.
         struct WorkingSetComparator {
-            explicit WorkingSetComparator(BSONObj p);
+            WorkingSetComparator(BSONObj p, const BSONKeyComparator* keyComparator);
 
             bool operator()(const SortableDataItem& lhs, const SortableDataItem& rhs) const;
 
             BSONObj pattern;
+
+            // Not owned.  May be NULL.
+            const BSONKeyComparator* keyComparator;
         };
 
         /**
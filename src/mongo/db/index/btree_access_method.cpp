@@ -68,4 +68,8 @@ namespace mongo {
         _keyGenerator->getKeys(obj, keys);
     }
 
+    void BtreeAccessMethod::getKeyStrings(const BSONObj& obj, KeyStringSet* keys) const {
+        _keyGenerator->getKeys(obj, keys);
+    }
+
 }  // namespace mongo
@@ -52,6 +52,10 @@ namespace mongo {
     private:
         virtual void getKeys(const BSONObj& obj, BSONObjSet* keys) const;
 
+        virtual bool generatesKeyStrings() const { return true; }
+
+        virtual void getKeyStrings(const BSONObj& obj, KeyStringSet* keys) const;
+
         // Our keys differ for V0 and V1.
         boost::scoped_ptr<BtreeKeyGenerator> _keyGenerator;
     };
@@ -28,6 +28,7 @@
 
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/index/btree_key_generator.h"
+#include "mongo/db/storage/key_string_set.h"
 #include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
@@ -45,6 +46,53 @@ namespace {
 
 } // namespace
 
+    /**
+     * Builds each key as a BSONObj with empty field names.
+     */
+    class BtreeKeyGenerator::BSONObjSetSink : public BtreeKeyGenerator::KeySink {
+    public:
+        BSONObjSetSink(BSONObjSet* keys, const BSONSizeTracker& sizeTracker)
+            : _keys(keys), _sizeTracker(sizeTracker) { }
+
+        virtual void addKey(const std::vector<BSONElement>& values) {
+            BSONObjBuilder b(_sizeTracker);
+            for (std::vector<BSONElement>::const_iterator i = values.begin(); i != values.end();
+                 ++i) {
+                b.appendAs(*i, "");
+            }
+            _keys->insert(b.obj());
+        }
+
+    private:
+        BSONObjSet* const _keys;
+        const BSONSizeTracker& _sizeTracker;
+    };
+
+    /**
+     * Encodes each key as a KeyString, reusing one KeyString buffer for all of them.
+     */
+    class BtreeKeyGenerator::KeyStringSink : public BtreeKeyGenerator::KeySink {
+    public:
+        explicit KeyStringSink(KeyStringSet* keys) : _keys(keys) { }
+
+        virtual void addKey(const std::vector<BSONElement>& values) {
+            // The size of the equivalent BSONObj: header and EOO, plus each element under an
+            // empty field name.
+            int bsonSize = 5;
+            for (std::vector<BSONElement>::const_iterator i = values.begin(); i != values.end();
+                 ++i) {
+                bsonSize += i->size() - i->fieldNameSize() + 1;
+            }
+
+            _keyString.resetToKey(values, _keys->getOrdering());
+            _keys->add(_keyString, bsonSize);
+        }
+
+    private:
+        KeyStringSet* const _keys;
+        KeyString _keyString;
+    };
+
     BtreeKeyGenerator::BtreeKeyGenerator(std::vector<const char*> fieldNames,
                                          std::vector<BSONElement> fixed,
                                          bool isSparse)
@@ -78,12 +126,30 @@ namespace {
 
         // '_fieldNames' and '_fixed' are passed by value so that they can be mutated as part of the
         // getKeys call.  :|
-        getKeysImpl(_fieldNames, _fixed, obj, keys);
+        BSONObjSetSink sink(keys, _sizeTracker);
+        getKeysImpl(_fieldNames, _fixed, obj, &sink);
         if (keys->empty() && ! _isSparse) {
             keys->insert(_nullKey);
         }
     }
 
+    void BtreeKeyGenerator::getKeys(const BSONObj& obj, KeyStringSet* keys) const {
+        KeyStringSink sink(keys);
+
+        if (_isIdIndex) {
+            BSONElement e = obj["_id"];
+            sink.addKey(std::vector<BSONElement>(1, e.eoo() ? nullElt : e));
+        }
+        else {
+            getKeysImpl(_fieldNames, _fixed, obj, &sink);
+            if (keys->empty() && ! _isSparse) {
+                sink.addKey(std::vector<BSONElement>(_fieldNames.size(), nullElt));
+            }
+        }
+
+        keys->finish();
+    }
+
     static void assertParallelArrays( const char *first, const char *second ) {
         std::stringstream ss;
         ss << "cannot index parallel arrays [" << first << "] [" << second << "]";
@@ -98,7 +164,7 @@ namespace {
     void BtreeKeyGeneratorV0::getKeysImpl(std::vector<const char*> fieldNames,
                                           std::vector<BSONElement> fixed,
                                           const BSONObj &obj,
-                                          BSONObjSet *keys) const {
+                                          KeySink* keys) const {
         BSONElement arrElt;
         unsigned arrIdx = ~0;
         unsigned numNotFound = 0;
@@ -153,24 +219,16 @@ namespace {
         if ( allFound ) {
             if ( arrElt.eoo() ) {
                 // no terminal array element to expand
-                BSONObjBuilder b(_sizeTracker);
-                for (std::vector< BSONElement >::iterator i = fixed.begin(); i != fixed.end(); ++i)
-                    b.appendAs( *i, "" );
-                keys->insert( b.obj() );
+                keys->addKey( fixed );
             }
             else {
                 // terminal array element to expand, so generate all keys
                 BSONObjIterator i( arrElt.embeddedObject() );
                 if ( i.more() ) {
+                    std::vector<BSONElement> values( fixed );
                     while (i.more()) {
-                        BSONObjBuilder b(_sizeTracker);
-                        for (unsigned j = 0; j < fixed.size(); ++j) {
-                            if ( j == arrIdx )
-                                b.appendAs( i.next(), "" );
-                            else
-                                b.appendAs( fixed[ j ], "" );
-                        }
-                        keys->insert( b.obj() );
+                        values[ arrIdx ] = i.next();
+                        keys->addKey( values );
                     }
                 }
                 else if ( fixed.size() > 1 ) {
@@ -197,20 +255,20 @@ namespace {
 
         if ( insertArrayNull ) {
             // x : [] - need to insert undefined
-            BSONObjBuilder b(_sizeTracker);
+            std::vector<BSONElement> values( fixed.size() );
             for (unsigned j = 0; j < fixed.size(); ++j) {
                 if ( j == arrIdx ) {
-                    b.appendUndefined( "" );
+                    values[ j ] = undefinedElt;
                 }
                 else {
                     BSONElement e = fixed[j];
                     if ( e.eoo() )
-                        b.appendNull( "" );
+                        values[ j ] = nullElt;
                     else
-                        b.appendAs( e , "" );
+                        values[ j ] = e;
                 }
             }
-            keys->insert( b.obj() );
+            keys->addKey( values );
         }
     }
 
@@ -256,7 +314,7 @@ namespace {
             std::vector<const char*>* fieldNames,
             std::vector<BSONElement>* fixed,
             const BSONElement& arrEntry,
-            BSONObjSet* keys,
+            KeySink* keys,
             unsigned numNotFound,
             const BSONElement& arrObjElt,
             const std::set<unsigned>& arrIdxs,
@@ -282,7 +340,7 @@ namespace {
     void BtreeKeyGeneratorV1::getKeysImpl(std::vector<const char*> fieldNames,
                                           std::vector<BSONElement> fixed,
                                           const BSONObj& obj,
-                                          BSONObjSet* keys) const {
+                                          KeySink* keys) const {
         getKeysImplWithArray(fieldNames, fixed, obj, keys, 0, _emptyPositionalInfo);
     }
 
@@ -290,7 +348,7 @@ namespace {
             std::vector<const char*> fieldNames,
             std::vector<BSONElement> fixed,
             const BSONObj& obj,
-            BSONObjSet* keys,
+            KeySink* keys,
             unsigned numNotFound,
             const std::vector<PositionalPathInfo>& positionalInfo) const {
         BSONElement arrElt;
@@ -340,11 +398,7 @@ namespace {
             if ( _isSparse && numNotFound == fieldNames.size()) {
                 return;
             }
-            BSONObjBuilder b(_sizeTracker);
-            for (std::vector< BSONElement >::iterator i = fixed.begin(); i != fixed.end(); ++i) {
-                b.appendAs( *i, "" );
-            }
-            keys->insert( b.obj() );
+            keys->addKey( fixed );
         }
         else if ( arrElt.embeddedObject().firstElement().eoo() ) {
             // Empty array, so set matching fields to undefined.
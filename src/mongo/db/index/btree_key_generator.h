@@ -34,6 +34,8 @@
 
 namespace mongo {
 
+    class KeyStringSet;
+
     /**
      * Internal class used by BtreeAccessMethod to generate keys for indexed documents.
      * This class is meant to be kept under the index access layer.
@@ -48,9 +50,26 @@ namespace mongo {
 
         void getKeys(const BSONObj& obj, BSONObjSet* keys) const;
 
+        /**
+         * Generates the same keys as above, encoded as KeyStrings in the ordering of 'keys', and
+         * finishes 'keys'. Each key is encoded straight from the document's elements, without
+         * first building it as a BSONObj.
+         */
+        void getKeys(const BSONObj& obj, KeyStringSet* keys) const;
+
         static const int ParallelArraysCode;
 
     protected:
+        /**
+         * Receives each key generated for a document, as the values of the key's fields in key
+         * pattern order. Duplicate keys are the receiver's to remove.
+         */
+        class KeySink {
+        public:
+            virtual ~KeySink() { }
+            virtual void addKey(const std::vector<BSONElement>& values) = 0;
+        };
+
         // These are used by the getKeysImpl(s) below.
         std::vector<const char*> _fieldNames;
         bool _isIdIndex;
@@ -59,11 +78,14 @@ namespace mongo {
         BSONSizeTracker _sizeTracker;
 
     private:
+        class BSONObjSetSink;
+        class KeyStringSink;
+
         // We have V0 and V1.  Sigh.
         virtual void getKeysImpl(std::vector<const char*> fieldNames,
                                  std::vector<BSONElement> fixed,
                                  const BSONObj& obj,
-                                 BSONObjSet* keys) const = 0;
+                                 KeySink* keys) const = 0;
 
         std::vector<BSONElement> _fixed;
     };
@@ -80,7 +102,7 @@ namespace mongo {
         virtual void getKeysImpl(std::vector<const char*> fieldNames,
                                  std::vector<BSONElement> fixed,
                                  const BSONObj& obj,
-                                 BSONObjSet* keys) const;
+                                 KeySink* keys) const;
     };
 
     class BtreeKeyGeneratorV1 : public BtreeKeyGenerator {
@@ -148,7 +170,7 @@ namespace mongo {
          * @param fieldNames - fields to index, may be postfixes in recursive calls
          * @param fixed - values that have already been identified for their index fields
          * @param obj - object from which keys should be extracted, based on names in fieldNames
-         * @param keys - set where index keys are written
+         * @param keys - receives the generated index keys
          * @param numNotFound - number of index fields that have already been identified as missing
          * @param array - array from which keys should be extracted, based on names in fieldNames
          *        If obj and array are both nonempty, obj will be one of the elements of array.
@@ -156,7 +178,7 @@ namespace mongo {
         virtual void getKeysImpl(std::vector<const char*> fieldNames,
                                  std::vector<BSONElement> fixed,
                                  const BSONObj& obj,
-                                 BSONObjSet* keys) const;
+                                 KeySink* keys) const;
 
         /**
          * This recursive method does the heavy-lifting for getKeysImpl().
@@ -164,7 +186,7 @@ namespace mongo {
         void getKeysImplWithArray(std::vector<const char*> fieldNames,
                                   std::vector<BSONElement> fixed,
                                   const BSONObj& obj,
-                                  BSONObjSet* keys,
+                                  KeySink* keys,
                                   unsigned numNotFound,
                                   const std::vector<PositionalPathInfo>& positionalInfo) const;
         /**
@@ -212,7 +234,7 @@ namespace mongo {
         void _getKeysArrEltFixed(std::vector<const char*>* fieldNames,
                                  std::vector<BSONElement>* fixed,
                                  const BSONElement& arrEntry,
-                                 BSONObjSet* keys,
+                                 KeySink* keys,
                                  unsigned numNotFound,
                                  const BSONElement& arrObjElt,
                                  const std::set<unsigned>& arrIdxs,
@@ -26,13 +26,20 @@
  *    it in the license file.
  */
 
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kIndex
+
 #include "mongo/db/index/btree_key_generator.h"
 
 #include <boost/scoped_ptr.hpp>
+#include <cstring>
 #include <iostream>
 
+#include "mongo/config.h"
 #include "mongo/db/json.h"
+#include "mongo/db/storage/key_string_set.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 using namespace mongo;
 using boost::scoped_ptr;
@@ -71,6 +78,33 @@ namespace {
         return true;
     }
 
+    /**
+     * Checks that the KeyStringSet holds exactly the keys of the BSONObjSet, in order.
+     */
+    bool keyStringsMatch(const BSONObjSet& expected, const KeyStringSet& actual) {
+        if (expected.size() != actual.size()) {
+            return false;
+        }
+
+        size_t i = 0;
+        for (BSONObjSet::iterator it = expected.begin(); it != expected.end(); ++it, ++i) {
+            KeyString ks(*it, actual.getOrdering());
+            KeyStringSet::Key key = actual[i];
+            if (key.getSize() != ks.getSize() ||
+                    memcmp(key.getBuffer(), ks.getBuffer(), ks.getSize()) != 0) {
+                return false;
+            }
+            if (key.getBsonSize() != it->objsize()) {
+                return false;
+            }
+            if (key.toBson(actual.getOrdering()).woCompare(*it) != 0) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
     bool testKeygen(const BSONObj& kp, const BSONObj& obj,
                     const BSONObjSet& expectedKeys, bool sparse = false) {
         //
@@ -103,9 +137,20 @@ namespace {
         if (!match) {
             cout << "Expected: " << dumpKeyset(expectedKeys) << ", "
                  << "Actual: " << dumpKeyset(actualKeys) << endl;
+            return false;
+        }
+
+        //
+        // Step 4: generating the keys as KeyStrings must give the same keys.
+        //
+        KeyStringSet actualKeyStrings(Ordering::make(kp));
+        keyGen->getKeys(obj, &actualKeyStrings);
+        if (!keyStringsMatch(actualKeys, actualKeyStrings)) {
+            cout << "KeyStrings do not match: " << dumpKeyset(actualKeys) << endl;
+            return false;
         }
 
-        return match;
+        return true;
     }
 
     //
@@ -829,4 +874,69 @@ namespace {
         ASSERT(testKeygen(keyPattern, genKeysFrom, expectedKeys));
     }
 
+    TEST(BtreeKeyGeneratorTest, KeyStringsDescending) {
+        BSONObj keyPattern = fromjson("{a: 1, b: -1}");
+        BSONObj genKeysFrom = fromjson("{a: [3, 1, 'x', 1.0, null], b: {c: 2}}");
+        BSONObjSet expectedKeys;
+        expectedKeys.insert(fromjson("{'': null, '': {c: 2}}"));
+        expectedKeys.insert(fromjson("{'': 1, '': {c: 2}}"));
+        expectedKeys.insert(fromjson("{'': 3, '': {c: 2}}"));
+        expectedKeys.insert(fromjson("{'': 'x', '': {c: 2}}"));
+        ASSERT(testKeygen(keyPattern, genKeysFrom, expectedKeys));
+    }
+
+#ifndef MONGO_CONFIG_DEBUG_BUILD
+    TEST(BtreeKeyGeneratorTest, PerformanceLargeArray) {
+        const int numDocs = 1000;
+        const int arraySize = 1000;
+
+        vector<const char*> fieldNames;
+        fieldNames.push_back("a");
+        fieldNames.push_back("b");
+        vector<BSONElement> fixed(2);
+        BtreeKeyGeneratorV1 keyGen(fieldNames, fixed, false);
+        const Ordering ord = Ordering::make(BSON("a" << 1 << "b" << 1));
+
+        vector<BSONObj> docs;
+        for (int i = 0; i < numDocs; i++) {
+            BSONArrayBuilder arr;
+            for (int j = 0; j < arraySize; j++) {
+                arr.append((i * 7919 + j * 104729) % (10 * arraySize));
+            }
+            docs.push_back(BSON("a" << arr.arr() << "b" << i));
+        }
+
+        // What an insert did before: a BSONObjSet which the storage engine then encodes
+        long long numKeys = 0;
+        {
+            Timer t;
+            for (int i = 0; i < numDocs; i++) {
+                BSONObjSet keys;
+                keyGen.getKeys(docs[i], &keys);
+                for (BSONObjSet::iterator it = keys.begin(); it != keys.end(); ++it) {
+                    KeyString ks(*it, ord);
+                    numKeys += ks.getSize() > 0;
+                }
+            }
+            log() << "BSONObjSet + KeyString: " << numKeys << " keys from " << numDocs
+                  << " docs took " << t.millis() << " ms";
+        }
+
+        long long numKeyStrings = 0;
+        {
+            Timer t;
+            KeyStringSet keys(ord);
+            for (int i = 0; i < numDocs; i++) {
+                keys.clear();
+                keyGen.getKeys(docs[i], &keys);
+                numKeyStrings += keys.size();
+            }
+            log() << "KeyStringSet: " << numKeyStrings << " keys from " << numDocs
+                  << " docs took " << t.millis() << " ms";
+        }
+
+        ASSERT_EQUALS(numKeys, numKeyStrings);
+    }
+#endif
+
 } // namespace
@@ -36,6 +36,7 @@
 
 #include "mongo/base/error_codes.h"
 #include "mongo/base/status.h"
+#include "mongo/bson/bson_key_comparator.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/jsobj.h"
@@ -66,6 +67,7 @@ namespace mongo {
     public:
         BtreeExternalSortComparison(const BSONObj& ordering, int version)
             : _ordering(Ordering::make(ordering)),
+              _keyComparator(_ordering),
               _version(version) {
             invariant(version == 1 || version == 0);
         }
@@ -74,13 +76,14 @@ namespace mongo {
 
         int operator() (const Data& l, const Data& r) const {
             int x = (_version == 1
-                        ? l.first.woCompare(r.first, _ordering, /*considerfieldname*/false)
+                        ? _keyComparator.compare(l.first, r.first)
                         : oldCompare(l.first, r.first, _ordering));
             if (x) { return x; }
             return l.second.compare(r.second);
         }
     private:
         const Ordering _ordering;
+        const BSONKeyComparator _keyComparator;
         const int _version;
     };
 
@@ -88,7 +91,8 @@ namespace mongo {
                                          SortedDataInterface* btree)
         : _btreeState(btreeState),
           _descriptor(btreeState->descriptor()),
-          _newInterface(btree) {
+          _newInterface(btree),
+          _ordering(Ordering::make(_descriptor->keyPattern())) {
         verify(0 == _descriptor->version() || 1 == _descriptor->version());
     }
 
@@ -105,6 +109,12 @@ namespace mongo {
                                      int64_t* numInserted) {
         *numInserted = 0;
 
+        if (useKeyStrings()) {
+            KeyStringSet keys(_ordering);
+            getKeyStrings(obj, &keys);
+            return insertKeyStrings(txn, keys, loc, options, numInserted);
+        }
+
         BSONObjSet keys;
         // Delegate to the subclass.
         getKeys(obj, &keys);
@@ -150,6 +160,64 @@ namespace mongo {
         return ret;
     }
 
+    // Same as the BSONObjSet loop in insert() above
+    Status IndexAccessMethod::insertKeyStrings(OperationContext* txn,
+                                               const KeyStringSet& keys,
+                                               const RecordId& loc,
+                                               const InsertDeleteOptions& options,
+                                               int64_t* numInserted) {
+        for (size_t i = 0; i < keys.size(); ++i) {
+            Status status = _newInterface->insertKeyString(txn, keys[i], loc,
+                                                           options.dupsAllowed);
+
+            if (status.isOK()) {
+                ++*numInserted;
+                continue;
+            }
+
+            if (status.code() == ErrorCodes::KeyTooLong && ignoreKeyTooLong(txn)) {
+                continue;
+            }
+
+            if (status.code() == ErrorCodes::DuplicateKeyValue) {
+                if (!_btreeState->isReady(txn)) {
+                    LOG(3) << "key " << keys[i].toBson(_ordering)
+                           << " already in index during background indexing (ok)";
+                    continue;
+                }
+            }
+
+            for (size_t j = 0; j < i; ++j) {
+                removeOneKeyString(txn, keys[j], loc, options.dupsAllowed);
+            }
+            *numInserted = 0;
+
+            return status;
+        }
+
+        if (*numInserted > 1) {
+            _btreeState->setMultikey( txn );
+        }
+
+        return Status::OK();
+    }
+
+    void IndexAccessMethod::removeOneKeyString(OperationContext* txn,
+                                               const KeyStringSet::Key& key,
+                                               const RecordId& loc,
+                                               bool dupsAllowed) {
+        try {
+            _newInterface->unindexKeyString(txn, key, loc, dupsAllowed);
+        } catch (AssertionException& e) {
+            log() << "Assertion failure: _unindex failed "
+                  << _descriptor->indexNamespace() << endl;
+            log() << "Assertion failure: _unindex failed: " << e.what()
+                  << "  key:" << key.toBson(_ordering).toString()
+                  << "  dl:" << loc;
+            logContext();
+        }
+    }
+
     void IndexAccessMethod::removeOneKey(OperationContext* txn,
                                          const BSONObj& key,
                                          const RecordId& loc,
@@ -179,6 +247,19 @@ namespace mongo {
                                      const InsertDeleteOptions &options,
                                      int64_t* numDeleted) {
 
+        if (useKeyStrings()) {
+            KeyStringSet keys(_ordering);
+            getKeyStrings(obj, &keys);
+            *numDeleted = 0;
+
+            for (size_t i = 0; i < keys.size(); ++i) {
+                removeOneKeyString(txn, keys[i], loc, options.dupsAllowed);
+                ++*numDeleted;
+            }
+
+            return Status::OK();
+        }
+
         BSONObjSet keys;
         getKeys(obj, &keys);
         *numDeleted = 0;
@@ -278,12 +359,30 @@ namespace mongo {
                                              UpdateTicket* ticket,
                                              const MatchExpression* indexFilter) {
 
+        ticket->loc = record;
+        ticket->dupsAllowed = options.dupsAllowed;
+
+        if (useKeyStrings()) {
+            ticket->oldKeyStrings.reset(new KeyStringSet(_ordering));
+            ticket->newKeyStrings.reset(new KeyStringSet(_ordering));
+            if (indexFilter == NULL || indexFilter->matchesBSON(from))
+                getKeyStrings(from, ticket->oldKeyStrings.get());
+            if (indexFilter == NULL || indexFilter->matchesBSON(to))
+                getKeyStrings(to, ticket->newKeyStrings.get());
+
+            ticket->oldKeyStrings->difference(*ticket->newKeyStrings,
+                                              &ticket->removedKeyStrings);
+            ticket->newKeyStrings->difference(*ticket->oldKeyStrings,
+                                              &ticket->addedKeyStrings);
+
+            ticket->_isValid = true;
+            return Status::OK();
+        }
+
         if (indexFilter == NULL || indexFilter->matchesBSON(from))
             getKeys(from, &ticket->oldKeys);
         if (indexFilter == NULL || indexFilter->matchesBSON(to))
             getKeys(to, &ticket->newKeys);
-        ticket->loc = record;
-        ticket->dupsAllowed = options.dupsAllowed;
 
         setDifference(ticket->oldKeys, ticket->newKeys, &ticket->removed);
         setDifference(ticket->newKeys, ticket->oldKeys, &ticket->added);
@@ -300,6 +399,37 @@ namespace mongo {
             return Status(ErrorCodes::InternalError, "Invalid UpdateTicket in update");
         }
 
+        if (ticket.oldKeyStrings) {
+            const KeyStringSet& oldKeys = *ticket.oldKeyStrings;
+            const KeyStringSet& newKeys = *ticket.newKeyStrings;
+
+            if (oldKeys.size() + ticket.addedKeyStrings.size()
+                    - ticket.removedKeyStrings.size() > 1) {
+                _btreeState->setMultikey( txn );
+            }
+
+            for (size_t i = 0; i < ticket.removedKeyStrings.size(); ++i) {
+                _newInterface->unindexKeyString(txn,
+                                                oldKeys[ticket.removedKeyStrings[i]],
+                                                ticket.loc,
+                                                ticket.dupsAllowed);
+            }
+
+            for (size_t i = 0; i < ticket.addedKeyStrings.size(); ++i) {
+                Status status = _newInterface->insertKeyString(txn,
+                                                               newKeys[ticket.addedKeyStrings[i]],
+                                                               ticket.loc,
+                                                               ticket.dupsAllowed);
+                if ( !status.isOK() ) {
+                    return status;
+                }
+            }
+
+            *numUpdated = ticket.addedKeyStrings.size();
+
+            return Status::OK();
+        }
+
         if (ticket.oldKeys.size() + ticket.added.size() - ticket.removed.size() > 1) {
             _btreeState->setMultikey( txn );
         }
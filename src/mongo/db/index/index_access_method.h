@@ -37,6 +37,7 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/record_id.h"
 #include "mongo/db/sorter/sorter.h"
+#include "mongo/db/storage/key_string_set.h"
 #include "mongo/db/storage/sorted_data_interface.h"
 
 namespace mongo {
@@ -237,6 +238,20 @@ namespace mongo {
          */
         virtual void getKeys(const BSONObj &obj, BSONObjSet *keys) const = 0;
 
+        /**
+         * Returns true if getKeyStrings() is implemented.  insert(), remove() and update() then
+         * hand keys to the SortedDataInterface as KeyStrings, if it takes them.
+         */
+        virtual bool generatesKeyStrings() const { return false; }
+
+        /**
+         * Fills 'keys' with the keys getKeys() would generate for 'obj', encoded as KeyStrings in
+         * the ordering of 'keys', and finishes it.
+         */
+        virtual void getKeyStrings(const BSONObj& obj, KeyStringSet* keys) const {
+            invariant(false);
+        }
+
     protected:
         // Determines whether it's OK to ignore ErrorCodes::KeyTooLong for this OperationContext
         bool ignoreKeyTooLong(OperationContext* txn);
@@ -250,7 +265,23 @@ namespace mongo {
                           const RecordId& loc,
                           bool dupsAllowed);
 
+        void removeOneKeyString(OperationContext* txn,
+                                const KeyStringSet::Key& key,
+                                const RecordId& loc,
+                                bool dupsAllowed);
+
+        bool useKeyStrings() const {
+            return generatesKeyStrings() && _newInterface->supportsKeyStrings();
+        }
+
+        Status insertKeyStrings(OperationContext* txn,
+                                const KeyStringSet& keys,
+                                const RecordId& loc,
+                                const InsertDeleteOptions& options,
+                                int64_t* numInserted);
+
         const std::unique_ptr<SortedDataInterface> _newInterface;
+        const Ordering _ordering;
     };
 
     /**
@@ -271,6 +302,13 @@ namespace mongo {
         std::vector<BSONObj*> removed;
         std::vector<BSONObj*> added;
 
+        // Used instead of the above when the index takes KeyStrings.  The removed and added
+        // keys are positions in the two sets.
+        std::unique_ptr<KeyStringSet> oldKeyStrings;
+        std::unique_ptr<KeyStringSet> newKeyStrings;
+        std::vector<size_t> removedKeyStrings;
+        std::vector<size_t> addedKeyStrings;
+
         RecordId loc;
         bool dupsAllowed;
     };
@@ -92,6 +92,10 @@ namespace mongo {
         return _cursor->getKey();
     }
 
+    bool IndexCursor::getKeyString(const char** data, size_t* size) const {
+        return _cursor->getKeyString(data, size);
+    }
+
     RecordId IndexCursor::getValue() const {
         return _cursor->getRecordId();
     }
@@ -113,6 +113,10 @@ namespace mongo {
         // Current key we point at.  Assumes !isEOF().
         BSONObj getKey() const;
 
+        // Current key as a KeyString, if the index stores them.  Assumes !isEOF().
+        // See SortedDataInterface::Cursor::getKeyString().
+        bool getKeyString(const char** data, size_t* size) const;
+
         // Current value we point at.  Assumes !isEOF().
         RecordId getValue() const;
 
@@ -0,0 +1,387 @@
+// index_stats.cpp
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/index/index_stats.h"
+
+#include <algorithm>
+#include <third_party/murmurhash3/MurmurHash3.h>
+
+#include "mongo/db/query/index_bounds.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+    namespace {
+
+        const int kVersion = 1;
+
+        /**
+         * Hashes the value of 'e' so that values the index treats as equal hash the same.
+         */
+        uint64_t hashValue(const BSONElement& e) {
+            uint64_t out[2];
+            if (e.isNumber()) {
+                // 1, 1.0 and NumberLong(1) are one value, and so are 0 and -0.0.
+                double d = e.numberDouble();
+                if (d == 0) {
+                    d = 0;
+                }
+                MurmurHash3_x64_128(&d, sizeof(d), 0, out);
+            }
+            else {
+                MurmurHash3_x64_128(e.value(), e.valuesize(), e.canonicalType(), out);
+            }
+            return out[0];
+        }
+
+        uint64_t hashRecordId(const RecordId& loc) {
+            const int64_t repr = loc.repr();
+            uint64_t out[2];
+            MurmurHash3_x64_128(&repr, sizeof(repr), 0, out);
+            return out[0];
+        }
+
+        int compareValues(const BSONElement& a, const BSONElement& b) {
+            return a.woCompare(b, false);
+        }
+
+        /**
+         * Estimates the number of keys of 'bucket' within 'interval', whose start is not greater
+         * than its end.
+         */
+        double estimateBucket(const IndexStats::Bucket& bucket,
+                              const BSONElement& start, bool startInclusive,
+                              const BSONElement& end, bool endInclusive) {
+            const BSONElement min = bucket.min();
+            const BSONElement max = bucket.max();
+
+            const int startVsMax = compareValues(start, max);
+            const int endVsMin = compareValues(end, min);
+            if (startVsMax > 0 || (startVsMax == 0 && !startInclusive)
+                || endVsMin < 0 || (endVsMin == 0 && !endInclusive)) {
+                return 0;
+            }
+
+            const int startVsMin = compareValues(start, min);
+            const int endVsMax = compareValues(end, max);
+            if ((startVsMin < 0 || (startVsMin == 0 && startInclusive))
+                && (endVsMax > 0 || (endVsMax == 0 && endInclusive))) {
+                return bucket.count;
+            }
+
+            // The interval covers part of the bucket.  Assume the keys are spread evenly over
+            // the bucket's distinct values.
+            const double perValue = static_cast<double>(bucket.count) / bucket.distinct;
+            if (compareValues(start, end) == 0) {
+                return perValue;
+            }
+
+            // Interpolate over numbers, and otherwise guess that half the bucket is covered.
+            double fraction = 0.5;
+            if (min.isNumber() && max.isNumber() && start.isNumber() && end.isNumber()
+                && max.numberDouble() > min.numberDouble()) {
+                const double lo = std::max(start.numberDouble(), min.numberDouble());
+                const double hi = std::min(end.numberDouble(), max.numberDouble());
+                fraction = std::max(0.0, hi - lo) / (max.numberDouble() - min.numberDouble());
+            }
+            return std::max(perValue, fraction * bucket.count);
+        }
+
+    } // namespace
+
+    //
+    // IndexStats
+    //
+
+    IndexStats::IndexStats() : _numKeys(0), _collectionRecords(0), _records(kSketchPrecision) {}
+
+    long long IndexStats::numDistinct(size_t fieldNum) const {
+        invariant(fieldNum < _fields.size());
+        return _fields[fieldNum].estimate();
+    }
+
+    long long IndexStats::estimateKeys(const IndexBounds& bounds) const {
+        if (bounds.isSimpleRange || bounds.fields.size() != _fields.size()
+            || bounds.fields.empty()) {
+            return -1;
+        }
+        if (_numKeys == 0) {
+            return 0;
+        }
+
+        double keys = 0;
+        const std::vector<Interval>& intervals = bounds.fields[0].intervals;
+        for (size_t i = 0; i < intervals.size(); ++i) {
+            const Interval& interval = intervals[i];
+
+            // Intervals on descending fields run from high to low.
+            BSONElement start = interval.start;
+            BSONElement end = interval.end;
+            bool startInclusive = interval.startInclusive;
+            bool endInclusive = interval.endInclusive;
+            if (compareValues(start, end) > 0) {
+                std::swap(start, end);
+                std::swap(startInclusive, endInclusive);
+            }
+
+            for (size_t b = 0; b < _histogram.size(); ++b) {
+                keys += estimateBucket(_histogram[b], start, startInclusive, end, endInclusive);
+            }
+        }
+
+        // Each point interval on a later field selects about 1/distinct of the keys.
+        for (size_t f = 1; f < bounds.fields.size(); ++f) {
+            const std::vector<Interval>& fieldIntervals = bounds.fields[f].intervals;
+            bool allPoints = true;
+            for (size_t i = 0; i < fieldIntervals.size() && allPoints; ++i) {
+                allPoints = fieldIntervals[i].isPoint();
+            }
+
+            const long long distinct = numDistinct(f);
+            if (allPoints && distinct > 0) {
+                keys *= std::min(1.0, static_cast<double>(fieldIntervals.size()) / distinct);
+            }
+        }
+
+        return static_cast<long long>(std::min(keys, static_cast<double>(_numKeys)) + 0.5);
+    }
+
+    BSONObj IndexStats::toBSON() const {
+        BSONObjBuilder bob;
+        bob.append("version", kVersion);
+        bob.append("numKeys", _numKeys);
+        bob.append("collectionRecords", _collectionRecords);
+        bob.appendBinData("records", _records.size(), BinDataGeneral, _records.data());
+
+        BSONArrayBuilder fields(bob.subarrayStart("fields"));
+        for (size_t i = 0; i < _fields.size(); ++i) {
+            fields.appendBinData(_fields[i].size(), BinDataGeneral, _fields[i].data());
+        }
+        fields.doneFast();
+
+        BSONArrayBuilder histogram(bob.subarrayStart("histogram"));
+        for (size_t i = 0; i < _histogram.size(); ++i) {
+            BSONObjBuilder bucket(histogram.subobjStart());
+            bucket.appendElements(_histogram[i].bounds);
+            bucket.append("count", _histogram[i].count);
+            bucket.append("distinct", _histogram[i].distinct);
+            bucket.doneFast();
+        }
+        histogram.doneFast();
+
+        return bob.obj();
+    }
+
+    // static
+    Status IndexStats::parse(const BSONObj& obj, IndexStats* out) {
+        if (obj["version"].numberInt() != kVersion) {
+            return Status(ErrorCodes::BadValue,
+                          str::stream() << "unsupported index stats version: " << obj["version"]);
+        }
+
+        IndexStats stats;
+        stats._numKeys = obj["numKeys"].numberLong();
+        stats._collectionRecords = obj["collectionRecords"].numberLong();
+
+        int len;
+        const char* data;
+        BSONElement records = obj["records"];
+        if (records.type() != BinData) {
+            return Status(ErrorCodes::BadValue, "index stats are missing 'records'");
+        }
+        data = records.binData(len);
+        if (!stats._records.load(data, len)) {
+            return Status(ErrorCodes::BadValue, "bad 'records' sketch in index stats");
+        }
+
+        BSONElement fields = obj["fields"];
+        if (fields.type() != Array) {
+            return Status(ErrorCodes::BadValue, "index stats are missing 'fields'");
+        }
+        BSONForEach(field, fields.Obj()) {
+            HyperLogLog sketch(kSketchPrecision);
+            if (field.type() != BinData) {
+                return Status(ErrorCodes::BadValue, "bad field sketch in index stats");
+            }
+            data = field.binData(len);
+            if (!sketch.load(data, len)) {
+                return Status(ErrorCodes::BadValue, "bad field sketch in index stats");
+            }
+            stats._fields.push_back(sketch);
+        }
+
+        BSONElement histogram = obj["histogram"];
+        if (histogram.type() != Array) {
+            return Status(ErrorCodes::BadValue, "index stats are missing 'histogram'");
+        }
+        BSONForEach(elt, histogram.Obj()) {
+            if (!elt.isABSONObj()) {
+                return Status(ErrorCodes::BadValue, "bad histogram bucket in index stats");
+            }
+            BSONObj bucketObj = elt.Obj();
+            Bucket bucket;
+            bucket.bounds = BSON("min" << bucketObj["min"] << "max" << bucketObj["max"]);
+            bucket.count = bucketObj["count"].numberLong();
+            bucket.distinct = bucketObj["distinct"].numberLong();
+            if (bucket.min().eoo() || bucket.max().eoo() || bucket.distinct <= 0) {
+                return Status(ErrorCodes::BadValue, "bad histogram bucket in index stats");
+            }
+            stats._histogram.push_back(bucket);
+        }
+
+        *out = stats;
+        return Status::OK();
+    }
+
+    //
+    // IndexStatsBuilder
+    //
+
+    IndexStatsBuilder::IndexStatsBuilder(const BSONObj& keyPattern, size_t maxBuckets)
+        : _maxBuckets(std::max(maxBuckets, size_t(1))),
+          _descending(keyPattern.firstElement().number() < 0),
+          _bucketSize(1),
+          _haveBucket(false),
+          _count(0),
+          _distinct(0),
+          _lastRunCount(0) {
+
+        for (int i = 0; i < keyPattern.nFields(); ++i) {
+            _stats._fields.push_back(HyperLogLog(IndexStats::kSketchPrecision));
+        }
+    }
+
+    void IndexStatsBuilder::addKey(const BSONObj& key, const RecordId& loc) {
+        ++_stats._numKeys;
+        _stats._records.add(hashRecordId(loc));
+
+        BSONObjIterator it(key);
+        for (size_t i = 0; i < _stats._fields.size() && it.more(); ++i) {
+            _stats._fields[i].add(hashValue(it.next()));
+        }
+
+        const BSONElement value = key.firstElement();
+        if (_haveBucket && compareValues(value, _last.firstElement()) == 0) {
+            ++_count;
+            ++_lastRunCount;
+            return;
+        }
+
+        // A new value.  This is the only place a bucket may end, so that no value is split.
+        if (_haveBucket && _count >= _bucketSize) {
+            closeBucket();
+        }
+
+        if (!_haveBucket) {
+            _haveBucket = true;
+            _first = value.wrap("");
+            _count = 0;
+            _distinct = 0;
+        }
+        _previous = _last;
+        _last = value.wrap("");
+        _lastRunCount = 1;
+        ++_count;
+        ++_distinct;
+    }
+
+    void IndexStatsBuilder::closeBucket() {
+        invariant(_haveBucket);
+        _haveBucket = false;
+
+        if (_distinct > 1 && _lastRunCount >= _bucketSize) {
+            // The last value is frequent enough to fill a bucket by itself.  Give it one, so that
+            // equality on it is estimated exactly rather than averaged with its neighbours.
+            addBucket(_first.firstElement(), _previous.firstElement(),
+                      _count - _lastRunCount, _distinct - 1);
+            addBucket(_last.firstElement(), _last.firstElement(), _lastRunCount, 1);
+        }
+        else {
+            addBucket(_first.firstElement(), _last.firstElement(), _count, _distinct);
+        }
+
+        std::vector<IndexStats::Bucket>& histogram = _stats._histogram;
+        while (histogram.size() > _maxBuckets) {
+            // Too many buckets.  Make buckets twice as large and merge neighbours which fit
+            // together.  A bucket which already holds that many keys stays on its own.
+            _bucketSize *= 2;
+
+            std::vector<IndexStats::Bucket> merged;
+            merged.push_back(histogram[0]);
+            for (size_t i = 1; i < histogram.size(); ++i) {
+                IndexStats::Bucket& current = merged.back();
+                if (current.count + histogram[i].count > _bucketSize) {
+                    merged.push_back(histogram[i]);
+                    continue;
+                }
+                current.bounds = BSON("min" << current.min() << "max" << histogram[i].max());
+                current.count += histogram[i].count;
+                current.distinct += histogram[i].distinct;
+            }
+            histogram.swap(merged);
+        }
+    }
+
+    void IndexStatsBuilder::addBucket(const BSONElement& first,
+                                      const BSONElement& last,
+                                      long long count,
+                                      long long distinct) {
+        IndexStats::Bucket bucket;
+        bucket.bounds = BSON("min" << first << "max" << last);
+        bucket.count = count;
+        bucket.distinct = distinct;
+        _stats._histogram.push_back(bucket);
+    }
+
+    void IndexStatsBuilder::setCollectionRecords(long long numRecords) {
+        _stats._collectionRecords = numRecords;
+    }
+
+    IndexStats IndexStatsBuilder::done() {
+        if (_haveBucket) {
+            closeBucket();
+        }
+
+        // Until now bucket bounds and order followed the index.  Make them ascending.
+        if (_descending) {
+            std::vector<IndexStats::Bucket>& histogram = _stats._histogram;
+            std::reverse(histogram.begin(), histogram.end());
+            for (size_t i = 0; i < histogram.size(); ++i) {
+                histogram[i].bounds =
+                    BSON("min" << histogram[i].max() << "max" << histogram[i].min());
+            }
+        }
+
+        return _stats;
+    }
+
+} // namespace mongo
@@ -0,0 +1,166 @@
+// index_stats.h
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/record_id.h"
+#include "mongo/util/hyperloglog.h"
+
+namespace mongo {
+
+    struct IndexBounds;
+
+    /**
+     * Statistics about the keys of a btree index, for the query planner.  These are built by the
+     * analyze command from a scan of the whole index and kept in the catalog next to the index
+     * spec.  They are not maintained by writes, so they describe the index as of the last analyze.
+     *
+     * The statistics are:
+     *  - the number of keys, and an estimate of the number of distinct RecordIds they point to
+     *    (which differ for multikey indexes).
+     *  - an equi-depth histogram over the values of the first field of the key.  No value is
+     *    split between buckets, and a value with a bucket's worth of keys gets a bucket to
+     *    itself, so that equality on a frequent value is estimated exactly.
+     *  - a HyperLogLog sketch of the distinct values of every field of the key.
+     */
+    class IndexStats {
+    public:
+        struct Bucket {
+            // The smallest and largest values in the bucket, as fields "min" and "max".  Buckets
+            // are in ascending order of value whatever the direction of the index.
+            BSONObj bounds;
+            long long count;
+            long long distinct;
+
+            BSONElement min() const { return bounds["min"]; }
+            BSONElement max() const { return bounds["max"]; }
+        };
+
+        // Precision of the per-field sketches, which are stored in the catalog: 1KB each, with
+        // a standard error of about 3%.
+        static const int kSketchPrecision = 10;
+
+        static const size_t kDefaultMaxBuckets = 100;
+
+        IndexStats();
+
+        /**
+         * Parses the output of toBSON() into 'out'.
+         */
+        static Status parse(const BSONObj& obj, IndexStats* out);
+
+        BSONObj toBSON() const;
+
+        long long numKeys() const { return _numKeys; }
+
+        long long numRecords() const { return _records.estimate(); }
+
+        /**
+         * The number of documents in the collection when the statistics were gathered.
+         */
+        long long collectionRecords() const { return _collectionRecords; }
+
+        /**
+         * Estimated number of distinct values of field 'fieldNum' of the key.
+         */
+        long long numDistinct(size_t fieldNum) const;
+
+        const std::vector<Bucket>& histogram() const { return _histogram; }
+
+        /**
+         * Estimates how many keys of the index fall within 'bounds'.  The histogram gives the
+         * estimate for the first field, which is then scaled down by the selectivity of any
+         * later fields whose bounds are all points.  Returns -1 if the bounds can't be
+         * estimated, such as if they are simple ranges.
+         */
+        long long estimateKeys(const IndexBounds& bounds) const;
+
+    private:
+        friend class IndexStatsBuilder;
+
+        long long _numKeys;
+        long long _collectionRecords;
+        HyperLogLog _records;
+        std::vector<HyperLogLog> _fields;
+        std::vector<Bucket> _histogram;
+    };
+
+    /**
+     * Builds IndexStats from all of the keys of an index, fed in index order.
+     */
+    class IndexStatsBuilder {
+        MONGO_DISALLOW_COPYING(IndexStatsBuilder);
+    public:
+        IndexStatsBuilder(const BSONObj& keyPattern, size_t maxBuckets);
+
+        void addKey(const BSONObj& key, const RecordId& loc);
+
+        /**
+         * Records how many documents the collection had when the scan began.
+         */
+        void setCollectionRecords(long long numRecords);
+
+        /**
+         * Returns the statistics of the keys added so far.  Call once, after the last addKey().
+         */
+        IndexStats done();
+
+    private:
+        void closeBucket();
+        void addBucket(const BSONElement& first,
+                       const BSONElement& last,
+                       long long count,
+                       long long distinct);
+
+        const size_t _maxBuckets;
+        const bool _descending;
+
+        IndexStats _stats;
+
+        // Buckets are closed once they hold this many keys.  It doubles each time the number of
+        // buckets grows past _maxBuckets and neighbouring buckets are merged.
+        long long _bucketSize;
+
+        // The bucket being filled.  Its bounds are the first and last values seen, in index order.
+        // _previous is the value before _last, and _lastRunCount the number of keys with _last.
+        bool _haveBucket;
+        BSONObj _first;
+        BSONObj _previous;
+        BSONObj _last;
+        long long _count;
+        long long _distinct;
+        long long _lastRunCount;
+    };
+
+} // namespace mongo
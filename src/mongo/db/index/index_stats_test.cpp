@@ -0,0 +1,243 @@
+// index_stats_test.cpp
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <cmath>
+
+#include "mongo/db/index/index_stats.h"
+#include "mongo/db/json.h"
+#include "mongo/db/query/index_bounds.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+    using namespace mongo;
+
+    OrderedIntervalList makeOil(const std::string& name,
+                                const BSONObj& start,
+                                const BSONObj& end,
+                                bool startInclusive = true,
+                                bool endInclusive = true) {
+        OrderedIntervalList oil(name);
+        oil.intervals.push_back(Interval(BSON("" << start.firstElement()
+                                              << "" << end.firstElement()),
+                                         startInclusive,
+                                         endInclusive));
+        return oil;
+    }
+
+    OrderedIntervalList makePointOil(const std::string& name, const BSONObj& point) {
+        return makeOil(name, point, point);
+    }
+
+    void assertWithin(long long expected, long long actual, double relativeError) {
+        ASSERT_LESS_THAN_OR_EQUALS(std::abs(static_cast<double>(actual - expected)),
+                                   relativeError * expected);
+    }
+
+    // Keys 0 .. n-1 of {a: 1}, one document each.
+    IndexStats buildUniform(int n, size_t maxBuckets, bool descending = false) {
+        IndexStatsBuilder builder(BSON("a" << (descending ? -1 : 1)), maxBuckets);
+        for (int i = 0; i < n; ++i) {
+            const int value = descending ? n - 1 - i : i;
+            builder.addKey(BSON("" << value), RecordId(value + 1));
+        }
+        builder.setCollectionRecords(n);
+        return builder.done();
+    }
+
+    TEST(IndexStatsTest, Empty) {
+        IndexStatsBuilder builder(BSON("a" << 1), 10);
+        IndexStats stats = builder.done();
+        ASSERT_EQUALS(0, stats.numKeys());
+        ASSERT(stats.histogram().empty());
+
+        IndexBounds bounds;
+        bounds.fields.push_back(makePointOil("a", BSON("" << 1)));
+        ASSERT_EQUALS(0, stats.estimateKeys(bounds));
+    }
+
+    TEST(IndexStatsTest, HistogramCoversAllKeys) {
+        IndexStats stats = buildUniform(10000, 20);
+        ASSERT_EQUALS(10000, stats.numKeys());
+        assertWithin(10000, stats.numRecords(), 0.1);
+        assertWithin(10000, stats.numDistinct(0), 0.1);
+
+        const std::vector<IndexStats::Bucket>& histogram = stats.histogram();
+        ASSERT_LESS_THAN_OR_EQUALS(histogram.size(), 20U);
+        ASSERT_GREATER_THAN_OR_EQUALS(histogram.size(), 10U);
+
+        long long count = 0;
+        long long distinct = 0;
+        for (size_t i = 0; i < histogram.size(); ++i) {
+            count += histogram[i].count;
+            distinct += histogram[i].distinct;
+            ASSERT_LESS_THAN_OR_EQUALS(histogram[i].min().numberInt(),
+                                       histogram[i].max().numberInt());
+            if (i > 0) {
+                ASSERT_LESS_THAN(histogram[i - 1].max().numberInt(),
+                                 histogram[i].min().numberInt());
+            }
+        }
+        ASSERT_EQUALS(10000, count);
+        ASSERT_EQUALS(10000, distinct);
+        ASSERT_EQUALS(0, histogram.front().min().numberInt());
+        ASSERT_EQUALS(9999, histogram.back().max().numberInt());
+    }
+
+    TEST(IndexStatsTest, EstimateRanges) {
+        IndexStats stats = buildUniform(10000, 50);
+
+        IndexBounds bounds;
+        bounds.fields.push_back(makeOil("a", BSON("" << 1000), BSON("" << 3000), true, false));
+        assertWithin(2000, stats.estimateKeys(bounds), 0.05);
+
+        bounds.fields[0] = makeOil("a", BSON("" << MINKEY), BSON("" << MAXKEY));
+        ASSERT_EQUALS(10000, stats.estimateKeys(bounds));
+
+        bounds.fields[0] = makeOil("a", BSON("" << 20000), BSON("" << 30000));
+        ASSERT_EQUALS(0, stats.estimateKeys(bounds));
+
+        bounds.fields[0] = makePointOil("a", BSON("" << 1234));
+        ASSERT_EQUALS(1, stats.estimateKeys(bounds));
+
+        // Two intervals add up
+        bounds.fields[0] = makeOil("a", BSON("" << 0), BSON("" << 1000), true, false);
+        bounds.fields[0].intervals.push_back(
+            makeOil("a", BSON("" << 5000), BSON("" << 6000), true, false).intervals[0]);
+        assertWithin(2000, stats.estimateKeys(bounds), 0.05);
+    }
+
+    TEST(IndexStatsTest, DescendingIndex) {
+        IndexStats ascending = buildUniform(10000, 50);
+        IndexStats descending = buildUniform(10000, 50, true);
+
+        // The histogram is ascending either way
+        ASSERT_EQUALS(0, descending.histogram().front().min().numberInt());
+        ASSERT_EQUALS(9999, descending.histogram().back().max().numberInt());
+
+        // Bounds on a descending field run from high to low
+        IndexBounds bounds;
+        bounds.fields.push_back(makeOil("a", BSON("" << 3000), BSON("" << 1000), false, true));
+        assertWithin(2000, descending.estimateKeys(bounds), 0.05);
+
+        bounds.fields[0] = makePointOil("a", BSON("" << 1234));
+        ASSERT_EQUALS(1, descending.estimateKeys(bounds));
+    }
+
+    TEST(IndexStatsTest, FrequentValueGetsItsOwnBucket) {
+        IndexStatsBuilder builder(BSON("a" << 1), 10);
+        long long loc = 1;
+        for (int i = 0; i < 5000; ++i) {
+            builder.addKey(BSON("" << i), RecordId(loc++));
+            if (i == 2500) {
+                for (int j = 0; j < 5000; ++j) {
+                    builder.addKey(BSON("" << i), RecordId(loc++));
+                }
+            }
+        }
+        IndexStats stats = builder.done();
+
+        IndexBounds bounds;
+        bounds.fields.push_back(makePointOil("a", BSON("" << 2500)));
+        ASSERT_EQUALS(5001, stats.estimateKeys(bounds));
+
+        bounds.fields[0] = makePointOil("a", BSON("" << 100));
+        ASSERT_LESS_THAN(stats.estimateKeys(bounds), 10);
+    }
+
+    TEST(IndexStatsTest, NumbersOfDifferentTypesAreOneValue) {
+        IndexStatsBuilder builder(BSON("a" << 1), 10);
+        builder.addKey(BSON("" << 1), RecordId(1));
+        builder.addKey(BSON("" << 1.0), RecordId(2));
+        builder.addKey(BSON("" << 1LL), RecordId(3));
+        builder.addKey(BSON("" << "1"), RecordId(4));
+        IndexStats stats = builder.done();
+
+        ASSERT_EQUALS(4, stats.numKeys());
+        ASSERT_EQUALS(2, stats.numDistinct(0));
+    }
+
+    TEST(IndexStatsTest, LaterPointFieldsAreSelective) {
+        // {a: i % 10, b: i % 100} in index order
+        IndexStatsBuilder builder(BSON("a" << 1 << "b" << 1), 20);
+        for (int a = 0; a < 10; ++a) {
+            for (int i = 0; i < 1000; ++i) {
+                builder.addKey(BSON("" << a << "" << (i % 100)), RecordId(a * 1000 + i + 1));
+            }
+        }
+        IndexStats stats = builder.done();
+        assertWithin(100, stats.numDistinct(1), 0.05);
+
+        IndexBounds bounds;
+        bounds.fields.push_back(makePointOil("a", BSON("" << 3)));
+        bounds.fields.push_back(makePointOil("b", BSON("" << 7)));
+        assertWithin(10, stats.estimateKeys(bounds), 0.1);
+
+        // A range on the second field isn't used
+        bounds.fields[1] = makeOil("b", BSON("" << 0), BSON("" << 50));
+        ASSERT_EQUALS(1000, stats.estimateKeys(bounds));
+    }
+
+    TEST(IndexStatsTest, UnsupportedBounds) {
+        IndexStats stats = buildUniform(100, 10);
+
+        IndexBounds simple;
+        simple.isSimpleRange = true;
+        simple.startKey = BSON("" << 1);
+        simple.endKey = BSON("" << 10);
+        ASSERT_EQUALS(-1, stats.estimateKeys(simple));
+
+        // Bounds for a different key pattern
+        IndexBounds bounds;
+        bounds.fields.push_back(makePointOil("a", BSON("" << 1)));
+        bounds.fields.push_back(makePointOil("b", BSON("" << 1)));
+        ASSERT_EQUALS(-1, stats.estimateKeys(bounds));
+    }
+
+    TEST(IndexStatsTest, RoundTrip) {
+        IndexStats stats = buildUniform(10000, 30);
+
+        IndexStats parsed;
+        ASSERT_OK(IndexStats::parse(stats.toBSON(), &parsed));
+        ASSERT_EQUALS(stats.toBSON(), parsed.toBSON());
+        ASSERT_EQUALS(stats.numKeys(), parsed.numKeys());
+        ASSERT_EQUALS(10000, parsed.collectionRecords());
+        ASSERT_EQUALS(stats.numRecords(), parsed.numRecords());
+        ASSERT_EQUALS(stats.numDistinct(0), parsed.numDistinct(0));
+
+        IndexBounds bounds;
+        bounds.fields.push_back(makeOil("a", BSON("" << 1000), BSON("" << 3000), true, false));
+        ASSERT_EQUALS(stats.estimateKeys(bounds), parsed.estimateKeys(bounds));
+
+        ASSERT_NOT_OK(IndexStats::parse(BSON("version" << 2), &parsed));
+        ASSERT_NOT_OK(IndexStats::parse(fromjson("{version: 1, numKeys: 1}"), &parsed));
+    }
+
+} // namespace
@@ -0,0 +1,246 @@
+// expression_compiled.cpp
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/matcher/expression_compiled.h"
+
+#include <algorithm>
+
+#include "mongo/db/matcher/expression_leaf.h"
+
+namespace mongo {
+
+    namespace {
+
+        // Leaves whose matches() is matchesSingleElement() of the element at their path, when
+        // the path holds no arrays
+        bool isCompilableLeaf(const MatchExpression* expr) {
+            switch (expr->matchType()) {
+            case MatchExpression::LTE:
+            case MatchExpression::LT:
+            case MatchExpression::EQ:
+            case MatchExpression::GT:
+            case MatchExpression::GTE:
+            case MatchExpression::REGEX:
+            case MatchExpression::MOD:
+            case MatchExpression::EXISTS:
+            case MatchExpression::MATCH_IN:
+                return !expr->path().empty();
+            default:
+                return false;
+            }
+        }
+
+    } // namespace
+
+    CompiledMatchExpression::CompiledMatchExpression(const MatchExpression* expr)
+        : _expr(expr),
+          _numLeavesDone(0) {
+        _nodes.push_back(PathNode());
+
+        compile(expr);
+
+        _nodeSeen.resize(_nodes.size());
+    }
+
+    void CompiledMatchExpression::compile(const MatchExpression* expr) {
+        if (MatchExpression::AND == expr->matchType()) {
+            for (size_t i = 0; i < expr->numChildren(); ++i) {
+                compile(expr->getChild(i));
+            }
+            return;
+        }
+
+        if (isCompilableLeaf(expr)) {
+            addLeaf(static_cast<const LeafMatchExpression*>(expr));
+            return;
+        }
+
+        _residual.push_back(expr);
+    }
+
+    void CompiledMatchExpression::addLeaf(const LeafMatchExpression* leaf) {
+        const size_t leafIndex = _leaves.size();
+        _leaves.push_back(leaf);
+
+        size_t nodeIndex = 0;
+
+        StringData rest = leaf->path();
+        while (true) {
+            const size_t dot = rest.find('.');
+            const StringData part = (dot == std::string::npos) ? rest : rest.substr(0, dot);
+
+            size_t childIndex = 0;
+            const std::vector<size_t>& children = _nodes[nodeIndex].children;
+            for (size_t i = 0; i < children.size(); ++i) {
+                if (_nodes[children[i]].name == part) {
+                    childIndex = children[i];
+                    break;
+                }
+            }
+
+            if (0 == childIndex) {
+                PathNode child;
+                child.name = part;
+                childIndex = _nodes.size();
+                _nodes.push_back(child);
+                _nodes[nodeIndex].children.push_back(childIndex);
+            }
+
+            nodeIndex = childIndex;
+
+            if (dot == std::string::npos) {
+                break;
+            }
+            rest = rest.substr(dot + 1);
+        }
+
+        _nodes[nodeIndex].leaves.push_back(leafIndex);
+    }
+
+    const CompiledMatchExpression::PathNode*
+    CompiledMatchExpression::findChild(const PathNode& node, StringData name) const {
+        for (size_t i = 0; i < node.children.size(); ++i) {
+            const PathNode& child = _nodes[node.children[i]];
+            if (child.name == name) {
+                return &child;
+            }
+        }
+        return NULL;
+    }
+
+    bool CompiledMatchExpression::matchesBSON(const BSONObj& doc) const {
+        if (_leaves.empty()) {
+            return _expr->matchesBSON(doc);
+        }
+
+        std::fill(_nodeSeen.begin(), _nodeSeen.end(), 0);
+        _numLeavesDone = 0;
+
+        if (!matchesObject(_nodes[0], doc, doc)) {
+            return false;
+        }
+
+        if (_numLeavesDone < _leaves.size()) {
+            // The walk never reached these paths, so they are missing from the document.
+            const BSONElement missing;
+            for (size_t i = 1; i < _nodes.size(); ++i) {
+                if (_nodeSeen[i]) {
+                    continue;
+                }
+                const std::vector<size_t>& leaves = _nodes[i].leaves;
+                for (size_t j = 0; j < leaves.size(); ++j) {
+                    if (!_leaves[leaves[j]]->matchesSingleElement(missing)) {
+                        return false;
+                    }
+                }
+            }
+        }
+
+        for (size_t i = 0; i < _residual.size(); ++i) {
+            if (!_residual[i]->matchesBSON(doc)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    bool CompiledMatchExpression::matchesObject(const PathNode& node,
+                                                const BSONObj& obj,
+                                                const BSONObj& doc) const {
+        BSONObjIterator it(obj);
+        while (it.more()) {
+            const BSONElement elt = it.next();
+            const PathNode* child = findChild(node, elt.fieldNameStringData());
+            if (NULL == child) {
+                continue;
+            }
+
+            // Only the first field with a given name counts, as with BSONObj::getField().
+            const size_t childIndex = child - &_nodes[0];
+            if (_nodeSeen[childIndex]) {
+                continue;
+            }
+            _nodeSeen[childIndex] = 1;
+
+            if (!matchesElement(*child, elt, doc)) {
+                return false;
+            }
+
+            if (_numLeavesDone == _leaves.size()) {
+                break;
+            }
+        }
+        return true;
+    }
+
+    bool CompiledMatchExpression::matchesElement(const PathNode& node,
+                                                 const BSONElement& elt,
+                                                 const BSONObj& doc) const {
+        if (Array == elt.type()) {
+            return matchesInterpreted(node, doc);
+        }
+
+        for (size_t i = 0; i < node.leaves.size(); ++i) {
+            ++_numLeavesDone;
+            if (!_leaves[node.leaves[i]]->matchesSingleElement(elt)) {
+                return false;
+            }
+        }
+
+        // Paths continuing through anything but a subdocument are missing.
+        if (!node.children.empty() && Object == elt.type()) {
+            return matchesObject(node, elt.Obj(), doc);
+        }
+
+        return true;
+    }
+
+    bool CompiledMatchExpression::matchesInterpreted(const PathNode& node,
+                                                     const BSONObj& doc) const {
+        for (size_t i = 0; i < node.leaves.size(); ++i) {
+            ++_numLeavesDone;
+            if (!_leaves[node.leaves[i]]->matchesBSON(doc)) {
+                return false;
+            }
+        }
+
+        for (size_t i = 0; i < node.children.size(); ++i) {
+            _nodeSeen[node.children[i]] = 1;
+            if (!matchesInterpreted(_nodes[node.children[i]], doc)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+} // namespace mongo
@@ -0,0 +1,113 @@
+// expression_compiled.h
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/matcher/expression.h"
+
+namespace mongo {
+
+    class LeafMatchExpression;
+
+    /**
+     * A form of a MatchExpression tree which matches a BSON document in a single pass over it.
+     *
+     * The leaves under the top-level $and (or the root, if it is a leaf) which compare one field
+     * with a value are gathered, and their paths merged into a trie.  matchesBSON() walks the
+     * document once, descending only into subdocuments some path continues into, and evaluates
+     * each leaf on the element at its path as soon as that element is reached.  The first leaf
+     * which fails ends the walk, as does having evaluated every leaf.  Leaves whose path is
+     * missing are then evaluated against a missing element, as the interpreter would.
+     *
+     * Arrays on a path have subtle semantics, so the leaves below an array are handed to the
+     * interpreter.  So are the remaining parts of the tree ($or, $not, $elemMatch, $where, ...),
+     * once all compiled leaves have matched.  Match details are not supported.
+     *
+     * The expression must outlive this object.  matchesBSON() keeps scratch state in the
+     * object, so an instance must not be used by several threads at once.
+     */
+    class CompiledMatchExpression {
+        MONGO_DISALLOW_COPYING(CompiledMatchExpression);
+    public:
+        explicit CompiledMatchExpression(const MatchExpression* expr);
+
+        /**
+         * Same result as expr->matchesBSON(doc).
+         */
+        bool matchesBSON(const BSONObj& doc) const;
+
+        /**
+         * The number of leaves evaluated during the walk.  If zero, matchesBSON() simply runs
+         * the interpreter.
+         */
+        size_t numCompiledLeaves() const { return _leaves.size(); }
+
+    private:
+        struct PathNode {
+            StringData name;
+
+            // Indexes into _leaves of the leaves whose path ends here
+            std::vector<size_t> leaves;
+
+            // Indexes into _nodes
+            std::vector<size_t> children;
+        };
+
+        void compile(const MatchExpression* expr);
+
+        void addLeaf(const LeafMatchExpression* leaf);
+
+        const PathNode* findChild(const PathNode& node, StringData name) const;
+
+        bool matchesObject(const PathNode& node, const BSONObj& obj, const BSONObj& doc) const;
+
+        bool matchesElement(const PathNode& node, const BSONElement& elt,
+                            const BSONObj& doc) const;
+
+        bool matchesInterpreted(const PathNode& node, const BSONObj& doc) const;
+
+        const MatchExpression* _expr;
+
+        std::vector<const LeafMatchExpression*> _leaves;
+        std::vector<const MatchExpression*> _residual;
+
+        // _nodes[0] is the root, for the document itself
+        std::vector<PathNode> _nodes;
+
+        // Scratch space for matchesBSON()
+        mutable std::vector<char> _nodeSeen;
+        mutable size_t _numLeavesDone;
+    };
+
+} // namespace mongo
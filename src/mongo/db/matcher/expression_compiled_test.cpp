@@ -0,0 +1,267 @@
+// expression_compiled_test.cpp
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include <boost/scoped_ptr.hpp>
+#include <cstdlib>
+
+#include "mongo/config.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/matcher/expression_compiled.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/platform/random.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+    using boost::scoped_ptr;
+    using std::string;
+    using std::vector;
+
+    namespace {
+
+        MatchExpression* parse(const BSONObj& query) {
+            StatusWithMatchExpression result = MatchExpressionParser::parse(query);
+            ASSERT_OK(result.getStatus());
+            return result.getValue();
+        }
+
+        void assertSameAsInterpreter(const BSONObj& query, const BSONObj& doc) {
+            scoped_ptr<MatchExpression> expr(parse(query));
+            CompiledMatchExpression compiled(expr.get());
+            if (expr->matchesBSON(doc) != compiled.matchesBSON(doc)) {
+                FAIL(str::stream() << "query " << query << " on " << doc << ": interpreter says "
+                                   << expr->matchesBSON(doc));
+            }
+        }
+
+        //
+        // Random queries and documents over a few fields, likely to hit each other
+        //
+
+        const char* const kFields[] = {"a", "b", "c", "0"};
+        const char* const kPaths[] = {"a", "b", "c", "a.b", "a.c", "b.a", "a.b.c", "a.0", "c.0.a"};
+        const size_t kNumFields = sizeof(kFields) / sizeof(kFields[0]);
+        const size_t kNumPaths = sizeof(kPaths) / sizeof(kPaths[0]);
+
+        BSONObj randomDoc(PseudoRandom& rand, int depth);
+
+        void appendRandomValue(PseudoRandom& rand, int depth, StringData name, BSONObjBuilder* b) {
+            switch (std::abs(rand.nextInt32()) % (depth > 1 ? 7 : 9)) {
+            case 0: b->append(name, std::abs(rand.nextInt32()) % 4); break;
+            case 1: b->append(name, (std::abs(rand.nextInt32()) % 8) / 2.0); break;
+            case 2: b->append(name, (std::abs(rand.nextInt32()) % 2) ? "x" : "yz"); break;
+            case 3: b->appendNull(name); break;
+            case 4: b->append(name, (std::abs(rand.nextInt32()) % 2) == 0); break;
+            case 5: b->append(name, 2LL); break;
+            case 6: b->appendMinKey(name); break;
+            case 7: b->append(name, randomDoc(rand, depth + 1)); break;
+            default: {
+                BSONArrayBuilder arr(b->subarrayStart(name));
+                const int n = std::abs(rand.nextInt32()) % 3;
+                for (int i = 0; i < n; i++) {
+                    BSONObjBuilder elt;
+                    appendRandomValue(rand, depth + 1, "", &elt);
+                    arr.append(elt.obj().firstElement());
+                }
+                arr.doneFast();
+            }
+            }
+        }
+
+        BSONObj randomDoc(PseudoRandom& rand, int depth) {
+            BSONObjBuilder b;
+            const int n = std::abs(rand.nextInt32()) % 5;
+            for (int i = 0; i < n; i++) {
+                // Repeated field names are possible, on purpose
+                const char* field = kFields[std::abs(rand.nextInt32()) % kNumFields];
+                appendRandomValue(rand, depth, field, &b);
+            }
+            return b.obj();
+        }
+
+        void appendRandomPredicate(PseudoRandom& rand, BSONArrayBuilder* clauses) {
+            const char* path = kPaths[std::abs(rand.nextInt32()) % kNumPaths];
+
+            BSONObjBuilder valueBuilder;
+            appendRandomValue(rand, 2, "", &valueBuilder);
+            const BSONObj valueObj = valueBuilder.obj();
+            const BSONElement value = valueObj.firstElement();
+
+            BSONObjBuilder clause;
+            switch (std::abs(rand.nextInt32()) % 12) {
+            case 0: clause.appendAs(value, path); break;
+            case 1: clause.append(path, BSON("$lt" << value)); break;
+            case 2: clause.append(path, BSON("$lte" << value)); break;
+            case 3: clause.append(path, BSON("$gt" << value)); break;
+            case 4: clause.append(path, BSON("$gte" << value)); break;
+            case 5: clause.append(path, BSON("$in" << BSON_ARRAY(value << 1 << BSONNULL))); break;
+            case 6: clause.append(path, BSON("$exists" << (rand.nextInt32() % 2 == 0))); break;
+            case 7: clause.append(path, BSON("$mod" << BSON_ARRAY(2 << 0))); break;
+            case 8: clause.append(path, BSON("$regex" << "^y")); break;
+            case 9: clause.append(path, BSON("$ne" << value)); break;
+            case 10: clause.append(path, BSON("$size" << 1)); break;
+            default:
+                clause.append("$or", BSON_ARRAY(BSON(path << value) << BSON("b" << 1)));
+                break;
+            }
+            clauses->append(clause.obj());
+        }
+
+        BSONObj randomQuery(PseudoRandom& rand) {
+            BSONObjBuilder query;
+            BSONArrayBuilder clauses(query.subarrayStart("$and"));
+            const int n = 1 + std::abs(rand.nextInt32()) % 4;
+            for (int i = 0; i < n; i++) {
+                appendRandomPredicate(rand, &clauses);
+            }
+            clauses.doneFast();
+            return query.obj();
+        }
+
+    } // namespace
+
+    TEST(CompiledMatchExpressionTest, CompilesConjunctionsOfLeaves) {
+        scoped_ptr<MatchExpression> expr(parse(fromjson(
+            "{a: 1, 'b.c': {$gt: 2, $lt: 5}, d: {$in: [1, 2]}, e: {$exists: true}}")));
+        CompiledMatchExpression compiled(expr.get());
+        ASSERT_EQUALS(5U, compiled.numCompiledLeaves());
+
+        ASSERT(compiled.matchesBSON(fromjson("{a: 1, b: {c: 3}, d: 2, e: null}")));
+        ASSERT_FALSE(compiled.matchesBSON(fromjson("{a: 1, b: {c: 5}, d: 2, e: null}")));
+        ASSERT_FALSE(compiled.matchesBSON(fromjson("{a: 1, b: {c: 3}, d: 2}")));
+        ASSERT_FALSE(compiled.matchesBSON(fromjson("{a: 1, b: 3, d: 2, e: 1}")));
+    }
+
+    TEST(CompiledMatchExpressionTest, LeavesOthersToInterpreter) {
+        scoped_ptr<MatchExpression> expr(parse(fromjson("{$or: [{a: 1}, {b: 1}]}")));
+        CompiledMatchExpression compiled(expr.get());
+        ASSERT_EQUALS(0U, compiled.numCompiledLeaves());
+        ASSERT(compiled.matchesBSON(fromjson("{b: 1}")));
+
+        scoped_ptr<MatchExpression> mixed(parse(fromjson("{a: 1, b: {$not: {$gt: 1}}}")));
+        CompiledMatchExpression compiledMixed(mixed.get());
+        ASSERT_EQUALS(1U, compiledMixed.numCompiledLeaves());
+        ASSERT(compiledMixed.matchesBSON(fromjson("{a: 1, b: 0}")));
+        ASSERT_FALSE(compiledMixed.matchesBSON(fromjson("{a: 1, b: 2}")));
+    }
+
+    TEST(CompiledMatchExpressionTest, MissingAndNull) {
+        assertSameAsInterpreter(fromjson("{a: null}"), fromjson("{}"));
+        assertSameAsInterpreter(fromjson("{'a.b': null}"), fromjson("{a: 1}"));
+        assertSameAsInterpreter(fromjson("{'a.b': {$exists: false}}"), fromjson("{a: {c: 1}}"));
+        assertSameAsInterpreter(fromjson("{'a.b': {$exists: true}}"), fromjson("{a: {b: null}}"));
+    }
+
+    TEST(CompiledMatchExpressionTest, Arrays) {
+        assertSameAsInterpreter(fromjson("{a: 2}"), fromjson("{a: [1, 2]}"));
+        assertSameAsInterpreter(fromjson("{a: [1, 2]}"), fromjson("{a: [1, 2]}"));
+        assertSameAsInterpreter(fromjson("{'a.b': 2, c: 1}"),
+                                fromjson("{a: [{b: 1}, {b: 2}], c: 1}"));
+        assertSameAsInterpreter(fromjson("{'a.0': 1}"), fromjson("{a: [1, 2]}"));
+        assertSameAsInterpreter(fromjson("{'a.0': 1}"), fromjson("{a: {'0': 1}}"));
+    }
+
+    TEST(CompiledMatchExpressionTest, RepeatedFieldNames) {
+        // Only the first 'a' counts
+        BSONObj doc = BSON("a" << 1 << "a" << 2);
+        assertSameAsInterpreter(BSON("a" << 2), doc);
+        assertSameAsInterpreter(BSON("a" << 1), doc);
+
+        BSONObj nested = BSON("a" << 1 << "a" << BSON("b" << 1));
+        assertSameAsInterpreter(BSON("a.b" << 1), nested);
+    }
+
+    TEST(CompiledMatchExpressionTest, RandomQueriesMatchInterpreter) {
+        PseudoRandom rand(20150601);
+        for (int i = 0; i < 20000; i++) {
+            const BSONObj query = randomQuery(rand);
+            scoped_ptr<MatchExpression> expr(parse(query));
+            CompiledMatchExpression compiled(expr.get());
+
+            for (int j = 0; j < 10; j++) {
+                const BSONObj doc = randomDoc(rand, 0);
+                if (expr->matchesBSON(doc) != compiled.matchesBSON(doc)) {
+                    FAIL(str::stream() << "query " << query << " on " << doc
+                                       << ": interpreter says " << expr->matchesBSON(doc));
+                }
+            }
+        }
+    }
+
+#ifndef MONGO_CONFIG_DEBUG_BUILD
+    TEST(CompiledMatchExpressionTest, PerformanceManyPredicates) {
+        const int numDocs = 100 * 1000;
+
+        // Ten predicates over a wide document, all of which match
+        BSONObjBuilder queryBuilder;
+        BSONObjBuilder docBuilder;
+        for (int i = 0; i < 30; i++) {
+            const string field = str::stream() << "f" << i;
+            if (i % 3 == 2) {
+                queryBuilder.append(field, BSON("$gte" << i));
+            }
+            docBuilder.append(field, i);
+        }
+        docBuilder.append("sub", BSON("x" << 1 << "y" << "abc"));
+        const BSONObj query = queryBuilder.obj();
+        const BSONObj doc = docBuilder.obj();
+
+        scoped_ptr<MatchExpression> expr(parse(query));
+        CompiledMatchExpression compiled(expr.get());
+        ASSERT_EQUALS(10U, compiled.numCompiledLeaves());
+
+        int matched = 0;
+        {
+            Timer t;
+            for (int i = 0; i < numDocs; i++) {
+                matched += expr->matchesBSON(doc);
+            }
+            log() << "interpreted: " << numDocs << " docs took " << t.millis() << " ms";
+        }
+        {
+            Timer t;
+            for (int i = 0; i < numDocs; i++) {
+                matched -= compiled.matchesBSON(doc);
+            }
+            log() << "compiled: " << numDocs << " docs took " << t.millis() << " ms";
+        }
+        ASSERT_EQUALS(0, matched);
+    }
+#endif
+
+} // namespace mongo
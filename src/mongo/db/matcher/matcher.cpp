@@ -51,12 +51,16 @@ namespace mongo {
                  result.isOK() );
 
         _expression.reset( result.getValue() );
+        _compiled.reset( new CompiledMatchExpression( _expression.get() ) );
     }
 
     bool Matcher::matches(const BSONObj& doc, MatchDetails* details ) const {
         if ( !_expression )
             return true;
 
+        if ( !details )
+            return _compiled->matchesBSON( doc );
+
         return _expression->matchesBSON( doc, details );
     }
 
@@ -36,6 +36,7 @@
 #include "mongo/base/status.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/db/matcher/expression.h"
+#include "mongo/db/matcher/expression_compiled.h"
 #include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/matcher/match_details.h"
 
@@ -44,6 +45,7 @@ namespace mongo {
 
     /**
      * Matcher is a simple wrapper around a BSONObj and the MatchExpression created from it.
+     * Matches which don't ask for details use the compiled form of the expression.
      */
     class Matcher {
         MONGO_DISALLOW_COPYING(Matcher);
@@ -63,6 +65,7 @@ namespace mongo {
         BSONObj _pattern;
 
         boost::scoped_ptr<MatchExpression> _expression;
+        boost::scoped_ptr<CompiledMatchExpression> _compiled;
     };
 
 }  // namespace mongo
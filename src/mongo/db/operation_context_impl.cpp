@@ -34,7 +34,9 @@
 
 #include <memory>
 
+#include "mongo/base/counter.h"
 #include "mongo/db/client.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/concurrency/lock_state.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/service_context.h"
@@ -49,11 +51,37 @@
 namespace mongo {
 
 namespace {
+
+    // Per-client object allocation statistics. Comparing these against the number of operation
+    // contexts shows how many allocations each operation incurs for its locker and recovery unit.
+    Counter64 operationContextsCreated;
+    Counter64 lockersAllocated;
+    Counter64 recoveryUnitsAllocated;
+    Counter64 recoveryUnitsReused;
+
+    ServerStatusMetricField<Counter64> displayOperationContextsCreated(
+                                                    "operation.contexts.created",
+                                                    &operationContextsCreated );
+    ServerStatusMetricField<Counter64> displayLockersAllocated(
+                                                    "operation.contexts.lockersAllocated",
+                                                    &lockersAllocated );
+    ServerStatusMetricField<Counter64> displayRecoveryUnitsAllocated(
+                                                    "operation.contexts.recoveryUnitsAllocated",
+                                                    &recoveryUnitsAllocated );
+    ServerStatusMetricField<Counter64> displayRecoveryUnitsReused(
+                                                    "operation.contexts.recoveryUnitsReused",
+                                                    &recoveryUnitsReused );
+
     std::unique_ptr<Locker> newLocker() {
+        lockersAllocated.increment();
         if (isMMAPV1()) return stdx::make_unique<MMAPV1LockerImpl>();
         return stdx::make_unique<DefaultLockerImpl>();
     }
 
+    /**
+     * Objects which are kept on the Client across operations, so that consecutive operations on
+     * the same connection do not need to allocate them again.
+     */
     class ClientOperationInfo {
     public:
         Locker* getLocker() {
@@ -63,8 +91,34 @@ namespace {
             return _locker.get();
         }
 
+        /**
+         * Returns the recovery unit left over by a previous operation on this client, or a new
+         * one from the storage engine if there is none. The caller takes ownership.
+         */
+        RecoveryUnit* takeRecoveryUnit() {
+            if (_recoveryUnit) {
+                recoveryUnitsReused.increment();
+                return _recoveryUnit.release();
+            }
+
+            recoveryUnitsAllocated.increment();
+            return getGlobalServiceContext()->getGlobalStorageEngine()->newRecoveryUnit();
+        }
+
+        /**
+         * Takes ownership of a finished operation's recovery unit and keeps it for the next
+         * operation, if the storage engine allows reusing it.
+         */
+        void returnRecoveryUnit(RecoveryUnit* unit) {
+            std::unique_ptr<RecoveryUnit> owned(unit);
+            if (!_recoveryUnit && unit->prepareForReuse()) {
+                _recoveryUnit = std::move(owned);
+            }
+        }
+
     private:
         std::unique_ptr<Locker> _locker;
+        std::unique_ptr<RecoveryUnit> _recoveryUnit;
     };
 
     const auto clientOperationInfoDecoration = Client::declareDecoration<ClientOperationInfo>();
@@ -79,14 +133,19 @@ namespace {
 
         invariant(_locker);
 
-        StorageEngine* storageEngine = getGlobalServiceContext()->getGlobalStorageEngine();
-        _recovery.reset(storageEngine->newRecoveryUnit());
+        operationContextsCreated.increment();
+        _recovery.reset(clientOperationInfoDecoration(_client).takeRecoveryUnit());
 
         _client->setOperationContext(this);
     }
 
     OperationContextImpl::~OperationContextImpl() {
         _locker->assertEmptyAndReset();
+
+        if (_recovery.get()) {
+            clientOperationInfoDecoration(_client).returnRecoveryUnit(_recovery.release());
+        }
+
         _client->resetOperationContext();
     }
 
@@ -356,6 +356,11 @@ namespace mongo {
                 bob->append("indexBounds", spec->indexBounds);
             }
 
+            // The estimate from the index statistics, to compare against keysExamined
+            if (spec->keysEstimated >= 0) {
+                bob->appendNumber("keysEstimated", spec->keysEstimated);
+            }
+
             if (verbosity >= ExplainCommon::EXEC_STATS) {
                 bob->appendNumber("keysExamined", spec->keysExamined);
                 bob->appendNumber("dupsTested", spec->dupsTested);
@@ -58,6 +58,7 @@
 #include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/plan_estimator.h"
 #include "mongo/db/query/plan_executor.h"
 #include "mongo/db/query/planner_access.h"
 #include "mongo/db/query/planner_analysis.h"
@@ -151,6 +152,13 @@ namespace mongo {
                                                         desc->unique(),
                                                         desc->indexName(),
                                                         desc->infoObj()));
+
+            // Statistics aren't maintained by writes, so stop trusting them once the collection
+            // has changed a lot since the last analyze
+            boost::shared_ptr<const IndexStats> stats = ice->getStats();
+            if (stats && !PlanEstimator::isStale(*stats, collection->numRecords(txn))) {
+                plannerParams->indices.back().stats = stats;
+            }
         }
 
         // If query supports index filters, filter params.indices by indices in query settings.
@@ -319,6 +327,8 @@ namespace mongo {
                                                             &qs, &backupQs);
 
                 if (status.isOK()) {
+                    PlanEstimator::annotate(plannerParams, qs->root.get());
+
                     PlanStage *backupRoot = NULL;
                     // The working set is shared by the root and backupRoot plans.
                     verify(StageBuilder::build(opCtx, collection, *qs, ws, rootOut));
@@ -391,6 +401,9 @@ namespace mongo {
                 }
             }
 
+            // Don't bother racing plans the index statistics say are far worse than another
+            PlanEstimator::prune(plannerParams, &solutions);
+
             if (1 == solutions.size()) {
                 // Only one possible plan.  Run it.  Build the stages from the solution.
                 verify(StageBuilder::build(opCtx, collection, *solutions[0], ws, rootOut));
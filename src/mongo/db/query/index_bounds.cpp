@@ -307,6 +307,45 @@ namespace mongo {
         return true;
     }
 
+    bool IndexBoundsChecker::getContiguousRun(vector<BSONElement>* prefix,
+                                              const Interval** interval) const {
+        prefix->clear();
+        *interval = NULL;
+
+        size_t i = 0;
+        for (; i < _curInterval.size(); ++i) {
+            const Interval& ival = _bounds->fields[i].intervals[_curInterval[i]];
+            if (!ival.isPoint()) {
+                break;
+            }
+            prefix->push_back(ival.start);
+        }
+
+        if (i == _curInterval.size()) {
+            return true;
+        }
+
+        *interval = &_bounds->fields[i].intervals[_curInterval[i]];
+
+        // The remaining fields must not constrain the key, or the keys within the current
+        // intervals are interleaved with keys outside of them.
+        for (++i; i < _curInterval.size(); ++i) {
+            const Interval& ival = _bounds->fields[i].intervals[_curInterval[i]];
+            if (!ival.startInclusive || !ival.endInclusive) {
+                return false;
+            }
+
+            const BSONType startType = ival.start.type();
+            const BSONType endType = ival.end.type();
+            if (!(startType == MinKey && endType == MaxKey)
+                    && !(startType == MaxKey && endType == MinKey)) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
     bool IndexBoundsChecker::findLeftmostProblem(const vector<BSONElement>& keyValues,
                                                   size_t* where,
                                                   Location* what) {
@@ -190,6 +190,19 @@ namespace mongo {
         KeyState checkKey(const BSONObj& key, int* keyEltsToUse, bool* movePastKeyElts,
                           std::vector<const BSONElement*>* out, std::vector<bool>* incOut);
 
+        /**
+         * Describes the keys which lie within the intervals that the key last passed to checkKey()
+         * was found in, if they are contiguous in the index.  Only meaningful after checkKey()
+         * returned VALID; checkKey() returns VALID for all of these keys without moving on.
+         *
+         * The keys are contiguous if they start with fields whose current interval is a point,
+         * followed by at most one field with any other interval, followed by fields whose current
+         * interval holds all values.  In that case 'prefix' is filled with the point values and
+         * 'interval' is set to the interval of the next field, or NULL if all fields are points.
+         * Returns false otherwise.
+         */
+        bool getContiguousRun(std::vector<BSONElement>* prefix, const Interval** interval) const;
+
         /**
          * Relative position of a key to an interval.
          * Exposed for testing only.
@@ -340,6 +340,55 @@ namespace {
         ASSERT(movePastKeyElts);
     }
 
+    TEST(IndexBoundsCheckerTest, ContiguousRun) {
+        OrderedIntervalList fooList("foo");
+        fooList.intervals.push_back(Interval(BSON("" << 1 << "" << 1), true, true));
+        fooList.intervals.push_back(Interval(BSON("" << 5 << "" << 5), true, true));
+
+        OrderedIntervalList barList("bar");
+        barList.intervals.push_back(Interval(BSON("" << 3 << "" << 8), true, false));
+
+        OrderedIntervalList bazList("baz");
+        BSONObjBuilder allValues;
+        allValues.appendMinKey("");
+        allValues.appendMaxKey("");
+        bazList.intervals.push_back(Interval(allValues.obj(), true, true));
+
+        IndexBounds bounds;
+        bounds.fields.push_back(fooList);
+        bounds.fields.push_back(barList);
+        bounds.fields.push_back(bazList);
+        IndexBoundsChecker it(&bounds, BSON("foo" << 1 << "bar" << 1 << "baz" << 1), 1);
+
+        int keyEltsToUse;
+        bool movePastKeyElts;
+        vector<const BSONElement*> elt(3);
+        vector<bool> inc(3);
+
+        ASSERT_EQUALS(IndexBoundsChecker::VALID,
+                      it.checkKey(BSON("" << 5 << "" << 3 << "" << "x"),
+                                  &keyEltsToUse, &movePastKeyElts, &elt, &inc));
+
+        // {foo: 5, bar: [3, 8)} with any baz
+        vector<BSONElement> prefix;
+        const Interval* interval;
+        ASSERT(it.getContiguousRun(&prefix, &interval));
+        ASSERT_EQUALS(1U, prefix.size());
+        ASSERT_EQUALS(5, prefix[0].numberInt());
+        ASSERT(interval == &bounds.fields[1].intervals[0]);
+
+        // Once 'baz' is constrained, keys with other values of 'baz' are interleaved.
+        bounds.fields[2].intervals[0] = Interval(BSON("" << "a" << "" << "z"), true, true);
+        ASSERT_FALSE(it.getContiguousRun(&prefix, &interval));
+
+        // If every field is a point the run is a single key.
+        bounds.fields[1].intervals[0] = Interval(BSON("" << 3 << "" << 3), true, true);
+        bounds.fields[2].intervals[0] = Interval(BSON("" << "x" << "" << "x"), true, true);
+        ASSERT(it.getContiguousRun(&prefix, &interval));
+        ASSERT_EQUALS(3U, prefix.size());
+        ASSERT(NULL == interval);
+    }
+
     TEST(IndexBoundsCheckerTest, MoveIntervalForwardToNextInterval) {
         OrderedIntervalList fooList("foo");
         fooList.intervals.push_back(Interval(BSON("" << 7 << "" << 20), true, true));
@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <boost/shared_ptr.hpp>
 #include <string>
 
 #include "mongo/db/index_names.h"
@@ -36,6 +37,8 @@
 
 namespace mongo {
 
+    class IndexStats;
+
     /**
      * This name sucks, but every name involving 'index' is used somewhere.
      */
@@ -110,6 +113,10 @@ namespace mongo {
         // by the keyPattern?)
         IndexType type;
 
+        // Statistics from the last analyze of the index, if any.  Used to estimate how many keys
+        // a scan of the index will examine.
+        boost::shared_ptr<const IndexStats> stats;
+
         std::string toString() const {
             mongoutils::str::stream ss;
             ss << "kp: "  << keyPattern.toString();
@@ -0,0 +1,141 @@
+// plan_estimator.cpp
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/plan_estimator.h"
+
+#include "mongo/db/index/index_stats.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+
+    namespace {
+
+        // Plans this cheap are always worth racing, however they compare to the others
+        const long long kMinPrunedKeys = 100;
+
+        const IndexStats* findStats(const QueryPlannerParams& params, const BSONObj& keyPattern) {
+            for (size_t i = 0; i < params.indices.size(); ++i) {
+                const IndexEntry& entry = params.indices[i];
+                if (0 == entry.keyPattern.woCompare(keyPattern)) {
+                    return entry.stats.get();
+                }
+            }
+            return NULL;
+        }
+
+    }  // namespace
+
+    // static
+    long long PlanEstimator::annotate(const QueryPlannerParams& params, QuerySolutionNode* root) {
+        if (STAGE_IXSCAN == root->getType()) {
+            IndexScanNode* ixn = static_cast<IndexScanNode*>(root);
+            const IndexStats* stats = findStats(params, ixn->indexKeyPattern);
+            ixn->estimatedKeys = stats ? stats->estimateKeys(ixn->bounds) : -1;
+            return ixn->estimatedKeys;
+        }
+
+        if (root->children.empty()) {
+            // A collection scan, or an index scan we have no statistics for
+            return -1;
+        }
+
+        // Every index scan below an AND, OR or merge sort is run, so their costs add up
+        long long total = 0;
+        for (size_t i = 0; i < root->children.size(); ++i) {
+            long long childKeys = annotate(params, root->children[i]);
+            if (childKeys < 0 || total < 0) {
+                total = -1;
+            }
+            else {
+                total += childKeys;
+            }
+        }
+        return total;
+    }
+
+    // static
+    void PlanEstimator::prune(const QueryPlannerParams& params,
+                              std::vector<QuerySolution*>* solutions) {
+        std::vector<long long> costs;
+        for (size_t i = 0; i < solutions->size(); ++i) {
+            costs.push_back(annotate(params, (*solutions)[i]->root.get()));
+        }
+
+        const double ratio = internalQueryPlannerStatsPruneRatio;
+        if (ratio <= 0 || solutions->size() < 2) {
+            return;
+        }
+
+        std::vector<bool> pruned(solutions->size(), false);
+        for (size_t i = 0; i < solutions->size(); ++i) {
+            if (costs[i] < kMinPrunedKeys) {
+                continue;
+            }
+
+            for (size_t j = 0; j < solutions->size(); ++j) {
+                if (i == j || costs[j] < 0 || pruned[j]) {
+                    continue;
+                }
+                if ((*solutions)[j]->hasBlockingStage && !(*solutions)[i]->hasBlockingStage) {
+                    continue;
+                }
+                if (costs[i] > ratio * costs[j]) {
+                    pruned[i] = true;
+                    break;
+                }
+            }
+        }
+
+        std::vector<QuerySolution*> kept;
+        for (size_t i = 0; i < solutions->size(); ++i) {
+            if (pruned[i]) {
+                LOG(2) << "Not racing candidate plan estimated to examine " << costs[i]
+                       << " keys:\n" << (*solutions)[i]->toString();
+                delete (*solutions)[i];
+            }
+            else {
+                kept.push_back((*solutions)[i]);
+            }
+        }
+        solutions->swap(kept);
+    }
+
+    // static
+    bool PlanEstimator::isStale(const IndexStats& stats, long long numRecords) {
+        const long long then = stats.collectionRecords();
+        const long long drift = numRecords > then ? numRecords - then : then - numRecords;
+        return drift > internalQueryPlannerStatsMaxDrift * std::max(then, 1LL);
+    }
+
+}  // namespace mongo
@@ -0,0 +1,71 @@
+// plan_estimator.h
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/db/query/query_planner_params.h"
+#include "mongo/db/query/query_solution.h"
+
+namespace mongo {
+
+    /**
+     * Uses the index statistics gathered by the analyze command to estimate the cost of query
+     * solutions before they are run.  The cost of a solution is the number of index keys it
+     * examines, summed over all of its index scans.
+     */
+    class PlanEstimator {
+    public:
+        /**
+         * Sets IndexScanNode::estimatedKeys on each index scan in the tree rooted at 'root' whose
+         * index has statistics in 'params', and returns the estimated cost of the tree.  Returns
+         * -1 if any leaf of the tree can't be estimated, such as a collection scan.
+         */
+        static long long annotate(const QueryPlannerParams& params, QuerySolutionNode* root);
+
+        /**
+         * Annotates each of 'solutions', then deletes and removes the solutions whose cost is
+         * more than internalQueryPlannerStatsPruneRatio times that of another solution, so that
+         * they are not raced.  A solution without a blocking stage is never pruned in favor of
+         * one with a blocking stage, as it may not have to run to completion.  At least one
+         * solution is always left.
+         */
+        static void prune(const QueryPlannerParams& params,
+                          std::vector<QuerySolution*>* solutions);
+
+        /**
+         * Returns true if 'stats' should not be used because the collection, which now has
+         * 'numRecords' documents, has changed size by more than
+         * internalQueryPlannerStatsMaxDrift since they were gathered.
+         */
+        static bool isStale(const IndexStats& stats, long long numRecords);
+    };
+
+}  // namespace mongo
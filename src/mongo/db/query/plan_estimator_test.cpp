@@ -0,0 +1,232 @@
+// plan_estimator_test.cpp
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <boost/make_shared.hpp>
+
+#include "mongo/db/index/index_stats.h"
+#include "mongo/db/query/plan_estimator.h"
+#include "mongo/db/query/query_knobs.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+    using namespace mongo;
+
+    // Builds statistics for 'keyPattern' over the single-field keys 0 .. n-1.
+    boost::shared_ptr<const IndexStats> buildStats(const BSONObj& keyPattern, int n) {
+        IndexStatsBuilder builder(keyPattern, IndexStats::kDefaultMaxBuckets);
+        for (int i = 0; i < n; ++i) {
+            builder.addKey(BSON("" << i), RecordId(i + 1));
+        }
+        return boost::make_shared<const IndexStats>(builder.done());
+    }
+
+    QueryPlannerParams makeParams() {
+        QueryPlannerParams params;
+        params.indices.push_back(IndexEntry(BSON("a" << 1)));
+        params.indices.back().stats = buildStats(BSON("a" << 1), 10000);
+        params.indices.push_back(IndexEntry(BSON("b" << 1)));
+        params.indices.back().stats = buildStats(BSON("b" << 1), 10000);
+        // No statistics for {c: 1}
+        params.indices.push_back(IndexEntry(BSON("c" << 1)));
+        return params;
+    }
+
+    // A scan of the keys in [start, end] of the index 'field'.
+    IndexScanNode* makeScan(const std::string& field, int start, int end) {
+        IndexScanNode* ixn = new IndexScanNode();
+        ixn->indexKeyPattern = BSON(field << 1);
+        OrderedIntervalList oil(field);
+        oil.intervals.push_back(Interval(BSON("" << start << "" << end), true, true));
+        ixn->bounds.fields.push_back(oil);
+        return ixn;
+    }
+
+    QuerySolution* makeSolution(QuerySolutionNode* leaf, bool hasBlockingStage = false) {
+        FetchNode* fetch = new FetchNode();
+        fetch->children.push_back(leaf);
+
+        QuerySolution* soln = new QuerySolution();
+        soln->root.reset(fetch);
+        soln->hasBlockingStage = hasBlockingStage;
+        return soln;
+    }
+
+    // Sets internalQueryPlannerStatsPruneRatio, which is off by default, for the life of the
+    // object.
+    class ScopedPruneRatio {
+    public:
+        explicit ScopedPruneRatio(double ratio) : _oldRatio(internalQueryPlannerStatsPruneRatio) {
+            internalQueryPlannerStatsPruneRatio = ratio;
+        }
+
+        ~ScopedPruneRatio() {
+            internalQueryPlannerStatsPruneRatio = _oldRatio;
+        }
+
+    private:
+        const double _oldRatio;
+    };
+
+    void deleteAll(std::vector<QuerySolution*>* solutions) {
+        for (size_t i = 0; i < solutions->size(); ++i) {
+            delete (*solutions)[i];
+        }
+        solutions->clear();
+    }
+
+    TEST(PlanEstimatorTest, AnnotateIndexScans) {
+        QueryPlannerParams params = makeParams();
+
+        IndexScanNode* ixn = makeScan("a", 0, 99);
+        boost::scoped_ptr<QuerySolution> soln(makeSolution(ixn));
+        long long cost = PlanEstimator::annotate(params, soln->root.get());
+        ASSERT_EQUALS(cost, ixn->estimatedKeys);
+        ASSERT_GREATER_THAN(cost, 50);
+        ASSERT_LESS_THAN(cost, 200);
+
+        // Without statistics there is no estimate
+        IndexScanNode* unknown = makeScan("c", 0, 99);
+        boost::scoped_ptr<QuerySolution> unknownSoln(makeSolution(unknown));
+        ASSERT_EQUALS(-1, PlanEstimator::annotate(params, unknownSoln->root.get()));
+        ASSERT_EQUALS(-1, unknown->estimatedKeys);
+    }
+
+    TEST(PlanEstimatorTest, AnnotateAddsUpChildren) {
+        QueryPlannerParams params = makeParams();
+
+        AndHashNode* andNode = new AndHashNode();
+        andNode->children.push_back(makeScan("a", 0, 99));
+        andNode->children.push_back(makeScan("b", 0, 999));
+        boost::scoped_ptr<QuerySolution> soln(makeSolution(andNode));
+        long long cost = PlanEstimator::annotate(params, soln->root.get());
+        ASSERT_GREATER_THAN(cost, 1000);
+        ASSERT_LESS_THAN(cost, 1300);
+
+        // One child we can't estimate makes the whole tree unknown, but the others are still
+        // annotated
+        IndexScanNode* known = makeScan("a", 0, 99);
+        AndHashNode* mixed = new AndHashNode();
+        mixed->children.push_back(makeScan("c", 0, 99));
+        mixed->children.push_back(known);
+        boost::scoped_ptr<QuerySolution> mixedSoln(makeSolution(mixed));
+        ASSERT_EQUALS(-1, PlanEstimator::annotate(params, mixedSoln->root.get()));
+        ASSERT_GREATER_THAN(known->estimatedKeys, 0);
+
+        CollectionScanNode* collScan = new CollectionScanNode();
+        boost::scoped_ptr<QuerySolution> collScanSoln(makeSolution(collScan));
+        ASSERT_EQUALS(-1, PlanEstimator::annotate(params, collScanSoln->root.get()));
+    }
+
+    TEST(PlanEstimatorTest, PruneExpensivePlans) {
+        ScopedPruneRatio pruneRatio(10);
+        QueryPlannerParams params = makeParams();
+
+        std::vector<QuerySolution*> solutions;
+        solutions.push_back(makeSolution(makeScan("a", 0, 4999)));
+        solutions.push_back(makeSolution(makeScan("b", 0, 99)));
+        solutions.push_back(makeSolution(makeScan("c", 0, 9999)));
+        QuerySolution* cheapest = solutions[1];
+        QuerySolution* unknown = solutions[2];
+
+        PlanEstimator::prune(params, &solutions);
+
+        // The plan without an estimate has to be raced
+        ASSERT_EQUALS(2U, solutions.size());
+        ASSERT_EQUALS(cheapest, solutions[0]);
+        ASSERT_EQUALS(unknown, solutions[1]);
+        deleteAll(&solutions);
+    }
+
+    TEST(PlanEstimatorTest, PruneKeepsPlansWithoutBlockingStages) {
+        ScopedPruneRatio pruneRatio(10);
+        QueryPlannerParams params = makeParams();
+
+        // The cheaper plan has to sort, while the other may be able to stop early
+        std::vector<QuerySolution*> solutions;
+        solutions.push_back(makeSolution(makeScan("a", 0, 4999)));
+        solutions.push_back(makeSolution(makeScan("b", 0, 99), true));
+
+        PlanEstimator::prune(params, &solutions);
+        ASSERT_EQUALS(2U, solutions.size());
+
+        // But if both sort, the expensive one goes
+        solutions[0]->hasBlockingStage = true;
+        PlanEstimator::prune(params, &solutions);
+        ASSERT_EQUALS(1U, solutions.size());
+        ASSERT_TRUE(solutions[0]->hasBlockingStage);
+        deleteAll(&solutions);
+    }
+
+    TEST(PlanEstimatorTest, PruneNeverLeavesFewerThanOnePlan) {
+        ScopedPruneRatio pruneRatio(10);
+        QueryPlannerParams params = makeParams();
+
+        std::vector<QuerySolution*> solutions;
+        solutions.push_back(makeSolution(makeScan("a", 0, 9999)));
+        solutions.push_back(makeSolution(makeScan("b", 0, 9999)));
+        PlanEstimator::prune(params, &solutions);
+        ASSERT_EQUALS(2U, solutions.size());
+        deleteAll(&solutions);
+    }
+
+    TEST(PlanEstimatorTest, PruneCanBeDisabled) {
+        ScopedPruneRatio pruneRatio(0);
+        QueryPlannerParams params = makeParams();
+
+        std::vector<QuerySolution*> solutions;
+        solutions.push_back(makeSolution(makeScan("a", 0, 4999)));
+        solutions.push_back(makeSolution(makeScan("b", 0, 99)));
+        PlanEstimator::prune(params, &solutions);
+        ASSERT_EQUALS(2U, solutions.size());
+
+        // The plans are still annotated for explain
+        FetchNode* fetch = static_cast<FetchNode*>(solutions[0]->root.get());
+        ASSERT_GREATER_THAN(static_cast<IndexScanNode*>(fetch->children[0])->estimatedKeys, 0);
+
+        deleteAll(&solutions);
+    }
+
+    TEST(PlanEstimatorTest, StatsGoStaleAsTheCollectionChanges) {
+        IndexStatsBuilder builder(BSON("a" << 1), IndexStats::kDefaultMaxBuckets);
+        builder.setCollectionRecords(1000);
+        const IndexStats stats = builder.done();
+
+        ASSERT_FALSE(PlanEstimator::isStale(stats, 1000));
+        ASSERT_FALSE(PlanEstimator::isStale(stats, 1100));
+        ASSERT_FALSE(PlanEstimator::isStale(stats, 900));
+        ASSERT_TRUE(PlanEstimator::isStale(stats, 1500));
+        ASSERT_TRUE(PlanEstimator::isStale(stats, 500));
+
+        // Emptying the collection makes them stale too
+        ASSERT_TRUE(PlanEstimator::isStale(stats, 0));
+    }
+
+}  // namespace
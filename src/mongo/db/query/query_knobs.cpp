@@ -62,6 +62,11 @@ namespace mongo {
 
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryMaxScansToExplode, int, 200);
 
+    // Off by default: statistics are local to each node, and only refreshed by analyze.
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerStatsPruneRatio, double, 0.0);
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerStatsMaxDrift, double, 0.2);
+
     MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecMaxBlockingSortBytes, int, 32 * 1024 * 1024);
 
     // Yield every 128 cycles or 10ms.
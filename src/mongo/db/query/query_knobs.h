@@ -92,6 +92,14 @@ namespace mongo {
     // during explodeForSort?
     extern int internalQueryMaxScansToExplode;
 
+    // Candidate plans which index statistics say will examine this many times more keys than
+    // another candidate are not raced.  Zero or less disables pruning.
+    extern double internalQueryPlannerStatsPruneRatio;
+
+    // Index statistics are ignored once the collection's document count has changed by more
+    // than this fraction since they were gathered.
+    extern double internalQueryPlannerStatsMaxDrift;
+
     //
     // Query execution.
     //
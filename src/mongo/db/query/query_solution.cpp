@@ -397,7 +397,11 @@ namespace mongo {
     //
 
     IndexScanNode::IndexScanNode()
-        : indexIsMultiKey(false), direction(1), maxScan(0), addKeyMetadata(false) { }
+        : indexIsMultiKey(false),
+          direction(1),
+          maxScan(0),
+          addKeyMetadata(false),
+          estimatedKeys(-1) { }
 
     void IndexScanNode::appendToString(mongoutils::str::stream* ss, int indent) const {
         addIndent(ss, indent);
@@ -412,6 +416,10 @@ namespace mongo {
         *ss << "direction = " << direction << '\n';
         addIndent(ss, indent + 1);
         *ss << "bounds = " << bounds.toString() << '\n';
+        if (estimatedKeys >= 0) {
+            addIndent(ss, indent + 1);
+            *ss << "estimatedKeys = " << estimatedKeys << '\n';
+        }
         addCommon(ss, indent);
     }
 
@@ -574,6 +582,7 @@ namespace mongo {
         copy->maxScan = this->maxScan;
         copy->addKeyMetadata = this->addKeyMetadata;
         copy->bounds = this->bounds;
+        copy->estimatedKeys = this->estimatedKeys;
 
         return copy;
     }
@@ -419,6 +419,9 @@ namespace mongo {
         // If you use the complex bounds, we force Btree access.
         // The complex bounds require Btree access.
         IndexBounds bounds;
+
+        // How many keys the index statistics say the scan will examine, or -1 if unknown.
+        long long estimatedKeys;
     };
 
     struct ProjectionNode : public QuerySolutionNode {
@@ -94,12 +94,17 @@ namespace mongo {
             params.direction = ixn->direction;
             params.maxScan = ixn->maxScan;
             params.addKeyMetadata = ixn->addKeyMetadata;
+            params.estimatedKeys = ixn->estimatedKeys;
             return new IndexScan(txn, params, ws, ixn->filter.get());
         }
         else if (STAGE_FETCH == root->getType()) {
             const FetchNode* fn = static_cast<const FetchNode*>(root);
             PlanStage* childStage = buildStages(txn, collection, qsol, fn->children[0], ws);
             if (NULL == childStage) { return NULL; }
+            if (STAGE_AND_HASH == childStage->stageType()) {
+                // The fetch only needs RecordIds out of the intersection.
+                static_cast<AndHashStage*>(childStage)->setRecordIdsOnly();
+            }
             return new FetchStage(txn, ws, childStage, fn->filter.get(), collection);
         }
         else if (STAGE_SORT == root->getType()) {
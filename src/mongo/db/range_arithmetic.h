@@ -33,6 +33,7 @@
 #include <vector>
 
 #include "mongo/db/jsobj.h"
+#include "mongo/util/persistent_map.h"
 
 namespace mongo {
 
@@ -110,8 +111,11 @@ namespace mongo {
      *
      * NOTE: For overlap testing to work correctly, there may be no overlaps present in the map
      * itself.
+     *
+     * Copies of a RangeMap share structure, so deriving a new map which differs in a few ranges
+     * costs O(log n) per changed range rather than a full copy.
      */
-    typedef std::map<BSONObj, BSONObj, BSONObjCmp> RangeMap;
+    typedef PersistentMap<BSONObj, BSONObj, BSONObjCmp> RangeMap;
 
     /**
      * A RangeVector is a list of [lower,upper) ranges.
@@ -32,6 +32,9 @@
 
 #include "mongo/db/range_deleter_db_env.h"
 
+#include <algorithm>
+
+#include "mongo/base/counter.h"
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/catalog/collection.h"
@@ -40,15 +43,134 @@
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/write_concern_options.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/d_state.h"
+#include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/log.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
+#include "mongo/util/token_bucket.h"
 
 namespace mongo {
 
     using std::endl;
     using std::string;
 
+namespace {
+
+    // Maximum number of documents deleted under one acquisition of the write lock
+    MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterBatchSize, int, 1);
+
+    // Limits on the rate of range deletion across all collections; 0 means unlimited
+    MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterMaxDocsPerSec, int, 0);
+    MONGO_EXPORT_SERVER_PARAMETER(rangeDeleterMaxBytesPerSec, long long, 0);
+
+    // Throttled deletes sleep in slices of at most this long so that killOp is noticed promptly
+    const long long kMaxThrottleSleepMicros = 100 * 1000;
+
+    TokenBucket docLimiter(0, 0);
+    TokenBucket byteLimiter(0, 0);
+
+    Counter64 totalDocsDeleted;
+    Counter64 totalBytesDeleted;
+    Counter64 totalBatches;
+    Counter64 totalThrottledMicros;
+
+    class RangeDeleteThrottle;
+
+    // Deletes currently running, for serverStatus
+    SimpleMutex activeDeletesMutex("rangeDeleterActive");
+    std::set<const RangeDeleteThrottle*> activeDeletes;
+
+    /**
+     * Paces one range delete according to the rate limits above and tracks its progress.
+     */
+    class RangeDeleteThrottle : public Helpers::RemoveRangeThrottle {
+        MONGO_DISALLOW_COPYING(RangeDeleteThrottle);
+    public:
+        RangeDeleteThrottle(const string& ns, const BSONObj& min, const BSONObj& max)
+            : _ns(ns), _min(min.getOwned()), _max(max.getOwned()) {
+            SimpleMutex::scoped_lock lk(activeDeletesMutex);
+            activeDeletes.insert(this);
+        }
+
+        virtual ~RangeDeleteThrottle() {
+            SimpleMutex::scoped_lock lk(activeDeletesMutex);
+            activeDeletes.erase(this);
+        }
+
+        virtual int batchSize() {
+            return rangeDeleterBatchSize;
+        }
+
+        virtual void batchDeleted(OperationContext* txn, long long numDocs, long long numBytes) {
+            _docs.addAndFetch(numDocs);
+            _bytes.addAndFetch(numBytes);
+            _batches.addAndFetch(1);
+            totalDocsDeleted.increment(numDocs);
+            totalBytesDeleted.increment(numBytes);
+            totalBatches.increment();
+
+            // Pick up the current limits so that setParameter applies to running deletes. The
+            // doc bucket holds at least one batch, or no batch could ever go through unthrottled.
+            const double docRate = rangeDeleterMaxDocsPerSec;
+            const double byteRate = static_cast<double>(rangeDeleterMaxBytesPerSec);
+            docLimiter.setRate(docRate, std::max(docRate, static_cast<double>(batchSize())));
+            byteLimiter.setRate(byteRate, byteRate);
+
+            const long long now = curTimeMicros64();
+            long long waitMicros = std::max(docLimiter.take(numDocs, now),
+                                            byteLimiter.take(numBytes, now));
+            if (waitMicros <= 0) {
+                return;
+            }
+
+            _throttledMicros.addAndFetch(waitMicros);
+            totalThrottledMicros.increment(waitMicros);
+
+            while (waitMicros > 0) {
+                txn->checkForInterrupt();
+                const long long sleepMicros = std::min(waitMicros, kMaxThrottleSleepMicros);
+                sleepmicros(sleepMicros);
+                waitMicros -= sleepMicros;
+            }
+        }
+
+        void append(BSONObjBuilder* builder) const {
+            const long long elapsedMillis = _timer.millis();
+            const long long docs = _docs.load();
+            const long long bytes = _bytes.load();
+
+            builder->append("ns", _ns);
+            builder->append("min", _min);
+            builder->append("max", _max);
+            builder->append("elapsedMillis", elapsedMillis);
+            builder->append("deletedDocs", docs);
+            builder->append("deletedBytes", bytes);
+            builder->append("batches", _batches.load());
+            builder->append("throttledMillis", _throttledMicros.load() / 1000);
+            if (elapsedMillis > 0) {
+                builder->append("docsPerSec", docs * 1000 / elapsedMillis);
+                builder->append("bytesPerSec", bytes * 1000 / elapsedMillis);
+            }
+        }
+
+    private:
+        const string _ns;
+        const BSONObj _min;
+        const BSONObj _max;
+        const Timer _timer;
+
+        AtomicInt64 _docs;
+        AtomicInt64 _bytes;
+        AtomicInt64 _batches;
+        AtomicInt64 _throttledMicros;
+    };
+
+} // namespace
+
     void RangeDeleterDBEnv::initThread() {
         if ( currentClient.get() == NULL )
             Client::initThread( "RangeDeleter" );
@@ -102,6 +224,8 @@ namespace mongo {
                   << ", with opId: " << opId
                   << endl;
 
+            RangeDeleteThrottle throttle(ns, inclusiveLower, exclusiveUpper);
+
             try {
                 *deletedDocs =
                         Helpers::removeRange(txn,
@@ -113,7 +237,8 @@ namespace mongo {
                                              writeConcern,
                                              removeSaverPtr,
                                              fromMigrate,
-                                             onlyRemoveOrphans);
+                                             onlyRemoveOrphans,
+                                             &throttle);
 
                 if (*deletedDocs < 0) {
                     *errMsg = "collection or index dropped before data could be cleaned";
@@ -165,4 +290,25 @@ namespace mongo {
 
         collection->getCursorManager()->getCursorIds( openCursors );
     }
+
+    void RangeDeleterDBEnv::appendProgress(BSONObjBuilder* builder) {
+        {
+            BSONArrayBuilder inProgress(builder->subarrayStart("inProgress"));
+            SimpleMutex::scoped_lock lk(activeDeletesMutex);
+            for (std::set<const RangeDeleteThrottle*>::const_iterator it = activeDeletes.begin();
+                 it != activeDeletes.end(); ++it) {
+                BSONObjBuilder entryBuilder(inProgress.subobjStart());
+                (*it)->append(&entryBuilder);
+            }
+        }
+
+        BSONObjBuilder totals(builder->subobjStart("totals"));
+        totals.append("deletedDocs", totalDocsDeleted.get());
+        totals.append("deletedBytes", totalBytesDeleted.get());
+        totals.append("batches", totalBatches.get());
+        totals.append("throttledMillis", totalThrottledMicros.get() / 1000);
+        totals.append("batchSize", rangeDeleterBatchSize);
+        totals.append("maxDocsPerSec", rangeDeleterMaxDocsPerSec);
+        totals.append("maxBytesPerSec", rangeDeleterMaxBytesPerSec);
+    }
 }
@@ -64,5 +64,11 @@ namespace mongo {
         virtual void getCursorIds(OperationContext* txn,
                                   StringData ns,
                                   std::set<CursorId>* openCursors);
+
+        /**
+         * Appends the progress and throughput of the deletes currently running, and totals
+         * over all deletes since startup. Used by serverStatus.
+         */
+        static void appendProgress(BSONObjBuilder* builder);
     };
 }
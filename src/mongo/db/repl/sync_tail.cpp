@@ -87,6 +87,16 @@ namespace repl {
     static ServerStatusMetricField<TimerStats> displayOpBatchesApplied(
                                                     "repl.apply.batches",
                                                     &applyBatchStats );
+
+    // Number of global lock acquisitions, which were blocked behind batch application and the
+    // total time they spent waiting
+    static ServerStatusMetricField<Counter64> displayBlockedAcquisitions(
+                                            "repl.apply.blockedReaders.num",
+                                            &Lock::ParallelBatchWriterMode::blockedAcquisitions );
+    static ServerStatusMetricField<Counter64> displayBlockedMicros(
+                                            "repl.apply.blockedReaders.totalMicros",
+                                            &Lock::ParallelBatchWriterMode::blockedMicros );
+
     void initializePrefetchThread() {
         if (!ClientBasic::getCurrent()) {
             Client::initThreadIfNotAlready();
@@ -110,7 +120,8 @@ namespace repl {
         _networkQueue(q), 
         _applyFunc(func),
         _writerPool(replWriterThreadCount, "repl writer worker "),
-        _prefetcherPool(replPrefetcherThreadCount, "repl prefetch worker ")
+        _prefetcherPool(replPrefetcherThreadCount, "repl prefetch worker "),
+        _oplogWriterPool(1, "repl oplog writer ")
     {}
 
     SyncTail::~SyncTail() {}
@@ -279,42 +290,51 @@ namespace repl {
         fillWriterVectors(ops, &writerVectors, &mustAwaitCommit);
         LOG(2) << "replication batch size is " << ops.size() << endl;
         // We must grab this because we're going to grab write locks later.
-        // We hold this mutex the entire time we're writing; it doesn't matter
-        // because all readers are blocked anyway.
+        // We hold this mutex the entire time we're applying so that fsyncLock cannot capture a
+        // partially applied batch. Readers are only blocked while the writer threads run (see
+        // below), so they are not excluded for the whole time this mutex is held.
         SimpleMutex::scoped_lock fsynclk(filesLockedFsync);
 
-        // stop all readers until we're done
-        Lock::ParallelBatchWriterMode pbwm;
-
         ReplicationCoordinator* replCoord = getGlobalReplicationCoordinator();
-        if (replCoord->getMemberState().primary() &&
-            !replCoord->isWaitingForApplierToDrain()) {
 
-            severe() << "attempting to replicate ops while primary";
-            fassertFailed(28527);
-        }
+        {
+            // Stop all readers only while the writer threads apply the batch, since that is when
+            // they could observe a partially applied batch. Writing the batch to the oplog and
+            // advancing the optime afterwards does not exclude them, so readers on a secondary
+            // may see a batch's data before its entries are in the oplog and before the optime
+            // reflects it. That is intended: the data is consistent with the end of the batch,
+            // and minValid still covers a crash until the oplog write completes.
+            Lock::ParallelBatchWriterMode pbwm;
 
-        applyOps(writerVectors);
+            if (replCoord->getMemberState().primary() &&
+                !replCoord->isWaitingForApplierToDrain()) {
+
+                severe() << "attempting to replicate ops while primary";
+                fassertFailed(28527);
+            }
+
+            applyOps(writerVectors);
+        }
 
         if (inShutdown()) {
             return Timestamp();
         }
 
-        if (mustAwaitCommit) {
-            txn->recoveryUnit()->goingToAwaitCommit();
-        }
-        Timestamp lastOpTime = writeOpsToOplog(txn, ops);
-        // Wait for journal before setting last op time if any op in batch had j:true
-        if (mustAwaitCommit) {
-            txn->recoveryUnit()->awaitCommit();
-        }
-        ReplClientInfo::forClient(txn->getClient()).setLastOp(lastOpTime);
-        replCoord->setMyLastOptime(lastOpTime);
-        setNewOptime(lastOpTime);
+        // Writing the batch to the oplog overlaps with fetching and applying the next batch. This
+        // keeps the crash-safety guarantees, because minValid for the next batch is set before
+        // any of it is applied: after a crash the data files may only be ahead of the oplog,
+        // which is covered by minValid, never behind it. Batches must reach the oplog in order,
+        // so the previous batch has to be written first.
+        waitForOplogWrites();
 
-        BackgroundSync::get()->notify(txn);
+        boost::shared_ptr<std::deque<BSONObj> > batch(new std::deque<BSONObj>(ops));
+        _oplogWriterPool.schedule(&SyncTail::writeBatchToOplog, batch, mustAwaitCommit);
+
+        return ops.back()["ts"].timestamp();
+    }
 
-        return lastOpTime;
+    void SyncTail::waitForOplogWrites() {
+        _oplogWriterPool.join();
     }
 
     void SyncTail::fillWriterVectors(const std::deque<BSONObj>& ops,
@@ -409,11 +429,14 @@ namespace repl {
             const Timestamp lastOpTime = multiApply(txn, ops.getDeque());
 
             if (inShutdown()) {
+                waitForOplogWrites();
                 return;
             }
 
             // if the last op applied was our end, return
             if (lastOpTime == endOpTime) {
+                waitForOplogWrites();
+
                 LOG(1) << "SyncTail applied " << entriesApplied
                        << " entries (" << bytesApplied << " bytes)"
                        << " and finished at opTime " << endOpTime.toStringPretty();
@@ -550,6 +573,13 @@ namespace {
         if (!peek_success) {
             // if we don't have anything in the queue, wait a bit for something to appear
             if (ops->empty()) {
+                // No batch is being applied, so once the last one is in the oplog our optime
+                // covers everything taken from the bgsync buffer. Only then may bgsync treat the
+                // buffer as applied, since it uses our optime to choose a sync source or to roll
+                // back.
+                waitForOplogWrites();
+                BackgroundSync::get()->notify(txn);
+
                 if (replCoord->isWaitingForApplierToDrain()) {
                     BackgroundSync::get()->waitUntilPaused();
                     if (peek(&op)) {
@@ -558,6 +588,8 @@ namespace {
                         // is complete.
                         return false;
                     }
+                    // The oplog writes were waited for above, so the optime covers everything
+                    // which has been applied before this node starts accepting writes
                     replCoord->signalDrainComplete(txn);
                 }
                 // block up to 1 second
@@ -655,6 +687,39 @@ namespace {
         }
     }
 
+    void SyncTail::writeBatchToOplog(boost::shared_ptr<std::deque<BSONObj> > ops,
+                                     bool mustAwaitCommit) {
+        initializeWriterThread();
+
+        OperationContextImpl txn;
+
+        // The applier thread holds the parallel batch writer lock while applying the next batch
+        txn.lockState()->setIsBatchWriter(true);
+
+        try {
+            if (mustAwaitCommit) {
+                txn.recoveryUnit()->goingToAwaitCommit();
+            }
+            Timestamp lastOpTime = writeOpsToOplog(&txn, *ops);
+            // Wait for journal before setting last op time if any op in batch had j:true
+            if (mustAwaitCommit) {
+                txn.recoveryUnit()->awaitCommit();
+            }
+            ReplClientInfo::forClient(txn.getClient()).setLastOp(lastOpTime);
+            getGlobalReplicationCoordinator()->setMyLastOptime(lastOpTime);
+            setNewOptime(lastOpTime);
+        }
+        catch (const DBException& e) {
+            if (inShutdown()) {
+                return;
+            }
+
+            // The batch has already been applied, so there is no way to retry it
+            severe() << "oplog writer caught exception: " << causedBy(e);
+            fassertFailedNoTrace(28636);
+        }
+    }
+
     // This free function is used by the writer threads to apply each op
     void multiSyncApply(const std::vector<BSONObj>& ops, SyncTail* st) {
         initializeWriterThread();
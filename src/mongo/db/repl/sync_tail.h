@@ -28,6 +28,7 @@
 
 #pragma once
 
+#include <boost/shared_ptr.hpp>
 #include <deque>
 
 #include "mongo/db/storage/mmap_v1/dur.h"
@@ -100,9 +101,16 @@ namespace repl {
 
         // Prefetch and write a deque of operations, using the supplied function.
         // Initial Sync and Sync Tail each use a different function.
-        // Returns the last OpTime applied.
+        // Returns the last OpTime applied. The ops are written to the oplog in the background,
+        // see waitForOplogWrites.
         Timestamp multiApply(OperationContext* txn, std::deque<BSONObj>& ops);
 
+        /**
+         * Blocks until all batches applied by multiApply have been written to the oplog and
+         * the optime has been advanced past them.
+         */
+        void waitForOplogWrites();
+
         /**
          * Applies oplog entries until reaching "endOpTime".
          *
@@ -131,10 +139,17 @@ namespace repl {
                                bool* mustAwaitCommit);
         void handleSlaveDelay(const BSONObj& op);
 
+        // Used by the oplog writer thread to write an applied batch to the oplog and advance the
+        // optime
+        static void writeBatchToOplog(boost::shared_ptr<std::deque<BSONObj> > ops,
+                                      bool mustAwaitCommit);
+
         // persistent pool of worker threads for writing ops to the databases
         threadpool::ThreadPool _writerPool;
         // persistent pool of worker threads for prefetching
         threadpool::ThreadPool _prefetcherPool;
+        // single thread, which writes applied batches to the oplog in order
+        threadpool::ThreadPool _oplogWriterPool;
 
     };
 
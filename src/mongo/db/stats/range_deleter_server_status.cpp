@@ -28,6 +28,7 @@
 
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/db/commands/server_status.h"
+#include "mongo/db/range_deleter_db_env.h"
 #include "mongo/db/range_deleter_service.h"
 
 namespace mongo {
@@ -48,7 +49,30 @@ namespace mongo {
      *       waitForReplStart: ISODate("2014-06-11T22:45:30.221Z"),
      *       waitForReplEnd: ISODate("2014-06-11T22:45:30.221Z")
      *     }
-     *   ]
+     *   ],
+     *   inProgress: [
+     *     {
+     *       ns: "test.user",
+     *       min: { x: 0 },
+     *       max: { x: 100 },
+     *       elapsedMillis: NumberLong(2000),
+     *       deletedDocs: NumberLong(4000),
+     *       deletedBytes: NumberLong(400000),
+     *       batches: NumberLong(40),
+     *       throttledMillis: NumberLong(1500),
+     *       docsPerSec: NumberLong(2000),
+     *       bytesPerSec: NumberLong(200000)
+     *     }
+     *   ],
+     *   totals: {
+     *     deletedDocs: NumberLong(4000),
+     *     deletedBytes: NumberLong(400000),
+     *     batches: NumberLong(40),
+     *     throttledMillis: NumberLong(1500),
+     *     batchSize: 100,
+     *     maxDocsPerSec: 2000,
+     *     maxBytesPerSec: NumberLong(0)
+     *   }
      * }
      */
     class RangeDeleterServerStatusSection : public ServerStatusSection {
@@ -93,6 +117,8 @@ namespace mongo {
             }
             result.append("lastDeleteStats", oldStatsBuilder.arr());
 
+            RangeDeleterDBEnv::appendProgress(&result);
+
             return result.obj();
         }
 
@@ -104,6 +104,15 @@ namespace mongo {
         return md.indexes[offset].ready;
     }
 
+    BSONObj BSONCollectionCatalogEntry::getIndexStats( OperationContext* txn,
+                                                       StringData indexName ) const {
+        MetaData md = _getMetaData( txn );
+
+        int offset = md.findIndexOffset( indexName );
+        invariant( offset >= 0 );
+        return md.indexes[offset].stats.getOwned();
+    }
+
     // --------------------------
 
     void BSONCollectionCatalogEntry::IndexMetaData::updateTTLSetting( long long newExpireSeconds ) {
@@ -163,6 +172,8 @@ namespace mongo {
                 sub.appendBool( "ready", indexes[i].ready );
                 sub.appendBool( "multikey", indexes[i].multikey );
                 sub.append( "head", static_cast<long long>(indexes[i].head.repr()) );
+                if ( !indexes[i].stats.isEmpty() )
+                    sub.append( "stats", indexes[i].stats );
                 sub.done();
             }
             arr.done();
@@ -193,6 +204,8 @@ namespace mongo {
                                          idx["head_b"].Int() );
                 }
                 imd.multikey = idx["multikey"].trueValue();
+                if ( idx["stats"].isABSONObj() )
+                    imd.stats = idx["stats"].Obj().getOwned();
                 indexes.push_back( imd );
             }
         }
@@ -68,6 +68,9 @@ namespace mongo {
         virtual bool isIndexReady( OperationContext* txn,
                                    StringData indexName ) const;
 
+        virtual BSONObj getIndexStats( OperationContext* txn,
+                                       StringData indexName ) const;
+
         // ------ for implementors
 
         struct IndexMetaData {
@@ -83,6 +86,7 @@ namespace mongo {
             bool ready;
             RecordId head;
             bool multikey;
+            BSONObj stats; // empty unless the index has been analyzed
         };
 
         struct MetaData {
@@ -65,6 +65,11 @@ namespace mongo {
 
         virtual void setRollbackWritesDisabled() {}
 
+        virtual bool prepareForReuse() {
+            // Changes are cleared when the outermost unit of work ends
+            return _depth == 0;
+        }
+
         virtual SnapshotId getSnapshotId() const { return SnapshotId(); }
 
     private:
@@ -27,6 +27,7 @@
  */
 #include "mongo/platform/basic.h"
 
+#include "mongo/bson/bson_key_comparator.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/storage/index_entry_comparison.h"
 
@@ -64,7 +65,7 @@ namespace mongo {
             const BSONElement l = lhsIt.next();
             const BSONElement r = rhsIt.next();
 
-            if (int cmp = l.woCompare(r, /*compareFieldNames=*/false)) {
+            if (int cmp = BSONKeyComparator::compareElements(l, r)) {
                 if (cmp == std::numeric_limits<int>::min()) {
                     // can't be negated
                     cmp = -1;
@@ -271,6 +271,22 @@ namespace mongo {
         _appendAllElementsForIndexing(obj, ord);
     }
 
+    void KeyString::resetToKey(const std::vector<BSONElement>& values,
+                               Ordering ord,
+                               Discriminator discriminator) {
+        resetToEmpty();
+        for (size_t i = 0; i < values.size(); i++) {
+            _appendBsonValue(values[i], ord.get(i) == -1, NULL);
+        }
+
+        switch (discriminator) {
+        case kInclusive: break;
+        case kExclusiveBefore: _append(kLess, false); break;
+        case kExclusiveAfter: _append(kGreater, false); break;
+        }
+        _append(kEnd, false);
+    }
+
     // ----------------------------------------------------------------------
     // -----------   APPEND CODE  -------------------------------------------
     // ----------------------------------------------------------------------
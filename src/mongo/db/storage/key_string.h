@@ -30,6 +30,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/bson/bsonmisc.h"
@@ -183,6 +185,16 @@ namespace mongo {
             uint8_t _buf[1/*size*/ + kMaxBytesNeeded];
         };
 
+        /**
+         * Where a key built from a prefix of an index key's fields sorts relative to the stored
+         * keys which start with those values.  Stored keys must use kInclusive.
+         */
+        enum Discriminator {
+            kInclusive,
+            kExclusiveBefore,
+            kExclusiveAfter,
+        };
+
         KeyString() {}
 
         KeyString(const BSONObj& obj, Ordering ord, RecordId recordId) {
@@ -225,6 +237,19 @@ namespace mongo {
 
         void resetToKey(const BSONObj& obj, Ordering ord, RecordId recordId);
         void resetToKey(const BSONObj& obj, Ordering ord);
+
+        /**
+         * Resets to the encoding of the index key whose fields have the given values, in order.
+         * Equivalent to resetToKey() on a BSONObj holding 'values' under empty field names,
+         * without building that object.
+         *
+         * With kExclusiveBefore or kExclusiveAfter, 'values' may be a prefix of the index's fields
+         * and the result sorts before or after every stored key starting with them, whatever
+         * follows, so it can serve as a bound for memcmp() against stored keys.
+         */
+        void resetToKey(const std::vector<BSONElement>& values,
+                        Ordering ord,
+                        Discriminator discriminator = kInclusive);
         void resetFromBuffer(const void* buffer, size_t size) {
             _buffer.reset();
             memcpy(_buffer.skip(size), buffer, size);
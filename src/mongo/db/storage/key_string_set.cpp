@@ -0,0 +1,139 @@
+// key_string_set.cpp
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/key_string_set.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "mongo/util/assert_util.h"
+#include "mongo/util/bufreader.h"
+
+namespace mongo {
+
+    bool KeyStringSet::Key::typeBitsAreAllZeros() const {
+        // See KeyString::TypeBits::getBuffer(): the AllZeros state is the single byte 0x0.
+        return _typeBitsSize == 1 && getTypeBitsBuffer()[0] == 0;
+    }
+
+    BSONObj KeyStringSet::Key::toBson(Ordering ord) const {
+        BufReader reader(getTypeBitsBuffer(), static_cast<unsigned>(_typeBitsSize));
+        return KeyString::toBson(_data, _size, ord, KeyString::TypeBits::fromBuffer(&reader));
+    }
+
+    class KeyStringSet::EntryLess {
+    public:
+        explicit EntryLess(const KeyStringSet* set) : _set(set) {}
+
+        bool operator()(const Entry& lhs, const Entry& rhs) const {
+            return _set->_compare(lhs, *_set, rhs) < 0;
+        }
+
+    private:
+        const KeyStringSet* _set;
+    };
+
+    int KeyStringSet::_compare(const Entry& lhs,
+                               const KeyStringSet& rhsSet,
+                               const Entry& rhs) const {
+        const int cmp = memcmp(_buffer.data() + lhs.offset,
+                               rhsSet._buffer.data() + rhs.offset,
+                               std::min(lhs.size, rhs.size));
+        if (cmp) {
+            return cmp;
+        }
+        return lhs.size < rhs.size ? -1 : (lhs.size > rhs.size ? 1 : 0);
+    }
+
+    void KeyStringSet::add(const KeyString& key, int bsonSize) {
+        const KeyString::TypeBits& typeBits = key.getTypeBits();
+
+        Entry entry;
+        entry.offset = _buffer.size();
+        entry.size = key.getSize();
+        entry.typeBitsSize = typeBits.getSize();
+        entry.bsonSize = bsonSize;
+
+        _buffer.append(key.getBuffer(), key.getSize());
+        _buffer.append(reinterpret_cast<const char*>(typeBits.getBuffer()), typeBits.getSize());
+        _entries.push_back(entry);
+        _finished = false;
+    }
+
+    void KeyStringSet::finish() {
+        if (_finished) {
+            return;
+        }
+
+        // Stable, so that the first of several equal keys is the one kept
+        const EntryLess less(this);
+        std::stable_sort(_entries.begin(), _entries.end(), less);
+
+        size_t kept = 0;
+        for (size_t i = 0; i < _entries.size(); i++) {
+            if (kept > 0 && !less(_entries[kept - 1], _entries[i])) {
+                continue;
+            }
+            _entries[kept++] = _entries[i];
+        }
+        _entries.resize(kept);
+        _finished = true;
+    }
+
+    KeyStringSet::Key KeyStringSet::operator[](size_t i) const {
+        dassert(_finished);
+        const Entry& entry = _entries[i];
+        return Key(_buffer.data() + entry.offset, entry.size, entry.typeBitsSize, entry.bsonSize);
+    }
+
+    void KeyStringSet::clear() {
+        _buffer.clear();
+        _entries.clear();
+        _finished = true;
+    }
+
+    void KeyStringSet::difference(const KeyStringSet& other, std::vector<size_t>* out) const {
+        invariant(_finished && other._finished);
+
+        size_t j = 0;
+        for (size_t i = 0; i < _entries.size(); i++) {
+            while (j < other._entries.size()
+                   && _compare(_entries[i], other, other._entries[j]) > 0) {
+                j++;
+            }
+            if (j == other._entries.size()
+                    || _compare(_entries[i], other, other._entries[j]) != 0) {
+                out->push_back(i);
+            }
+        }
+    }
+
+} // namespace mongo
@@ -0,0 +1,143 @@
+// key_string_set.h
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/ordering.h"
+#include "mongo/db/storage/key_string.h"
+
+namespace mongo {
+
+    /**
+     * A set of index keys encoded as KeyStrings without RecordIds, held in one flat buffer.
+     *
+     * This is the KeyString counterpart of the BSONObjSet an index fills with the keys of a
+     * document. Adding a key appends its bytes to the buffer; finish() then sorts the keys and
+     * removes duplicates in one pass. Keys are equal if they encode to the same bytes, which is
+     * the case exactly when their BSON forms compare equal with woCompare(), e.g. 1 and 1.0. Of
+     * equal keys, the first one added is kept, as BSONObjSet::insert() would.
+     */
+    class KeyStringSet {
+    public:
+
+        /**
+         * A key in the set. It points into the set's buffer, so is only valid until the set is
+         * next modified.
+         */
+        class Key {
+        public:
+            /**
+             * The encoded key, without a RecordId.
+             */
+            const char* getBuffer() const { return _data; }
+            size_t getSize() const { return _size; }
+
+            /**
+             * The key's TypeBits, encoded as by KeyString::TypeBits::getBuffer().
+             */
+            const char* getTypeBitsBuffer() const { return _data + _size; }
+            size_t getTypeBitsSize() const { return _typeBitsSize; }
+            bool typeBitsAreAllZeros() const;
+
+            /**
+             * The size the key has as a BSONObj, which is what index key size limits apply to.
+             */
+            int getBsonSize() const { return _bsonSize; }
+
+            BSONObj toBson(Ordering ord) const;
+
+        private:
+            friend class KeyStringSet;
+
+            Key(const char* data, size_t size, size_t typeBitsSize, int bsonSize)
+                : _data(data), _size(size), _typeBitsSize(typeBitsSize), _bsonSize(bsonSize) {
+            }
+
+            const char* _data;
+            size_t _size;
+            size_t _typeBitsSize;
+            int _bsonSize;
+        };
+
+        explicit KeyStringSet(Ordering ord) : _ordering(ord), _finished(true) {}
+
+        /**
+         * The ordering of the index the keys are encoded for.
+         */
+        Ordering getOrdering() const { return _ordering; }
+
+        /**
+         * Appends 'key', which must have been encoded with getOrdering(). 'bsonSize' is the size
+         * of the key as a BSONObj. Call finish() before reading the set.
+         */
+        void add(const KeyString& key, int bsonSize);
+
+        /**
+         * Sorts the keys added since the last call and removes duplicates.
+         */
+        void finish();
+
+        size_t size() const { return _entries.size(); }
+        bool empty() const { return _entries.empty(); }
+
+        Key operator[](size_t i) const;
+
+        void clear();
+
+        /**
+         * Appends to 'out' the position in this set of each key which is not in 'other'. Both sets
+         * must be finished.
+         */
+        void difference(const KeyStringSet& other, std::vector<size_t>* out) const;
+
+    private:
+        struct Entry {
+            size_t offset;
+            size_t size;
+            size_t typeBitsSize;
+            int bsonSize;
+        };
+
+        class EntryLess;
+
+        int _compare(const Entry& lhs, const KeyStringSet& rhsSet, const Entry& rhs) const;
+
+        Ordering _ordering;
+        bool _finished;
+
+        // Each key is stored as its KeyString bytes followed by its TypeBits bytes
+        std::string _buffer;
+        std::vector<Entry> _entries;
+    };
+
+} // namespace mongo
@@ -35,6 +35,7 @@
 #include "mongo/platform/basic.h"
 #include "mongo/config.h"
 #include "mongo/db/storage/key_string.h"
+#include "mongo/db/storage/key_string_set.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/hex.h"
 #include "mongo/util/log.h"
@@ -844,3 +845,70 @@ TEST(KeyStringTest, RecordIds) {
     }
 }
 
+
+TEST(KeyStringTest, ExclusiveBounds) {
+    const Ordering ord = Ordering::make(BSON("a" << 1 << "b" << -1));
+    BSONObj prefixObj = BSON("" << 5);
+    std::vector<BSONElement> prefix(1, prefixObj.firstElement());
+    KeyString before;
+    before.resetToKey(prefix, ord, KeyString::kExclusiveBefore);
+    KeyString after;
+    after.resetToKey(prefix, ord, KeyString::kExclusiveAfter);
+
+    const BSONObj keys[] = {
+        BSON("" << 5 << "" << MAXKEY),
+        BSON("" << 5 << "" << 1),
+        BSON("" << 5 << "" << MINKEY),
+    };
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+        KeyString key(keys[i], ord, RecordId(i + 1));
+        ASSERT_LT(before, key);
+        ASSERT_GT(after, key);
+    }
+    ASSERT_GT(before, KeyString(BSON("" << 4.5 << "" << MINKEY), ord, RecordId::max()));
+    ASSERT_LT(after, KeyString(BSON("" << 5.5 << "" << MAXKEY), ord, RecordId::min()));
+}
+
+TEST(KeyStringSetTest, SortsAndKeepsFirstOfEqualKeys) {
+    KeyStringSet set(ONE_ASCENDING);
+    const BSONObj keys[] = {BSON("" << 3), BSON("" << 1.0), BSON("" << "a"), BSON("" << 1)};
+    for (size_t i = 0; i < sizeof(keys) / sizeof(keys[0]); i++) {
+        set.add(KeyString(keys[i], ONE_ASCENDING), keys[i].objsize());
+    }
+    set.finish();
+
+    ASSERT_EQUALS(3U, set.size());
+    ASSERT_EQUALS(set[0].toBson(ONE_ASCENDING), BSON("" << 1.0));
+    ASSERT_EQUALS(set[0].toBson(ONE_ASCENDING).firstElement().type(), NumberDouble);
+    ASSERT_FALSE(set[0].typeBitsAreAllZeros());
+    ASSERT_EQUALS(set[1].toBson(ONE_ASCENDING), BSON("" << 3));
+    ASSERT(set[1].typeBitsAreAllZeros());
+    ASSERT_EQUALS(set[2].toBson(ONE_ASCENDING), BSON("" << "a"));
+    ASSERT_EQUALS(set[2].getBsonSize(), keys[2].objsize());
+}
+
+TEST(KeyStringSetTest, Difference) {
+    KeyStringSet lhs(ONE_DESCENDING);
+    KeyStringSet rhs(ONE_DESCENDING);
+    for (int i = 0; i < 10; i++) {
+        BSONObj key = BSON("" << i);
+        if (i % 2 == 0) lhs.add(KeyString(key, ONE_DESCENDING), key.objsize());
+        if (i % 3 == 0) rhs.add(KeyString(key, ONE_DESCENDING), key.objsize());
+    }
+    lhs.finish();
+    rhs.finish();
+
+    // lhs is {8, 6, 4, 2, 0} and rhs is {9, 6, 3, 0}
+    std::vector<size_t> removed;
+    lhs.difference(rhs, &removed);
+    ASSERT_EQUALS(3U, removed.size());
+    ASSERT_EQUALS(lhs[removed[0]].toBson(ONE_DESCENDING), BSON("" << 8));
+    ASSERT_EQUALS(lhs[removed[1]].toBson(ONE_DESCENDING), BSON("" << 4));
+    ASSERT_EQUALS(lhs[removed[2]].toBson(ONE_DESCENDING), BSON("" << 2));
+
+    std::vector<size_t> added;
+    rhs.difference(lhs, &added);
+    ASSERT_EQUALS(2U, added.size());
+    ASSERT_EQUALS(rhs[added[0]].toBson(ONE_DESCENDING), BSON("" << 9));
+    ASSERT_EQUALS(rhs[added[1]].toBson(ONE_DESCENDING), BSON("" << 3));
+}
@@ -170,6 +170,61 @@ namespace mongo {
         _db->remove(txn, Slice::of(KeyString(key, _ordering, loc)));
     }
 
+    Status KVSortedDataImpl::insertKeyString(OperationContext* txn,
+                                             const KeyStringSet::Key& key,
+                                             const RecordId& loc,
+                                             bool dupsAllowed) {
+        invariant(loc.isNormal());
+
+        // The key is only decoded to BSON for error messages and the generic dup key check.
+        if (key.getBsonSize() >= kTempKeyMaxSize) {
+            return checkKeySize(key.toBson(_ordering));
+        }
+
+        KeyString keyString;
+        if (!dupsAllowed) {
+            Status s = Status::OK();
+            if (_db->supportsDupKeyCheck()) {
+                KeyString upper;
+                keyString.resetFromBuffer(key.getBuffer(), key.getSize());
+                keyString.appendRecordId(RecordId::min());
+                upper.resetFromBuffer(key.getBuffer(), key.getSize());
+                upper.appendRecordId(RecordId::max());
+                s = _db->dupKeyCheck(txn, Slice::of(keyString), Slice::of(upper), loc);
+            }
+            else {
+                s = dupKeyCheck(txn, key.toBson(_ordering), loc);
+            }
+
+            if (s == ErrorCodes::DuplicateKey) {
+                return Status(ErrorCodes::DuplicateKey, dupKeyError(key.toBson(_ordering)));
+            }
+            if (!s.isOK()) {
+                return s;
+            }
+        }
+
+        keyString.resetFromBuffer(key.getBuffer(), key.getSize());
+        keyString.appendRecordId(loc);
+        Slice val;
+        if (!key.typeBitsAreAllZeros()) {
+            val = Slice(key.getTypeBitsBuffer(), key.getTypeBitsSize());
+        }
+        return _db->insert(txn, Slice::of(keyString), val, false);
+    }
+
+    void KVSortedDataImpl::unindexKeyString(OperationContext* txn,
+                                            const KeyStringSet::Key& key,
+                                            const RecordId& loc,
+                                            bool dupsAllowed) {
+        invariant(loc.isNormal());
+
+        KeyString keyString;
+        keyString.resetFromBuffer(key.getBuffer(), key.getSize());
+        keyString.appendRecordId(loc);
+        _db->remove(txn, Slice::of(keyString));
+    }
+
     Status KVSortedDataImpl::dupKeyCheck(OperationContext* txn,
                                          const BSONObj& key,
                                          const RecordId& loc) {
@@ -421,6 +476,21 @@ namespace mongo {
             return _keyBson;
         }
 
+        bool getKeyString(const char** data, size_t* size) const {
+            _initialize();
+            invariant(!isEOF());
+            if (_isKeyCurrent) {
+                *data = _keyString.getBuffer();
+                *size = _keyString.getSize();
+                return true;
+            }
+            // Points into the dictionary cursor's current entry, which stays put until we move
+            const Slice key = _cursor->currKey();
+            *data = key.data();
+            *size = key.size();
+            return true;
+        }
+
         RecordId getRecordId() const {
             _initialize();
             if (isEOF()) {
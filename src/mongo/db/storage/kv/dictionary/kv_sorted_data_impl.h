@@ -85,6 +85,18 @@ namespace mongo {
 
         virtual Status dupKeyCheck(OperationContext* txn, const BSONObj& key, const RecordId& loc);
 
+        virtual bool supportsKeyStrings() const { return true; }
+
+        virtual Status insertKeyString(OperationContext* txn,
+                                       const KeyStringSet::Key& key,
+                                       const RecordId& loc,
+                                       bool dupsAllowed);
+
+        virtual void unindexKeyString(OperationContext* txn,
+                                      const KeyStringSet::Key& key,
+                                      const RecordId& loc,
+                                      bool dupsAllowed);
+
         virtual void fullValidate(OperationContext* txn, bool full, long long* numKeysOut,
                                   BSONObjBuilder* output) const;
 
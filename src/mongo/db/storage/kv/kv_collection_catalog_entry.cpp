@@ -119,6 +119,17 @@ namespace mongo {
         _catalog->putMetaData( txn,  ns().toString(), md );
     }
 
+    Status KVCollectionCatalogEntry::setIndexStats( OperationContext* txn,
+                                                    StringData indexName,
+                                                    const BSONObj& stats ) {
+        MetaData md = _getMetaData( txn );
+        int offset = md.findIndexOffset( indexName );
+        invariant( offset >= 0 );
+        md.indexes[offset].stats = stats.getOwned();
+        _catalog->putMetaData( txn, ns().toString(), md );
+        return Status::OK();
+    }
+
     Status KVCollectionCatalogEntry::removeIndex( OperationContext* txn,
                                                   StringData indexName ) {
         MetaData md = _getMetaData( txn );
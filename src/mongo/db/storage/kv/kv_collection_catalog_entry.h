@@ -59,6 +59,10 @@ namespace mongo {
                                    StringData indexName,
                                    const RecordId& newHead );
 
+        virtual Status setIndexStats( OperationContext* txn,
+                                      StringData indexName,
+                                      const BSONObj& stats );
+
         virtual Status removeIndex( OperationContext* txn,
                                     StringData indexName );
 
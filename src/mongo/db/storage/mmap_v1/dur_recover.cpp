@@ -34,6 +34,9 @@
 
 #include "mongo/db/storage/mmap_v1/dur_recover.h"
 
+#include <boost/functional/hash.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/thread.hpp>
 #include <fcntl.h>
 #include <iomanip>
 #include <iostream>
@@ -50,11 +53,13 @@
 #include "mongo/util/bufreader.h"
 #include "mongo/util/checksum.h"
 #include "mongo/util/compress.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/hex.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/startup_test.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -252,10 +257,67 @@ namespace mongo {
         }
 
 
+        /**
+         * Journal recovery is bound by checksumming, decompression and memory copies, so use the
+         * available cores, but not more threads than replication uses for applying writes.
+         */
+        static int recoveryThreadCount() {
+            return std::max(1u, std::min(16u, boost::thread::hardware_concurrency()));
+        }
+
+        // Limits on how much of a journal file is decompressed before being applied
+        static const size_t maxSectionsPerBatch = 64;
+        static const unsigned long long maxCompressedBytesPerBatch = 128 * 1024 * 1024;
+
+
+        /**
+         * A section, which has been located in a journal file during parallel recovery. After
+         * parseSection has run, 'entries' point into the buffer owned by 'iterator'.
+         */
+        struct RecoveryJob::PendingSection {
+            PendingSection(const JSectHeader* h, const char* data, unsigned len, const JSectFooter* f)
+                : header(h),
+                  data(data),
+                  len(len),
+                  footer(f),
+                  skip(false),
+                  corrupt(false),
+                  status(Status::OK()) { }
+
+            const JSectHeader* header;
+            const char* data;
+            unsigned len;
+            const JSectFooter* footer;
+
+            // Only verify the checksum, but do not decompress
+            bool skip;
+
+            bool corrupt;
+            Status status;
+
+            boost::shared_ptr<JournalSectionIterator> iterator;
+            vector<ParsedJournalEntry> entries;
+        };
+
+        /**
+         * A basic write, which has been assigned to its (already opened) data file.
+         */
+        struct RecoveryJob::PendingWrite {
+            PendingWrite(DurableMappedFile* mmf, const JEntry* e) : mmf(mmf), e(e) { }
+
+            DurableMappedFile* mmf;
+            const JEntry* e;
+        };
+
+
         RecoveryJob::RecoveryJob()
             : _recovering(false),
               _lastDataSyncedFromLastRun(0),
-              _lastSeqMentionedInConsoleLog(1) {
+              _lastSeqMentionedInConsoleLog(1),
+              _sectionsApplied(0),
+              _bytesApplied(0),
+              _decompressMicros(0),
+              _applyMicros(0) {
 
         }
 
@@ -328,6 +390,7 @@ namespace mongo {
                 void* dest = (char*)mmf->view_write() + entry.e->ofs;
                 memcpy(dest, entry.e->srcData(), entry.e->len);
                 stats.curr()->_writeToDataFilesBytes += entry.e->len;
+                _bytesApplied += entry.e->len;
             }
             else {
                 massert(13622, "Trying to write past end of file in WRITETODATAFILES", _recovering);
@@ -398,17 +461,8 @@ namespace mongo {
                 }
             }
 
-            if( _recovering && _lastDataSyncedFromLastRun > h->seqNumber + ExtraKeepTimeMs ) {
-                if( h->seqNumber != _lastSeqMentionedInConsoleLog ) {
-                    static int n;
-                    if( ++n < 10 ) {
-                        log() << "recover skipping application of section seq:" << h->seqNumber << " < lsn:" << _lastDataSyncedFromLastRun << endl;
-                    }
-                    else if( n == 10 ) { 
-                        log() << "recover skipping application of section more..." << endl;
-                    }
-                    _lastSeqMentionedInConsoleLog = h->seqNumber;
-                }
+            if (shouldSkipSection(*h)) {
+                logSkippedSection(*h);
                 return;
             }
 
@@ -442,13 +496,184 @@ namespace mongo {
 
             // got all the entries for one group commit.  apply them:
             applyEntries(entries);
+            _sectionsApplied++;
+        }
+
+        bool RecoveryJob::shouldSkipSection(const JSectHeader& h) const {
+            return _recovering && _lastDataSyncedFromLastRun > h.seqNumber + ExtraKeepTimeMs;
+        }
+
+        void RecoveryJob::logSkippedSection(const JSectHeader& h) {
+            if( h.seqNumber != _lastSeqMentionedInConsoleLog ) {
+                static int n;
+                if( ++n < 10 ) {
+                    log() << "recover skipping application of section seq:" << h.seqNumber << " < lsn:" << _lastDataSyncedFromLastRun << endl;
+                }
+                else if( n == 10 ) { 
+                    log() << "recover skipping application of section more..." << endl;
+                }
+                _lastSeqMentionedInConsoleLog = h.seqNumber;
+            }
+        }
+
+        void RecoveryJob::parseSection(PendingSection* section) {
+            try {
+                if (!section->footer->checkHash(section->header,
+                                                section->len + sizeof(JSectHeader))) {
+                    log() << "journal section checksum doesn't match";
+                    throw JournalSectionCorruptException();
+                }
+
+                if (section->skip) {
+                    return;
+                }
+
+                section->iterator.reset(new JournalSectionIterator(*section->header,
+                                                                   section->data,
+                                                                   section->len,
+                                                                   true));
+
+                // read all entries to make sure this section is valid
+                ParsedJournalEntry e;
+                while (!section->iterator->atEof()) {
+                    section->iterator->next(e);
+                    section->entries.push_back(e);
+                }
+            }
+            catch (const JournalSectionCorruptException&) {
+                section->corrupt = true;
+            }
+            catch (const BufReader::eof&) {
+                section->corrupt = true;
+            }
+            catch (const DBException& ex) {
+                section->status = ex.toStatus();
+            }
+        }
+
+        void RecoveryJob::applyWrites(const vector<PendingWrite>* writes,
+                                      unsigned long long* bytesWritten) {
+            for (vector<PendingWrite>::const_iterator it = writes->begin();
+                 it != writes->end();
+                 ++it) {
+
+                void* dest = (char*)it->mmf->view_write() + it->e->ofs;
+                memcpy(dest, it->e->srcData(), it->e->len);
+                *bytesWritten += it->e->len;
+            }
+        }
+
+        void RecoveryJob::flushPendingWrites(vector<vector<PendingWrite> >& pendingWrites,
+                                             ThreadPool* pool) {
+            vector<unsigned long long> bytesWritten(pendingWrites.size(), 0);
+
+            for (size_t i = 0; i < pendingWrites.size(); i++) {
+                if (!pendingWrites[i].empty()) {
+                    pool->schedule(&RecoveryJob::applyWrites, &pendingWrites[i], &bytesWritten[i]);
+                }
+            }
+            pool->join();
+
+            for (size_t i = 0; i < pendingWrites.size(); i++) {
+                stats.curr()->_writeToDataFilesBytes += bytesWritten[i];
+                _bytesApplied += bytesWritten[i];
+                pendingWrites[i].clear();
+            }
+        }
+
+        bool RecoveryJob::processSectionsParallel(vector<PendingSection>& sections,
+                                                  ThreadPool* pool) {
+            // Checksum and decompress all sections at once
+            Timer decompressTimer;
+            for (size_t i = 0; i < sections.size(); i++) {
+                sections[i].skip = shouldSkipSection(*sections[i].header);
+                pool->schedule(&RecoveryJob::parseSection, &sections[i]);
+            }
+            pool->join();
+            _decompressMicros += decompressTimer.micros();
+
+            // Apply the sections in journal order. All writes to a data file go to the same
+            // partition, so they are applied in the order they were journaled. Operations other
+            // than basic writes (file creation, dropping a database) act as a barrier.
+            Timer applyTimer;
+
+            LockMongoFilesShared lkFiles; // for RecoveryJob::Last
+            boost::lock_guard<boost::mutex> lk(_mx);
+
+            vector<vector<PendingWrite> > pendingWrites(recoveryThreadCount());
+            const boost::hash<const void*> mmfHasher = boost::hash<const void*>();
+
+            bool foundCorrupt = false;
+
+            Last last;
+            for (size_t i = 0; i < sections.size(); i++) {
+                const PendingSection& section = sections[i];
+
+                // Processing stops at the first corrupt section
+                if (section.corrupt) {
+                    foundCorrupt = true;
+                    break;
+                }
+
+                if (!section.status.isOK()) {
+                    flushPendingWrites(pendingWrites, pool);
+                    uassertStatusOK(section.status);
+                }
+
+                if (section.skip) {
+                    logSkippedSection(*section.header);
+                    continue;
+                }
+
+                for (vector<ParsedJournalEntry>::const_iterator it = section.entries.begin();
+                     it != section.entries.end();
+                     ++it) {
+
+                    if (it->e) {
+                        verify(it->dbName);
+
+                        DurableMappedFile* mmf = last.newEntry(*it, *this);
+
+                        // Writes past the end of the file are ignored while recovering
+                        if ((it->e->ofs + it->e->len) <= mmf->length()) {
+                            verify(mmf->view_write());
+                            verify(it->e->srcData());
+
+                            pendingWrites[mmfHasher(mmf) % pendingWrites.size()].push_back(
+                                                                        PendingWrite(mmf, it->e));
+                        }
+                    }
+                    else if (it->op) {
+                        flushPendingWrites(pendingWrites, pool);
+
+                        if (it->op->needFilesClosed()) {
+                            _close();
+
+                            // The files cached in 'last' are not open anymore
+                            last = Last();
+                        }
+                        it->op->replay();
+                    }
+                }
+
+                _sectionsApplied++;
+            }
+
+            flushPendingWrites(pendingWrites, pool);
+            _applyMicros += applyTimer.micros();
+
+            return foundCorrupt;
         }
 
         /** apply a specific journal file, that is already mmap'd
             @param p start of the memory mapped file
             @return true if this is detected to be the last file (ends abruptly)
         */
-        bool RecoveryJob::processFileBuffer(const void *p, unsigned len) {
+        bool RecoveryJob::processFileBuffer(const void *p, unsigned len, ThreadPool* pool) {
+            // Sections, which have been located, but not applied yet, if recovering in parallel
+            vector<PendingSection> sections;
+            unsigned long long sectionsCompressedBytes = 0;
+
             try {
                 unsigned long long fileId;
                 BufReader br(p,len);
@@ -491,6 +716,10 @@ namespace mongo {
                             log() << "Ending processFileBuffer at differing fileId want:" << fileId << " got:" << h.fileId << endl;
                             log() << "  sect len:" << h.sectionLen() << " seqnum:" << h.seqNumber << endl;
                         }
+
+                        if (!sections.empty()) {
+                            processSectionsParallel(sections, pool);
+                        }
                         return true;
                     }
                     unsigned slen = h.sectionLen();
@@ -498,20 +727,49 @@ namespace mongo {
                     const char *hdr = (const char *) br.skip(h.sectionLenWithPadding());
                     const char *data = hdr + sizeof(JSectHeader);
                     const char *footer = data + dataLen;
-                    processSection((const JSectHeader*) hdr, data, dataLen, (const JSectFooter*) footer);
+
+                    if (pool) {
+                        sections.push_back(PendingSection((const JSectHeader*) hdr,
+                                                          data,
+                                                          dataLen,
+                                                          (const JSectFooter*) footer));
+                        sectionsCompressedBytes += dataLen;
+
+                        if (sections.size() >= maxSectionsPerBatch ||
+                                sectionsCompressedBytes >= maxCompressedBytesPerBatch) {
+                            if (processSectionsParallel(sections, pool)) {
+                                return true; // abrupt end
+                            }
+                            sections.clear();
+                            sectionsCompressedBytes = 0;
+                        }
+                    }
+                    else {
+                        processSection((const JSectHeader*) hdr, data, dataLen, (const JSectFooter*) footer);
+                    }
 
                     // ctrl c check
                     uassert(ErrorCodes::Interrupted, "interrupted during journal recovery", !inShutdown());
                 }
+
+                if (!sections.empty() && processSectionsParallel(sections, pool)) {
+                    return true; // abrupt end
+                }
             }
             catch (const BufReader::eof&) {
                 if (mmapv1GlobalOptions.journalOptions & MMAPV1Options::JournalDumpJournal)
                     log() << "ABRUPT END" << endl;
+                if (!sections.empty()) {
+                    processSectionsParallel(sections, pool);
+                }
                 return true; // abrupt end
             }
             catch (const JournalSectionCorruptException&) {
                 if (mmapv1GlobalOptions.journalOptions & MMAPV1Options::JournalDumpJournal)
                     log() << "ABRUPT END" << endl;
+                if (!sections.empty()) {
+                    processSectionsParallel(sections, pool);
+                }
                 return true; // abrupt end
             }
 
@@ -519,7 +777,7 @@ namespace mongo {
         }
 
         /** apply a specific journal file */
-        bool RecoveryJob::processFile(boost::filesystem::path journalfile) {
+        bool RecoveryJob::processFile(boost::filesystem::path journalfile, ThreadPool* pool) {
             log() << "recover " << journalfile.string() << endl;
 
             try { 
@@ -535,7 +793,7 @@ namespace mongo {
             MemoryMappedFile f;
             void *p = f.mapWithOptions(journalfile.string().c_str(), MongoFile::READONLY | MongoFile::SEQUENTIAL);
             massert(13544, str::stream() << "recover error couldn't open " << journalfile.string(), p);
-            return processFileBuffer(p, (unsigned) f.length());
+            return processFileBuffer(p, (unsigned) f.length(), pool);
         }
 
         /** @param files all the j._0 style files we need to apply for recovery */
@@ -548,8 +806,31 @@ namespace mongo {
             _lastDataSyncedFromLastRun = journalReadLSN();
             log() << "recover lsn: " << _lastDataSyncedFromLastRun << endl;
 
+            _sectionsApplied = 0;
+            _bytesApplied = 0;
+            _decompressMicros = 0;
+            _applyMicros = 0;
+
+            // The diagnostic modes need the sections to be processed one entry at a time
+            boost::scoped_ptr<ThreadPool> pool;
+            const int numThreads = recoveryThreadCount();
+            if (numThreads > 1 &&
+                    !(mmapv1GlobalOptions.journalOptions & (MMAPV1Options::JournalScanOnly |
+                                                            MMAPV1Options::JournalDumpJournal))) {
+                pool.reset(new ThreadPool(numThreads, "journal recovery worker "));
+                log() << "recover using " << numThreads << " threads" << endl;
+            }
+
+            Timer recoveryTimer;
+
             for( unsigned i = 0; i != files.size(); ++i ) {
-                bool abruptEnd = processFile(files[i]);
+                bool abruptEnd = processFile(files[i], pool.get());
+
+                log() << "recover progress: " << (i + 1) << " of " << files.size() << " files, "
+                      << _sectionsApplied << " sections, "
+                      << _bytesApplied / (1024 * 1024) << "MB applied in "
+                      << recoveryTimer.millis() << "ms" << endl;
+
                 if( abruptEnd && i+1 < files.size() ) {
                     log() << "recover error: abrupt end to file " << files[i].string() << ", yet it isn't the last journal file" << endl;
                     close();
@@ -559,6 +840,13 @@ namespace mongo {
 
             close();
 
+            log() << "recover applied " << _sectionsApplied << " sections in "
+                  << recoveryTimer.millis() << "ms" << endl;
+            if (pool) {
+                log() << "recover spent " << _decompressMicros / 1000 << "ms decompressing and "
+                      << _applyMicros / 1000 << "ms applying sections" << endl;
+            }
+
             if (mmapv1GlobalOptions.journalOptions & MMAPV1Options::JournalScanOnly) {
                 uasserted(13545, str::stream() << "--durOptions "
                                                << (int) MMAPV1Options::JournalScanOnly
@@ -41,6 +41,10 @@ namespace mongo {
 
     class DurableMappedFile;
 
+    namespace threadpool {
+        class ThreadPool;
+    }
+
     namespace dur {
 
         struct ParsedJournalEntry;
@@ -77,13 +81,39 @@ namespace mongo {
             };
 
 
+            struct PendingSection;
+            struct PendingWrite;
+
             void write(Last& last, const ParsedJournalEntry& entry); // actually writes to the file
             void applyEntry(Last& last, const ParsedJournalEntry& entry, bool apply, bool dump);
             void applyEntries(const std::vector<ParsedJournalEntry> &entries);
-            bool processFileBuffer(const void *, unsigned len);
-            bool processFile(boost::filesystem::path journalfile);
+            bool processFileBuffer(const void *, unsigned len, threadpool::ThreadPool* pool);
+            bool processFile(boost::filesystem::path journalfile, threadpool::ThreadPool* pool);
             void _close(); // doesn't lock
 
+            /**
+             * Parallel recovery. Sections are checksummed and decompressed on the pool, after
+             * which their writes are applied in journal order, with the writes to each data file
+             * handled by a single pool thread.
+             *
+             * @return true if a corrupt section was found, in which case none of the sections
+             *          following it have been applied.
+             */
+            bool processSectionsParallel(std::vector<PendingSection>& sections,
+                                         threadpool::ThreadPool* pool);
+            void flushPendingWrites(std::vector<std::vector<PendingWrite> >& pendingWrites,
+                                    threadpool::ThreadPool* pool);
+
+            // Run on the pool threads
+            static void parseSection(PendingSection* section);
+            static void applyWrites(const std::vector<PendingWrite>* writes,
+                                    unsigned long long* bytesWritten);
+
+            // A section must not be applied if it is older than the data which was synced to the
+            // data files before the last shutdown
+            bool shouldSkipSection(const JSectHeader& h) const;
+            void logSkippedSection(const JSectHeader& h);
+
 
             // Set of memory mapped files and a mutex to protect them
             mongo::mutex _mx;
@@ -95,6 +125,12 @@ namespace mongo {
             unsigned long long _lastDataSyncedFromLastRun;
             unsigned long long _lastSeqMentionedInConsoleLog;
 
+            // Progress of the current recovery, for logging
+            unsigned long long _sectionsApplied;
+            unsigned long long _bytesApplied;
+            unsigned long long _decompressMicros;
+            unsigned long long _applyMicros;
+
 
             static RecoveryJob& _instance;
         };
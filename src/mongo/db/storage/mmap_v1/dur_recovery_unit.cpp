@@ -98,6 +98,15 @@ namespace mongo {
         // no-op since we have no transaction
     }
 
+    bool DurRecoveryUnit::prepareForReuse() {
+        // Don't hold on to the pre-image memory of a large operation for the rest of the
+        // connection's lifetime.
+        const size_t maxRetainedPreimageBytes = 1024 * 1024;
+
+        // State is already reset when the outermost unit of work ends.
+        return !inAUnitOfWork() && _preimageBuffer.capacity() <= maxRetainedPreimageBytes;
+    }
+
     void DurRecoveryUnit::commitChanges() {
         invariant(!_mustRollback);
         invariant(inOutermostUnitOfWork());
@@ -63,6 +63,8 @@ namespace mongo {
 
         virtual void setRollbackWritesDisabled();
 
+        virtual bool prepareForReuse();
+
         virtual SnapshotId getSnapshotId() const { return SnapshotId(); }
 
     private:
@@ -0,0 +1,193 @@
+// record_store_test_performance.cpp
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/db/storage/record_store_test_harness.h"
+
+#include <boost/scoped_ptr.hpp>
+#include <string>
+#include <vector>
+
+#include "mongo/base/owned_pointer_vector.h"
+#include "mongo/config.h"
+#include "mongo/db/record_id.h"
+#include "mongo/db/storage/record_data.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/db/storage/storage_benchmark.h"
+#include "mongo/platform/random.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+
+#ifndef MONGO_CONFIG_DEBUG_BUILD
+
+    using boost::scoped_ptr;
+
+    namespace {
+
+        // The store has the same number of records whatever the number of threads
+        const int64_t kNumRecords = 20 * 1000;
+        const int kRecordSize = 128;
+        const int kScanLength = 100;
+        const int kDamageSize = 8;
+
+        /**
+         * The operations of each benchmark phase, against one record store.  Each thread
+         * inserts its own records, updates only those, and reads any of them.
+         */
+        class RecordStoreBenchmark {
+        public:
+            RecordStoreBenchmark(RecordStore* rs, int numThreads, int64_t recordsPerThread)
+                : _rs(rs),
+                  _recordsPerThread(recordsPerThread),
+                  _locs(numThreads * recordsPerThread),
+                  _data(kRecordSize, 'x') {
+                for (int t = 0; t < numThreads; t++) {
+                    _random.push_back(PseudoRandom(int64_t(t + 1)));
+                    _iterators.push_back(NULL);
+                }
+            }
+
+            typedef void (RecordStoreBenchmark::*Method)(OperationContext*, int, int64_t);
+
+            StorageBenchmark::Op op(Method method) {
+                return stdx::bind(method, this, stdx::placeholders::_1, stdx::placeholders::_2,
+                                  stdx::placeholders::_3);
+            }
+
+            void insert(OperationContext* txn, int thread, int64_t i) {
+                WriteUnitOfWork uow(txn);
+                StatusWith<RecordId> res = _rs->insertRecord(txn, _data.c_str(), _data.size(),
+                                                             false);
+                ASSERT_OK(res.getStatus());
+                uow.commit();
+                ownLoc(thread, i) = res.getValue();
+            }
+
+            void pointRead(OperationContext* txn, int thread, int64_t i) {
+                RecordData data = _rs->dataFor(txn, randomLoc(thread));
+                ASSERT_EQUALS(kRecordSize, data.size());
+            }
+
+            void rangeScan(OperationContext* txn, int thread, int64_t i) {
+                scoped_ptr<RecordIterator> it(_rs->getIterator(txn, randomLoc(thread)));
+                for (int n = 0; n < kScanLength && !it->isEOF(); n++) {
+                    it->getNext();
+                }
+            }
+
+            void updateWithDamages(OperationContext* txn, int thread, int64_t i) {
+                const RecordId& loc = ownLoc(thread, i);
+
+                mutablebson::DamageVector damages(1);
+                damages[0].sourceOffset = 0;
+                damages[0].targetOffset = i % (kRecordSize - kDamageSize);
+                damages[0].size = kDamageSize;
+
+                WriteUnitOfWork uow(txn);
+                RecordData oldRec = _rs->dataFor(txn, loc);
+                ASSERT_OK(_rs->updateWithDamages(txn, loc, oldRec, "yyyyyyyy", damages));
+                uow.commit();
+            }
+
+            // A step of a full scan which yields between every record.  The phase must run
+            // 'recordsPerThread' operations per thread.
+            void saveRestore(OperationContext* txn, int thread, int64_t i) {
+                RecordIterator*& it = _iterators.mutableVector()[thread];
+                if (!it || it->isEOF()) {
+                    delete it;
+                    it = _rs->getIterator(txn);
+                }
+
+                it->saveState();
+                ASSERT(it->restoreState(txn));
+                it->getNext();
+
+                // The iterator must not outlive the thread's OperationContext
+                if (i == _recordsPerThread - 1) {
+                    delete it;
+                    it = NULL;
+                }
+            }
+
+        private:
+            RecordId& ownLoc(int thread, int64_t i) {
+                return _locs[thread * _recordsPerThread + i];
+            }
+
+            const RecordId& randomLoc(int thread) {
+                return _locs[static_cast<uint64_t>(_random[thread].nextInt64()) % _locs.size()];
+            }
+
+            RecordStore* const _rs;
+            const int64_t _recordsPerThread;
+            std::vector<RecordId> _locs;
+            std::vector<PseudoRandom> _random;
+            OwnedPointerVector<RecordIterator> _iterators;
+            const std::string _data;
+        };
+
+    } // namespace
+
+    // Measures each kind of operation at 1 to StorageBenchmark::kMaxThreads threads
+    TEST( RecordStoreTestHarness, PerformanceThroughputAndLatency ) {
+        for ( int numThreads = 1; numThreads <= StorageBenchmark::kMaxThreads; numThreads *= 2 ) {
+            scoped_ptr<HarnessHelper> harnessHelper( newHarnessHelper() );
+            scoped_ptr<RecordStore> rs( harnessHelper->newNonCappedRecordStore() );
+
+            StorageBenchmark bench( "RecordStore",
+                                    harnessHelper->supportsDocLocking(),
+                                    stdx::bind( &HarnessHelper::newOperationContext,
+                                                harnessHelper.get() ) );
+
+            const int64_t opsPerThread = kNumRecords / numThreads;
+            RecordStoreBenchmark ops( rs.get(), numThreads, opsPerThread );
+
+            bench.run( "insert", StorageBenchmark::kWrite, numThreads, opsPerThread,
+                       ops.op( &RecordStoreBenchmark::insert ) );
+            {
+                scoped_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+                ASSERT_EQUALS( opsPerThread * numThreads, rs->numRecords( opCtx.get() ) );
+            }
+
+            bench.run( "pointRead", StorageBenchmark::kRead, numThreads, opsPerThread,
+                       ops.op( &RecordStoreBenchmark::pointRead ) );
+            bench.run( "rangeScan", StorageBenchmark::kRead, numThreads, opsPerThread / 10,
+                       ops.op( &RecordStoreBenchmark::rangeScan ) );
+            if ( rs->updateWithDamagesSupported() ) {
+                bench.run( "updateWithDamages", StorageBenchmark::kWrite, numThreads,
+                           opsPerThread, ops.op( &RecordStoreBenchmark::updateWithDamages ) );
+            }
+            bench.run( "saveRestore", StorageBenchmark::kRead, numThreads, opsPerThread,
+                       ops.op( &RecordStoreBenchmark::saveRestore ) );
+        }
+    }
+
+#endif
+
+} // namespace mongo
@@ -54,6 +54,15 @@ namespace mongo {
         virtual void beingReleasedFromOperationContext() {}
         virtual void beingSetOnOperationContext() {}
 
+        /**
+         * Called when the operation which owns this RecoveryUnit is finished. Returning true
+         * means that the RecoveryUnit has no active unit of work or registered changes left and
+         * may be handed to the next operation of the same client instead of being deleted.
+         *
+         * The default is to not allow reuse.
+         */
+        virtual bool prepareForReuse() { return false; }
+
         /**
          * These should be called through WriteUnitOfWork rather than directly.
          *
@@ -62,6 +62,10 @@ namespace mongo {
         }
         virtual void setRollbackWritesDisabled() {}
 
+        virtual bool prepareForReuse() {
+            return true;
+        }
+
         virtual SnapshotId getSnapshotId() const { return SnapshotId(); }
     };
 
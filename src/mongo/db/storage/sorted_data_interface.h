@@ -31,6 +31,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/record_id.h"
+#include "mongo/db/storage/key_string_set.h"
 #include "mongo/db/storage/record_store.h"
 
 #pragma once
@@ -110,6 +111,36 @@ namespace mongo {
                              const RecordId& loc,
                              bool dupsAllowed) = 0;
 
+        /**
+         * Returns true if this index implements insertKeyString() and unindexKeyString(), which
+         * take keys already encoded as KeyStrings by the index access method.  Indexes which
+         * store KeyStrings can then skip building each key as a BSONObj and encoding it again.
+         */
+        virtual bool supportsKeyStrings() const { return false; }
+
+        /**
+         * Same as insert(), for a key encoded in this index's ordering.  Only called if
+         * supportsKeyStrings() returns true.
+         */
+        virtual Status insertKeyString(OperationContext* txn,
+                                       const KeyStringSet::Key& key,
+                                       const RecordId& loc,
+                                       bool dupsAllowed) {
+            invariant(false);
+            return Status::OK();
+        }
+
+        /**
+         * Same as unindex(), for a key encoded in this index's ordering.  Only called if
+         * supportsKeyStrings() returns true.
+         */
+        virtual void unindexKeyString(OperationContext* txn,
+                                      const KeyStringSet::Key& key,
+                                      const RecordId& loc,
+                                      bool dupsAllowed) {
+            invariant(false);
+        }
+
         /**
          * Return ErrorCodes::DuplicateKey if 'key' already exists in 'this'
          * index at a RecordId other than 'loc', and Status::OK() otherwise.
@@ -294,6 +325,16 @@ namespace mongo {
              */
             virtual BSONObj getKey() const = 0;
 
+            /**
+             * If the index stores its keys as KeyStrings encoded with the index's Ordering,
+             * possibly followed by the RecordId, points 'data' and 'size' at the current entry's
+             * encoding and returns true.  This lets callers compare keys to KeyString bounds with memcmp()
+             * without decoding them.  The buffer is valid until 'this' cursor is next moved.
+             *
+             * Returns false if the index stores keys some other way.
+             */
+            virtual bool getKeyString(const char** data, size_t* size) const { return false; }
+
             /**
              * Return the RecordId associated with the current position of 'this' cursor.
              */
@@ -78,6 +78,12 @@ namespace mongo {
         virtual OperationContext* newOperationContext() {
             return new OperationContextNoop( newRecoveryUnit() );
         }
+
+        /**
+         * Whether the engine supports document-level locking, so that several threads may
+         * write to the same store at once.
+         */
+        virtual bool supportsDocLocking() const { return false; }
     };
 
     HarnessHelper* newHarnessHelper();
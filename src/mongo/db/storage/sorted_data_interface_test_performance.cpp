@@ -0,0 +1,177 @@
+// sorted_data_interface_test_performance.cpp
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/db/storage/sorted_data_interface_test_harness.h"
+
+#include <boost/scoped_ptr.hpp>
+#include <vector>
+
+#include "mongo/base/owned_pointer_vector.h"
+#include "mongo/config.h"
+#include "mongo/db/storage/sorted_data_interface.h"
+#include "mongo/db/storage/storage_benchmark.h"
+#include "mongo/platform/random.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+
+#ifndef MONGO_CONFIG_DEBUG_BUILD
+
+    using boost::scoped_ptr;
+
+    namespace {
+
+        // The index has the same number of keys whatever the number of threads
+        const int64_t kNumKeys = 20 * 1000;
+        const int kScanLength = 100;
+
+        BSONObj keyFor(int64_t k) {
+            return BSON("" << static_cast<long long>(k));
+        }
+
+        RecordId locFor(int64_t k) {
+            return RecordId(42, static_cast<int>(k * 2));
+        }
+
+        /**
+         * The operations of each benchmark phase, against one index.  Threads insert
+         * interleaved keys, as with an increasing key such as an ObjectId, and read any of them.
+         */
+        class SortedDataBenchmark {
+        public:
+            typedef void (SortedDataBenchmark::*Method)(OperationContext*, int, int64_t);
+
+            SortedDataBenchmark(SortedDataInterface* sorted, int numThreads, int64_t keysPerThread)
+                : _sorted(sorted),
+                  _numThreads(numThreads),
+                  _keysPerThread(keysPerThread) {
+                for (int t = 0; t < numThreads; t++) {
+                    _random.push_back(PseudoRandom(int64_t(t + 1)));
+                    _cursors.push_back(NULL);
+                }
+            }
+
+            StorageBenchmark::Op op(Method method) {
+                return stdx::bind(method, this, stdx::placeholders::_1, stdx::placeholders::_2,
+                                  stdx::placeholders::_3);
+            }
+
+            void insert(OperationContext* txn, int thread, int64_t i) {
+                const int64_t k = i * _numThreads + thread;
+                WriteUnitOfWork uow(txn);
+                ASSERT_OK(_sorted->insert(txn, keyFor(k), locFor(k), true));
+                uow.commit();
+            }
+
+            void pointRead(OperationContext* txn, int thread, int64_t i) {
+                const int64_t k = randomKey(thread);
+                scoped_ptr<SortedDataInterface::Cursor> cursor(_sorted->newCursor(txn, 1));
+                ASSERT(cursor->locate(keyFor(k), locFor(k)));
+            }
+
+            void rangeScan(OperationContext* txn, int thread, int64_t i) {
+                const int64_t k = randomKey(thread);
+                scoped_ptr<SortedDataInterface::Cursor> cursor(_sorted->newCursor(txn, 1));
+                cursor->locate(keyFor(k), locFor(k));
+                for (int n = 0; n < kScanLength && !cursor->isEOF(); n++) {
+                    cursor->getKey();
+                    cursor->advance();
+                }
+            }
+
+            // A step of a full scan which yields between every key.  The phase must run
+            // 'keysPerThread' operations per thread.
+            void saveRestore(OperationContext* txn, int thread, int64_t i) {
+                SortedDataInterface::Cursor*& cursor = _cursors.mutableVector()[thread];
+                if (!cursor || cursor->isEOF()) {
+                    delete cursor;
+                    cursor = _sorted->newCursor(txn, 1);
+                    cursor->locate(minKey, RecordId::min());
+                }
+
+                cursor->savePosition();
+                cursor->restorePosition(txn);
+                cursor->advance();
+
+                // The cursor must not outlive the thread's OperationContext
+                if (i == _keysPerThread - 1) {
+                    delete cursor;
+                    cursor = NULL;
+                }
+            }
+
+        private:
+            int64_t randomKey(int thread) {
+                return static_cast<uint64_t>(_random[thread].nextInt64())
+                    % (_numThreads * _keysPerThread);
+            }
+
+            SortedDataInterface* const _sorted;
+            const int _numThreads;
+            const int64_t _keysPerThread;
+            std::vector<PseudoRandom> _random;
+            OwnedPointerVector<SortedDataInterface::Cursor> _cursors;
+        };
+
+    } // namespace
+
+    // Measures each kind of operation at 1 to StorageBenchmark::kMaxThreads threads
+    TEST( SortedDataInterface, PerformanceThroughputAndLatency ) {
+        for ( int numThreads = 1; numThreads <= StorageBenchmark::kMaxThreads; numThreads *= 2 ) {
+            scoped_ptr<HarnessHelper> harnessHelper( newHarnessHelper() );
+            scoped_ptr<SortedDataInterface> sorted(
+                harnessHelper->newSortedDataInterface( false ) );
+
+            StorageBenchmark bench( "SortedDataInterface",
+                                    harnessHelper->supportsDocLocking(),
+                                    stdx::bind( &HarnessHelper::newOperationContext,
+                                                harnessHelper.get() ) );
+
+            const int64_t opsPerThread = kNumKeys / numThreads;
+            SortedDataBenchmark ops( sorted.get(), numThreads, opsPerThread );
+
+            bench.run( "insert", StorageBenchmark::kWrite, numThreads, opsPerThread,
+                       ops.op( &SortedDataBenchmark::insert ) );
+            {
+                scoped_ptr<OperationContext> opCtx( harnessHelper->newOperationContext() );
+                ASSERT_EQUALS( opsPerThread * numThreads, sorted->numEntries( opCtx.get() ) );
+            }
+
+            bench.run( "pointRead", StorageBenchmark::kRead, numThreads, opsPerThread,
+                       ops.op( &SortedDataBenchmark::pointRead ) );
+            bench.run( "rangeScan", StorageBenchmark::kRead, numThreads, opsPerThread / 10,
+                       ops.op( &SortedDataBenchmark::rangeScan ) );
+            bench.run( "saveRestore", StorageBenchmark::kRead, numThreads, opsPerThread,
+                       ops.op( &SortedDataBenchmark::saveRestore ) );
+        }
+    }
+
+#endif
+
+} // namespace mongo
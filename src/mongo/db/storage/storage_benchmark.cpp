@@ -0,0 +1,154 @@
+// storage_benchmark.cpp
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/storage_benchmark.h"
+
+#include <algorithm>
+#include <boost/ref.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/barrier.hpp>
+#include <boost/thread/locks.hpp>
+#include <boost/thread/thread.hpp>
+#include <vector>
+
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/util/latency_histogram.h"
+#include "mongo/util/log.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+    StorageBenchmark::StorageBenchmark(const std::string& suite,
+                                       bool supportsDocLocking,
+                                       const OperationContextFactory& newOperationContext)
+        : _suite(suite),
+          _supportsDocLocking(supportsDocLocking),
+          _newOperationContext(newOperationContext) {
+    }
+
+    BSONObj StorageBenchmark::run(const std::string& phase,
+                                  OpType type,
+                                  int numThreads,
+                                  int64_t opsPerThread,
+                                  const Op& op) {
+        invariant(numThreads > 0);
+
+        std::vector<LatencyHistogram> latencies(numThreads);
+        std::vector<int64_t> writeConflicts(numThreads);
+
+        // Every thread sets up its OperationContext before the clock starts
+        boost::barrier start(numThreads + 1);
+        boost::thread_group threads;
+        for (int t = 0; t < numThreads; t++) {
+            threads.create_thread(stdx::bind(&StorageBenchmark::_runThread, this,
+                                             type, t, opsPerThread, boost::cref(op), &start,
+                                             &latencies[t], &writeConflicts[t]));
+        }
+
+        start.wait();
+        Timer timer;
+        threads.join_all();
+        const long long micros = std::max(timer.micros(), 1LL);
+
+        LatencyHistogram total;
+        int64_t totalWriteConflicts = 0;
+        for (int t = 0; t < numThreads; t++) {
+            total.merge(latencies[t]);
+            totalWriteConflicts += writeConflicts[t];
+        }
+
+        // Latencies are recorded in nanoseconds, as many operations take under a microsecond
+        BSONObjBuilder result;
+        result.append("suite", _suite);
+        result.append("phase", phase);
+        result.append("threads", numThreads);
+        result.append("ops", static_cast<double>(total.count()));
+        result.append("seconds", micros / (1000.0 * 1000.0));
+        result.append("opsPerSecond", total.count() * 1000.0 * 1000.0 / micros);
+        result.append("meanMicros", total.mean() / 1000);
+        result.append("p50Micros", total.valueAtPercentile(50) / 1000.0);
+        result.append("p99Micros", total.valueAtPercentile(99) / 1000.0);
+        result.append("p999Micros", total.valueAtPercentile(99.9) / 1000.0);
+        result.append("maxMicros", total.max() / 1000.0);
+        result.append("writeConflicts", static_cast<double>(totalWriteConflicts));
+        BSONObj obj = result.obj();
+
+        log() << "storage benchmark: " << obj.jsonString(Strict);
+        return obj;
+    }
+
+    void StorageBenchmark::_runThread(OpType type,
+                                      int thread,
+                                      int64_t numOps,
+                                      const Op& op,
+                                      boost::barrier* start,
+                                      LatencyHistogram* latencies,
+                                      int64_t* writeConflicts) {
+        boost::scoped_ptr<OperationContext> txn(_newOperationContext());
+        start->wait();
+
+        for (int64_t i = 0; i < numOps; i++) {
+            Timer timer;
+            while (true) {
+                try {
+                    _runOp(type, op, txn.get(), thread, i);
+                    break;
+                }
+                catch (const WriteConflictException&) {
+                    (*writeConflicts)++;
+                }
+            }
+            latencies->record(timer.nanos());
+        }
+    }
+
+    void StorageBenchmark::_runOp(OpType type,
+                                  const Op& op,
+                                  OperationContext* txn,
+                                  int thread,
+                                  int64_t i) {
+        if (_supportsDocLocking) {
+            op(txn, thread, i);
+        }
+        else if (type == kWrite) {
+            boost::unique_lock<boost::shared_mutex> lk(_collectionLock);
+            op(txn, thread, i);
+        }
+        else {
+            boost::shared_lock<boost::shared_mutex> lk(_collectionLock);
+            op(txn, thread, i);
+        }
+    }
+
+} // namespace mongo
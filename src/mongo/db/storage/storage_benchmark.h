@@ -0,0 +1,112 @@
+// storage_benchmark.h
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <boost/thread/shared_mutex.hpp>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/platform/cstdint.h"
+#include "mongo/stdx/functional.h"
+
+namespace boost {
+    class barrier;
+} // namespace boost
+
+namespace mongo {
+
+    class LatencyHistogram;
+    class OperationContext;
+
+    /**
+     * Runs the phases of a storage engine microbenchmark.  Each phase performs a number of
+     * operations on each of one or more threads, and its throughput and latency percentiles are
+     * reported as one line of JSON in the log:
+     *
+     *   storage benchmark: { "suite" : "RecordStore", "phase" : "insert", "threads" : 4, ... }
+     *
+     * The RecordStore and SortedDataInterface test harnesses use this to measure each engine
+     * with the same workload.  They are linked into one test binary per engine, so the binary
+     * identifies the engine the results are for.
+     *
+     * For engines without document-level locking, operations are serialized as a collection
+     * lock would: writes run alone, and reads share access with other reads.
+     */
+    class StorageBenchmark {
+        MONGO_DISALLOW_COPYING(StorageBenchmark);
+    public:
+        enum OpType { kRead, kWrite };
+
+        static const int kMaxThreads = 8;
+
+        typedef stdx::function<OperationContext* ()> OperationContextFactory;
+
+        /**
+         * Performs operation 'i' on behalf of 'thread', using that thread's 'txn'.  Operations
+         * which throw a WriteConflictException are retried, and the retries count towards the
+         * operation's latency.
+         */
+        typedef stdx::function<void (OperationContext* txn, int thread, int64_t i)> Op;
+
+        StorageBenchmark(const std::string& suite,
+                         bool supportsDocLocking,
+                         const OperationContextFactory& newOperationContext);
+
+        /**
+         * Runs 'opsPerThread' operations on each of 'numThreads' threads, each with its own
+         * OperationContext.  Returns the results, which are also logged.
+         */
+        BSONObj run(const std::string& phase,
+                    OpType type,
+                    int numThreads,
+                    int64_t opsPerThread,
+                    const Op& op);
+
+    private:
+        void _runThread(OpType type,
+                        int thread,
+                        int64_t numOps,
+                        const Op& op,
+                        boost::barrier* start,
+                        LatencyHistogram* latencies,
+                        int64_t* writeConflicts);
+
+        void _runOp(OpType type, const Op& op, OperationContext* txn, int thread, int64_t i);
+
+        const std::string _suite;
+        const bool _supportsDocLocking;
+        const OperationContextFactory _newOperationContext;
+
+        // Stands in for the collection lock for engines without document-level locking
+        boost::shared_mutex _collectionLock;
+    };
+
+} // namespace mongo
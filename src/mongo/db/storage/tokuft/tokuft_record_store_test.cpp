@@ -64,6 +64,10 @@ namespace mongo {
 	    return _engine->newRecoveryUnit();
 	}
 
+        virtual bool supportsDocLocking() const {
+            return _engine->supportsDocLocking();
+        }
+
     private:
         std::auto_ptr<KVHarnessHelper> _kvHarness;
         KVEngine *_engine;
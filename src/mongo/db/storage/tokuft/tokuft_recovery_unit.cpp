@@ -155,6 +155,23 @@ namespace mongo {
         return SnapshotId(_txn.id());
     }
 
+    bool TokuFTRecoveryUnit::prepareForReuse() {
+        if (_depth > 0 || !_changes.empty()) {
+            return false;
+        }
+
+        // Reads leave their snapshot txn open until the recovery unit goes away. Drop it so the
+        // next operation gets a fresh snapshot, with the isolation its own locks call for.
+        _txn = ftcxx::DBTxn();
+        _rollbackWritesDisabled = false;
+        setLowestInvisible(RecordId());
+
+        // The cached member state must not outlast a state transition, and the next operation may
+        // come after one.
+        _knowsAboutReplicationState = false;
+        return true;
+    }
+
     bool TokuFTRecoveryUnit::_opCtxIsWriting(OperationContext *opCtx) {
         const Locker *state = opCtx->lockState();
         invariant(state != NULL);
@@ -79,6 +79,8 @@ namespace mongo {
 
         SnapshotId getSnapshotId() const;
 
+        bool prepareForReuse();
+
     private:
         typedef boost::shared_ptr<Change> ChangePtr;
         typedef std::vector<ChangePtr> Changes;
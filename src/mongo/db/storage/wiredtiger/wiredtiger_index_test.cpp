@@ -90,6 +90,8 @@ namespace mongo {
             return new WiredTigerRecoveryUnit( _sessionCache );
         }
 
+        virtual bool supportsDocLocking() const { return true; }
+
     private:
         unittest::TempDir _dbpath;
         WT_CONNECTION* _conn;
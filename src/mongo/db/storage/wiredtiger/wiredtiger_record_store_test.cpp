@@ -138,6 +138,8 @@ namespace mongo {
             return new WiredTigerRecoveryUnit( _sessionCache );
         }
 
+        virtual bool supportsDocLocking() const { return true; }
+
         WT_CONNECTION* conn() const { return _conn; }
 
     private:
@@ -119,6 +119,58 @@ namespace mongo {
         }
     } myall;
 
+    /** Records the batches removeRange reports. */
+    class CountingThrottle : public Helpers::RemoveRangeThrottle {
+    public:
+        explicit CountingThrottle( int batchSize ) :
+            _batchSize( batchSize ), numBatches( 0 ), numDocs( 0 ), numBytes( 0 ) {
+        }
+
+        virtual int batchSize() { return _batchSize; }
+
+        virtual void batchDeleted( OperationContext* txn, long long docs, long long bytes ) {
+            ASSERT_LESS_THAN_OR_EQUALS( docs, _batchSize );
+            numBatches++;
+            numDocs += docs;
+            numBytes += bytes;
+        }
+
+    private:
+        const int _batchSize;
+
+    public:
+        int numBatches;
+        long long numDocs;
+        long long numBytes;
+    };
+
+    TEST(DBHelperTests, RemoveRangeInBatches) {
+        const char* const batchNs = "unittests.removebatchtests";
+
+        OperationContextImpl txn;
+        DBDirectClient client(&txn);
+        client.dropCollection( batchNs );
+
+        for ( int i = 0; i < 20; ++i ) {
+            client.insert( batchNs, BSON( "_id" << i ) );
+        }
+
+        CountingThrottle throttle( 3 );
+        KeyRange range( batchNs, BSON( "_id" << 2 ), BSON( "_id" << 13 ), BSON( "_id" << 1 ) );
+        WriteConcernOptions dummyWriteConcern;
+        long long numDeleted = Helpers::removeRange( &txn, range, false, dummyWriteConcern,
+                                                     NULL, false, false, &throttle );
+
+        // 11 documents in batches of 3, 3, 3 and 2
+        ASSERT_EQUALS( 11, numDeleted );
+        ASSERT_EQUALS( 11, throttle.numDocs );
+        ASSERT_EQUALS( 4, throttle.numBatches );
+        ASSERT_EQUALS( 11 * BSON( "_id" << 0 ).objsize(), throttle.numBytes );
+
+        ASSERT_EQUALS( 9U, client.count( batchNs ) );
+        ASSERT_EQUALS( 0U, client.count( batchNs, BSON( "_id" << GTE << 2 << LT << 13 ) ) );
+    }
+
     //
     // Tests getting disk locs for an index range
     //
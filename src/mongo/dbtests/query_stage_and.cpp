@@ -262,6 +262,165 @@ namespace QueryStageAnd {
         }
     };
 
+    /**
+     * Same as QueryStageAndHashInvalidation, but with the AND holding only RecordIds.  The
+     * invalidated RecordId should still be fetched and flagged.
+     */
+    class QueryStageAndHashRecordIdsOnlyInvalidation : public QueryStageAndBase {
+    public:
+        void run() {
+            OldClientWriteContext ctx(&_txn, ns());
+            Database* db = ctx.db();
+            Collection* coll = ctx.getCollection();
+            if (!coll) {
+                WriteUnitOfWork wuow(&_txn);
+                coll = db->createCollection(&_txn, ns());
+                wuow.commit();
+            }
+
+            for (int i = 0; i < 50; ++i) {
+                insert(BSON("foo" << i << "bar" << i));
+            }
+
+            addIndex(BSON("foo" << 1));
+            addIndex(BSON("bar" << 1));
+
+            WorkingSet ws;
+            scoped_ptr<AndHashStage> ah(new AndHashStage(&ws, NULL, coll));
+
+            // Foo <= 20
+            IndexScanParams params;
+            params.descriptor = getIndex(BSON("foo" << 1), coll);
+            params.bounds.isSimpleRange = true;
+            params.bounds.startKey = BSON("" << 20);
+            params.bounds.endKey = BSONObj();
+            params.bounds.endKeyInclusive = true;
+            params.direction = -1;
+            ah->addChild(new IndexScan(&_txn, params, &ws, NULL));
+
+            // Bar >= 10
+            params.descriptor = getIndex(BSON("bar" << 1), coll);
+            params.bounds.startKey = BSON("" << 10);
+            params.bounds.endKey = BSONObj();
+            params.bounds.endKeyInclusive = true;
+            params.direction = 1;
+            ah->addChild(new IndexScan(&_txn, params, &ws, NULL));
+
+            ah->setRecordIdsOnly();
+
+            // Read foo=20, ..., foo=12 into the bitmap.
+            for (int i = 0; i < 10; ++i) {
+                WorkingSetID out;
+                PlanStage::StageState status = ah->work(&out);
+                ASSERT_EQUALS(PlanStage::NEED_TIME, status);
+            }
+
+            ah->saveState();
+            set<RecordId> data;
+            getLocs(&data, coll);
+            for (set<RecordId>::const_iterator it = data.begin(); it != data.end(); ++it) {
+                if (coll->docFor(&_txn, *it).value()["foo"].numberInt() == 15) {
+                    ah->invalidate(&_txn, *it, INVALIDATION_DELETION);
+                    remove(coll->docFor(&_txn, *it).value());
+                    break;
+                }
+            }
+            ah->restoreState(&_txn);
+
+            const unordered_set<WorkingSetID>& flagged = ws.getFlagged();
+            ASSERT_EQUALS(size_t(1), flagged.size());
+
+            WorkingSetMember* member = ws.get(*flagged.begin());
+            ASSERT_TRUE(NULL != member);
+            ASSERT_EQUALS(WorkingSetMember::OWNED_OBJ, member->state);
+            BSONElement elt;
+            ASSERT_TRUE(member->getFieldDotted("foo", &elt));
+            ASSERT_EQUALS(15, elt.numberInt());
+
+            // The results come from the last child, so they only have bar's index data.
+            int count = 0;
+            while (!ah->isEOF()) {
+                WorkingSetID id = WorkingSet::INVALID_ID;
+                PlanStage::StageState status = ah->work(&id);
+                if (PlanStage::ADVANCED != status) { continue; }
+
+                ++count;
+                member = ws.get(id);
+                ASSERT_TRUE(member->hasLoc());
+
+                ASSERT_TRUE(member->getFieldDotted("bar", &elt));
+                ASSERT_GREATER_THAN_OR_EQUALS(elt.numberInt(), 10);
+                ASSERT_LESS_THAN_OR_EQUALS(elt.numberInt(), 20);
+                ASSERT_NOT_EQUALS(15, elt.numberInt());
+            }
+
+            ASSERT_EQUALS(10, count);
+        }
+    };
+
+    // An AND with three children holding only RecordIds, fetched by its parent.
+    class QueryStageAndHashRecordIdsOnlyThreeLeaf : public QueryStageAndBase {
+    public:
+        void run() {
+            OldClientWriteContext ctx(&_txn, ns());
+            Database* db = ctx.db();
+            Collection* coll = ctx.getCollection();
+            if (!coll) {
+                WriteUnitOfWork wuow(&_txn);
+                coll = db->createCollection(&_txn, ns());
+                wuow.commit();
+            }
+
+            for (int i = 0; i < 50; ++i) {
+                insert(BSON("foo" << i << "bar" << i << "baz" << i));
+            }
+
+            addIndex(BSON("foo" << 1));
+            addIndex(BSON("bar" << 1));
+            addIndex(BSON("baz" << 1));
+
+            WorkingSet ws;
+            AndHashStage* ah = new AndHashStage(&ws, NULL, coll);
+
+            // Foo <= 20
+            IndexScanParams params;
+            params.descriptor = getIndex(BSON("foo" << 1), coll);
+            params.bounds.isSimpleRange = true;
+            params.bounds.startKey = BSON("" << 20);
+            params.bounds.endKey = BSONObj();
+            params.bounds.endKeyInclusive = true;
+            params.direction = -1;
+            ah->addChild(new IndexScan(&_txn, params, &ws, NULL));
+
+            // Bar >= 10
+            params.descriptor = getIndex(BSON("bar" << 1), coll);
+            params.bounds.startKey = BSON("" << 10);
+            params.bounds.endKey = BSONObj();
+            params.bounds.endKeyInclusive = true;
+            params.direction = 1;
+            ah->addChild(new IndexScan(&_txn, params, &ws, NULL));
+
+            // 5 <= baz <= 15
+            params.descriptor = getIndex(BSON("baz" << 1), coll);
+            params.bounds.startKey = BSON("" << 5);
+            params.bounds.endKey = BSON("" << 15);
+            params.bounds.endKeyInclusive = true;
+            params.direction = 1;
+            ah->addChild(new IndexScan(&_txn, params, &ws, NULL));
+
+            ah->setRecordIdsOnly();
+            scoped_ptr<FetchStage> fetch(new FetchStage(&_txn, &ws, ah, NULL, coll));
+
+            // foo == 10, 11, 12, 13, 14, 15, in the order of the last child.
+            for (int i = 10; i <= 15; ++i) {
+                BSONObj obj = getNext(fetch.get(), &ws);
+                ASSERT_EQUALS(i, obj["foo"].numberInt());
+                ASSERT_EQUALS(i, obj["baz"].numberInt());
+            }
+            ASSERT_EQUALS(0, countResults(fetch.get()));
+        }
+    };
+
     // Invalidate one of the "are we EOF?" lookahead results.
     class QueryStageAndHashInvalidateLookahead : public QueryStageAndBase {
     public:
@@ -1399,6 +1558,8 @@ namespace QueryStageAnd {
 
         void setupTests() {
             add<QueryStageAndHashInvalidation>();
+            add<QueryStageAndHashRecordIdsOnlyInvalidation>();
+            add<QueryStageAndHashRecordIdsOnlyThreeLeaf>();
             add<QueryStageAndHashTwoLeaf>();
             add<QueryStageAndHashTwoLeafFirstChildLargeKeys>();
             add<QueryStageAndHashTwoLeafLastChildLargeKeys>();
@@ -28,6 +28,8 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
+
 #include "mongo/db/client.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/exec/index_scan.h"
@@ -35,6 +37,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/json.h"
 #include "mongo/db/operation_context_impl.h"
+#include "mongo/db/query/index_bounds_builder.h"
 #include "mongo/dbtests/dbtests.h"
 
 namespace QueryStageIxscan {
@@ -308,6 +311,220 @@ namespace QueryStageIxscan {
         }
     };
 
+    /**
+     * Scans a compound index holding values of many types and checks that the keys returned for
+     * a set of bounds are exactly those IndexBoundsChecker::isValidKey() accepts, in index order.
+     *
+     * On engines whose cursors expose the encoded KeyString, IndexScan accepts most of these keys
+     * by comparing them to encoded interval ends, so this checks that path against the BSON one.
+     */
+    class IndexScanBoundsTest : public IndexScanTest {
+    public:
+        virtual void setup() {
+            IndexScanTest::setup();
+
+            {
+                WriteUnitOfWork wunit(&_txn);
+                ASSERT_OK(_coll->getIndexCatalog()->createIndexOnEmptyCollection(
+                            &_txn,
+                            BSON("ns" << ns()
+                              << "key" << keyPattern()
+                              << "name" << DBClientBase::genIndexName(keyPattern()))));
+                wunit.commit();
+            }
+
+            BSONObj aValues = BSON_ARRAY(BSONNULL << 1 << 2.5 << "x" << "y"
+                                         << BSON("o" << 1) << true);
+            BSONObj bValues = BSON_ARRAY(BSONNULL << -1 << 0 << 3LL << 4.5 << "a" << "b" << "c"
+                                         << BSON("o" << 1) << false);
+
+            int id = 0;
+            BSONObjIterator aIt(aValues);
+            while (aIt.more()) {
+                BSONElement a = aIt.next();
+                BSONObjIterator bIt(bValues);
+                while (bIt.more()) {
+                    BSONElement b = bIt.next();
+
+                    BSONObjBuilder doc;
+                    doc.append("_id", id++);
+                    doc.appendAs(a, "a");
+                    doc.appendAs(b, "b");
+                    insert(doc.obj());
+
+                    BSONObjBuilder key;
+                    key.appendAs(a, "");
+                    key.appendAs(b, "");
+                    _keys.push_back(key.obj());
+                }
+            }
+        }
+
+        static BSONObj keyPattern() { return BSON("a" << 1 << "b" << -1); }
+
+        /**
+         * 'bounds' lists the intervals of each field in ascending order.  Scans in both directions.
+         */
+        void checkBounds(const IndexBounds& bounds) {
+            for (int direction = 1; direction >= -1; direction -= 2) {
+                IndexScanParams params;
+                params.descriptor =
+                    _coll->getIndexCatalog()->findIndexByKeyPattern(&_txn, keyPattern());
+                invariant(params.descriptor);
+                params.bounds = bounds;
+                params.direction = direction;
+                IndexBoundsBuilder::alignBounds(&params.bounds, keyPattern(), direction);
+
+                IndexBoundsChecker checker(&params.bounds, keyPattern(), direction);
+                std::vector<BSONObj> expected;
+                for (size_t i = 0; i < _keys.size(); ++i) {
+                    if (checker.isValidKey(_keys[i])) {
+                        expected.push_back(_keys[i]);
+                    }
+                }
+                std::sort(expected.begin(), expected.end(), KeyOrder(direction));
+
+                IndexScan ixscan(&_txn, params, &_ws, NULL);
+                std::vector<BSONObj> actual;
+                WorkingSetID out;
+                PlanStage::StageState state = PlanStage::NEED_TIME;
+                while (PlanStage::IS_EOF != state) {
+                    state = ixscan.work(&out);
+                    ASSERT_NE(PlanStage::DEAD, state);
+                    ASSERT_NE(PlanStage::FAILURE, state);
+                    if (PlanStage::ADVANCED == state) {
+                        actual.push_back(_ws.get(out)->keyData[0].keyData.getOwned());
+                        _ws.free(out);
+                    }
+                }
+
+                ASSERT_EQUALS(expected.size(), actual.size());
+                for (size_t i = 0; i < expected.size(); ++i) {
+                    ASSERT_EQUALS(expected[i], actual[i]);
+                }
+            }
+        }
+
+    private:
+        struct KeyOrder {
+            explicit KeyOrder(int direction) : direction(direction) { }
+            bool operator()(const BSONObj& lhs, const BSONObj& rhs) const {
+                return direction * lhs.woCompare(rhs, keyPattern(), false) < 0;
+            }
+            int direction;
+        };
+
+        std::vector<BSONObj> _keys;
+    };
+
+    // Bounds where the keys in the current intervals are contiguous in the index: points on 'a'
+    // followed by a range on 'b', a range on 'a' followed by all values of 'b', or only points.
+    class QueryStageIxscanContiguousBounds : public IndexScanBoundsTest {
+    public:
+        void run() {
+            setup();
+
+            {
+                IndexBounds bounds;
+                OrderedIntervalList a("a");
+                a.intervals.push_back(Interval(BSON("" << 1 << "" << 1), true, true));
+                a.intervals.push_back(Interval(BSON("" << "x" << "" << "x"), true, true));
+                OrderedIntervalList b("b");
+                b.intervals.push_back(Interval(BSON("" << 0 << "" << "b"), false, true));
+                bounds.fields.push_back(a);
+                bounds.fields.push_back(b);
+                checkBounds(bounds);
+            }
+
+            {
+                IndexBounds bounds;
+                OrderedIntervalList a("a");
+                a.intervals.push_back(Interval(BSON("" << 1 << "" << 1), true, true));
+                a.intervals.push_back(Interval(BSON("" << "x" << "" << "x"), true, true));
+                OrderedIntervalList b("b");
+                b.intervals.push_back(Interval(BSON("" << MINKEY << "" << MAXKEY), true, true));
+                bounds.fields.push_back(a);
+                bounds.fields.push_back(b);
+                checkBounds(bounds);
+            }
+
+            {
+                IndexBounds bounds;
+                OrderedIntervalList a("a");
+                a.intervals.push_back(Interval(BSON("" << BSONNULL << "" << 1), true, false));
+                a.intervals.push_back(Interval(BSON("" << 2.5 << "" << "y"), false, true));
+                OrderedIntervalList b("b");
+                b.intervals.push_back(Interval(BSON("" << MINKEY << "" << MAXKEY), true, true));
+                bounds.fields.push_back(a);
+                bounds.fields.push_back(b);
+                checkBounds(bounds);
+            }
+
+            {
+                IndexBounds bounds;
+                OrderedIntervalList a("a");
+                a.intervals.push_back(Interval(BSON("" << 2.5 << "" << 2.5), true, true));
+                a.intervals.push_back(Interval(BSON("" << "y" << "" << "y"), true, true));
+                OrderedIntervalList b("b");
+                b.intervals.push_back(Interval(BSON("" << BSONNULL << "" << 0), true, false));
+                b.intervals.push_back(Interval(BSON("" << "a" << "" << BSON("o" << 1)),
+                                               false, false));
+                bounds.fields.push_back(a);
+                bounds.fields.push_back(b);
+                checkBounds(bounds);
+            }
+
+            {
+                IndexBounds bounds;
+                OrderedIntervalList a("a");
+                a.intervals.push_back(Interval(BSON("" << 1 << "" << 1), true, true));
+                a.intervals.push_back(Interval(BSON("" << true << "" << true), true, true));
+                OrderedIntervalList b("b");
+                b.intervals.push_back(Interval(BSON("" << -1 << "" << -1), true, true));
+                b.intervals.push_back(Interval(BSON("" << "a" << "" << "a"), true, true));
+                b.intervals.push_back(Interval(BSON("" << BSON("o" << 1) << "" << BSON("o" << 1)),
+                                               true, true));
+                bounds.fields.push_back(a);
+                bounds.fields.push_back(b);
+                checkBounds(bounds);
+            }
+        }
+    };
+
+    // Bounds where the keys in the current intervals are interleaved with keys outside of them,
+    // so every key has to be checked.
+    class QueryStageIxscanNonContiguousBounds : public IndexScanBoundsTest {
+    public:
+        void run() {
+            setup();
+
+            {
+                IndexBounds bounds;
+                OrderedIntervalList a("a");
+                a.intervals.push_back(Interval(BSON("" << 1 << "" << "x"), false, false));
+                a.intervals.push_back(Interval(BSON("" << true << "" << true), true, true));
+                OrderedIntervalList b("b");
+                b.intervals.push_back(Interval(BSON("" << -1 << "" << "c"), false, false));
+                bounds.fields.push_back(a);
+                bounds.fields.push_back(b);
+                checkBounds(bounds);
+            }
+
+            {
+                IndexBounds bounds;
+                OrderedIntervalList a("a");
+                a.intervals.push_back(Interval(BSON("" << MINKEY << "" << 1), true, true));
+                a.intervals.push_back(Interval(BSON("" << "y" << "" << MAXKEY), true, true));
+                OrderedIntervalList b("b");
+                b.intervals.push_back(Interval(BSON("" << "b" << "" << "b"), true, true));
+                b.intervals.push_back(Interval(BSON("" << false << "" << false), true, true));
+                bounds.fields.push_back(a);
+                bounds.fields.push_back(b);
+                checkBounds(bounds);
+            }
+        }
+    };
+
     class All : public Suite {
     public:
         All() : Suite("query_stage_ixscan") {}
@@ -318,6 +535,8 @@ namespace QueryStageIxscan {
             add<QueryStageIxscanInsertDuringSaveExclusive>();
             add<QueryStageIxscanInsertDuringSaveExclusive2>();
             add<QueryStageIxscanInsertDuringSaveReverse>();
+            add<QueryStageIxscanContiguousBounds>();
+            add<QueryStageIxscanNonContiguousBounds>();
         }
     } QueryStageIxscanAll;
 
@@ -37,7 +37,9 @@
 #include "mongo/base/owned_pointer_map.h"
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/namespace_string.h"
 #include "mongo/db/server_options.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/db/write_concern_options.h"
 #include "mongo/s/catalog/catalog_manager.h"
@@ -73,6 +75,22 @@ namespace mongo {
 
     MONGO_FP_DECLARE(skipBalanceRound);
 
+    // Balance by chunk data size and shard operation rate (BalancerPolicy::balanceByLoad)
+    // rather than by chunk counts
+    MONGO_EXPORT_SERVER_PARAMETER(balancerLoadAware, bool, false);
+
+    // With balancerLoadAware, the most non-conflicting migrations to run per collection per round
+    MONGO_EXPORT_SERVER_PARAMETER(balancerMaxMigrationsPerCollection, int, 4);
+
+    namespace {
+        // Bounds the dataSize commands a round issues, over all collections.  Chunks left
+        // unmeasured use the collection's average chunk size on their shard until a later round.
+        const int kMaxChunkSizeEstimatesPerRound = 100;
+
+        // Chunk size estimates older than this are refreshed when the budget allows
+        const time_t kChunkSizeEstimateTTLSecs = 10 * 60;
+    }
+
     Balancer balancer;
 
     Balancer::Balancer()
@@ -199,6 +217,124 @@ namespace mongo {
                         NULL);
     }
 
+    void Balancer::_sampleOpRates( const ShardInfoMap& shardInfo, OpRateMap* opRates ) {
+        for ( ShardInfoMap::const_iterator i = shardInfo.begin(); i != shardInfo.end(); ++i ) {
+            const string& shard = i->first;
+
+            map<string, long long> counts;
+            try {
+                Shard::getShardOpCounts( Shard::make( shard ).getConnString(), &counts );
+            }
+            catch ( const DBException& ex ) {
+                warning() << "could not read operation counters of " << shard << causedBy( ex );
+                _opCountSamples.erase( shard );
+                continue;
+            }
+
+            const unsigned long long now = curTimeMillis64();
+
+            map<string, OpCountSample>::const_iterator last = _opCountSamples.find( shard );
+            if ( last != _opCountSamples.end() && now > last->second.millis ) {
+                const double elapsedSecs = ( now - last->second.millis ) / 1000.0;
+                for ( map<string, long long>::const_iterator c = counts.begin();
+                      c != counts.end();
+                      ++c ) {
+                    map<string, long long>::const_iterator before =
+                        last->second.counts.find( c->first );
+                    if ( before != last->second.counts.end() && c->second >= before->second ) {
+                        (*opRates)[c->first][shard] =
+                            ( c->second - before->second ) / elapsedSecs;
+                    }
+                }
+            }
+
+            OpCountSample& sample = _opCountSamples[shard];
+            sample.counts.swap( counts );
+            sample.millis = now;
+        }
+    }
+
+    void Balancer::_estimateChunkSizes( const string& ns,
+                                        const ShardKeyPattern& keyPattern,
+                                        const ShardToChunksMap& shardToChunksMap,
+                                        DistributionStatus* status,
+                                        int* estimatesLeft ) {
+        const NamespaceString nss( ns );
+        const time_t now = time( 0 );
+
+        ChunkSizeMap& cached = _chunkSizes[ns];
+        ChunkSizeMap current;
+
+        for ( ShardToChunksMap::const_iterator i = shardToChunksMap.begin();
+              i != shardToChunksMap.end();
+              ++i ) {
+
+            const vector<ChunkType*>& chunks = i->second->vector();
+            if ( chunks.empty() )
+                continue;
+
+            try {
+                ScopedDbConnection conn( Shard::make( i->first ).getConnString(), 30 );
+
+                long long averageSize = 0;
+                BSONObj collStats;
+                if ( conn->runCommand( nss.db().toString(),
+                                       BSON( "collStats" << nss.coll() ),
+                                       collStats ) ) {
+                    averageSize = collStats["size"].numberLong() / chunks.size();
+                }
+
+                for ( unsigned j = 0; j < chunks.size(); j++ ) {
+                    const ChunkType& chunk = *chunks[j];
+
+                    ChunkSizeMap::const_iterator last = cached.find( chunk.getMin() );
+                    bool known = last != cached.end() &&
+                                 last->second.max.woCompare( chunk.getMax() ) == 0;
+
+                    ChunkSizeSample sample;
+                    if ( known )
+                        sample = last->second;
+
+                    if ( ( !known || now - sample.taken >= kChunkSizeEstimateTTLSecs ) &&
+                         *estimatesLeft > 0 ) {
+                        (*estimatesLeft)--;
+
+                        BSONObj res;
+                        if ( conn->runCommand( nss.db().toString(),
+                                               BSON( "dataSize" << ns
+                                                     << "keyPattern" << keyPattern.toBSON()
+                                                     << "min" << chunk.getMin()
+                                                     << "max" << chunk.getMax()
+                                                     << "estimate" << true ),
+                                               res ) ) {
+                            sample.max = chunk.getMax().getOwned();
+                            sample.bytes = res["size"].numberLong();
+                            sample.taken = now;
+                            known = true;
+                        }
+                    }
+
+                    if ( known ) {
+                        current[chunk.getMin().getOwned()] = sample;
+                        status->setChunkDataSize( chunk.getMin(), sample.bytes );
+                    }
+                    else {
+                        status->setChunkDataSize( chunk.getMin(), averageSize );
+                    }
+                }
+
+                conn.done();
+            }
+            catch ( const DBException& ex ) {
+                warning() << "could not estimate chunk sizes of " << ns << " on " << i->first
+                          << causedBy( ex );
+            }
+        }
+
+        // Drop the estimates of chunks which have since been split, merged or removed
+        cached.swap( current );
+    }
+
      /* 
      * Builds the details object for the actionlog.
      * Current formats for detail are:
@@ -398,6 +534,14 @@ namespace mongo {
         
         OCCASIONALLY warnOnMultiVersion( shardInfo );
 
+        // Operation rates by namespace and shard, and what is left of the round's dataSize budget
+        OpRateMap opRates;
+        int chunkSizeEstimatesLeft = kMaxChunkSizeEstimatesPerRound;
+
+        if ( balancerLoadAware ) {
+            _sampleOpRates( shardInfo, &opRates );
+        }
+
         //
         // 3. For each collection, check if the balancing policy recommends moving anything around.
         //
@@ -519,6 +663,38 @@ namespace mongo {
                 continue;
             }
 
+            if ( balancerLoadAware ) {
+                _estimateChunkSizes( ns,
+                                     cm->getShardKeyPattern(),
+                                     shardToChunksMap.map(),
+                                     &status,
+                                     &chunkSizeEstimatesLeft );
+
+                // Only this collection's own traffic counts towards its shards' loads
+                OpRateMap::const_iterator nsRates = opRates.find( ns );
+                if ( nsRates != opRates.end() ) {
+                    for ( map<string, double>::const_iterator r = nsRates->second.begin();
+                          r != nsRates->second.end();
+                          ++r ) {
+                        status.setOpsPerSec( r->first, r->second );
+                    }
+                }
+
+                BalancerPolicy::LoadOptions options;
+                options.maxMigrations = balancerMaxMigrationsPerCollection;
+
+                OwnedPointerVector<MigrateInfo> migrations;
+                _policy->balanceByLoad( ns, status, options, &migrations );
+
+                // The migrations involve distinct shards, so they run one after the other
+                // without invalidating each other
+                vector<MigrateInfo*> released = migrations.release();
+                for ( unsigned i = 0; i < released.size(); i++ ) {
+                    candidateChunks->push_back( CandidateChunkPtr( released[i] ) );
+                }
+                continue;
+            }
+
             CandidateChunk* p = _policy->balance( ns, status, _balancedLastTime );
             if ( p ) candidateChunks->push_back( CandidateChunkPtr( p ) );
         }
@@ -32,6 +32,8 @@
 
 #include <boost/scoped_ptr.hpp>
 #include <boost/shared_ptr.hpp>
+#include <map>
+#include <string>
 
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/s/balancer_policy.h"
@@ -39,6 +41,7 @@
 
 namespace mongo {
 
+    class ShardKeyPattern;
     struct WriteConcernOptions;
 
     /**
@@ -76,6 +79,25 @@ namespace mongo {
 
         // decide which chunks to move; owned here.
         boost::scoped_ptr<BalancerPolicy> _policy;
+
+        // last per-namespace operation counts read from each shard, to derive operation rates
+        struct OpCountSample {
+            std::map<std::string, long long> counts;
+            unsigned long long millis;
+        };
+        std::map<std::string, OpCountSample> _opCountSamples;
+
+        // operations per second, by namespace and then shard
+        typedef std::map<std::string, std::map<std::string, double> > OpRateMap;
+
+        // chunk data size estimates by namespace and chunk min, reused across rounds
+        struct ChunkSizeSample {
+            BSONObj max;
+            long long bytes;
+            time_t taken;
+        };
+        typedef std::map<BSONObj, ChunkSizeSample> ChunkSizeMap;
+        std::map<std::string, ChunkSizeMap> _chunkSizes;
         
         /**
          * Checks that the balancer can connect to all servers it needs to do its job.
@@ -95,6 +117,25 @@ namespace mongo {
          */
         void _doBalanceRound( DBClientBase& conn, std::vector<CandidateChunkPtr>* candidateChunks );
 
+        /**
+         * Fills 'opRates' with the rate of operations each shard in 'shardInfo' has served on
+         * each namespace, from the change in its counts since the previous call.  Shards seen
+         * for the first time have no rates yet.
+         */
+        void _sampleOpRates( const ShardInfoMap& shardInfo, OpRateMap* opRates );
+
+        /**
+         * Records an estimated data size for every chunk of 'ns' in 'status'.  Stale or unknown
+         * chunks are measured with the dataSize command while '*estimatesLeft', which is shared
+         * by all collections of the round, lasts; the others use the last measurement, or the
+         * average chunk size of the collection on their shard.
+         */
+        void _estimateChunkSizes( const std::string& ns,
+                                  const ShardKeyPattern& keyPattern,
+                                  const ShardToChunksMap& shardToChunksMap,
+                                  DistributionStatus* status,
+                                  int* estimatesLeft );
+
         /**
          * Issues chunk migration request, one at a time.
          *
@@ -32,6 +32,7 @@
 #include "mongo/platform/basic.h"
 
 #include <algorithm>
+#include <cmath>
 
 #include "mongo/client/connpool.h"
 #include "mongo/s/balancer_policy.h"
@@ -59,7 +60,7 @@ namespace mongo {
 
     DistributionStatus::DistributionStatus( const ShardInfoMap& shardInfo,
                                             const ShardToChunksMap& shardToChunksMap )
-        : _shardInfo( shardInfo ), _shardChunks( shardToChunksMap ) {
+        : _shardInfo( shardInfo ), _shardChunks( shardToChunksMap ), _knownChunkDataSize( 0 ) {
 
         for ( ShardInfoMap::const_iterator i = _shardInfo.begin(); i != _shardInfo.end(); ++i ) {
             _shards.insert( i->first );
@@ -72,6 +73,33 @@ namespace mongo {
         return i->second;
     }
 
+    void DistributionStatus::setChunkDataSize( const BSONObj& min, long long bytes ) {
+        long long& size = _chunkDataSizes[min.getOwned()];
+        _knownChunkDataSize += bytes - size;
+        size = bytes;
+    }
+
+    long long DistributionStatus::getChunkDataSize( const ChunkType& chunk ) const {
+        map<BSONObj,long long>::const_iterator i = _chunkDataSizes.find( chunk.getMin() );
+        if ( i != _chunkDataSizes.end() )
+            return i->second;
+
+        if ( _chunkDataSizes.empty() )
+            return 1;
+
+        return std::max( 1LL, _knownChunkDataSize /
+                                  static_cast<long long>( _chunkDataSizes.size() ) );
+    }
+
+    void DistributionStatus::setOpsPerSec( const string& shard, double opsPerSec ) {
+        _opsPerSec[shard] = opsPerSec;
+    }
+
+    double DistributionStatus::getOpsPerSec( const string& shard ) const {
+        map<string,double>::const_iterator i = _opsPerSec.find( shard );
+        return i == _opsPerSec.end() ? 0 : i->second;
+    }
+
     unsigned DistributionStatus::totalChunks() const {
         unsigned total = 0;
 
@@ -345,15 +373,12 @@ namespace mongo {
         return StatusWith<string>(tagRange.getTag());
     }
 
-    MigrateInfo* BalancerPolicy::balance( const string& ns,
-                                          const DistributionStatus& distribution,
-                                          int balancedLastTime ) {
-
+    MigrateInfo* BalancerPolicy::_requiredMigration( const string& ns,
+                                                     const DistributionStatus& distribution ) {
 
         // 1) check for shards that policy require to us to move off of:
         //    draining only
         // 2) check tag policy violations
-        // 3) then we make sure chunks are balanced for each tag
 
         // ----
 
@@ -447,6 +472,18 @@ namespace mongo {
             }
         }
 
+        return NULL;
+    }
+
+    MigrateInfo* BalancerPolicy::balance( const string& ns,
+                                          const DistributionStatus& distribution,
+                                          int balancedLastTime ) {
+
+        // 1) and 2) draining shards and tag violations
+        MigrateInfo* required = _requiredMigration( ns, distribution );
+        if ( required )
+            return required;
+
         // 3) for each tag balance
 
         int threshold = 8;
@@ -529,6 +566,155 @@ namespace mongo {
         return NULL;
     }
 
+    namespace {
+
+        // Per shard state for BalancerPolicy::balanceByLoad
+        struct ShardLoad {
+            ShardLoad() : dataSize( 0 ), load( 0 ), loadPerByte( 0 ), used( false ) {}
+
+            long long dataSize;
+            double load;
+            // load which moves along with each byte of the shard's chunks
+            double loadPerByte;
+            // already part of a suggested migration
+            bool used;
+        };
+
+        typedef map<string, ShardLoad> ShardLoadMap;
+
+    } // namespace
+
+    void BalancerPolicy::balanceByLoad( const string& ns,
+                                        const DistributionStatus& distribution,
+                                        const LoadOptions& options,
+                                        OwnedPointerVector<MigrateInfo>* migrations ) {
+
+        auto_ptr<MigrateInfo> required( _requiredMigration( ns, distribution ) );
+        if ( required.get() ) {
+            migrations->push_back( required.release() );
+            return;
+        }
+
+        const set<string>& shards = distribution.shards();
+        if ( shards.size() < 2 )
+            return;
+
+        ShardLoadMap loads;
+        long long totalData = 0;
+        double totalOps = 0;
+        for ( set<string>::const_iterator i = shards.begin(); i != shards.end(); ++i ) {
+            ShardLoad& shardLoad = loads[*i];
+
+            const vector<ChunkType*>& chunks = distribution.getChunks( *i );
+            for ( unsigned j = 0; j < chunks.size(); j++ )
+                shardLoad.dataSize += distribution.getChunkDataSize( *chunks[j] );
+
+            totalData += shardLoad.dataSize;
+            totalOps += distribution.getOpsPerSec( *i );
+        }
+
+        if ( totalData == 0 )
+            return;
+
+        // Scale data and operations so that the average shard has a load of 1.  Without any
+        // operation counters this is a pure data size balance.
+        const double meanData = static_cast<double>( totalData ) / shards.size();
+        const double meanOps = totalOps / shards.size();
+        const double opsWeight = meanOps > 0 ? options.opsWeight : 0;
+        const double totalWeight = options.dataWeight + opsWeight;
+        if ( totalWeight <= 0 )
+            return;
+
+        for ( ShardLoadMap::iterator i = loads.begin(); i != loads.end(); ++i ) {
+            ShardLoad& shardLoad = i->second;
+
+            double load = options.dataWeight * shardLoad.dataSize / meanData;
+            if ( opsWeight > 0 )
+                load += opsWeight * distribution.getOpsPerSec( i->first ) / meanOps;
+
+            shardLoad.load = load / totalWeight;
+            if ( shardLoad.dataSize > 0 )
+                shardLoad.loadPerByte = shardLoad.load / shardLoad.dataSize;
+        }
+
+        for ( int suggested = 0; suggested < options.maxMigrations; suggested++ ) {
+
+            vector<std::pair<double, string> > byLoad;
+            for ( ShardLoadMap::const_iterator i = loads.begin(); i != loads.end(); ++i ) {
+                if ( !i->second.used )
+                    byLoad.push_back( std::make_pair( i->second.load, i->first ) );
+            }
+            std::sort( byLoad.begin(), byLoad.end() );
+
+            // Try donors from the most loaded down, each against receivers from the least
+            // loaded up, and take the first pair for which some chunk can be moved
+            auto_ptr<MigrateInfo> migration;
+            double moved = 0;
+            for ( vector<std::pair<double, string> >::reverse_iterator donor = byLoad.rbegin();
+                  donor != byLoad.rend() && !migration.get();
+                  ++donor ) {
+
+                const string& from = donor->second;
+                const vector<ChunkType*>& chunks = distribution.getChunks( from );
+
+                for ( vector<std::pair<double, string> >::const_iterator receiver =
+                          byLoad.begin();
+                      receiver != byLoad.end() && !migration.get();
+                      ++receiver ) {
+
+                    const double imbalance = donor->first - receiver->first;
+                    if ( imbalance <= options.threshold )
+                        break;
+
+                    const string& to = receiver->second;
+                    const ShardInfo& info = distribution.shardInfo( to );
+                    if ( info.isSizeMaxed() || info.isDraining() )
+                        continue;
+
+                    // Pick the chunk which leaves the pair closest to even.  Only chunks
+                    // carrying less load than the imbalance lower the higher of the two.
+                    const ChunkType* best = NULL;
+                    double bestSpread = imbalance;
+                    double bestLoad = 0;
+                    for ( unsigned j = 0; j < chunks.size(); j++ ) {
+                        const ChunkType& chunk = *chunks[j];
+                        if ( chunk.isJumboSet() && chunk.getJumbo() )
+                            continue;
+
+                        if ( !info.hasTag( distribution.getTagForChunk( chunk ) ) )
+                            continue;
+
+                        const double chunkLoad =
+                            distribution.getChunkDataSize( chunk ) * loads[from].loadPerByte;
+                        const double spread = std::fabs( imbalance - 2 * chunkLoad );
+                        if ( spread < bestSpread ) {
+                            best = &chunk;
+                            bestSpread = spread;
+                            bestLoad = chunkLoad;
+                        }
+                    }
+
+                    if ( best ) {
+                        migration.reset( new MigrateInfo( ns, to, from, best->toBSON() ) );
+                        moved = bestLoad;
+                    }
+                }
+            }
+
+            if ( !migration.get() )
+                break;
+
+            log() << " ns: " << ns << " going to move " << migration->chunk.toString()
+                  << " from: " << migration->from << " (load " << loads[migration->from].load
+                  << ") to: " << migration->to << " (load " << loads[migration->to].load
+                  << ") carrying load " << moved << endl;
+
+            loads[migration->from].used = true;
+            loads[migration->to].used = true;
+            migrations->push_back( migration.release() );
+        }
+    }
+
 
     ShardInfo::ShardInfo(long long maxSizeMB,
                          long long currSizeMB,
@@ -180,6 +180,28 @@ namespace mongo {
 
         /** @return the ShardInfo for the shard */
         const ShardInfo& shardInfo( const std::string& shard ) const;
+
+        /**
+         * Records the estimated data size of the chunk starting at 'min'.
+         */
+        void setChunkDataSize( const BSONObj& min, long long bytes );
+
+        /**
+         * @return the estimated data size of the chunk in bytes.  Chunks without an estimate
+         *         are assumed to be of average size, or 1 if no estimates are known at all.
+         */
+        long long getChunkDataSize( const ChunkType& chunk ) const;
+
+        /**
+         * Records the rate of operations the shard has recently served on this collection.
+         */
+        void setOpsPerSec( const std::string& shard, double opsPerSec );
+
+        /**
+         * @return the rate of operations the shard has recently served on this collection, 0 if
+         *         unknown.  Only consulted by BalancerPolicy::balanceByLoad.
+         */
+        double getOpsPerSec( const std::string& shard ) const;
         
         /** writes all state to log() */
         void dump() const;
@@ -212,6 +234,9 @@ namespace mongo {
         std::map<BSONObj,TagRange> _tagRanges;
         std::set<std::string> _allTags;
         std::set<std::string> _shards;
+        std::map<BSONObj,long long> _chunkDataSizes;
+        long long _knownChunkDataSize;
+        std::map<std::string,double> _opsPerSec;
     };
 
     class BalancerPolicy {
@@ -231,6 +256,52 @@ namespace mongo {
         static MigrateInfo* balance( const std::string& ns,
                                      const DistributionStatus& distribution,
                                      int balancedLastTime );
+
+        struct LoadOptions {
+            LoadOptions() : dataWeight( 1.0 ), opsWeight( 1.0 ), threshold( 0.1 ),
+                            maxMigrations( 4 ) {}
+
+            // relative importance of data size and operation rate in a shard's load
+            double dataWeight;
+            double opsWeight;
+
+            // imbalance, as a fraction of the average shard load, below which we don't move
+            double threshold;
+
+            // most migrations to suggest for the collection in one round
+            int maxMigrations;
+        };
+
+        /**
+         * Load-aware alternative to balance().  Rather than chunk counts, each shard's load is
+         * the weighted sum of the collection's data on it (from the chunk size estimates in
+         * 'distribution') and the rate of operations it serves on the collection, which is
+         * attributed to its chunks in proportion to their size.  Traffic to other collections
+         * on the shard is not counted, so a shard hot on one collection doesn't make the
+         * others move chunks off it.
+         *
+         * Draining shards and tag violations are handled exactly as by balance().  Otherwise
+         * migrations are chosen greedily from the most loaded shard to the least loaded one
+         * that may take the chunk, picking the chunk which best evens out the pair, so that
+         * the maximum load goes down with every move.  A shard takes part in at most one
+         * suggested migration, so the suggestions don't conflict with each other and each
+         * remains valid after the others have run.
+         *
+         * Appends the suggested migrations, if any, to 'migrations'.
+         */
+        static void balanceByLoad( const std::string& ns,
+                                   const DistributionStatus& distribution,
+                                   const LoadOptions& options,
+                                   OwnedPointerVector<MigrateInfo>* migrations );
+
+    private:
+
+        /**
+         * @return a migration off a draining shard or fixing a tag violation, or NULL if no
+         *         such move is required.  Caller owns the MigrateInfo instance.
+         */
+        static MigrateInfo* _requiredMigration( const std::string& ns,
+                                                const DistributionStatus& distribution );
     };
 
 
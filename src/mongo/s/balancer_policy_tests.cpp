@@ -594,5 +594,245 @@ namespace mongo {
                 }
             }
         }
+
+        /**
+         * Sets the data size of every chunk on 'shard' to 'bytes', in both the size map used to
+         * simulate moves and the distribution.
+         */
+        void setChunkSizes( OwnedShardToChunksMap& map, const string& shard, long long bytes,
+                            std::map<BSONObj, long long>* sizes ) {
+            const vector<ChunkType*>& chunks = map.mutableMap()[shard]->vector();
+            for ( unsigned i = 0; i < chunks.size(); i++ ) {
+                (*sizes)[chunks[i]->getMin()] = bytes;
+            }
+        }
+
+        void applyChunkSizes( const std::map<BSONObj, long long>& sizes, DistributionStatus* d ) {
+            for ( std::map<BSONObj, long long>::const_iterator i = sizes.begin();
+                  i != sizes.end();
+                  ++i ) {
+                d->setChunkDataSize( i->first, i->second );
+            }
+        }
+
+        TEST( BalancerPolicyTests, LoadBalanceByDataSize ) {
+            // shard0 has fewer, but much larger, chunks
+            OwnedShardToChunksMap chunks;
+            addShard( chunks, 2, false );
+            addShard( chunks, 10, true );
+
+            std::map<BSONObj, long long> sizes;
+            setChunkSizes( chunks, "shard0", 50, &sizes );
+            setChunkSizes( chunks, "shard1", 1, &sizes );
+
+            ShardInfoMap shards;
+            shards["shard0"] = ShardInfo(0, 0, false);
+            shards["shard1"] = ShardInfo(0, 0, false);
+
+            DistributionStatus d(shards, chunks.map());
+
+            // By chunk count shard1 donates
+            scoped_ptr<MigrateInfo> m(BalancerPolicy::balance( "ns", d, 0 ));
+            ASSERT( m );
+            ASSERT_EQUALS( "shard1", m->from );
+
+            // By data size shard0 does
+            applyChunkSizes( sizes, &d );
+            OwnedPointerVector<MigrateInfo> migrations;
+            BalancerPolicy::balanceByLoad( "ns", d, BalancerPolicy::LoadOptions(), &migrations );
+            ASSERT_EQUALS( 1U, migrations.size() );
+            ASSERT_EQUALS( "shard0", migrations[0]->from );
+            ASSERT_EQUALS( "shard1", migrations[0]->to );
+        }
+
+        TEST( BalancerPolicyTests, LoadBalanceByOperations ) {
+            // Same data on both shards, but shard0 serves all the operations
+            OwnedShardToChunksMap chunks;
+            addShard( chunks, 5, false );
+            addShard( chunks, 5, true );
+
+            ShardInfoMap shards;
+            shards["shard0"] = ShardInfo(0, 0, false);
+            shards["shard1"] = ShardInfo(0, 0, false);
+
+            DistributionStatus d(shards, chunks.map());
+            d.setOpsPerSec( "shard0", 1000 );
+
+            OwnedPointerVector<MigrateInfo> migrations;
+            BalancerPolicy::balanceByLoad( "ns", d, BalancerPolicy::LoadOptions(), &migrations );
+            ASSERT_EQUALS( 1U, migrations.size() );
+            ASSERT_EQUALS( "shard0", migrations[0]->from );
+            ASSERT_EQUALS( "shard1", migrations[0]->to );
+
+            // Ignoring operations, the data is already balanced
+            BalancerPolicy::LoadOptions dataOnly;
+            dataOnly.opsWeight = 0;
+            migrations.clear();
+            BalancerPolicy::balanceByLoad( "ns", d, dataOnly, &migrations );
+            ASSERT_EQUALS( 0U, migrations.size() );
+        }
+
+        TEST( BalancerPolicyTests, LoadMultipleMigrationsUseDistinctShards ) {
+            OwnedShardToChunksMap chunks;
+            addShard( chunks, 10, false );
+            addShard( chunks, 10, false );
+            addShard( chunks, 0, false );
+            addShard( chunks, 0, true );
+
+            ShardInfoMap shards;
+            for ( int i = 0; i < 4; i++ ) {
+                shards[str::stream() << "shard" << i] = ShardInfo(0, 0, false);
+            }
+
+            DistributionStatus d(shards, chunks.map());
+
+            OwnedPointerVector<MigrateInfo> migrations;
+            BalancerPolicy::balanceByLoad( "ns", d, BalancerPolicy::LoadOptions(), &migrations );
+            ASSERT_EQUALS( 2U, migrations.size() );
+
+            std::set<string> involved;
+            for ( size_t i = 0; i < migrations.size(); i++ ) {
+                ASSERT( migrations[i]->from == "shard0" || migrations[i]->from == "shard1" );
+                ASSERT( migrations[i]->to == "shard2" || migrations[i]->to == "shard3" );
+                involved.insert( migrations[i]->from );
+                involved.insert( migrations[i]->to );
+            }
+            ASSERT_EQUALS( 4U, involved.size() );
+
+            // Limited to a single migration
+            BalancerPolicy::LoadOptions options;
+            options.maxMigrations = 1;
+            migrations.clear();
+            BalancerPolicy::balanceByLoad( "ns", d, options, &migrations );
+            ASSERT_EQUALS( 1U, migrations.size() );
+        }
+
+        TEST( BalancerPolicyTests, LoadDrainingAndTagsFirst ) {
+            OwnedShardToChunksMap chunks;
+            addShard( chunks, 5, false );
+            addShard( chunks, 5, false );
+            addShard( chunks, 5, true );
+
+            ShardInfoMap shards;
+            shards["shard0"] = ShardInfo(0, 0, false);
+            shards["shard1"] = ShardInfo(0, 0, true);
+            shards["shard2"] = ShardInfo(0, 0, false);
+
+            DistributionStatus d(shards, chunks.map());
+            d.setOpsPerSec( "shard2", 1000 );
+
+            OwnedPointerVector<MigrateInfo> migrations;
+            BalancerPolicy::balanceByLoad( "ns", d, BalancerPolicy::LoadOptions(), &migrations );
+            ASSERT_EQUALS( 1U, migrations.size() );
+            ASSERT_EQUALS( "shard1", migrations[0]->from );
+            ASSERT_EQUALS( "shard0", migrations[0]->to );
+        }
+
+        TEST( BalancerPolicyTests, LoadRespectsTagsAndMaxSize ) {
+            OwnedShardToChunksMap chunks;
+            addShard( chunks, 10, false );
+            addShard( chunks, 0, false );
+            addShard( chunks, 0, false );
+            addShard( chunks, 0, true );
+
+            // shard1 is full and shard2 lacks the tag, which leaves only shard3
+            ShardInfoMap shards;
+            shards["shard0"] = ShardInfo(0, 0, false);
+            shards["shard1"] = ShardInfo(1, 2, false);
+            shards["shard2"] = ShardInfo(0, 0, false);
+            shards["shard3"] = ShardInfo(0, 0, false);
+            shards["shard0"].addTag( "a" );
+            shards["shard1"].addTag( "a" );
+            shards["shard3"].addTag( "a" );
+
+            DistributionStatus d(shards, chunks.map());
+            d.addTagRange( TagRange( BSON( "x" << MINKEY ), BSON( "x" << MAXKEY ), "a" ) );
+
+            OwnedPointerVector<MigrateInfo> migrations;
+            BalancerPolicy::balanceByLoad( "ns", d, BalancerPolicy::LoadOptions(), &migrations );
+            ASSERT_EQUALS( 1U, migrations.size() );
+            ASSERT_EQUALS( "shard0", migrations[0]->from );
+            ASSERT_EQUALS( "shard3", migrations[0]->to );
+        }
+
+        /**
+         * Sets up shards with random numbers of chunks of random sizes and hot spots, then
+         * applies the suggested migrations until there are none.  The most loaded shard must
+         * never get more loaded, and at the end it must be within the threshold of the least
+         * loaded one, or hold no chunk small enough to even them out.
+         */
+        TEST( BalancerPolicyTests, LoadSimulation ) {
+            PseudoRandom rng(1337);
+
+            for (int test = 0; test < 10; test++) {
+                const int numShards = 5;
+
+                OwnedShardToChunksMap chunks;
+                ShardInfoMap shards;
+                std::map<BSONObj, long long> sizes;
+                long long maxChunkSize = 0;
+
+                for (int i = 0; i < numShards; i++) {
+                    addShard(chunks, std::abs(rng.nextInt32(50)), i == numShards - 1);
+                    const string name = str::stream() << "shard" << i;
+                    shards[name] = ShardInfo(0, 0, false);
+
+                    const vector<ChunkType*>& shardChunks = chunks.mutableMap()[name]->vector();
+                    for (unsigned j = 0; j < shardChunks.size(); j++) {
+                        const long long size = 1 + std::abs(rng.nextInt32(100));
+                        sizes[shardChunks[j]->getMin()] = size;
+                        maxChunkSize = std::max(maxChunkSize, size);
+                    }
+                }
+
+                long long totalSize = 0;
+                for (std::map<BSONObj, long long>::const_iterator i = sizes.begin();
+                     i != sizes.end(); ++i) {
+                    totalSize += i->second;
+                }
+
+                long long lastMax = std::numeric_limits<long long>::max();
+                long long maxSize = 0;
+                long long minSize = 0;
+
+                for (int round = 0; round < 1000; round++) {
+                    // Data size on each shard
+                    maxSize = 0;
+                    minSize = std::numeric_limits<long long>::max();
+                    for (int i = 0; i < numShards; i++) {
+                        const vector<ChunkType*>& shardChunks =
+                            chunks.mutableMap()[str::stream() << "shard" << i]->vector();
+                        long long size = 0;
+                        for (unsigned j = 0; j < shardChunks.size(); j++) {
+                            size += sizes[shardChunks[j]->getMin()];
+                        }
+                        maxSize = std::max(maxSize, size);
+                        minSize = std::min(minSize, size);
+                    }
+
+                    ASSERT_LESS_THAN_OR_EQUALS(maxSize, lastMax);
+                    lastMax = maxSize;
+
+                    DistributionStatus d(shards, chunks.map());
+                    applyChunkSizes(sizes, &d);
+
+                    OwnedPointerVector<MigrateInfo> migrations;
+                    BalancerPolicy::balanceByLoad("ns", d, BalancerPolicy::LoadOptions(),
+                                                  &migrations);
+                    if (migrations.empty())
+                        break;
+
+                    for (size_t i = 0; i < migrations.size(); i++) {
+                        moveChunk(chunks, migrations[i]);
+                    }
+                }
+
+                log() << "test " << test << " finished with shard data sizes between "
+                      << minSize << " and " << maxSize << endl;
+
+                const double mean = static_cast<double>(totalSize) / numShards;
+                ASSERT(maxSize - minSize <= std::max(0.1 * mean, double(maxChunkSize)));
+            }
+        }
     }
 }
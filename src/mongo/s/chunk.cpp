@@ -42,6 +42,7 @@
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/db/lasterror.h"
 #include "mongo/db/query/query_solution.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/write_concern.h"
 #include "mongo/db/write_concern_options.h"
 #include "mongo/platform/random.h"
@@ -72,6 +73,10 @@ namespace {
 
     const int kTooManySplitPoints = 4;
 
+    // When positive, splitVector picks the median of forced splits from a random sample of this
+    // many keys, in one pass instead of two. Auto-splits keep the full scan, which can stop early.
+    MONGO_EXPORT_SERVER_PARAMETER(splitVectorSampleSize, int, 0);
+
     /**
      * Attempts to move the given chunk to another shard.
      *
@@ -280,6 +285,9 @@ namespace {
         cmd.append( "min" , getMin() );
         cmd.append( "max" , getMax() );
         cmd.appendBool( "force" , true );
+        if ( splitVectorSampleSize > 0 ) {
+            cmd.append( "sampleSize" , splitVectorSampleSize );
+        }
         BSONObj cmdObj = cmd.obj();
 
         if ( ! conn->runCommand( "admin" , cmdObj , result )) {
@@ -39,8 +39,8 @@
 
 namespace mongo {
 
-    template < class ValType, class ShardType >
-    bool ConfigDiffTracker<ValType,ShardType>::
+    template < class ValType, class ShardType, class MapType >
+    bool ConfigDiffTracker<ValType,ShardType,MapType>::
         isOverlapping( const BSONObj& min, const BSONObj& max )
     {
         RangeOverlap overlap = overlappingRange( min, max );
@@ -48,8 +48,8 @@ namespace mongo {
         return overlap.first != overlap.second;
     }
 
-    template < class ValType, class ShardType >
-    void ConfigDiffTracker<ValType,ShardType>::
+    template < class ValType, class ShardType, class MapType >
+    void ConfigDiffTracker<ValType,ShardType,MapType>::
         removeOverlapping( const BSONObj& min, const BSONObj& max )
     {
         verifyAttached();
@@ -59,8 +59,8 @@ namespace mongo {
         _currMap->erase( overlap.first, overlap.second );
     }
 
-    template < class ValType, class ShardType >
-    typename ConfigDiffTracker<ValType,ShardType>::RangeOverlap ConfigDiffTracker<ValType,ShardType>::
+    template < class ValType, class ShardType, class MapType >
+    typename ConfigDiffTracker<ValType,ShardType,MapType>::RangeOverlap ConfigDiffTracker<ValType,ShardType,MapType>::
         overlappingRange( const BSONObj& min, const BSONObj& max )
     {
         verifyAttached();
@@ -88,8 +88,8 @@ namespace mongo {
         return RangeOverlap( low, high );
     }
 
-    template<class ValType, class ShardType>
-    int ConfigDiffTracker<ValType, ShardType>::calculateConfigDiff(const std::string& config) {
+    template < class ValType, class ShardType, class MapType >
+    int ConfigDiffTracker<ValType,ShardType,MapType>::calculateConfigDiff(const std::string& config) {
         verifyAttached();
 
         // Get the diff query required
@@ -117,8 +117,8 @@ namespace mongo {
         }
     }
 
-    template < class ValType, class ShardType >
-    int ConfigDiffTracker<ValType,ShardType>::
+    template < class ValType, class ShardType, class MapType >
+    int ConfigDiffTracker<ValType,ShardType,MapType>::
         calculateConfigDiff( DBClientCursorInterface& diffCursor )
     {
         verifyAttached();
@@ -224,8 +224,8 @@ namespace mongo {
         return _validDiffs;
     }
 
-    template<class ValType, class ShardType>
-    Query ConfigDiffTracker<ValType, ShardType>::configDiffQuery() const {
+    template < class ValType, class ShardType, class MapType >
+    Query ConfigDiffTracker<ValType,ShardType,MapType>::configDiffQuery() const {
 
         verifyAttached();
 
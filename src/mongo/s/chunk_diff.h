@@ -49,8 +49,13 @@ namespace mongo {
      * implementation, because the logic is identical, or the chunk data, because that would be
      * slow for big clusters, so this is the alternative for now.
      * TODO: Standardize between mongos and mongod and convert template parameters to types.
+     *
+     * MapType only needs the ordered lookup, insert and range erase parts of the std::map
+     * interface, so mongod can keep its chunks in a structurally shared RangeMap.
      */
-    template < class ValType, class ShardType >
+    template < class ValType,
+               class ShardType,
+               class MapType = std::map<BSONObj, ValType, BSONObjCmp> >
     class ConfigDiffTracker {
     public:
 
@@ -59,7 +64,7 @@ namespace mongo {
         //
 
         // RangeMap stores ranges indexed by max or  min key
-        typedef typename std::map<BSONObj, ValType, BSONObjCmp> RangeMap;
+        typedef MapType RangeMap;
 
         // RangeOverlap is a pair of iterators defining a subset of ranges
         typedef typename std::pair< typename RangeMap::iterator, typename RangeMap::iterator> RangeOverlap;
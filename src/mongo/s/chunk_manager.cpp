@@ -36,6 +36,7 @@
 #include <set>
 
 #include "mongo/db/query/index_bounds_builder.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_planner_common.h"
 #include "mongo/s/catalog/catalog_manager.h"
@@ -180,6 +181,7 @@ namespace {
                     const_cast<set<Shard>&>(_shards).swap(shards);
                     const_cast<ShardVersionMap&>(_shardVersions).swap(shardVersions);
                     const_cast<ChunkRangeManager&>(_chunkRanges).reloadAll(_chunkMap);
+                    const_cast<ChunkRoutingIndex&>(_routingIndex).build(_chunkMap);
 
                     return;
                 }
@@ -464,6 +466,14 @@ namespace {
             BSONObj chunkMin;
             ChunkPtr chunk;
             {
+                chunk = _routingIndex.upperBound( shardKey );
+                if ( chunk && chunk->containsKey( shardKey ) ) {
+                    return chunk;
+                }
+
+                // The routing index is not populated for chunk managers which were never loaded
+                // and it should never disagree with the map, but the map is authoritative
+                chunk.reset();
                 ChunkMap::const_iterator it = _chunkMap.upper_bound( shardKey );
                 if (it != _chunkMap.end()) {
                     chunkMin = it->first;
@@ -909,6 +919,78 @@ namespace {
         }
     }
 
+    // The ChunkMap compares shard keys with BSONObj::woCompare and no ordering, so the bounds
+    // are encoded with every field ascending
+    static Ordering routingKeyOrdering() {
+        return Ordering::make(BSONObj());
+    }
+
+    void ChunkRoutingIndex::build(const ChunkMap& chunks) {
+        clear();
+
+        _keyOffsets.reserve(chunks.size() + 1);
+        _chunks.reserve(chunks.size());
+
+        const Ordering ord = routingKeyOrdering();
+        KeyString ks;
+        for (ChunkMap::const_iterator it = chunks.begin(); it != chunks.end(); ++it) {
+            ks.resetToKey(it->first, ord);
+
+            _keyOffsets.push_back(_keyData.size());
+            _keyData.insert(_keyData.end(), ks.getBuffer(), ks.getBuffer() + ks.getSize());
+            _chunks.push_back(it->second);
+        }
+        _keyOffsets.push_back(_keyData.size());
+
+        // Every metadata reload builds a new index, so don't keep the slack around
+        std::vector<char>(_keyData).swap(_keyData);
+    }
+
+    void ChunkRoutingIndex::clear() {
+        _keyData.clear();
+        _keyOffsets.clear();
+        _chunks.clear();
+    }
+
+    int ChunkRoutingIndex::_compareMaxTo(size_t pos, const char* key, size_t keySize) const {
+        const size_t maxSize = _keyOffsets[pos + 1] - _keyOffsets[pos];
+        const int cmp = memcmp(&_keyData[_keyOffsets[pos]], key, std::min(maxSize, keySize));
+        if (cmp) {
+            return cmp;
+        }
+
+        return maxSize < keySize ? -1 : (maxSize == keySize ? 0 : 1);
+    }
+
+    ChunkPtr ChunkRoutingIndex::upperBound(const BSONObj& shardKey) const {
+        if (_chunks.empty()) {
+            return ChunkPtr();
+        }
+
+        const KeyString key(shardKey, routingKeyOrdering());
+
+        // Find the first max bound, which is greater than the key
+        size_t first = 0;
+        size_t count = _chunks.size();
+        while (count > 0) {
+            const size_t step = count / 2;
+            const size_t mid = first + step;
+            if (_compareMaxTo(mid, key.getBuffer(), key.getSize()) <= 0) {
+                first = mid + 1;
+                count -= step + 1;
+            }
+            else {
+                count = step;
+            }
+        }
+
+        if (first == _chunks.size()) {
+            return ChunkPtr();
+        }
+
+        return _chunks[first];
+    }
+
     int ChunkManager::getCurrentDesiredChunkSize() const {
         // split faster in early chunks helps spread out an initial load better
         const int minChunkSize = 1 << 20;  // 1 MBytes
@@ -103,6 +103,42 @@ namespace mongo {
     };
 
 
+    /**
+     * Immutable routing table, which is built from a ChunkMap on every metadata reload.
+     *
+     * The max bound of each chunk is encoded as a KeyString and all of them are stored back to
+     * back in a single buffer, sorted in ascending order. Finding the chunk for a shard key is a
+     * binary search over that buffer using memcmp, instead of a walk down the ChunkMap tree with
+     * a BSONObj::woCompare at every node.
+     */
+    class ChunkRoutingIndex {
+    public:
+        void build(const ChunkMap& chunks);
+
+        void clear();
+
+        size_t size() const { return _chunks.size(); }
+
+        /**
+         * Returns the chunk with the smallest max bound, which is greater than 'shardKey', or
+         * an empty pointer if there is none. Same as ChunkMap::upper_bound.
+         */
+        ChunkPtr upperBound(const BSONObj& shardKey) const;
+
+    private:
+        // Compares the max bound of the chunk at 'pos' to the encoded key
+        int _compareMaxTo(size_t pos, const char* key, size_t keySize) const;
+
+        // Encoded max bounds, back to back
+        std::vector<char> _keyData;
+
+        // Offset of each chunk's max bound in _keyData, followed by the total size
+        std::vector<uint32_t> _keyOffsets;
+
+        std::vector<ChunkPtr> _chunks;
+    };
+
+
     /* config.sharding
          { ns: 'alleyinsider.fs.chunks' ,
            key: { ts : 1 } ,
@@ -237,6 +273,7 @@ namespace mongo {
 
         const ChunkMap _chunkMap;
         const ChunkRangeManager _chunkRanges;
+        const ChunkRoutingIndex _routingIndex;
 
         const std::set<Shard> _shards;
 
@@ -30,6 +30,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include "mongo/config.h"
 #include "mongo/db/json.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/query/canonical_query.h"
@@ -37,6 +38,7 @@
 #include "mongo/s/shard_key_pattern.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace {
 
@@ -532,4 +534,103 @@ namespace {
         CheckBoundList(list, expectedList);
     }
 
+    // Builds 'numChunks' adjacent chunks covering { a: MinKey, b: MinKey } to
+    // { a: MaxKey, b: MaxKey }, with split points { a: 10 * i, b: "x<i>" }
+    ChunkMap makeChunkMap(int numChunks) {
+        const Shard shard("shard0000", "localhost:27017", 0, false);
+
+        ChunkMap chunks;
+        BSONObj min = BSON("a" << MINKEY << "b" << MINKEY);
+        for (int i = 1; i <= numChunks; i++) {
+            BSONObj max = (i == numChunks) ?
+                BSON("a" << MAXKEY << "b" << MAXKEY) :
+                BSON("a" << 10 * i << "b" << std::string(str::stream() << "x" << i));
+
+            chunks[max] = ChunkPtr(new Chunk(NULL, min, max, shard));
+            min = max;
+        }
+
+        return chunks;
+    }
+
+    TEST(CMRoutingIndexTest, MatchesChunkMap) {
+        const ChunkMap chunks = makeChunkMap(100);
+
+        ChunkRoutingIndex index;
+        index.build(chunks);
+        ASSERT_EQUALS(chunks.size(), index.size());
+
+        std::vector<BSONObj> keys;
+        keys.push_back(BSON("a" << MINKEY << "b" << MINKEY));
+        keys.push_back(BSON("a" << MAXKEY << "b" << MAXKEY));
+        keys.push_back(BSON("a" << 10 << "b" << "x1"));
+        keys.push_back(BSON("a" << 10.0 << "b" << "x1"));
+        keys.push_back(BSON("a" << 10LL << "b" << "x0"));
+        keys.push_back(BSON("a" << 10.5 << "b" << ""));
+        keys.push_back(BSON("a" << -1 << "b" << BSONNULL));
+        keys.push_back(BSON("a" << "str" << "b" << 1));
+        keys.push_back(BSON("a" << 999 << "b" << "zzz"));
+        for (int i = 0; i < 1010; i += 3) {
+            keys.push_back(BSON("a" << i << "b" << std::string(str::stream() << "x" << i / 10)));
+        }
+
+        for (size_t i = 0; i < keys.size(); i++) {
+            ChunkMap::const_iterator it = chunks.upper_bound(keys[i]);
+            ChunkPtr expected = (it == chunks.end()) ? ChunkPtr() : it->second;
+            ASSERT(expected == index.upperBound(keys[i]));
+        }
+    }
+
+    TEST(CMRoutingIndexTest, Empty) {
+        ChunkRoutingIndex index;
+        ASSERT(!index.upperBound(BSON("a" << 1)));
+
+        index.build(makeChunkMap(1));
+        ASSERT(index.upperBound(BSON("a" << 1 << "b" << 1)));
+
+        index.clear();
+        ASSERT(!index.upperBound(BSON("a" << 1 << "b" << 1)));
+    }
+
+#ifndef MONGO_CONFIG_DEBUG_BUILD
+
+    TEST(CMRoutingIndexTest, PerformanceFindChunk) {
+        const int numChunks = 200 * 1000;
+        const int numLookups = 1000 * 1000;
+
+        const ChunkMap chunks = makeChunkMap(numChunks);
+
+        Timer buildTimer;
+        ChunkRoutingIndex index;
+        index.build(chunks);
+        log() << "Built routing index for " << numChunks << " chunks in "
+              << buildTimer.millis() << " ms";
+
+        std::vector<BSONObj> keys;
+        for (int i = 0; i < 4096; i++) {
+            const int a = (i * 7919) % (numChunks * 10);
+            keys.push_back(BSON("a" << a << "b" << "y"));
+        }
+
+        size_t found = 0;
+        Timer mapTimer;
+        for (int i = 0; i < numLookups; i++) {
+            found += chunks.upper_bound(keys[i % keys.size()]) != chunks.end();
+        }
+        const long long mapMicros = mapTimer.micros();
+
+        Timer indexTimer;
+        for (int i = 0; i < numLookups; i++) {
+            found += static_cast<bool>(index.upperBound(keys[i % keys.size()]));
+        }
+        const long long indexMicros = indexTimer.micros();
+
+        ASSERT_EQUALS(2U * numLookups, found);
+
+        log() << "Chunk map: " << (mapMicros * 1000) / numLookups << " ns per lookup, "
+              << "routing index: " << (indexMicros * 1000) / numLookups << " ns per lookup";
+    }
+
+#endif  // MONGO_CONFIG_DEBUG_BUILD
+
 } // namespace
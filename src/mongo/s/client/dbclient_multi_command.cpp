@@ -38,6 +38,7 @@
 #include "mongo/s/client/shard_connection.h"
 #include "mongo/s/write_ops/batched_command_request.h"
 #include "mongo/util/net/message.h"
+#include "mongo/util/net/socket_poll.h"
 
 namespace mongo {
 
@@ -52,6 +53,7 @@ namespace mongo {
         dbName( dbName.toString() ),
         cmdObj( cmdObj ),
         conn( NULL ),
+        sent( false ),
         status( Status::OK() ) {
     }
 
@@ -126,7 +128,12 @@ namespace mongo {
             it != _pendingCommands.end(); ++it ) {
 
             PendingCommand* command = *it;
+
+            // Already sent on a previous sendAll
+            if ( command->sent ) continue;
+
             dassert( NULL == command->conn );
+            command->sent = true;
 
             try {
                 dassert( command->endpoint.type() == ConnectionString::MASTER ||
@@ -154,6 +161,7 @@ namespace mongo {
                     // invalidate other connections which might be bad.  But if the connection
                     // doesn't seem bad, don't send it back, because we don't want to reuse it.
                     if ( !command->conn->isFailed() ) {
+                        shardConnectionPool.decrementEgress( command->endpoint.toString() );
                         delete command->conn;
                     }
                     else {
@@ -170,10 +178,61 @@ namespace mongo {
         return static_cast<int>( _pendingCommands.size() );
     }
 
+    DBClientMultiCommand::PendingQueue::iterator DBClientMultiCommand::_nextReadyCommand() {
+
+        std::vector<pollfd> pollInfo;
+        std::vector<PendingQueue::iterator> polled;
+
+        for ( PendingQueue::iterator it = _pendingCommands.begin();
+            it != _pendingCommands.end(); ++it ) {
+
+            PendingCommand* command = *it;
+            if ( !command->sent ) continue;
+
+            // Failed sends can be reported right away
+            if ( NULL == command->conn ) return it;
+
+            DBClientConnection* conn = dynamic_cast<DBClientConnection*>( command->conn );
+            if ( NULL == conn ) {
+                // Can't poll other kinds of connections, fall back to waiting for the oldest
+                polled.clear();
+                break;
+            }
+
+            pollfd pfd;
+            pfd.fd = conn->port().psock->rawFD();
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            pollInfo.push_back( pfd );
+            polled.push_back( it );
+        }
+
+        if ( polled.size() > 1 && isPollSupported() ) {
+            // Errors and hangups are reported by the subsequent recv, so any event will do. On
+            // timeout, the recv on the oldest command reports it.
+            int timeoutMillis = _timeoutMillis > 0 ? _timeoutMillis : -1;
+            if ( socketPoll( &pollInfo[0], pollInfo.size(), timeoutMillis ) > 0 ) {
+                for ( size_t i = 0; i < pollInfo.size(); ++i ) {
+                    if ( pollInfo[i].revents ) return polled[i];
+                }
+            }
+        }
+
+        for ( PendingQueue::iterator it = _pendingCommands.begin();
+            it != _pendingCommands.end(); ++it ) {
+            if ( ( *it )->sent ) return it;
+        }
+
+        return _pendingCommands.end();
+    }
+
     Status DBClientMultiCommand::recvAny( ConnectionString* endpoint, BSONSerializable* response ) {
 
-        scoped_ptr<PendingCommand> command( _pendingCommands.front() );
-        _pendingCommands.pop_front();
+        PendingQueue::iterator next = _nextReadyCommand();
+        invariant( next != _pendingCommands.end() );
+
+        scoped_ptr<PendingCommand> command( *next );
+        _pendingCommands.erase( next );
 
         *endpoint = command->endpoint;
         if ( !command->status.isOK() ) return command->status;
@@ -202,6 +261,7 @@ namespace mongo {
             // invalidate other connections which might be bad.  But if the connection doesn't seem
             // bad, don't send it back, because we don't want to reuse it.
             if ( !command->conn->isFailed() ) {
+                shardConnectionPool.decrementEgress( command->endpoint.toString() );
                 delete command->conn;
             }
             else {
@@ -223,7 +283,10 @@ namespace mongo {
 
             PendingCommand* command = *it;
 
-            if ( NULL != command->conn ) delete command->conn;
+            if ( NULL != command->conn ) {
+                shardConnectionPool.decrementEgress( command->endpoint.toString() );
+                delete command->conn;
+            }
             delete command;
             command = NULL;
         }
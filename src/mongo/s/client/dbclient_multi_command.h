@@ -77,11 +77,18 @@ namespace mongo {
             // Where to send it
             DBClientBase* conn;
 
+            // Whether sendAll has already tried to send it
+            bool sent;
+
             // If anything goes wrong
             Status status;
         };
 
         typedef std::deque<PendingCommand*> PendingQueue;
+
+        // Returns the position of the sent command whose response should be received next
+        PendingQueue::iterator _nextReadyCommand();
+
         PendingQueue _pendingCommands;
         int _timeoutMillis;
     };
@@ -29,6 +29,9 @@
 #pragma once
 
 #include <deque>
+#include <set>
+#include <string>
+#include <vector>
 
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/s/client/multi_command_dispatch.h"
@@ -90,6 +93,10 @@ namespace mongo {
      *
      * If an endpoint isn't registered with a MockEndpoint, just returns BatchedCommandResponses
      * with ok : true.
+     *
+     * Responses are returned in send order, except that the responses of hosts marked slow are
+     * held back while any other response is outstanding.  Each send and receive is recorded as an
+     * event, so tests can check the order in which commands went out and came back.
      */
     class MockMultiWriteCommand : public MultiCommandDispatch {
     public:
@@ -104,11 +111,17 @@ namespace mongo {
         void addCommand( const ConnectionString& endpoint,
                          StringData dbName,
                          const BSONSerializable& request ) {
-            _pending.push_back( endpoint );
+            _added.push_back( endpoint );
         }
 
         void sendAll() {
-            // No-op
+            // Only the commands added since the last call go out
+            for ( std::deque<ConnectionString>::const_iterator it = _added.begin();
+                it != _added.end(); ++it ) {
+                _events.push_back( "send " + it->toString() );
+                _pending.push_back( *it );
+            }
+            _added.clear();
         }
 
         int numPending() const {
@@ -124,9 +137,22 @@ namespace mongo {
             BatchedCommandResponse* batchResponse = //
                 static_cast<BatchedCommandResponse*>( response );
 
-            *endpoint = _pending.front();
-            MockWriteResult* mockResponse = releaseByHost( _pending.front() );
-            _pending.pop_front();
+            ASSERT( !_pending.empty() );
+
+            // The first response not from a slow host, or the first response if all are slow
+            std::deque<ConnectionString>::iterator next = _pending.begin();
+            for ( std::deque<ConnectionString>::iterator it = _pending.begin();
+                it != _pending.end(); ++it ) {
+                if ( _slowHosts.count( it->toString() ) == 0 ) {
+                    next = it;
+                    break;
+                }
+            }
+
+            *endpoint = *next;
+            _pending.erase( next );
+            _events.push_back( "recv " + endpoint->toString() );
+            MockWriteResult* mockResponse = releaseByHost( *endpoint );
 
             if ( NULL == mockResponse ) {
                 batchResponse->setOk( true );
@@ -145,6 +171,21 @@ namespace mongo {
             return _mockEndpoints.vector();
         }
 
+        /**
+         * Holds back the responses of 'endpoint' while responses of other hosts are outstanding.
+         */
+        void setSlowHost( const ConnectionString& endpoint ) {
+            _slowHosts.insert( endpoint.toString() );
+        }
+
+        /**
+         * Returns "send <host>" and "recv <host>" for every command sent and response returned,
+         * in the order they happened.
+         */
+        const std::vector<std::string>& getEvents() const {
+            return _events;
+        }
+
     private:
 
         // Find a MockEndpoint* by host, and release it so we don't see it again
@@ -166,7 +207,14 @@ namespace mongo {
         // Manually-stored ranges
         OwnedPointerVector<MockWriteResult> _mockEndpoints;
 
+        // Added, but not yet sent
+        std::deque<ConnectionString> _added;
+
+        // Sent and waiting for recvAny, in send order
         std::deque<ConnectionString> _pending;
+
+        std::set<std::string> _slowHosts;
+        std::vector<std::string> _events;
     };
 
 } // namespace mongo
@@ -54,16 +54,17 @@ namespace mongo {
          * Adds a command to this multi-command dispatch.  Commands are registered with a
          * ConnectionString endpoint and a serializable request.
          *
-         * Commands are not sent immediately, they are sent on sendAll.
+         * Commands are not sent immediately, they are sent on sendAll.  Commands may be added
+         * while previously sent commands are still waiting for their responses.
          */
         virtual void addCommand( const ConnectionString& endpoint,
                                  StringData dbName,
                                  const BSONSerializable& request ) = 0;
 
         /**
-         * Sends all the commands in this dispatch to their endpoints, in undefined order and
-         * without waiting for responses.  May block on full send queue (though this should be
-         * rare).
+         * Sends all the commands added since the last sendAll to their endpoints, in undefined
+         * order and without waiting for responses.  May block on full send queue (though this
+         * should be rare).
          *
          * Any error which occurs during sendAll will be reported on recvAny, *does not throw.*
          */
@@ -76,7 +77,8 @@ namespace mongo {
 
         /**
          * Blocks until a command response has come back.  Any outstanding command response may be
-         * returned with associated endpoint.
+         * returned with associated endpoint, so a slow endpoint does not hold up the responses of
+         * the others.
          *
          * Returns !OK on send/recv/parse failure, otherwise command-level errors are returned in
          * the response object itself.
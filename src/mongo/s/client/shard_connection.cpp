@@ -180,7 +180,8 @@ namespace {
                         delete ss->avail;
                     }
                     else {
-                        release(addr, ss->avail);
+                        // Parked connections hold no in-use slot
+                        shardConnectionPool.releaseIdle(addr, ss->avail);
                     }
 
                     ss->avail = 0;
@@ -209,11 +210,21 @@ namespace {
 
             auto_ptr<DBClientBase> c;
             if (s->avail) {
+                // The parked connection gave back its in-use slot, take one again first.  May
+                // throw if the host has too many connections in use, leaving it parked.
+                shardConnectionPool.incrementEgress(addr, 0);
+
                 c.reset(s->avail);
                 s->avail = 0;
 
-                // May throw an exception
-                shardConnectionPool.onHandedOut(c.get());
+                try {
+                    // May throw an exception
+                    shardConnectionPool.onHandedOut(c.get());
+                }
+                catch (...) {
+                    shardConnectionPool.decrementEgress(addr);
+                    throw;
+                }
             }
             else {
                 c.reset(shardConnectionPool.get(addr));
@@ -264,6 +275,9 @@ namespace {
             // used - as thread local variables. This means that threads won't be able to
             // see the s->avail connection of other threads.
 
+            // Only connections in use count against the host's limit, so that threads parking
+            // connections cannot starve the others
+            shardConnectionPool.decrementEgress(addr);
             s->avail = conn;
         }
 
@@ -296,6 +310,9 @@ namespace {
                     if( ! s->avail ) {
                         s->avail = shardConnectionPool.get( sconnString );
                         s->created++; // After, so failed creation doesn't get counted
+
+                        // Parked for later requests on this thread, see done()
+                        shardConnectionPool.decrementEgress( sconnString );
                     }
 
                     versionManager.checkShardVersionCB( s->avail, ns, false, 1 );
@@ -499,6 +516,7 @@ namespace {
                 ClientConnections::threadInstance()->done(_addr, _conn);
             }
             else {
+                shardConnectionPool.decrementEgress(_addr);
                 delete _conn;
             }
 
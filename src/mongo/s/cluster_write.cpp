@@ -35,7 +35,9 @@
 #include <string>
 #include <vector>
 
+#include "mongo/base/counter.h"
 #include "mongo/base/status.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/write_concern_options.h"
 #include "mongo/s/catalog/catalog_manager.h"
 #include "mongo/s/chunk_manager.h"
@@ -60,6 +62,28 @@ namespace mongo {
 
     namespace {
 
+        // Child write batches sent to shards and their total round trip time
+        Counter64 childBatchesSent;
+        Counter64 childBatchesTotalMicros;
+
+        ServerStatusMetricField<Counter64> displayChildBatchesSent(
+                                                    "sharding.writeBatches.num",
+                                                    &childBatchesSent);
+        ServerStatusMetricField<Counter64> displayChildBatchesTotalMicros(
+                                                    "sharding.writeBatches.totalMicros",
+                                                    &childBatchesTotalMicros);
+
+        void recordChildBatchLatencies(const BatchWriteExecStats& stats) {
+            const HostLatencyMap& latencies = stats.getChildBatchLatencies();
+            for (HostLatencyMap::const_iterator it = latencies.begin();
+                 it != latencies.end();
+                 ++it) {
+
+                childBatchesSent.increment(it->second.numBatches);
+                childBatchesTotalMicros.increment(it->second.totalMicros);
+            }
+        }
+
         /**
          * Constructs the BSON specification document for the given namespace, index key
          * and options.
@@ -273,6 +297,8 @@ namespace mongo {
                 splitIfNeeded(request.getNS(), *targeter.getStats());
             }
 
+            recordChildBatchLatencies(exec.getStats());
+
             _stats->setShardStats(exec.releaseStats());
         }
     }
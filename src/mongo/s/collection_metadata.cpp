@@ -114,7 +114,6 @@ namespace mongo {
         metadata->_shardVersion = newShardVersion;
         metadata->_collVersion =
                 newShardVersion > _collVersion ? newShardVersion : this->_collVersion;
-        metadata->fillRanges();
 
         invariant(metadata->isValid());
         return metadata.release();
@@ -168,7 +167,6 @@ namespace mongo {
         metadata->_shardVersion = newShardVersion;
         metadata->_collVersion =
                 newShardVersion > _collVersion ? newShardVersion : this->_collVersion;
-        metadata->fillRanges();
 
         invariant(metadata->isValid());
         return metadata.release();
@@ -208,7 +206,6 @@ namespace mongo {
         metadata->_pendingMap = this->_pendingMap;
         metadata->_pendingMap.erase( pending.getMin() );
         metadata->_chunksMap = this->_chunksMap;
-        metadata->_rangesMap = this->_rangesMap;
         metadata->_shardVersion = _shardVersion;
         metadata->_collVersion = _collVersion;
 
@@ -243,7 +240,6 @@ namespace mongo {
         metadata->fillKeyPatternFields();
         metadata->_pendingMap = this->_pendingMap;
         metadata->_chunksMap = this->_chunksMap;
-        metadata->_rangesMap = this->_rangesMap;
         metadata->_shardVersion = _shardVersion;
         metadata->_collVersion = _collVersion;
 
@@ -351,7 +347,7 @@ namespace mongo {
                 ++it ) {
             BSONObj split = *it;
             invariant(split.woCompare(startKey) > 0);
-            metadata->_chunksMap[startKey] = split.getOwned();
+            metadata->_chunksMap.set( startKey, split.getOwned() );
             metadata->_chunksMap.insert( make_pair( split.getOwned(), chunk.getMax().getOwned() ));
             metadata->_shardVersion.incMinor();
             startKey = split;
@@ -359,7 +355,6 @@ namespace mongo {
 
         metadata->_collVersion =
                 metadata->_shardVersion > _collVersion ? metadata->_shardVersion : _collVersion;
-        metadata->fillRanges();
 
         invariant(metadata->isValid());
         return metadata.release();
@@ -433,7 +428,6 @@ namespace mongo {
         metadata->fillKeyPatternFields();
         metadata->_pendingMap = this->_pendingMap;
         metadata->_chunksMap = this->_chunksMap;
-        metadata->_rangesMap = this->_rangesMap;
         metadata->_shardVersion = newShardVersion;
         metadata->_collVersion =
                 newShardVersion > _collVersion ? newShardVersion : this->_collVersion;
@@ -455,12 +449,12 @@ namespace mongo {
             return true;
         }
 
-        if ( _rangesMap.size() <= 0 ) {
+        if ( _chunksMap.size() <= 0 ) {
             return false;
         }
 
-        RangeMap::const_iterator it = _rangesMap.upper_bound( key );
-        if ( it != _rangesMap.begin() ) it--;
+        RangeMap::const_iterator it = _chunksMap.upper_bound( key );
+        if ( it != _chunksMap.begin() ) it--;
 
         bool good = rangeContains( it->first, it->second, key );
 
@@ -471,7 +465,7 @@ namespace mongo {
             log() << "bad: " << key << " " << it->first << " " << key.woCompare( it->first ) << " "
                   << key.woCompare( it->second ) << endl;
 
-            for ( RangeMap::const_iterator i = _rangesMap.begin(); i != _rangesMap.end(); ++i ) {
+            for ( RangeMap::const_iterator i = _chunksMap.begin(); i != _chunksMap.end(); ++i ) {
                 log() << "\t" << i->first << "\t" << i->second << "\t" << endl;
             }
         }
@@ -650,13 +644,13 @@ namespace mongo {
     string CollectionMetadata::toString() const {
         StringBuilder ss;
         ss << " CollectionManager version: " << _shardVersion.toString() << " key: " << _keyPattern;
-        if (_rangesMap.empty()) {
+        if (_chunksMap.empty()) {
             return ss.str();
         }
 
-        RangeMap::const_iterator it = _rangesMap.begin();
+        RangeMap::const_iterator it = _chunksMap.begin();
         ss << it->first << " -> " << it->second;
-        while (it != _rangesMap.end()) {
+        while (++it != _chunksMap.end()) {
             ss << ", "<< it->first << " -> " << it->second;
         }
         return ss.str();
@@ -686,14 +680,14 @@ namespace mongo {
 
         if (_shardVersion.majorVersion() > 0) {
             // Must be chunks
-            if (_rangesMap.size() == 0 || _chunksMap.size() == 0)
+            if (_chunksMap.size() == 0)
                 return false;
         }
         else {
             // No chunks
             if (_shardVersion.minorVersion() > 0)
                 return false;
-            if (_rangesMap.size() > 0 || _chunksMap.size() > 0)
+            if (_chunksMap.size() > 0)
                 return false;
         }
 
@@ -709,40 +703,6 @@ namespace mongo {
         return key.nFields() == _keyPattern.nFields();
     }
 
-    void CollectionMetadata::fillRanges() {
-        if (_chunksMap.empty())
-            return;
-
-        // Load the chunk information, coallesceing their ranges.  The version for this shard
-        // would be the highest version for any of the chunks.
-        RangeMap::const_iterator it = _chunksMap.begin();
-        BSONObj min,max;
-        while (it != _chunksMap.end()) {
-            BSONObj currMin = it->first;
-            BSONObj currMax = it->second;
-            ++it;
-
-            // coalesce the chunk's bounds in ranges if they are adjacent chunks
-            if (min.isEmpty()) {
-                min = currMin;
-                max = currMax;
-                continue;
-            }
-            if (max == currMin) {
-                max = currMax;
-                continue;
-            }
-
-            _rangesMap.insert(make_pair(min, max));
-
-            min = currMin;
-            max = currMax;
-        }
-        dassert(!min.isEmpty());
-
-        _rangesMap.insert(make_pair(min, max));
-    }
-
     void CollectionMetadata::fillKeyPatternFields() {
         // Parse the shard keys into the states 'keys' and 'keySet' members.
         BSONObjIterator patternIter = _keyPattern.begin();
@@ -292,24 +292,15 @@ namespace mongo {
         // Map of ranges of chunks that are migrating but have not been confirmed added yet
         RangeMap _pendingMap;
 
-        // Map of chunks tracked by this shard
+        // Map of chunks tracked by this shard.  Derived metadata shares all unchanged chunks
+        // with the metadata it was cloned or refreshed from.
         RangeMap _chunksMap;
 
-        // A second map from a min key into a range or contiguous chunks. The map is redundant
-        // w.r.t. _chunkMap but we expect high chunk contiguity, especially in small
-        // installations.
-        RangeMap _rangesMap;
-
         /**
          * Returns true if this metadata was loaded with all necessary information.
          */
         bool isValid() const;
 
-        /**
-         * Try to find chunks that are adjacent and record these intervals in the _rangesMap
-         */
-        void fillRanges();
-
         /**
          * Creates the _keyField* local data
          */
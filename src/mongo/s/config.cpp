@@ -166,6 +166,9 @@ namespace mongo {
           _primary("config", "", 0 /* maxSize */, false /* draining */),
           _shardingEnabled(false) {
         invariant(!_name.empty());
+
+        boost::lock_guard<boost::mutex> lk( _lock );
+        _publishSnapshot();
     }
 
     DBConfig::~DBConfig() {
@@ -175,8 +178,27 @@ namespace mongo {
     bool DBConfig::isSharded( const string& ns ) {
         if ( ! _shardingEnabled )
             return false;
-        boost::lock_guard<boost::mutex> lk( _lock );
-        return _isSharded( ns );
+        return _getSnapshot()->shardedCollections.count( ns ) > 0;
+    }
+
+    void DBConfig::_publishSnapshot() {
+        boost::shared_ptr<RoutingSnapshot> snapshot(new RoutingSnapshot());
+        snapshot->primary = _primary;
+
+        for (CollectionInfoMap::const_iterator it = _collections.begin();
+             it != _collections.end();
+             ++it) {
+
+            if (it->second.isSharded()) {
+                snapshot->shardedCollections[it->first] = it->second.getCM();
+            }
+        }
+
+        boost::atomic_store(&_snapshot, boost::shared_ptr<const RoutingSnapshot>(snapshot));
+    }
+
+    boost::shared_ptr<const DBConfig::RoutingSnapshot> DBConfig::_getSnapshot() const {
+        return boost::atomic_load(&_snapshot);
     }
 
     bool DBConfig::_isSharded( const string& ns ) {
@@ -276,6 +298,7 @@ namespace mongo {
                                   initPoints,
                                   initShards);
             ci.shard(cm);
+            _publishSnapshot();
 
             _save();
 
@@ -338,6 +361,8 @@ namespace mongo {
         }
 
         ci.unshard();
+        _publishSnapshot();
+
         _save( false, true );
         return true;
     }
@@ -353,28 +378,23 @@ namespace mongo {
         primary.reset();
 
         {
-            boost::lock_guard<boost::mutex> lk( _lock );
-
-            CollectionInfoMap::iterator i = _collections.find( ns );
-
-            // No namespace
-            if( i == _collections.end() ){
-                // If we don't know about this namespace, it's unsharded by default
-                primary.reset( new Shard( _primary ) );
+            // A single snapshot has both the chunk managers and the primary, so this is atomic
+            // with respect to sharding and unsharding, without taking the lock
+            const boost::shared_ptr<const RoutingSnapshot> snapshot = _getSnapshot();
+
+            std::map<string, ChunkManagerPtr>::const_iterator i =
+                                                    snapshot->shardedCollections.find( ns );
+
+            // TODO: we need to be careful about handling shardingEnabled, b/c in some places we seem to use and
+            // some we don't.  If we use this function in combination with just getChunkManager() on a slightly
+            // borked config db, we'll get lots of staleconfig retries
+            if( _shardingEnabled && i != snapshot->shardedCollections.end() ){
+                manager = i->second;
             }
-            else {
-                CollectionInfo& cInfo = i->second;
-
-                // TODO: we need to be careful about handling shardingEnabled, b/c in some places we seem to use and
-                // some we don't.  If we use this function in combination with just getChunkManager() on a slightly
-                // borked config db, we'll get lots of staleconfig retries
-                if( _shardingEnabled && cInfo.isSharded() ){
-                    manager = cInfo.getCM();
-                }
-                else{
-                    // Make a copy, we don't want to be tied to this config object
-                    primary.reset( new Shard( _primary ) );
-                }
+            else{
+                // If we don't know about this namespace, it's unsharded by default. Make a copy,
+                // we don't want to be tied to this config object
+                primary.reset( new Shard( snapshot->primary ) );
             }
         }
 
@@ -403,6 +423,17 @@ namespace mongo {
         ChunkVersion oldVersion;
         ChunkManagerPtr oldManager;
 
+        if ( ! ( shouldReload || forceReload ) ) {
+            // Fast path for routing, which doesn't need the lock
+            const boost::shared_ptr<const RoutingSnapshot> snapshot = _getSnapshot();
+
+            std::map<string, ChunkManagerPtr>::const_iterator i =
+                                                    snapshot->shardedCollections.find( ns );
+            if ( i != snapshot->shardedCollections.end() ) {
+                return i->second;
+            }
+        }
+
         {
             boost::lock_guard<boost::mutex> lk( _lock );
             
@@ -529,6 +560,7 @@ namespace mongo {
 
         if ( shouldReset ){
             ci.resetCM( temp.release() );
+            _publishSnapshot();
         }
         
         uassert( 15883 , str::stream() << "not sharded after chunk manager reset : " << ns , ci.isSharded() );
@@ -538,6 +570,8 @@ namespace mongo {
     void DBConfig::setPrimary( const std::string& s ) {
         boost::lock_guard<boost::mutex> lk( _lock );
         _primary.reset( s );
+        _publishSnapshot();
+
         _save();
     }
 
@@ -599,6 +633,8 @@ namespace mongo {
 
         conn.done();
 
+        _publishSnapshot();
+
         return true;
     }
 
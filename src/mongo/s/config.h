@@ -36,6 +36,7 @@
 #pragma once
 
 #include <boost/shared_ptr.hpp>
+#include <map>
 
 #include "mongo/client/dbclient_rs.h"
 #include "mongo/s/shard.h"
@@ -170,6 +171,25 @@ namespace mongo {
 
         typedef std::map<std::string, CollectionInfo> CollectionInfoMap;
 
+        /**
+         * Immutable copy of the routing information of this database. Requests are routed
+         * through the most recently published snapshot, so they don't need to take _lock.
+         */
+        struct RoutingSnapshot {
+            Shard primary;
+
+            // Chunk managers of the sharded collections only
+            std::map<std::string, boost::shared_ptr<ChunkManager> > shardedCollections;
+        };
+
+        /**
+         * Builds a snapshot from _primary and _collections and makes it visible to readers. Must
+         * be called with _lock held, after every change to either of them.
+         */
+        void _publishSnapshot();
+
+        boost::shared_ptr<const RoutingSnapshot> _getSnapshot() const;
+
 
         /**
             lockless
@@ -190,7 +210,11 @@ namespace mongo {
 
         CollectionInfoMap _collections;
 
-        mutable mongo::mutex _lock; // TODO: change to r/w lock ??
+        // Only accessed through boost::atomic_load and boost::atomic_store
+        boost::shared_ptr<const RoutingSnapshot> _snapshot;
+
+        // Serializes changes to the configuration, readers use _snapshot instead
+        mutable mongo::mutex _lock;
         mutable mongo::mutex _hitConfigServerLock;
     };
 
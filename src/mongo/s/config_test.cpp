@@ -0,0 +1,152 @@
+/**
+ *    Copyright (C) 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kSharding
+
+#include "mongo/platform/basic.h"
+
+#include <boost/shared_ptr.hpp>
+#include <map>
+#include <string>
+
+#include "mongo/config.h"
+#include "mongo/s/chunk_manager.h"
+#include "mongo/s/config.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/unittest/thread_benchmark.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/log.h"
+
+namespace {
+
+    using namespace mongo;
+
+    /**
+     * Assigns a primary shard without going through setPrimary, which saves to the config server.
+     */
+    class PrimaryDBConfig : public DBConfig {
+    public:
+        PrimaryDBConfig(const std::string& name, const Shard& primary) : DBConfig(name) {
+            boost::lock_guard<boost::mutex> lk(_lock);
+            _primary = primary;
+            _publishSnapshot();
+        }
+    };
+
+    TEST(DBConfigTest, UnknownCollectionRoutesToPrimary) {
+        PrimaryDBConfig config("test", Shard("shard0000", "localhost:27018", 0, false));
+        config.enableSharding(false);
+
+        ASSERT_FALSE(config.isSharded("test.foo"));
+
+        ChunkManagerPtr manager;
+        ShardPtr primary;
+        config.getChunkManagerOrPrimary("test.foo", manager, primary);
+        ASSERT(!manager);
+        ASSERT(primary);
+        ASSERT_EQUALS("shard0000", primary->getName());
+        ASSERT_EQUALS(config.getPrimary().getName(), primary->getName());
+
+        ASSERT_THROWS(config.getChunkManager("test.foo"), UserException);
+    }
+
+    // Measures how routing lookups of a sharded collection scale with the number of threads
+    // looking up collections in the same database, compared with taking DBConfig::_lock as
+    // lookups did before routing snapshots. It is not practical to run this on debug builds.
+#ifndef MONGO_CONFIG_DEBUG_BUILD
+
+    const int NUM_PERF_ITERS_PER_THREAD = 500 * 1000;
+
+    /**
+     * Lets the benchmark route a sharded collection without a config server, and keeps a copy of
+     * the collection map to measure the old lookup path under _lock against.
+     */
+    class BenchmarkDBConfig : public DBConfig {
+    public:
+        BenchmarkDBConfig() : DBConfig("test") { }
+
+        void addShardedCollection(const std::string& ns) {
+            boost::lock_guard<boost::mutex> lk(_lock);
+
+            ChunkManagerPtr manager(new ChunkManager(ns, ShardKeyPattern(BSON("_id" << 1)), false));
+            _lockedCollections[ns] = manager;
+
+            // Publish directly, since CollectionInfo would load the chunks from the config server
+            boost::shared_ptr<RoutingSnapshot> snapshot(new RoutingSnapshot(*_getSnapshot()));
+            snapshot->shardedCollections[ns] = manager;
+            boost::atomic_store(&_snapshot, boost::shared_ptr<const RoutingSnapshot>(snapshot));
+        }
+
+        ChunkManagerPtr getChunkManagerUnderLock(const std::string& ns) {
+            boost::lock_guard<boost::mutex> lk(_lock);
+            std::map<std::string, ChunkManagerPtr>::const_iterator it = _lockedCollections.find(ns);
+            invariant(it != _lockedCollections.end());
+            return it->second;
+        }
+
+    private:
+        std::map<std::string, ChunkManagerPtr> _lockedCollections;
+    };
+
+    void snapshotLookupLoop(BenchmarkDBConfig* config) {
+        for (int i = 0; i < NUM_PERF_ITERS_PER_THREAD; i++) {
+            invariant(config->getChunkManager("test.sharded"));
+        }
+    }
+
+    void lockedLookupLoop(BenchmarkDBConfig* config) {
+        for (int i = 0; i < NUM_PERF_ITERS_PER_THREAD; i++) {
+            invariant(config->getChunkManagerUnderLock("test.sharded"));
+        }
+    }
+
+    TEST(DBConfigTest, PerformanceShardedRoutingThroughput) {
+        BenchmarkDBConfig config;
+        config.enableSharding(false);
+        config.addShardedCollection("test.sharded");
+
+        for (int numThreads = 1; numThreads <= 64; numThreads = numThreads * 2) {
+            // Do some warm-up loops
+            snapshotLookupLoop(&config);
+
+            const long long snapshotMicros = unittest::runConcurrently(
+                numThreads, stdx::bind(snapshotLookupLoop, &config));
+            const long long lockedMicros = unittest::runConcurrently(
+                numThreads, stdx::bind(lockedLookupLoop, &config));
+
+            log() << numThreads << " threads: "
+                  << unittest::opsPerSecond(numThreads, NUM_PERF_ITERS_PER_THREAD, snapshotMicros)
+                  << " lookups/sec through the snapshot, "
+                  << unittest::opsPerSecond(numThreads, NUM_PERF_ITERS_PER_THREAD, lockedMicros)
+                  << " lookups/sec under _lock";
+        }
+    }
+
+#endif  // MONGO_CONFIG_DEBUG_BUILD
+
+} // namespace
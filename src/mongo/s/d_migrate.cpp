@@ -45,6 +45,7 @@
 #include <string>
 #include <vector>
 
+#include "mongo/base/owned_pointer_vector.h"
 #include "mongo/client/connpool.h"
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/db/auth/action_set.h"
@@ -70,6 +71,7 @@
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/range_deleter_service.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/storage/mmap_v1/dur.h"
@@ -85,12 +87,14 @@
 #include "mongo/s/grid.h"
 #include "mongo/s/shard.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/elapsed_tracker.h"
 #include "mongo/util/exit.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/queue.h"
+#include "mongo/util/scopeguard.h"
 #include "mongo/util/startup_test.h"
 
 // Pause while a fail point is enabled.
@@ -136,6 +140,29 @@ namespace mongo {
 
     Tee* migrateLog = RamLog::get("migrate");
 
+    // Number of threads inserting cloned documents on the recipient shard of a migration
+    const int kMaxMigrateCloneInsertionThreads = 16;
+    int migrateCloneInsertionThreads = 4;
+
+    class ExportedMigrateCloneInsertionThreadsParameter : public ExportedServerParameter<int> {
+    public:
+        ExportedMigrateCloneInsertionThreadsParameter() :
+            ExportedServerParameter<int>(ServerParameterSet::getGlobal(),
+                                         "migrateCloneInsertionThreads",
+                                         &migrateCloneInsertionThreads,
+                                         true,
+                                         true) {}
+
+        virtual Status validate(const int& potentialNewValue) {
+            if (potentialNewValue < 1 || potentialNewValue > kMaxMigrateCloneInsertionThreads) {
+                return Status(ErrorCodes::BadValue,
+                              str::stream() << "migrateCloneInsertionThreads must be between 1 "
+                                            << "and " << kMaxMigrateCloneInsertionThreads);
+            }
+            return Status::OK();
+        }
+    } exportedMigrateCloneInsertionThreadsParameter;
+
     class MoveTimingHelper {
     public:
         MoveTimingHelper(OperationContext* txn,
@@ -190,6 +217,13 @@ namespace mongo {
             }
         }
 
+        /**
+         * Adds the fields of 'stats' to the changelog entry.
+         */
+        void appendStats(const BSONObj& stats) {
+            _b.appendElements(stats);
+        }
+
         void done(int step) {
             verify( step == ++_next );
             verify( step <= _total );
@@ -2137,85 +2171,85 @@ namespace mongo {
                 // 3. initial bulk clone
                 setState(CLONE);
 
+                Timer cloneTimer;
+
+                // The batch being inserted must stay alive until the workers are done with it
+                BSONObj insertingBatch;
+                std::vector<BSONObj> insertingDocs;
+                OwnedPointerVector<CloneSlice> slices;
+
+                // Declared last, so that it is joined before the batch goes away on error
+                const int numThreads = std::max(1, std::min(migrateCloneInsertionThreads,
+                                                            kMaxMigrateCloneInsertionThreads));
+                threadpool::ThreadPool insertPool(numThreads, "migrateCloneWorker");
+
                 while ( true ) {
+                    // Fetch the next batch while the workers insert the previous one
                     BSONObj res;
                     if ( ! conn->runCommand( "admin" , BSON( "_migrateClone" << 1 ) , res ) ) {  // gets array of objects to copy, in disk order
                         setState(FAIL);
                         errmsg = "_migrateClone failed: ";
                         errmsg += res.toString();
                         error() << errmsg << migrateLog;
+                        insertPool.join();
                         conn.done();
                         return;
                     }
 
-                    BSONObj arr = res["objects"].Obj();
-                    int thisTime = 0;
+                    insertPool.join();
 
-                    BSONObjIterator i( arr );
-                    while( i.more() ) {
-                        txn->checkForInterrupt();
+                    txn->checkForInterrupt();
 
-                        if ( getState() == ABORT ) {
-                            errmsg = str::stream() << "Migration abort requested while "
-                                                   << "copying documents";
-                            error() << errmsg << migrateLog;
-                            return;
-                        }
+                    if ( getState() == ABORT ) {
+                        errmsg = str::stream() << "Migration abort requested while "
+                                               << "copying documents";
+                        error() << errmsg << migrateLog;
+                        return;
+                    }
 
-                        BSONObj docToClone = i.next().Obj();
-                        {
-                            OldClientWriteContext cx(txn, ns );
-
-                            BSONObj localDoc;
-                            if (willOverrideLocalId(txn,
-                                                    ns,
-                                                    min,
-                                                    max,
-                                                    shardKeyPattern,
-                                                    cx.db(),
-                                                    docToClone,
-                                                    &localDoc)) {
-                                string errMsg =
-                                    str::stream() << "cannot migrate chunk, local document "
-                                    << localDoc
-                                    << " has same _id as cloned "
-                                    << "remote document " << docToClone;
-
-                                warning() << errMsg << endl;
-
-                                // Exception will abort migration cleanly
-                                uasserted( 16976, errMsg );
-                            }
-
-                            Helpers::upsert( txn, ns, docToClone, true );
-                        }
-                        thisTime++;
+                    _finishCloneBatch(txn, slices.vector(), writeConcern);
+                    slices.clear();
 
-                        {
-                            boost::lock_guard<boost::mutex> statsLock(_mutex);
-                            _numCloned++;
-                            _clonedBytes += docToClone.objsize();
-                        }
+                    insertingBatch = res;
+                    insertingDocs.clear();
 
-                        if (writeConcern.shouldWaitForOtherNodes()) {
-                            repl::ReplicationCoordinator::StatusAndDuration replStatus =
-                                    repl::getGlobalReplicationCoordinator()->awaitReplication(
-                                            txn,
-                                            repl::ReplClientInfo::forClient(
-                                                    txn->getClient()).getLastOp(),
-                                            writeConcern);
-                            if (replStatus.status.code() == ErrorCodes::ExceededTimeLimit) {
-                                warning() << "secondaryThrottle on, but doc insert timed out; "
-                                             "continuing";
-                            }
-                            else {
-                                massertStatusOK(replStatus.status);
-                            }
-                        }
+                    BSONObjIterator i( insertingBatch["objects"].Obj() );
+                    while( i.more() ) {
+                        insertingDocs.push_back( i.next().Obj() );
                     }
 
-                    if ( thisTime == 0 )
+                    if ( insertingDocs.empty() )
                         break;
+
+                    // Documents in a batch don't depend on each other, so split it into
+                    // contiguous slices for the workers
+                    const size_t sliceSize =
+                        ( insertingDocs.size() + numThreads - 1 ) / numThreads;
+                    for ( size_t begin = 0; begin < insertingDocs.size(); begin += sliceSize ) {
+                        CloneSlice* slice = new CloneSlice( ns, min, max, shardKeyPattern );
+                        slice->docs = &insertingDocs;
+                        slice->begin = begin;
+                        slice->end = std::min( begin + sliceSize, insertingDocs.size() );
+                        slices.mutableVector().push_back( slice );
+
+                        insertPool.schedule( &MigrateStatus::_cloneSlice, this, slice );
+                    }
+                }
+
+                const long long cloneMillis = cloneTimer.millis();
+                {
+                    boost::lock_guard<boost::mutex> statsLock(_mutex);
+
+                    BSONObjBuilder cloneStats;
+                    cloneStats.append( "clonedDocs", _numCloned );
+                    cloneStats.append( "clonedBytes", _clonedBytes );
+                    cloneStats.append( "cloneMillis", cloneMillis );
+                    cloneStats.append( "cloneDocsPerSec",
+                                       _numCloned * 1000 / std::max( 1LL, cloneMillis ) );
+                    cloneStats.append( "cloneBytesPerSec",
+                                       _clonedBytes * 1000 / std::max( 1LL, cloneMillis ) );
+                    cloneStats.append( "cloneThreads", numThreads );
+                    timing.appendStats( cloneStats.obj() );
                 }
 
                 timing.done(3);
@@ -2506,6 +2540,174 @@ namespace mongo {
             return false;
         }
 
+        /**
+         * A contiguous part of a batch of cloned documents, which is inserted by one clone
+         * worker thread.
+         */
+        struct CloneSlice {
+            CloneSlice(const string& ns, BSONObj min, BSONObj max, BSONObj shardKeyPattern)
+                : ns(ns),
+                  min(min),
+                  max(max),
+                  shardKeyPattern(shardKeyPattern),
+                  docs(NULL),
+                  begin(0),
+                  end(0),
+                  status(Status::OK()),
+                  numInserted(0),
+                  bytesInserted(0) {
+            }
+
+            const string ns;
+            const BSONObj min;
+            const BSONObj max;
+            const BSONObj shardKeyPattern;
+
+            // Not owned here, documents [begin, end) are inserted
+            const std::vector<BSONObj>* docs;
+            size_t begin;
+            size_t end;
+
+            // Outcome
+            Status status;
+            Timestamp lastOp;
+            long long numInserted;
+            long long bytesInserted;
+        };
+
+        /**
+         * Runs on a clone worker thread and inserts the documents of one slice. Any error,
+         * including an abort request, is reported through the slice's status.
+         */
+        void _cloneSlice(CloneSlice* slice) {
+            // The thread pool only logs exceptions which escape its tasks, so every failure has
+            // to be recorded in the slice for the migrate thread to fail the migration
+            try {
+                _insertSlice(slice);
+            }
+            catch (const DBException& e) {
+                slice->status = e.toStatus();
+            }
+            catch (const std::exception& e) {
+                slice->status = Status(ErrorCodes::UnknownError,
+                                       str::stream() << "clone worker failed: " << e.what());
+            }
+            catch (...) {
+                slice->status = Status(ErrorCodes::UnknownError,
+                                       "clone worker failed with an unknown exception");
+            }
+        }
+
+        void _insertSlice(CloneSlice* slice) {
+            Client::initThreadIfNotAlready("migrateCloneWorker");
+            OperationContextImpl txn;
+            if (getGlobalAuthorizationManager()->isAuthEnabled()) {
+                txn.getClient()->getAuthorizationSession()->grantInternalAuthorization();
+            }
+
+            // Record how far this worker got in the oplog, even if an insert fails
+            ON_BLOCK_EXIT(&MigrateStatus::_recordSliceLastOp, slice, &txn);
+
+            // Don't hold the write lock for the whole slice
+            const size_t kDocsPerLock = 64;
+
+            size_t i = slice->begin;
+            while (i < slice->end) {
+                if (getState() == ABORT) {
+                    slice->status = Status(ErrorCodes::OperationFailed,
+                                           "Migration abort requested while copying "
+                                           "documents");
+                    return;
+                }
+
+                OldClientWriteContext cx(&txn, slice->ns);
+
+                const size_t lockEnd = std::min(i + kDocsPerLock, slice->end);
+                for (; i < lockEnd; i++) {
+                    const BSONObj& docToClone = (*slice->docs)[i];
+
+                    BSONObj localDoc;
+                    if (willOverrideLocalId(&txn,
+                                            slice->ns,
+                                            slice->min,
+                                            slice->max,
+                                            slice->shardKeyPattern,
+                                            cx.db(),
+                                            docToClone,
+                                            &localDoc)) {
+                        string errMsg =
+                            str::stream() << "cannot migrate chunk, local document "
+                            << localDoc
+                            << " has same _id as cloned "
+                            << "remote document " << docToClone;
+
+                        warning() << errMsg << endl;
+
+                        // Exception will abort migration cleanly
+                        uasserted( 16976, errMsg );
+                    }
+
+                    Helpers::upsert( &txn, slice->ns, docToClone, true );
+
+                    slice->numInserted++;
+                    slice->bytesInserted += docToClone.objsize();
+                }
+            }
+        }
+
+        static void _recordSliceLastOp(CloneSlice* slice, OperationContext* txn) {
+            slice->lastOp = repl::ReplClientInfo::forClient(txn->getClient()).getLastOp();
+        }
+
+        /**
+         * Called on the migrate thread once all slices of a cloned batch are done. Records the
+         * progress and throws if any of the slices failed.
+         */
+        void _finishCloneBatch(OperationContext* txn,
+                               const std::vector<CloneSlice*>& slices,
+                               const WriteConcernOptions& writeConcern) {
+            if (slices.empty()) {
+                return;
+            }
+
+            repl::ReplClientInfo& replClient = repl::ReplClientInfo::forClient(txn->getClient());
+            Timestamp lastOp = replClient.getLastOp();
+
+            for (size_t i = 0; i < slices.size(); i++) {
+                {
+                    boost::lock_guard<boost::mutex> statsLock(_mutex);
+                    _numCloned += slices[i]->numInserted;
+                    _clonedBytes += slices[i]->bytesInserted;
+                }
+
+                if (lastOp < slices[i]->lastOp) {
+                    lastOp = slices[i]->lastOp;
+                }
+            }
+
+            // The catchup phase waits for the cloned documents to replicate through the
+            // migrate thread's last op
+            replClient.setLastOp(lastOp);
+
+            for (size_t i = 0; i < slices.size(); i++) {
+                uassertStatusOK(slices[i]->status);
+            }
+
+            if (writeConcern.shouldWaitForOtherNodes()) {
+                repl::ReplicationCoordinator::StatusAndDuration replStatus =
+                        repl::getGlobalReplicationCoordinator()->awaitReplication(txn,
+                                                                                 lastOp,
+                                                                                 writeConcern);
+                if (replStatus.status.code() == ErrorCodes::ExceededTimeLimit) {
+                    warning() << "secondaryThrottle on, but doc insert timed out; "
+                                 "continuing";
+                }
+                else {
+                    massertStatusOK(replStatus.status);
+                }
+            }
+        }
+
         /**
          * Returns true if the majority of the nodes and the nodes corresponding to the given
          * writeConcern (if not empty) have applied till the specified lastOp.
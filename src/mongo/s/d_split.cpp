@@ -60,6 +60,7 @@
 #include "mongo/s/distlock.h"
 #include "mongo/s/grid.h"
 #include "mongo/s/shard_key_pattern.h"
+#include "mongo/s/split_point_sampler.h"
 #include "mongo/util/log.h"
 #include "mongo/util/timer.h"
 
@@ -223,6 +224,84 @@ namespace mongo {
         return key.replaceFieldNames(keyPattern).clientReadable();
     }
 
+    /**
+     * The sampling variant of splitVector.  Reads the range once, keeping a uniform random sample
+     * of its keys, and takes the split points (or the median, if 'forceMedianSplit') from the
+     * sample.  The result reports how far the split points may be from the exact ones.
+     */
+    bool sampledSplitKeys( OperationContext* txn,
+                           Collection* collection,
+                           IndexDescriptor* idx,
+                           const BSONObj& keyPattern,
+                           const BSONObj& min,
+                           const BSONObj& max,
+                           long long sampleSize,
+                           long long keyCount,
+                           long long maxSplitPoints,
+                           bool forceMedianSplit,
+                           long long maxChunkSize,
+                           string& errmsg,
+                           BSONObjBuilder& result ) {
+
+        Timer timer;
+        SplitPointSampler sampler( sampleSize, curTimeMicros64() );
+
+        auto_ptr<PlanExecutor> exec(
+            InternalPlanner::indexScan(txn, collection, idx, min, max,
+                                       false, InternalPlanner::FORWARD));
+        exec->setYieldPolicy(PlanExecutor::YIELD_AUTO);
+
+        BSONObj currKey;
+        while (PlanExecutor::ADVANCED == exec->getNext(&currKey, NULL)) {
+            if ( sampler.next() ) {
+                sampler.add( prettyKey(idx->keyPattern(), currKey).extractFields( keyPattern ) );
+            }
+        }
+
+        if ( sampler.keysSeen() == 0 ) {
+            errmsg = "can't open a cursor for splitting (desired range is possibly empty)";
+            return false;
+        }
+
+        vector<BSONObj> splitKeys;
+        set<BSONObj> tooFrequentKeys;
+        if ( forceMedianSplit ) {
+            BSONObj median = sampler.median();
+            if ( !median.isEmpty() ) {
+                splitKeys.push_back( median );
+            }
+        }
+        else {
+            splitKeys = sampler.splitPoints( keyCount, &tooFrequentKeys );
+            if ( maxSplitPoints && static_cast<long long>( splitKeys.size() ) > maxSplitPoints ) {
+                splitKeys.resize( maxSplitPoints );
+            }
+        }
+
+        for ( set<BSONObj>::const_iterator it = tooFrequentKeys.begin(); it != tooFrequentKeys.end(); ++it ) {
+            warning() << "chunk is larger than " << maxChunkSize
+                      << " bytes because of key " << *it << endl;
+        }
+
+        const double maxRankError = sampler.maxRankError( 0.99 );
+
+        if (timer.millis() > serverGlobalParams.slowMS) {
+            warning() << "Sampling the split vector for " << collection->ns() << " over " << keyPattern
+                      << " keyCount: " << keyCount << " numSplits: " << splitKeys.size()
+                      << " lookedAt: " << sampler.keysSeen() << " sampled: " << sampler.sampleSize()
+                      << " took " << timer.millis() << "ms" << endl;
+        }
+
+        result.append( "timeMillis", timer.millis() );
+        result.append( "sampled", BSON( "keysExamined" << sampler.keysSeen()
+                                        << "sampleSize" << static_cast<long long>( sampler.sampleSize() )
+                                        << "exact" << sampler.isExact()
+                                        << "maxRankError" << maxRankError
+                                        << "confidence" << 0.99 ) );
+        result.append( "splitKeys" , splitKeys );
+        return true;
+    }
+
     class SplitVector : public Command {
     public:
         SplitVector() : Command( "splitVector" , false ) {}
@@ -238,6 +317,10 @@ namespace mongo {
                  "  \n"
                  "  { splitVector : \"blog.post\" , keyPattern:{x:1} , min:{x:10} , max:{x:20}, force: true }\n"
                  "  'force' will produce one split point even if data is small; defaults to false\n"
+                 "  \n"
+                 "  { splitVector : \"blog.post\" , keyPattern:{x:1} , min:{x:10} , max:{x:20}, maxChunkSize:200, sampleSize:10000 }\n"
+                 "  'sampleSize' picks the split points from a random sample of that many keys, in a single pass\n"
+                 "  'sampleSize' is ignored when 'maxSplitPoints' is given without 'force'\n"
                  "NOTE: This command may take a while to run";
         }
         virtual Status checkAuthForCommand(ClientBasic* client,
@@ -288,6 +371,12 @@ namespace mongo {
                 maxChunkObjects = MaxChunkObjectsElem.numberLong();
             }
 
+            long long sampleSize = 0;
+            BSONElement sampleSizeElem = jsobj[ "sampleSize" ];
+            if ( sampleSizeElem.isNumber() ) {
+                sampleSize = sampleSizeElem.numberLong();
+            }
+
             vector<BSONObj> splitKeys;
 
             {
@@ -383,6 +472,14 @@ namespace mongo {
                     keyCount = maxChunkObjects;
                 }
                 
+                // The full scan stops after 'maxSplitPoints' keys, while the sample has to read
+                // the whole range, so sampling only pays off when every key would be read anyway
+                if ( sampleSize > 0 && ( forceMedianSplit || !maxSplitPoints ) ) {
+                    return sampledSplitKeys( txn, collection, idx, keyPattern, min, max,
+                                             sampleSize, keyCount, maxSplitPoints,
+                                             forceMedianSplit, maxChunkSize, errmsg, result );
+                }
+
                 //
                 // 2. Traverse the index and add the keyCount-th key to the result vector. If that key
                 //    appeared in the vector before, we omit it. The invariant here is that all the
@@ -44,6 +44,7 @@
 #include <string>
 #include <vector>
 
+#include "mongo/base/counter.h"
 #include "mongo/client/connpool.h"
 #include "mongo/db/auth/action_set.h"
 #include "mongo/db/auth/action_type.h"
@@ -51,11 +52,13 @@
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/auth/privilege.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/db.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/operation_context.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/db/stats/timer_stats.h"
 #include "mongo/db/wire_version.h"
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/client/shard_connection.h"
@@ -76,6 +79,20 @@ namespace mongo {
     using std::stringstream;
     using std::vector;
 
+    // Time spent loading collection metadata from the config servers, and how many of those
+    // loads started from the existing chunks rather than reloading all of them
+    static TimerStats metadataRefreshStats;
+    static ServerStatusMetricField<TimerStats> displayMetadataRefreshLatency(
+            "sharding.metadataRefresh.latency", &metadataRefreshStats);
+
+    static Counter64 metadataRefreshIncremental;
+    static ServerStatusMetricField<Counter64> displayMetadataRefreshIncremental(
+            "sharding.metadataRefresh.incremental", &metadataRefreshIncremental);
+
+    static Counter64 metadataRefreshFull;
+    static ServerStatusMetricField<Counter64> displayMetadataRefreshFull(
+            "sharding.metadataRefresh.full", &metadataRefreshFull);
+
     // -----ShardingState START ----
 
     ShardingState::ShardingState()
@@ -578,7 +595,9 @@ namespace mongo {
                                                  getShardName(),
                                                  ( fullReload ? NULL : beforeMetadata.get() ),
                                                  remoteMetadataRaw );
-        long long refreshMillis = refreshTimer.millis();
+        long long refreshMillis = metadataRefreshStats.record( refreshTimer );
+        if ( fullReload || !beforeMetadata ) metadataRefreshFull.increment();
+        else metadataRefreshIncremental.increment();
 
         if ( status.code() == ErrorCodes::NamespaceNotFound ) {
             remoteMetadata.reset();
@@ -55,9 +55,10 @@ namespace mongo {
      * This is an adapter so we can use config diffs - mongos and mongod do them slightly
      * differently.
      *
-     * The mongod adapter here tracks only a single shard, and stores ranges by (min, max).
+     * The mongod adapter here tracks only a single shard, and stores ranges by (min, max) in a
+     * RangeMap so that applying a diff to a copy of the old chunks only touches the changed ones.
      */
-    class SCMConfigDiffTracker : public ConfigDiffTracker<BSONObj, string> {
+    class SCMConfigDiffTracker : public ConfigDiffTracker<BSONObj, string, RangeMap> {
     public:
         SCMConfigDiffTracker( const string& currShard ) :
                 _currShard( currShard )
@@ -234,8 +235,8 @@ namespace mongo {
                 versionMap[shard] = oldMetadata->_shardVersion;
                 metadata->_collVersion = oldMetadata->_collVersion;
 
-                // TODO: This could be made more efficient if copying not required, but
-                // not as frequently reloaded as in mongos.
+                // The RangeMap copy is O(1) and shares all chunks with the old metadata, the
+                // diff below only pays for the chunks which changed.
                 metadata->_chunksMap = oldMetadata->_chunksMap;
 
                 LOG( 2 ) << "loading new chunks for collection " << ns
@@ -288,7 +289,6 @@ namespace mongo {
                            << " with version " << metadata->_collVersion << endl;
 
                 metadata->_shardVersion = versionMap[shard];
-                metadata->fillRanges();
                 conn.done();
 
                 invariant( metadata->isValid() );
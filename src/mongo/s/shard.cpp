@@ -491,6 +491,32 @@ namespace mongo {
         return listDatabases["totalSize"].numberLong();
     }
 
+    void Shard::getShardOpCounts(const string& shardHost, map<string, long long>* counts) {
+        ScopedDbConnection conn(shardHost);
+        BSONObj top;
+        bool ok = conn->runCommand("admin", BSON("top" << 1), top);
+        conn.done();
+
+        uassert(28639,
+                str::stream() << "call to top on " << shardHost << " failed: " << top,
+                ok);
+
+        BSONElement totals = top["totals"];
+
+        uassert(28640, "totals field not found in top",
+                totals.type() == Object);
+
+        BSONObjIterator it(totals.Obj());
+        while (it.more()) {
+            BSONElement coll = it.next();
+            if (coll.type() != Object) {
+                // The note on units
+                continue;
+            }
+            (*counts)[coll.fieldName()] = coll["total"]["count"].numberLong();
+        }
+    }
+
     ShardStatus Shard::getStatus() const {
         return ShardStatus(*this,
                            getShardDataSizeBytes(getConnString()),
@@ -31,6 +31,7 @@
 #pragma once
 
 #include <boost/shared_ptr.hpp>
+#include <map>
 
 #include "mongo/bson/bsonmisc.h"
 #include "mongo/client/dbclientinterface.h"
@@ -145,6 +146,13 @@ namespace mongo {
          */
         static long long getShardDataSizeBytes(const std::string& shardHost);
 
+        /**
+         * Fills 'counts' with the number of operations the shard has served on each namespace,
+         * from the top command.
+         */
+        static void getShardOpCounts(const std::string& shardHost,
+                                     std::map<std::string, long long>* counts);
+
         /**
          * Returns metadata and stats for this shard.
          */
@@ -0,0 +1,186 @@
+// split_point_sampler.cpp
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/split_point_sampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+    using std::set;
+    using std::vector;
+
+    namespace {
+
+        bool keyLess( const BSONObj& a, const BSONObj& b ) {
+            return a.woCompare( b ) < 0;
+        }
+
+    } // namespace
+
+    SplitPointSampler::SplitPointSampler( size_t sampleSize, int64_t seed )
+        : _capacity( std::max( sampleSize, static_cast<size_t>( 1 ) ) ),
+          _random( seed ),
+          _sorted( true ),
+          _keysSeen( 0 ),
+          _skip( 0 ),
+          _w( 0 ) {
+    }
+
+    bool SplitPointSampler::next() {
+        _keysSeen++;
+
+        if ( _keysSeen <= static_cast<long long>( _capacity ) )
+            return true;
+
+        if ( _skip > 0 ) {
+            _skip--;
+            return false;
+        }
+
+        return true;
+    }
+
+    void SplitPointSampler::add( const BSONObj& key ) {
+        dassert( _keysSeen > 0 );
+        _sorted = false;
+
+        if ( _keysSeen == 1 )
+            _first = key.getOwned();
+
+        if ( _sample.size() < _capacity ) {
+            _sample.push_back( key.getOwned() );
+            if ( _sample.size() == _capacity ) {
+                _w = std::exp( std::log( _nextUniform() ) / _capacity );
+                _drawSkip();
+            }
+            return;
+        }
+
+        const size_t victim = std::min( static_cast<size_t>( _nextUniform() * _capacity ),
+                                        _capacity - 1 );
+        _sample[victim] = key.getOwned();
+
+        _w *= std::exp( std::log( _nextUniform() ) / _capacity );
+        _drawSkip();
+    }
+
+    double SplitPointSampler::maxRankError( double confidence ) const {
+        invariant( confidence > 0 && confidence < 1 );
+
+        if ( isExact() )
+            return 0;
+
+        return std::sqrt( std::log( 2 / ( 1 - confidence ) ) / ( 2.0 * _sample.size() ) );
+    }
+
+    vector<BSONObj> SplitPointSampler::splitPoints( long long keysPerChunk,
+                                                    set<BSONObj>* tooFrequentKeys ) {
+        vector<BSONObj> splitKeys;
+        if ( _sample.empty() || keysPerChunk <= 0 )
+            return splitKeys;
+
+        _sort();
+
+        // Like splitVector, split on the key after every 'keysPerChunk' keys, counting from the
+        // first one.  Each sampled key stands for 'keysPerSample' of the keys seen.
+        const double keysPerSample = static_cast<double>( _keysSeen ) / _sample.size();
+        const double step = ( keysPerChunk + 1 ) / keysPerSample;
+
+        const BSONObj* last = &_first;
+        long long lastIndex = -1;
+        for ( double pos = step - 1 / keysPerSample; ; pos += step ) {
+            // Always move forward, even if the sample is too small for the requested chunk size
+            long long i = std::max( static_cast<long long>( pos ), lastIndex + 1 );
+            if ( i >= static_cast<long long>( _sample.size() ) )
+                break;
+
+            if ( _sample[i].woCompare( *last ) == 0 ) {
+                tooFrequentKeys->insert( _sample[i] );
+                i = std::upper_bound( _sample.begin() + i, _sample.end(), *last, keyLess ) -
+                    _sample.begin();
+                if ( i == static_cast<long long>( _sample.size() ) )
+                    break;
+                pos = i;
+            }
+
+            splitKeys.push_back( _sample[i] );
+            last = &_sample[i];
+            lastIndex = i;
+        }
+
+        return splitKeys;
+    }
+
+    BSONObj SplitPointSampler::median() {
+        if ( _sample.empty() )
+            return BSONObj();
+
+        _sort();
+
+        vector<BSONObj>::iterator it = _sample.begin() + _sample.size() / 2;
+        if ( it->woCompare( _first ) == 0 )
+            it = std::upper_bound( it, _sample.end(), _first, keyLess );
+
+        return it == _sample.end() ? BSONObj() : *it;
+    }
+
+    void SplitPointSampler::_sort() {
+        if ( _sorted )
+            return;
+
+        std::sort( _sample.begin(), _sample.end(), keyLess );
+        _sorted = true;
+    }
+
+    double SplitPointSampler::_nextUniform() {
+        // 53 random bits, offset by half a step so the result is never exactly 0 or 1
+        const uint64_t high = static_cast<uint32_t>( _random.nextInt32() );
+        const uint64_t low = static_cast<uint32_t>( _random.nextInt32() );
+        const uint64_t bits = ( ( high << 32 ) | low ) >> 11;
+        return ( bits + 0.5 ) / static_cast<double>( 1ULL << 53 );
+    }
+
+    void SplitPointSampler::_drawSkip() {
+        const double skip = std::floor( std::log( _nextUniform() ) / std::log1p( -_w ) );
+        if ( skip >= static_cast<double>( std::numeric_limits<long long>::max() ) ) {
+            _skip = std::numeric_limits<long long>::max();
+        }
+        else {
+            _skip = static_cast<long long>( skip );
+        }
+    }
+
+} // namespace mongo
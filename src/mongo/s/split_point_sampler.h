@@ -0,0 +1,124 @@
+// split_point_sampler.h
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <set>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/platform/random.h"
+
+namespace mongo {
+
+    /**
+     * Picks split points for a chunk from a uniform random sample of its shard keys, rather than
+     * by counting off every key in the chunk.
+     *
+     * The keys of the chunk are visited in order.  For each one the caller calls next(), and
+     * only if it returns true builds the key and passes it to add().  The sampler keeps a
+     * reservoir of up to 'sampleSize' keys using Li's "Algorithm L", which draws how many keys
+     * to skip between replacements, so that past the first 'sampleSize' keys only about
+     * sampleSize * ln(numKeys / sampleSize) of them are ever built.
+     *
+     * Split points are quantiles of the sorted sample.  By the Dvoretzky-Kiefer-Wolfowitz
+     * inequality they are all within maxRankError() of their exact position at once, as a
+     * fraction of the keys in the chunk.  While the chunk holds no more than 'sampleSize' keys
+     * the sample is the whole chunk and the split points are exact.
+     */
+    class SplitPointSampler {
+        MONGO_DISALLOW_COPYING(SplitPointSampler);
+    public:
+        SplitPointSampler( size_t sampleSize, int64_t seed );
+
+        /**
+         * Counts the next key of the chunk.  Returns true if that key should be passed to add().
+         */
+        bool next();
+
+        /**
+         * Adds the key just counted by next(), which must have returned true.
+         */
+        void add( const BSONObj& key );
+
+        /** @return the number of keys counted by next() */
+        long long keysSeen() const { return _keysSeen; }
+
+        /** @return the number of keys currently held in the sample */
+        size_t sampleSize() const { return _sample.size(); }
+
+        /** @return true if the sample holds every key seen */
+        bool isExact() const { return _keysSeen <= static_cast<long long>( _capacity ); }
+
+        /**
+         * @return the largest error, as a fraction of keysSeen(), in the position of any split
+         *         point, which holds with probability 'confidence'.  0 if the sample is exact.
+         */
+        double maxRankError( double confidence ) const;
+
+        /**
+         * Returns split points dividing the keys seen into runs of about 'keysPerChunk' keys,
+         * never including the first key seen.  As in splitVector, a key value which would be
+         * picked twice in a row is added to 'tooFrequentKeys' and the split moves to the next
+         * larger value.
+         */
+        std::vector<BSONObj> splitPoints( long long keysPerChunk,
+                                          std::set<BSONObj>* tooFrequentKeys );
+
+        /**
+         * @return the median key, or the next larger value if the median equals the first key
+         *         seen, or an empty object if there is no such key.
+         */
+        BSONObj median();
+
+    private:
+
+        // Sorts the sample, if it changed since the last sort
+        void _sort();
+
+        // Uniform in (0, 1)
+        double _nextUniform();
+
+        // Draws the number of keys to pass over before the next replacement
+        void _drawSkip();
+
+        const size_t _capacity;
+        PseudoRandom _random;
+
+        std::vector<BSONObj> _sample;
+        bool _sorted;
+
+        BSONObj _first;
+        long long _keysSeen;
+        long long _skip;
+        double _w;
+    };
+
+} // namespace mongo
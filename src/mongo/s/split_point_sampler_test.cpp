@@ -0,0 +1,293 @@
+// split_point_sampler_test.cpp
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kSharding
+
+#include "mongo/platform/basic.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <set>
+#include <vector>
+
+#include "mongo/config.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/s/split_point_sampler.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/log.h"
+#include "mongo/util/timer.h"
+
+namespace {
+
+    using namespace mongo;
+    using std::set;
+    using std::vector;
+
+    BSONObj key( int x ) {
+        return BSON( "x" << x );
+    }
+
+    /**
+     * The split points splitVector picks by counting every key.
+     */
+    vector<BSONObj> exactSplitPoints( const vector<BSONObj>& keys,
+                                      long long keyCount,
+                                      set<BSONObj>* tooFrequentKeys ) {
+        vector<BSONObj> splitKeys;
+        splitKeys.push_back( keys.front() );
+
+        long long currCount = 0;
+        for ( size_t i = 0; i < keys.size(); i++ ) {
+            currCount++;
+            if ( currCount > keyCount ) {
+                if ( keys[i].woCompare( splitKeys.back() ) == 0 ) {
+                    tooFrequentKeys->insert( keys[i] );
+                }
+                else {
+                    splitKeys.push_back( keys[i] );
+                    currCount = 0;
+                }
+            }
+        }
+
+        splitKeys.erase( splitKeys.begin() );
+        return splitKeys;
+    }
+
+    /**
+     * Offers the keys 0 .. numKeys - 1 to 'sampler', only building the ones it asks for.
+     * Returns how many it asked for.
+     */
+    long long sampleRange( SplitPointSampler* sampler, int numKeys ) {
+        long long added = 0;
+        for ( int i = 0; i < numKeys; i++ ) {
+            if ( sampler->next() ) {
+                sampler->add( key( i ) );
+                added++;
+            }
+        }
+        return added;
+    }
+
+    TEST(SplitPointSamplerTest, ExactWhenSampleHoldsEveryKey) {
+        // Every value repeats a few times
+        vector<BSONObj> keys;
+        for ( int i = 0; i < 1000; i++ ) {
+            keys.push_back( key( i / 3 ) );
+        }
+
+        const long long keyCounts[] = { 1, 2, 10, 99, 500, 2000 };
+        for ( size_t c = 0; c < sizeof( keyCounts ) / sizeof( keyCounts[0] ); c++ ) {
+            SplitPointSampler sampler( keys.size(), 1 );
+            for ( size_t i = 0; i < keys.size(); i++ ) {
+                ASSERT( sampler.next() );
+                sampler.add( keys[i] );
+            }
+            ASSERT( sampler.isExact() );
+            ASSERT_EQUALS( 0.0, sampler.maxRankError( 0.99 ) );
+
+            set<BSONObj> exactTooFrequent;
+            set<BSONObj> sampledTooFrequent;
+            vector<BSONObj> exact = exactSplitPoints( keys, keyCounts[c], &exactTooFrequent );
+            vector<BSONObj> sampled = sampler.splitPoints( keyCounts[c], &sampledTooFrequent );
+
+            ASSERT_EQUALS( exact.size(), sampled.size() );
+            for ( size_t i = 0; i < exact.size(); i++ ) {
+                ASSERT_EQUALS( exact[i], sampled[i] );
+            }
+            ASSERT( exactTooFrequent == sampledTooFrequent );
+        }
+    }
+
+    TEST(SplitPointSamplerTest, SplitPointsWithinErrorBound) {
+        const int numKeys = 100 * 1000;
+        const long long keyCount = 9999;
+
+        for ( int seed = 0; seed < 10; seed++ ) {
+            SplitPointSampler sampler( 10 * 1000, seed );
+            sampleRange( &sampler, numKeys );
+            ASSERT_EQUALS( numKeys, sampler.keysSeen() );
+            ASSERT_FALSE( sampler.isExact() );
+
+            set<BSONObj> tooFrequentKeys;
+            vector<BSONObj> splitKeys = sampler.splitPoints( keyCount, &tooFrequentKeys );
+            ASSERT( tooFrequentKeys.empty() );
+            ASSERT_GREATER_THAN_OR_EQUALS( splitKeys.size(), 8U );
+            ASSERT_LESS_THAN_OR_EQUALS( splitKeys.size(), 10U );
+
+            // Keys are their own rank; allow for rounding to a sampled key as well
+            const double bound = sampler.maxRankError( 0.9999 ) * numKeys +
+                                 2.0 * numKeys / sampler.sampleSize();
+            for ( size_t i = 0; i < splitKeys.size(); i++ ) {
+                const long long expected = ( i + 1 ) * ( keyCount + 1 ) - 1;
+                ASSERT_LESS_THAN_OR_EQUALS( std::abs( splitKeys[i]["x"].numberLong() - expected ),
+                                            bound );
+            }
+        }
+    }
+
+    TEST(SplitPointSamplerTest, OnlyBuildsSampledKeys) {
+        const int numKeys = 1000 * 1000;
+        const size_t sampleSize = 1000;
+
+        SplitPointSampler sampler( sampleSize, 1 );
+        const long long added = sampleRange( &sampler, numKeys );
+
+        // About sampleSize * (1 + ln(numKeys / sampleSize)), which is 7900 here
+        ASSERT_LESS_THAN( added, 20 * 1000 );
+        ASSERT_EQUALS( sampleSize, sampler.sampleSize() );
+    }
+
+    TEST(SplitPointSamplerTest, TooFrequentKeys) {
+        // A single value covers several chunks
+        SplitPointSampler sampler( 2000, 1 );
+        for ( int i = 0; i < 70000; i++ ) {
+            const int value = i < 10000 ? i : ( i < 60000 ? 10000 : i - 50000 );
+            if ( sampler.next() ) {
+                sampler.add( key( value ) );
+            }
+        }
+
+        set<BSONObj> tooFrequentKeys;
+        vector<BSONObj> splitKeys = sampler.splitPoints( 9999, &tooFrequentKeys );
+        ASSERT_EQUALS( 1U, tooFrequentKeys.count( key( 10000 ) ) );
+
+        ASSERT( !splitKeys.empty() );
+        ASSERT_GREATER_THAN( splitKeys.front().woCompare( key( 0 ) ), 0 );
+        for ( size_t i = 1; i < splitKeys.size(); i++ ) {
+            ASSERT_GREATER_THAN( splitKeys[i].woCompare( splitKeys[i - 1] ), 0 );
+        }
+    }
+
+    TEST(SplitPointSamplerTest, Median) {
+        const int numKeys = 100 * 1000;
+
+        SplitPointSampler sampler( 10 * 1000, 1 );
+        sampleRange( &sampler, numKeys );
+
+        const BSONObj median = sampler.median();
+        ASSERT_LESS_THAN_OR_EQUALS( std::abs( median["x"].numberLong() - numKeys / 2 ),
+                                    sampler.maxRankError( 0.9999 ) * numKeys );
+
+        // No median if every key equals the first
+        SplitPointSampler same( 100, 1 );
+        for ( int i = 0; i < 1000; i++ ) {
+            if ( same.next() ) {
+                same.add( key( 7 ) );
+            }
+        }
+        ASSERT( same.median().isEmpty() );
+
+        SplitPointSampler empty( 100, 1 );
+        ASSERT( empty.median().isEmpty() );
+    }
+
+#ifndef MONGO_CONFIG_DEBUG_BUILD
+    /**
+     * Compares picking split points and the median by counting every key, as splitVector does
+     * by default, against a single sampled pass.  Every key is built in both cases, since the
+     * index scan returns each one; only the handling of the keys differs.
+     */
+    TEST(SplitPointSamplerTest, PerformanceVersusFullScan) {
+        const int numKeys = 4 * 1000 * 1000;
+        const long long keyCount = 100 * 1000;
+        const size_t sampleSize = 10 * 1000;
+
+        // Full scan for split points
+        long long numSplits = 0;
+        {
+            Timer t;
+            BSONObj last = BSON( "" << 0 );
+            long long currCount = 0;
+            for ( int i = 0; i < numKeys; i++ ) {
+                BSONObj indexKey = BSON( "" << i );
+                if ( ++currCount > keyCount ) {
+                    BSONObj splitKey = indexKey.replaceFieldNames( BSON( "x" << 1 ) );
+                    if ( splitKey.woCompare( last ) != 0 ) {
+                        last = splitKey.getOwned();
+                        currCount = 0;
+                        numSplits++;
+                    }
+                }
+            }
+            log() << "full scan: " << numSplits << " split points from " << numKeys
+                  << " keys took " << t.millis() << " ms";
+        }
+
+        // Full scan for the median: one pass to count, and another to find it
+        {
+            Timer t;
+            long long count = 0;
+            for ( int i = 0; i < numKeys; i++ ) {
+                BSONObj indexKey = BSON( "" << i );
+                if ( !indexKey.isEmpty() )
+                    count++;
+            }
+            BSONObj median;
+            for ( int i = 0; i < numKeys && median.isEmpty(); i++ ) {
+                BSONObj indexKey = BSON( "" << i );
+                if ( i > count / 2 ) {
+                    median = indexKey.replaceFieldNames( BSON( "x" << 1 ) );
+                }
+            }
+            log() << "full scan: median " << median << " took " << t.millis() << " ms";
+        }
+
+        // Sampled pass, which yields both
+        {
+            Timer t;
+            SplitPointSampler sampler( sampleSize, 1 );
+            for ( int i = 0; i < numKeys; i++ ) {
+                BSONObj indexKey = BSON( "" << i );
+                if ( sampler.next() ) {
+                    sampler.add( indexKey.replaceFieldNames( BSON( "x" << 1 ) ) );
+                }
+            }
+
+            set<BSONObj> tooFrequentKeys;
+            vector<BSONObj> splitKeys = sampler.splitPoints( keyCount, &tooFrequentKeys );
+            const BSONObj median = sampler.median();
+            const int millis = t.millis();
+
+            double worstError = 0;
+            for ( size_t i = 0; i < splitKeys.size(); i++ ) {
+                const double expected = ( i + 1 ) * ( keyCount + 1 ) - 1;
+                worstError = std::max( worstError,
+                                       std::fabs( splitKeys[i]["x"].numberLong() - expected ) );
+            }
+
+            log() << "sampled: " << splitKeys.size() << " split points and median " << median
+                  << " from " << sampleSize << " samples took " << millis << " ms"
+                  << ", worst split point error " << worstError / numKeys
+                  << " of the keys, bound " << sampler.maxRankError( 0.99 ) << " at 99%";
+        }
+    }
+#endif
+
+} // namespace
@@ -41,9 +41,11 @@
 #include "mongo/s/write_ops/batch_write_op.h"
 #include "mongo/s/write_ops/write_error_detail.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
+    using boost::scoped_ptr;
     using std::endl;
     using std::make_pair;
     using std::stringstream;
@@ -161,11 +163,17 @@ namespace mongo {
             size_t numSent = 0;
             size_t numToSend = childBatches.size();
             bool remoteMetadataChanging = false;
-            while ( numSent != numToSend ) {
 
-                // Collect batches out on the network, mapped by endpoint
-                OwnedHostBatchMap ownedPendingBatches;
-                OwnedHostBatchMap::MapType& pendingBatches = ownedPendingBatches.mutableMap();
+            // Collect batches out on the network, mapped by endpoint. Responses are matched to
+            // batches by host, so only one batch can be outstanding per host. As soon as a host
+            // responds, its next batch is sent, without waiting for the other hosts.
+            OwnedHostBatchMap ownedPendingBatches;
+            OwnedHostBatchMap::MapType& pendingBatches = ownedPendingBatches.mutableMap();
+
+            // When each outstanding batch was sent, for latency stats
+            std::map<ConnectionString, Timer> sendTimers;
+
+            while ( numSent != numToSend ) {
 
                 //
                 // Send side
@@ -211,7 +219,7 @@ namespace mongo {
                         continue;
                     }
 
-                    // If we already have a batch for this host, wait until the next time
+                    // If we already have a batch for this host, wait until it responds
                     OwnedHostBatchMap::MapType::iterator pendingIt = pendingBatches.find( shardHost );
                     if ( pendingIt != pendingBatches.end() ) continue;
 
@@ -240,16 +248,20 @@ namespace mongo {
 
                     // Recv-side is responsible for cleaning up the nextBatch when used
                     pendingBatches.insert( make_pair( shardHost, nextBatch ) );
+                    sendTimers[shardHost] = Timer();
+                    ++numSent;
+                    ++_stats->numChildBatches;
                 }
 
-                // Send them all out
+                // Send out the new batches
                 _dispatcher->sendAll();
-                numSent += pendingBatches.size();
 
                 //
                 // Recv side
                 //
 
+                // Wait for one response at a time, so the next batch for that host can go out
+                // while the other hosts are still busy. Once everything is sent, drain the rest.
                 while ( _dispatcher->numPending() > 0 ) {
 
                     // Get the response
@@ -258,8 +270,13 @@ namespace mongo {
                     Status dispatchStatus = _dispatcher->recvAny( &shardHost, &response );
 
                     // Get the TargetedWriteBatch to find where to put the response
-                    dassert( pendingBatches.find( shardHost ) != pendingBatches.end() );
-                    TargetedWriteBatch* batch = pendingBatches.find( shardHost )->second;
+                    OwnedHostBatchMap::MapType::iterator pendingIt = pendingBatches.find( shardHost );
+                    dassert( pendingIt != pendingBatches.end() );
+                    scoped_ptr<TargetedWriteBatch> batch( pendingIt->second );
+                    pendingBatches.erase( pendingIt );
+
+                    _stats->noteChildBatchLatency( shardHost, sendTimers[shardHost].micros() );
+                    sendTimers.erase( shardHost );
 
                     if ( dispatchStatus.isOK() ) {
 
@@ -312,6 +329,8 @@ namespace mongo {
 
                         batchOp.noteBatchError( *batch, error );
                     }
+
+                    if ( numSent != numToSend ) break;
                 }
             }
 
@@ -394,4 +413,16 @@ namespace mongo {
     const HostOpTimeMap& BatchWriteExecStats::getWriteOpTimes() const {
         return _writeOpTimes;
     }
+
+    void BatchWriteExecStats::noteChildBatchLatency(const ConnectionString& host,
+                                                    long long micros) {
+        HostLatency& latency = _childBatchLatencies[host];
+        ++latency.numBatches;
+        latency.totalMicros += micros;
+        latency.maxMicros = std::max(latency.maxMicros, micros);
+    }
+
+    const HostLatencyMap& BatchWriteExecStats::getChildBatchLatencies() const {
+        return _childBatchLatencies;
+    }
 }
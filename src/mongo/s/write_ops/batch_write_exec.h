@@ -105,17 +105,32 @@ namespace mongo {
 
     typedef std::map<ConnectionString, HostOpTime> HostOpTimeMap;
 
+    struct HostLatency {
+        HostLatency() : numBatches(0), totalMicros(0), maxMicros(0) {}
+        long long numBatches;
+        long long totalMicros;
+        long long maxMicros;
+    };
+
+    typedef std::map<ConnectionString, HostLatency> HostLatencyMap;
+
     class BatchWriteExecStats {
     public:
 
         BatchWriteExecStats() :
-           numRounds( 0 ), numTargetErrors( 0 ), numResolveErrors( 0 ), numStaleBatches( 0 ) {
+           numRounds( 0 ), numTargetErrors( 0 ), numResolveErrors( 0 ), numStaleBatches( 0 ),
+           numChildBatches( 0 ) {
         }
 
         void noteWriteAt(const ConnectionString& host, Timestamp opTime, const OID& electionId);
 
         const HostOpTimeMap& getWriteOpTimes() const;
 
+        // Records the time between sending a child batch to a host and receiving its response
+        void noteChildBatchLatency(const ConnectionString& host, long long micros);
+
+        const HostLatencyMap& getChildBatchLatencies() const;
+
         // Expose via helpers if this gets more complex
 
         // Number of round trips required for the batch
@@ -126,9 +141,12 @@ namespace mongo {
         int numResolveErrors;
         // Number of stale batches
         int numStaleBatches;
+        // Number of child batches sent to shards
+        int numChildBatches;
 
     private:
 
         HostOpTimeMap _writeOpTimes;
+        HostLatencyMap _childBatchLatencies;
     };
 }
@@ -84,6 +84,91 @@ namespace {
         scoped_ptr<BatchWriteExec> exec;
     };
 
+    /**
+     * Resolves shards whose names start with 'A' to host A, and all other shards to host B, so
+     * that several child batches of one round can go to the same host.
+     */
+    class TwoHostShardResolver : public ShardResolver {
+    public:
+
+        Status chooseWriteHost( const std::string& shardName, ConnectionString* shardHost ) const {
+            *shardHost = shardName[0] == 'A' ? hostA() : hostB();
+            return Status::OK();
+        }
+
+        static ConnectionString hostA() {
+            std::string errMsg;
+            return ConnectionString::parse( "$hostA:12345", errMsg );
+        }
+
+        static ConnectionString hostB() {
+            std::string errMsg;
+            return ConnectionString::parse( "$hostB:12345", errMsg );
+        }
+    };
+
+    /**
+     * Mimics a collection whose chunks live on three shards, two of which are on the same host:
+     * x < 0 on shard A1 and 0 <= x < 2 on shard A2, both on host A, and x >= 2 on shard B.
+     */
+    class MockTwoHostBackend {
+    public:
+
+        MockTwoHostBackend( const NamespaceString& nss ) {
+
+            vector<MockRange*> mockRanges;
+            mockRanges.push_back( new MockRange( ShardEndpoint( "A1", ChunkVersion::IGNORED() ),
+                                                 nss,
+                                                 BSON( "x" << MINKEY ),
+                                                 BSON( "x" << 0 ) ) );
+            mockRanges.push_back( new MockRange( ShardEndpoint( "A2", ChunkVersion::IGNORED() ),
+                                                 nss,
+                                                 BSON( "x" << 0 ),
+                                                 BSON( "x" << 2 ) ) );
+            mockRanges.push_back( new MockRange( ShardEndpoint( "B", ChunkVersion::IGNORED() ),
+                                                 nss,
+                                                 BSON( "x" << 2 ),
+                                                 BSON( "x" << MAXKEY ) ) );
+            targeter.init( mockRanges );
+
+            exec.reset( new BatchWriteExec( &targeter, &resolver, &dispatcher ) );
+        }
+
+        /**
+         * Runs an unordered insert with one document for each shard, which makes one child batch
+         * per shard in a single round.
+         */
+        void insertOnePerShard( const NamespaceString& nss ) {
+            BatchedCommandRequest request( BatchedCommandRequest::BatchType_Insert );
+            request.setNS( nss.ns() );
+            request.setOrdered( false );
+            request.setWriteConcern( BSONObj() );
+            request.getInsertRequest()->addToDocuments( BSON( "x" << -1 ) );
+            request.getInsertRequest()->addToDocuments( BSON( "x" << 1 ) );
+            request.getInsertRequest()->addToDocuments( BSON( "x" << 3 ) );
+
+            BatchedCommandResponse response;
+            exec->executeBatch( request, &response );
+            ASSERT( response.getOk() );
+            ASSERT_EQUALS( exec->getStats().numRounds, 1 );
+            ASSERT_EQUALS( exec->getStats().numChildBatches, 3 );
+        }
+
+        MockNSTargeter targeter;
+        TwoHostShardResolver resolver;
+        MockMultiWriteCommand dispatcher;
+
+        scoped_ptr<BatchWriteExec> exec;
+    };
+
+    string sendEvent( const ConnectionString& host ) {
+        return "send " + host.toString();
+    }
+
+    string recvEvent( const ConnectionString& host ) {
+        return "recv " + host.toString();
+    }
+
     //
     // Tests for the BatchWriteExec
     //
@@ -111,6 +196,12 @@ namespace {
 
         const BatchWriteExecStats& stats = backend.exec->getStats();
         ASSERT_EQUALS( stats.numRounds, 1 );
+        ASSERT_EQUALS( stats.numChildBatches, 1 );
+
+        const HostLatencyMap& latencies = stats.getChildBatchLatencies();
+        ASSERT_EQUALS( latencies.size(), 1u );
+        ASSERT( latencies.find( backend.shardHost ) != latencies.end() );
+        ASSERT_EQUALS( latencies.find( backend.shardHost )->second.numBatches, 1 );
     }
 
     TEST(BatchWriteExecTests, SingleOpError) {
@@ -313,4 +404,65 @@ namespace {
         ASSERT_EQUALS( stats.numStaleBatches, 10 );
     }
 
+    TEST(BatchWriteExecTests, ResponsesOutOfSendOrder) {
+
+        //
+        // The first host sent to is slow, so its response comes back after the second host's
+        //
+
+        NamespaceString nss( "foo.bar" );
+        MockTwoHostBackend backend( nss );
+        backend.dispatcher.setSlowHost( TwoHostShardResolver::hostA() );
+
+        backend.insertOnePerShard( nss );
+
+        // The batch for A2 waits for A1's response, since host A can have only one outstanding
+        vector<string> expected;
+        expected.push_back( sendEvent( TwoHostShardResolver::hostA() ) );
+        expected.push_back( sendEvent( TwoHostShardResolver::hostB() ) );
+        expected.push_back( recvEvent( TwoHostShardResolver::hostB() ) );
+        expected.push_back( recvEvent( TwoHostShardResolver::hostA() ) );
+        expected.push_back( sendEvent( TwoHostShardResolver::hostA() ) );
+        expected.push_back( recvEvent( TwoHostShardResolver::hostA() ) );
+
+        const vector<string>& events = backend.dispatcher.getEvents();
+        ASSERT_EQUALS( expected.size(), events.size() );
+        for ( size_t i = 0; i < expected.size(); i++ ) {
+            ASSERT_EQUALS( expected[i], events[i] );
+        }
+    }
+
+    TEST(BatchWriteExecTests, NextBatchSentWhileOtherHostOutstanding) {
+
+        //
+        // Host A's second batch goes out as soon as A responds, while slow host B is still
+        // outstanding, and the second sendAll only sends that new batch
+        //
+
+        NamespaceString nss( "foo.bar" );
+        MockTwoHostBackend backend( nss );
+        backend.dispatcher.setSlowHost( TwoHostShardResolver::hostB() );
+
+        backend.insertOnePerShard( nss );
+
+        vector<string> expected;
+        expected.push_back( sendEvent( TwoHostShardResolver::hostA() ) );
+        expected.push_back( sendEvent( TwoHostShardResolver::hostB() ) );
+        expected.push_back( recvEvent( TwoHostShardResolver::hostA() ) );
+        expected.push_back( sendEvent( TwoHostShardResolver::hostA() ) );
+        expected.push_back( recvEvent( TwoHostShardResolver::hostA() ) );
+        expected.push_back( recvEvent( TwoHostShardResolver::hostB() ) );
+
+        const vector<string>& events = backend.dispatcher.getEvents();
+        ASSERT_EQUALS( expected.size(), events.size() );
+        for ( size_t i = 0; i < expected.size(); i++ ) {
+            ASSERT_EQUALS( expected[i], events[i] );
+        }
+
+        const HostLatencyMap& latencies = backend.exec->getStats().getChildBatchLatencies();
+        ASSERT_EQUALS( latencies.size(), 2u );
+        ASSERT_EQUALS( latencies.find( TwoHostShardResolver::hostA() )->second.numBatches, 2 );
+        ASSERT_EQUALS( latencies.find( TwoHostShardResolver::hostB() )->second.numBatches, 1 );
+    }
+
 } // unnamed namespace
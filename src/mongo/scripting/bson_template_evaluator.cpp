@@ -28,6 +28,8 @@
 
 #include "mongo/scripting/bson_template_evaluator.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstddef>
 #include <cstdlib>
 
@@ -38,9 +40,90 @@ namespace mongo {
 
     using std::string;
 
+    namespace {
+
+        // Uniform in [0, 1), from the same source as the other random operators
+        double randomFraction() {
+            return rand() / (RAND_MAX + 1.0);
+        }
+
+        /**
+         * Samples integers in [1, n] with P(k) proportional to 1 / k^exponent, by rejection
+         * inversion (Hormann and Derflinger, "Rejection-inversion to generate variates from
+         * monotone discrete distributions").  Setup and sampling are O(1) for any n, unlike the
+         * classic method which has to sum the whole harmonic series up front.
+         */
+        class ZipfSampler {
+        public:
+            ZipfSampler(long long n, double exponent)
+                : _n(n),
+                  _exponent(exponent),
+                  _hIntegralX1(hIntegral(1.5) - 1),
+                  _hIntegralN(hIntegral(n + 0.5)),
+                  _s(2 - hIntegralInverse(hIntegral(2.5) - h(2))) {
+            }
+
+            long long sample() const {
+                while (true) {
+                    const double u = _hIntegralN + randomFraction() * (_hIntegralX1 - _hIntegralN);
+                    const double x = hIntegralInverse(u);
+                    long long k = static_cast<long long>(x + 0.5);
+                    if (k < 1)
+                        k = 1;
+                    else if (k > _n)
+                        k = _n;
+
+                    if (k - x <= _s || u >= hIntegral(k + 0.5) - h(k))
+                        return k;
+                }
+            }
+
+        private:
+            // h(x) = 1 / x^exponent, and hIntegral is its antiderivative
+            double h(double x) const {
+                return std::exp(-_exponent * std::log(x));
+            }
+
+            double hIntegral(double x) const {
+                const double logX = std::log(x);
+                return helper2((1 - _exponent) * logX) * logX;
+            }
+
+            double hIntegralInverse(double x) const {
+                double t = x * (1 - _exponent);
+                if (t < -1)
+                    t = -1;
+                return std::exp(helper1(t) * x);
+            }
+
+            // log1p(x) / x and expm1(x) / x, which stay accurate as x approaches 0, where the
+            // exponent approaches 1
+            static double helper1(double x) {
+                if (std::fabs(x) > 1e-8)
+                    return std::log1p(x) / x;
+                return 1 - x * (0.5 - x * (1.0 / 3 - 0.25 * x));
+            }
+
+            static double helper2(double x) {
+                if (std::fabs(x) > 1e-8)
+                    return std::expm1(x) / x;
+                return 1 + x * 0.5 * (1 + x * (1.0 / 3) * (1 + 0.25 * x));
+            }
+
+            const long long _n;
+            const double _exponent;
+            const double _hIntegralX1;
+            const double _hIntegralN;
+            const double _s;
+        };
+
+    } // namespace
+
     void BsonTemplateEvaluator::initializeEvaluator() {
         addOperator("RAND_INT", &BsonTemplateEvaluator::evalRandInt);
         addOperator("RAND_INT_PLUS_THREAD", &BsonTemplateEvaluator::evalRandPlusThread);
+        addOperator("ZIPF_INT", &BsonTemplateEvaluator::evalZipfInt);
+        addOperator("HOTSPOT_INT", &BsonTemplateEvaluator::evalHotspotInt);
         addOperator("SEQ_INT", &BsonTemplateEvaluator::evalSeqInt);
         addOperator("RAND_STRING", &BsonTemplateEvaluator::evalRandString);
         addOperator("CONCAT", &BsonTemplateEvaluator::evalConcat);
@@ -198,6 +281,70 @@ namespace mongo {
         return StatusSuccess;
     }
 
+    BsonTemplateEvaluator::Status BsonTemplateEvaluator::evalZipfInt(BsonTemplateEvaluator* btl,
+                                                                     const char* fieldName,
+                                                                     const BSONObj& in,
+                                                                     BSONObjBuilder& out) {
+        // in = { #ZIPF_INT: [10, 20, 0.99] }
+        BSONObj range = in.firstElement().embeddedObject();
+        if (!range["0"].isNumber() || !range["1"].isNumber())
+            return StatusOpEvaluationError;
+        const long long min = range["0"].numberLong();
+        const long long max = range["1"].numberLong();
+        if (max <= min)
+            return StatusOpEvaluationError;
+        double exponent = 0.99;
+        if (range.nFields() == 3) {
+            if (!range[2].isNumber() || range[2].number() <= 0)
+                return StatusOpEvaluationError;
+            exponent = range[2].number();
+        }
+        const ZipfSampler sampler(max - min, exponent);
+        out.append(fieldName, min + sampler.sample() - 1);
+        return StatusSuccess;
+    }
+
+    BsonTemplateEvaluator::Status BsonTemplateEvaluator::evalHotspotInt(BsonTemplateEvaluator* btl,
+                                                                        const char* fieldName,
+                                                                        const BSONObj& in,
+                                                                        BSONObjBuilder& out) {
+        // in = { #HOTSPOT_INT: [0, 1000, 0.2, 0.8] }
+        BSONObj range = in.firstElement().embeddedObject();
+        if (!range["0"].isNumber() || !range["1"].isNumber())
+            return StatusOpEvaluationError;
+        const long long min = range["0"].numberLong();
+        const long long max = range["1"].numberLong();
+        if (max <= min)
+            return StatusOpEvaluationError;
+        double hotSetFraction = 0.2;
+        double hotOpFraction = 0.8;
+        if (range.nFields() >= 3) {
+            if (!range[2].isNumber() || range[2].number() < 0 || range[2].number() > 1)
+                return StatusOpEvaluationError;
+            hotSetFraction = range[2].number();
+        }
+        if (range.nFields() >= 4) {
+            if (!range[3].isNumber() || range[3].number() < 0 || range[3].number() > 1)
+                return StatusOpEvaluationError;
+            hotOpFraction = range[3].number();
+        }
+
+        // Keep at least one value in the hot set, and one in the cold set if it is to be chosen
+        long long hotSetSize = static_cast<long long>((max - min) * hotSetFraction);
+        hotSetSize = std::max(hotSetSize, 1LL);
+        if (hotOpFraction < 1)
+            hotSetSize = std::min(hotSetSize, max - min - 1);
+
+        const long long coldSetSize = max - min - hotSetSize;
+        long long randomNum;
+        if (coldSetSize == 0 || randomFraction() < hotOpFraction)
+            randomNum = min + static_cast<long long>(randomFraction() * hotSetSize);
+        else
+            randomNum = min + hotSetSize + static_cast<long long>(randomFraction() * coldSetSize);
+        out.append(fieldName, randomNum);
+        return StatusSuccess;
+    }
+
     BsonTemplateEvaluator::Status BsonTemplateEvaluator::evalSeqInt(BsonTemplateEvaluator* btl,
                                                                     const char* fieldName,
                                                                     const BSONObj& in,
@@ -29,7 +29,7 @@
 /*
  * This library supports a templating language that helps in generating BSON documents from a
  * template. The language supports the following template:
- * #RAND_INT, #SEQ_INT, #RAND_STRING, #CONCAT, and #OID.
+ * #RAND_INT, #ZIPF_INT, #HOTSPOT_INT, #SEQ_INT, #RAND_STRING, #CONCAT, and #OID.
  *
  * The language will help in quickly expressing richer documents  for use in benchRun.
  * Ex. : { key : { #RAND_INT: [10, 20] } } or  { key : { #CONCAT: ["hello", " ", "world"] } }
@@ -181,6 +181,28 @@ namespace mongo {
         static Status evalRandPlusThread(BsonTemplateEvaluator* btl, const char* fieldName,
                                   const BSONObj& in, BSONObjBuilder& out);
 
+        /*
+         * Operator method to support #ZIPF_INT : { key : { #ZIPF_INT: [10, 20, 0.99] } }
+         * Like #RAND_INT, chooses a number in [min, max), but from a Zipfian distribution rather
+         * than a uniform one: the k-th value of the range is chosen with probability proportional
+         * to 1 / k^exponent, so 'min' is the most popular value, 'min' + 1 the next, and so on.
+         * The optional third argument is the exponent, which must be positive and defaults to
+         * 0.99, a common choice for modelling skewed key popularity.
+         */
+        static Status evalZipfInt(BsonTemplateEvaluator* btl, const char* fieldName,
+                                  const BSONObj& in, BSONObjBuilder& out);
+
+        /*
+         * Operator method to support #HOTSPOT_INT : { key : { #HOTSPOT_INT: [0, 1000, 0.2, 0.8] } }
+         * Chooses a number in [min, max) where a "hot" set of values at the start of the range is
+         * accessed more often than the rest. The optional third argument is the fraction of the
+         * range which is hot (default 0.2), and the optional fourth is the fraction of
+         * evaluations which choose a hot value (default 0.8). Values are uniform within the hot
+         * and the cold sets.
+         */
+        static Status evalHotspotInt(BsonTemplateEvaluator* btl, const char* fieldName,
+                                     const BSONObj& in, BSONObjBuilder& out);
+
         /*
          * Operator method to support #SEQ_INT :
          *    { key : { #SEQ_INT: { seq_id: 0, start: 100, step: -2, unique: true } } }
@@ -262,6 +262,71 @@ namespace mongo {
             ASSERT_LESS_THAN(randValue1, 5);
         }
 
+        TEST(BSONTemplateEvaluatorTest, ZIPF_INT) {
+
+            BsonTemplateEvaluator t;
+            common_rand_tests("#ZIPF_INT", &t);
+
+            // Test failure with a non-positive exponent
+            BSONObjBuilder builder1;
+            BSONObj zipfObj = BSON( "#ZIPF_INT" << BSON_ARRAY( 0 << 100 << 0 ) );
+            ASSERT_EQUALS( BsonTemplateEvaluator::StatusOpEvaluationError,
+                           t.evaluate(BSON("zipfField" << zipfObj), builder1) );
+
+            // With exponent 1 over 100 values, the first value is chosen with probability
+            // 1 / H(100), about 0.19, and each later one less often
+            const int numSamples = 20000;
+            std::vector<int> counts(100);
+            zipfObj = BSON( "#ZIPF_INT" << BSON_ARRAY( 1000 << 1100 << 1.0 ) );
+            for (int i = 0; i < numSamples; i++) {
+                BSONObjBuilder builder;
+                ASSERT_EQUALS( BsonTemplateEvaluator::StatusSuccess,
+                               t.evaluate(BSON("zipfField" << zipfObj), builder) );
+                long long value = builder.obj()["zipfField"].numberLong();
+                ASSERT_GREATER_THAN_OR_EQUALS(value, 1000);
+                ASSERT_LESS_THAN(value, 1100);
+                counts[value - 1000]++;
+            }
+            ASSERT_GREATER_THAN(counts[0], numSamples * 0.17);
+            ASSERT_LESS_THAN(counts[0], numSamples * 0.22);
+            ASSERT_GREATER_THAN(counts[0], counts[1]);
+            ASSERT_GREATER_THAN(counts[1], counts[9]);
+            ASSERT_GREATER_THAN(counts[9], counts[99]);
+        }
+
+        TEST(BSONTemplateEvaluatorTest, HOTSPOT_INT) {
+
+            BsonTemplateEvaluator t;
+            common_rand_tests("#HOTSPOT_INT", &t);
+
+            // Test failure with fractions outside [0, 1]
+            BSONObjBuilder builder1;
+            BSONObj hotObj = BSON( "#HOTSPOT_INT" << BSON_ARRAY( 0 << 100 << 1.5 ) );
+            ASSERT_EQUALS( BsonTemplateEvaluator::StatusOpEvaluationError,
+                           t.evaluate(BSON("hotField" << hotObj), builder1) );
+            BSONObjBuilder builder2;
+            hotObj = BSON( "#HOTSPOT_INT" << BSON_ARRAY( 0 << 100 << 0.1 << -1 ) );
+            ASSERT_EQUALS( BsonTemplateEvaluator::StatusOpEvaluationError,
+                           t.evaluate(BSON("hotField" << hotObj), builder2) );
+
+            // 90% of the values should come from the first 10% of the range
+            const int numSamples = 10000;
+            int numHot = 0;
+            hotObj = BSON( "#HOTSPOT_INT" << BSON_ARRAY( 100 << 200 << 0.1 << 0.9 ) );
+            for (int i = 0; i < numSamples; i++) {
+                BSONObjBuilder builder;
+                ASSERT_EQUALS( BsonTemplateEvaluator::StatusSuccess,
+                               t.evaluate(BSON("hotField" << hotObj), builder) );
+                long long value = builder.obj()["hotField"].numberLong();
+                ASSERT_GREATER_THAN_OR_EQUALS(value, 100);
+                ASSERT_LESS_THAN(value, 200);
+                if (value < 110)
+                    numHot++;
+            }
+            ASSERT_GREATER_THAN(numHot, numSamples * 0.87);
+            ASSERT_LESS_THAN(numHot, numSamples * 0.93);
+        }
+
         TEST(BSONTemplateEvaluatorTest, SEQ_INT) {
 
             boost::scoped_ptr<BsonTemplateEvaluator> t(new BsonTemplateEvaluator());
@@ -39,6 +39,7 @@
 #include <boost/noncopyable.hpp>
 #include <boost/shared_ptr.hpp>
 #include <boost/thread/thread.hpp>
+#include <fstream>
 #include <iostream>
 
 #include "mongo/db/namespace_string.h"
@@ -89,11 +90,13 @@ namespace mongo {
     void BenchRunEventCounter::reset() {
         _numEvents = 0;
         _totalTimeMicros = 0;
+        _latencies.reset();
     }
 
     void BenchRunEventCounter::updateFrom(const BenchRunEventCounter &other) {
         _numEvents += other._numEvents;
         _totalTimeMicros += other._totalTimeMicros;
+        _latencies.merge(other._latencies);
     }
 
     BenchRunStats::BenchRunStats() {
@@ -111,6 +114,7 @@ namespace mongo {
         insertCounter.reset();
         deleteCounter.reset();
         queryCounter.reset();
+        commandCounter.reset();
 
         trappedErrors.clear();
     }
@@ -125,6 +129,7 @@ namespace mongo {
         insertCounter.updateFrom(other.insertCounter);
         deleteCounter.updateFrom(other.deleteCounter);
         queryCounter.updateFrom(other.queryCounter);
+        commandCounter.updateFrom(other.commandCounter);
 
         for (size_t i = 0; i < other.trappedErrors.size(); ++i)
             trappedErrors.push_back(other.trappedErrors[i]);
@@ -142,6 +147,8 @@ namespace mongo {
 
         parallel = 1;
         seconds = 1;
+        opsPerSecond = 0;
+        reportFile = "";
         hideResults = true;
         handleErrors = false;
         hideErrors = false;
@@ -179,6 +186,10 @@ namespace mongo {
             this->parallel = args["parallel"].numberInt();
         if ( args["seconds"].isNumber() )
             this->seconds = args["seconds"].number();
+        if ( args["opsPerSecond"].isNumber() )
+            this->opsPerSecond = args["opsPerSecond"].number();
+        if ( args["reportFile"].type() == String )
+            this->reportFile = args["reportFile"].String();
         if ( ! args["hideResults"].eoo() )
             this->hideResults = args["hideResults"].trueValue();
         if ( ! args["handleErrors"].eoo() )
@@ -191,6 +202,7 @@ namespace mongo {
             this->breakOnTrap = args["breakOnTrap"].trueValue();
 
         uassert(16164, "loopCommands config not supported", args["loopCommands"].eoo());
+        uassert(28641, "opsPerSecond must not be negative", this->opsPerSecond >= 0);
 
         if ( ! args["trapPattern"].eoo() ){
             const char* regex = args["trapPattern"].regex();
@@ -333,6 +345,17 @@ namespace mongo {
         return _brState->shouldWorkerFinish();
     }
 
+    long long BenchRunWorker::waitForScheduledStart(const Timer &timer, double dueMicros) const {
+        // Sleep in slices so that a low rate doesn't hold up the end of the run
+        const long long maxSleepMicros = 100 * 1000;
+        long long now = timer.micros();
+        while ( now < dueMicros && !shouldStop() ) {
+            sleepmicros( std::min( static_cast<long long>(dueMicros) - now, maxSleepMicros ) );
+            now = timer.micros();
+        }
+        return std::max( 0LL, now - static_cast<long long>(dueMicros) );
+    }
+
     void doNothing(const BSONObj&) { }
 
     void BenchRunWorker::generateLoadOnConnection( DBClientBase* conn ) {
@@ -350,6 +373,13 @@ namespace mongo {
             }
         }
 
+        // In open-loop mode, each thread takes its share of the target rate, and the threads'
+        // schedules are staggered so that they don't all send at once.
+        const bool openLoop = _config->opsPerSecond > 0;
+        const double opIntervalMicros =
+            openLoop ? 1000 * 1000 * _config->parallel / _config->opsPerSecond : 0;
+        double nextOpDueMicros = opIntervalMicros * _id / _config->parallel;
+
         while ( !shouldStop() ) {
             BSONObjIterator i( _config->ops );
             while ( i.more() ) {
@@ -358,6 +388,14 @@ namespace mongo {
 
                 BSONElement e = i.next();
 
+                // How late this op is starting relative to the schedule, charged to its latency
+                long long lagMicros = 0;
+                if ( openLoop ) {
+                    lagMicros = waitForScheduledStart( timer, nextOpDueMicros );
+                    nextOpDueMicros += opIntervalMicros;
+                    if ( shouldStop() ) break;
+                }
+
                 string ns = e["ns"].String();
                 string op = e["op"].String();
 
@@ -404,7 +442,7 @@ namespace mongo {
 
                         BSONObj result;
                         {
-                            BenchRunEventTrace _bret(&_stats.findOneCounter);
+                            BenchRunEventTrace _bret(&_stats.findOneCounter, lagMicros);
                             result = conn->findOne( ns , fixQuery( e["query"].Obj(),
                                                                    bsonTemplateEvaluator ) );
                         }
@@ -426,8 +464,12 @@ namespace mongo {
                     else if ( op == "command" ) {
 
                         BSONObj result;
-                        conn->runCommand( ns, fixQuery( e["command"].Obj(), bsonTemplateEvaluator ),
-                                          result, e["options"].numberInt() );
+                        {
+                            BenchRunEventTrace _bret(&_stats.commandCounter, lagMicros);
+                            conn->runCommand( ns,
+                                              fixQuery( e["command"].Obj(), bsonTemplateEvaluator ),
+                                              result, e["options"].numberInt() );
+                        }
 
                         if( check ){
                             int err = scope->invoke( scopeFunc , 0 , &result,  1000 * 60 , false );
@@ -459,12 +501,12 @@ namespace mongo {
 
                         // use special query function for exhaust query option
                         if (options & QueryOption_Exhaust) {
-                            BenchRunEventTrace _bret(&_stats.queryCounter);
+                            BenchRunEventTrace _bret(&_stats.queryCounter, lagMicros);
                             stdx::function<void (const BSONObj&)> castedDoNothing(doNothing);
                             count =  conn->query(castedDoNothing, ns, fixedQuery, &filter, options);
                         }
                         else {
-                            BenchRunEventTrace _bret(&_stats.queryCounter);
+                            BenchRunEventTrace _bret(&_stats.queryCounter, lagMicros);
                             cursor = conn->query(ns, fixedQuery, limit, skip, &filter, options,
                                                  batchSize);
                             count = cursor->itcount();
@@ -500,7 +542,7 @@ namespace mongo {
                         bool safe = e["safe"].trueValue();
 
                         {
-                            BenchRunEventTrace _bret(&_stats.updateCounter);
+                            BenchRunEventTrace _bret(&_stats.updateCounter, lagMicros);
                             BSONObj query = fixQuery(queryOrginal, bsonTemplateEvaluator);
                             BSONObj update = fixQuery(updateOriginal, bsonTemplateEvaluator);
 
@@ -552,7 +594,7 @@ namespace mongo {
                         BSONObj result;
 
                         {
-                            BenchRunEventTrace _bret(&_stats.insertCounter);
+                            BenchRunEventTrace _bret(&_stats.insertCounter, lagMicros);
 
                             BSONObj insertDoc = fixQuery(e["doc"].Obj(), bsonTemplateEvaluator);
 
@@ -601,7 +643,7 @@ namespace mongo {
                         bool safe = e["safe"].trueValue();
                         BSONObj result;
                         {
-                            BenchRunEventTrace _bret(&_stats.deleteCounter);
+                            BenchRunEventTrace _bret(&_stats.deleteCounter, lagMicros);
                             BSONObj predicate = fixQuery(query, bsonTemplateEvaluator);
                             if (useWriteCmd) {
 
@@ -705,7 +747,7 @@ namespace mongo {
                     conn->getLastError();
                 }
 
-                if (delay > 0)
+                if (delay > 0 && !openLoop)
                     sleepmillis( delay );
 
             }
@@ -864,6 +906,25 @@ namespace mongo {
                         static_cast<double>(counter.getTotalTimeMicros()) / counter.getNumEvents());
      }
 
+     static void appendLatencyPercentilesIfAvailable(
+             BSONObjBuilder &buf, const std::string &name, const BenchRunEventCounter &counter) {
+
+         const LatencyHistogram &latencies = counter.getLatencies();
+         if (latencies.count() == 0)
+             return;
+
+         BSONObjBuilder opBuilder(buf.subobjStart(name));
+         opBuilder.append("count", static_cast<long long>(latencies.count()));
+         opBuilder.append("meanMicros", latencies.mean());
+         opBuilder.append("minMicros", static_cast<long long>(latencies.min()));
+         opBuilder.append("p50Micros", static_cast<long long>(latencies.valueAtPercentile(50)));
+         opBuilder.append("p95Micros", static_cast<long long>(latencies.valueAtPercentile(95)));
+         opBuilder.append("p99Micros", static_cast<long long>(latencies.valueAtPercentile(99)));
+         opBuilder.append("p999Micros", static_cast<long long>(latencies.valueAtPercentile(99.9)));
+         opBuilder.append("maxMicros", static_cast<long long>(latencies.max()));
+         opBuilder.done();
+     }
+
      BSONObj BenchRunner::finish( BenchRunner* runner ) {
 
          runner->stop();
@@ -890,6 +951,21 @@ namespace mongo {
          appendAverageMicrosIfAvailable(buf, "deleteLatencyAverageMicros", stats.deleteCounter);
          appendAverageMicrosIfAvailable(buf, "updateLatencyAverageMicros", stats.updateCounter);
          appendAverageMicrosIfAvailable(buf, "queryLatencyAverageMicros", stats.queryCounter);
+         appendAverageMicrosIfAvailable(buf, "commandLatencyAverageMicros", stats.commandCounter);
+
+         if (runner->config().opsPerSecond > 0)
+             buf.append( "targetOpsPerSecond", runner->config().opsPerSecond );
+
+         {
+             BSONObjBuilder latencyBuilder(buf.subobjStart("latency"));
+             appendLatencyPercentilesIfAvailable(latencyBuilder, "findOne", stats.findOneCounter);
+             appendLatencyPercentilesIfAvailable(latencyBuilder, "insert", stats.insertCounter);
+             appendLatencyPercentilesIfAvailable(latencyBuilder, "delete", stats.deleteCounter);
+             appendLatencyPercentilesIfAvailable(latencyBuilder, "update", stats.updateCounter);
+             appendLatencyPercentilesIfAvailable(latencyBuilder, "query", stats.queryCounter);
+             appendLatencyPercentilesIfAvailable(latencyBuilder, "command", stats.commandCounter);
+             latencyBuilder.done();
+         }
 
          {
              BSONObjIterator i( after );
@@ -904,6 +980,14 @@ namespace mongo {
 
          BSONObj zoo = buf.obj();
 
+         const std::string &reportFile = runner->config().reportFile;
+         if (!reportFile.empty()) {
+             std::ofstream report(reportFile.c_str(), std::ios_base::app);
+             report << zoo.jsonString(Strict) << '\n';
+             if (!report)
+                 warning() << "benchRun could not write results to " << reportFile << endl;
+         }
+
          delete runner;
          return zoo;
      }
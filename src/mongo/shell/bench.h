@@ -39,6 +39,7 @@
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/platform/atomic_word.h"
+#include "mongo/util/latency_histogram.h"
 #include "mongo/util/timer.h"
 
 namespace pcrecpp {
@@ -102,6 +103,26 @@ namespace mongo {
          */
         double seconds;
 
+        /**
+         * Target rate of operations per second, across all threads.  Zero, the default, runs
+         * "closed loop": each thread issues its next operation as soon as the previous one
+         * returns.
+         *
+         * Otherwise each thread issues operations on a fixed schedule at its share of the rate,
+         * and latencies are measured from when each operation was due rather than when it was
+         * sent.  A thread which falls behind the schedule sends its next operation immediately,
+         * and the time it spent waiting counts towards that operation's latency, so a slow
+         * server cannot hide its queueing delay by slowing the client down (the "coordinated
+         * omission" problem).  The "delay" option of individual ops is ignored in this mode.
+         */
+        double opsPerSecond;
+
+        /**
+         * Optional path of a file to which the results of the run are appended, as one line of
+         * strict JSON, for tracking results across builds.
+         */
+        std::string reportFile;
+
         bool hideResults;
         bool handleErrors;
         bool hideErrors;
@@ -133,7 +154,8 @@ namespace mongo {
     };
 
     /**
-     * An event counter for events that have an associated duration.
+     * An event counter for events that have an associated duration.  Keeps a histogram of the
+     * durations as well as their total.
      *
      * Not thread safe.  Expected use is one instance per thread during parallel execution.
      */
@@ -159,6 +181,7 @@ namespace mongo {
         void countOne(long long timeMicros) {
             ++_numEvents;
             _totalTimeMicros += timeMicros;
+            _latencies.record(timeMicros);
         }
 
         /**
@@ -171,9 +194,15 @@ namespace mongo {
          */
         unsigned long long getNumEvents() const { return _numEvents; }
 
+        /**
+         * Get the distribution of the durations of the observed events, in microseconds.
+         */
+        const LatencyHistogram& getLatencies() const { return _latencies; }
+
     private:
         unsigned long long _numEvents;
         long long _totalTimeMicros;
+        LatencyHistogram _latencies;
     };
 
     /**
@@ -188,11 +217,16 @@ namespace mongo {
      * event, and otherwise, the succes counter will.
      *
      * In all cases, the counter objects must outlive the trace object.
+     *
+     * "startLagMicros" is added to the measured duration, for events which started later than
+     * they were scheduled to.
      */
     class BenchRunEventTrace : private boost::noncopyable {
     public:
-        explicit BenchRunEventTrace(BenchRunEventCounter *eventCounter) {
+        explicit BenchRunEventTrace(BenchRunEventCounter *eventCounter,
+                                    long long startLagMicros=0) {
             initialize(eventCounter, eventCounter, false);
+            _startLagMicros = startLagMicros;
         }
 
         BenchRunEventTrace(BenchRunEventCounter *successCounter,
@@ -202,7 +236,8 @@ namespace mongo {
         }
 
         ~BenchRunEventTrace() {
-            (_succeeded ? _successCounter : _failCounter)->countOne(_timer.micros());
+            (_succeeded ? _successCounter : _failCounter)->countOne(_timer.micros() +
+                                                                    _startLagMicros);
         }
 
         void succeed() { _succeeded = true; }
@@ -215,12 +250,14 @@ namespace mongo {
             _successCounter = successCounter;
             _failCounter = failCounter;
             _succeeded = !defaultToFailure;
+            _startLagMicros = 0;
         }
 
         Timer _timer;
         BenchRunEventCounter *_successCounter;
         BenchRunEventCounter *_failCounter;
         bool _succeeded;
+        long long _startLagMicros;
     };
 
     /**
@@ -243,6 +280,7 @@ namespace mongo {
         BenchRunEventCounter insertCounter;
         BenchRunEventCounter deleteCounter;
         BenchRunEventCounter queryCounter;
+        BenchRunEventCounter commandCounter;
 
         std::map<std::string, long long> opcounters;
         std::vector<BSONObj> trappedErrors;
@@ -351,6 +389,12 @@ namespace mongo {
         /// Predicate, used to decide whether or not it's time to terminate the worker.
         bool shouldStop() const;
 
+        /**
+         * Sleeps until "timer" reaches "dueMicros", or the worker is told to stop.  Returns how
+         * many microseconds late the operation due then is starting.
+         */
+        long long waitForScheduledStart(const Timer &timer, double dueMicros) const;
+
         size_t _id;
         const BenchRunConfig *_config;
         BenchRunState *_brState;
@@ -0,0 +1,72 @@
+// thread_benchmark.h
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+#include <vector>
+
+#include "mongo/stdx/functional.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+namespace unittest {
+
+    /**
+     * Runs 'loop' on 'numThreads' threads at once, waits for all of them to finish and returns
+     * the elapsed time in microseconds.  Used by the throughput benchmarks, which call this with
+     * increasing thread counts to see how an operation scales.
+     */
+    inline long long runConcurrently(int numThreads, const stdx::function<void()>& loop) {
+        Timer t;
+
+        std::vector<boost::shared_ptr<boost::thread> > threads;
+        for (int i = 0; i < numThreads; i++) {
+            threads.push_back(boost::shared_ptr<boost::thread>(new boost::thread(loop)));
+        }
+
+        for (int i = 0; i < numThreads; i++) {
+            threads[i]->join();
+        }
+
+        return t.micros();
+    }
+
+    /**
+     * Returns the rate per second of 'numThreads' threads each doing 'opsPerThread' operations
+     * in 'micros' microseconds.
+     */
+    inline double opsPerSecond(int numThreads, int opsPerThread, long long micros) {
+        const double ops = static_cast<double>(numThreads) * static_cast<double>(opsPerThread);
+        return ops * 1000.0 * 1000.0 / static_cast<double>(micros + 1);
+    }
+
+} // namespace unittest
+} // namespace mongo
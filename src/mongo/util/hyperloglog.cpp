@@ -0,0 +1,110 @@
+// hyperloglog.cpp
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/hyperloglog.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mongo/platform/bits.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+    HyperLogLog::HyperLogLog(int precision)
+        : _precision(precision),
+          _registers(size_t(1) << precision, 0) {
+        invariant(precision >= kMinPrecision && precision <= kMaxPrecision);
+    }
+
+    void HyperLogLog::add(uint64_t hash) {
+        const size_t index = hash >> (64 - _precision);
+
+        // Leading zeros of the remaining bits, plus one.  If they are all zero we count the
+        // bits we have, which is as long a run as this hash can show.
+        const uint64_t rest = hash << _precision;
+        const int rank = rest ? countLeadingZeros64(rest) + 1 : 64 - _precision + 1;
+
+        if (_registers[index] < rank) {
+            _registers[index] = static_cast<uint8_t>(rank);
+        }
+    }
+
+    void HyperLogLog::merge(const HyperLogLog& other) {
+        invariant(_precision == other._precision);
+        for (size_t i = 0; i < _registers.size(); ++i) {
+            _registers[i] = std::max(_registers[i], other._registers[i]);
+        }
+    }
+
+    long long HyperLogLog::estimate() const {
+        const double m = static_cast<double>(_registers.size());
+
+        double sum = 0;
+        size_t zeros = 0;
+        for (size_t i = 0; i < _registers.size(); ++i) {
+            sum += std::ldexp(1.0, -_registers[i]);
+            if (_registers[i] == 0) {
+                ++zeros;
+            }
+        }
+
+        double alpha;
+        switch (_registers.size()) {
+        case 16: alpha = 0.673; break;
+        case 32: alpha = 0.697; break;
+        case 64: alpha = 0.709; break;
+        default: alpha = 0.7213 / (1 + 1.079 / m); break;
+        }
+
+        double estimate = alpha * m * m / sum;
+
+        // The raw estimate is biased for small cardinalities; linear counting on the empty
+        // registers does better there.  With 64-bit hashes no large range correction is needed.
+        if (estimate <= 2.5 * m && zeros > 0) {
+            estimate = m * std::log(m / zeros);
+        }
+
+        return static_cast<long long>(estimate + 0.5);
+    }
+
+    bool HyperLogLog::load(const char* data, size_t size) {
+        for (int precision = kMinPrecision; precision <= kMaxPrecision; ++precision) {
+            if (size == (size_t(1) << precision)) {
+                _precision = precision;
+                _registers.assign(data, data + size);
+                return true;
+            }
+        }
+        return false;
+    }
+
+} // namespace mongo
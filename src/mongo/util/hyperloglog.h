@@ -0,0 +1,93 @@
+// hyperloglog.h
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "mongo/platform/cstdint.h"
+
+namespace mongo {
+
+    /**
+     * A HyperLogLog sketch, which estimates the number of distinct values added to it in a fixed
+     * amount of memory.
+     *
+     * Values are added as 64-bit hashes, which the caller must compute with a well mixing hash
+     * function.  The top 'precision' bits of the hash pick one of 2^precision one-byte registers,
+     * and each register keeps the longest run of leading zeros seen in the rest of the hash.  The
+     * standard error of the estimate is about 1.04 / sqrt(2^precision), so the default precision
+     * of 12 (4KB of registers) gives about 1.6%.
+     *
+     * Sketches with the same precision can be merged, giving the sketch of the union of their
+     * inputs.
+     */
+    class HyperLogLog {
+    public:
+        static const int kMinPrecision = 4;
+        static const int kMaxPrecision = 16;
+        static const int kDefaultPrecision = 12;
+
+        explicit HyperLogLog(int precision = kDefaultPrecision);
+
+        void add(uint64_t hash);
+
+        /**
+         * Folds 'other', which must have the same precision, into this sketch.
+         */
+        void merge(const HyperLogLog& other);
+
+        /**
+         * Estimated number of distinct hashes added.
+         */
+        long long estimate() const;
+
+        int precision() const { return _precision; }
+
+        //
+        // Serialization.  The registers are one byte each, 2^precision of them.
+        //
+
+        const char* data() const { return reinterpret_cast<const char*>(&_registers[0]); }
+        size_t size() const { return _registers.size(); }
+
+        /**
+         * Replaces the registers, and the precision, with those in 'data', as returned by data().
+         * Returns false, leaving the sketch unchanged, if 'size' is not a valid number of
+         * registers.
+         */
+        bool load(const char* data, size_t size);
+
+    private:
+        int _precision;
+        std::vector<uint8_t> _registers;
+    };
+
+} // namespace mongo
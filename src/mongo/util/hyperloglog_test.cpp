@@ -0,0 +1,127 @@
+// hyperloglog_test.cpp
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/hyperloglog.h"
+
+namespace {
+    using namespace mongo;
+
+    // A cheap, well mixing 64-bit hash (the splitmix64 finalizer).
+    uint64_t mix(uint64_t x) {
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    void assertWithin(long long expected, long long actual, double relativeError) {
+        ASSERT_LESS_THAN_OR_EQUALS(std::abs(static_cast<double>(actual - expected)),
+                                   relativeError * expected);
+    }
+
+    TEST(HyperLogLogTest, Empty) {
+        HyperLogLog hll;
+        ASSERT_EQUALS(0, hll.estimate());
+        ASSERT_EQUALS(size_t(1) << HyperLogLog::kDefaultPrecision, hll.size());
+    }
+
+    TEST(HyperLogLogTest, SmallCardinalities) {
+        HyperLogLog hll;
+        for (uint64_t i = 0; i < 100; ++i) {
+            hll.add(mix(i));
+            hll.add(mix(i));
+        }
+        assertWithin(100, hll.estimate(), 0.05);
+    }
+
+    TEST(HyperLogLogTest, LargeCardinalities) {
+        const long long counts[] = {1000, 10 * 1000, 100 * 1000, 1000 * 1000};
+        for (size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c) {
+            HyperLogLog hll;
+            for (long long i = 0; i < counts[c]; ++i) {
+                hll.add(mix(i));
+            }
+            // About three standard errors
+            assertWithin(counts[c], hll.estimate(), 0.05);
+        }
+    }
+
+    TEST(HyperLogLogTest, DuplicatesDoNotCount) {
+        HyperLogLog hll;
+        for (int round = 0; round < 10; ++round) {
+            for (uint64_t i = 0; i < 5000; ++i) {
+                hll.add(mix(i));
+            }
+        }
+        assertWithin(5000, hll.estimate(), 0.05);
+    }
+
+    TEST(HyperLogLogTest, MergeIsUnion) {
+        HyperLogLog a(10);
+        HyperLogLog b(10);
+        HyperLogLog both(10);
+        for (uint64_t i = 0; i < 20000; ++i) {
+            a.add(mix(i));
+            both.add(mix(i));
+        }
+        for (uint64_t i = 10000; i < 30000; ++i) {
+            b.add(mix(i));
+            both.add(mix(i));
+        }
+
+        a.merge(b);
+        ASSERT_EQUALS(both.estimate(), a.estimate());
+        assertWithin(30000, a.estimate(), 0.1);
+    }
+
+    TEST(HyperLogLogTest, LoadRoundTrip) {
+        HyperLogLog hll(8);
+        for (uint64_t i = 0; i < 1000; ++i) {
+            hll.add(mix(i));
+        }
+
+        const std::string saved(hll.data(), hll.size());
+        HyperLogLog loaded;
+        ASSERT(loaded.load(saved.data(), saved.size()));
+        ASSERT_EQUALS(8, loaded.precision());
+        ASSERT_EQUALS(hll.estimate(), loaded.estimate());
+
+        // Not a power of two
+        ASSERT_FALSE(loaded.load(saved.data(), saved.size() - 1));
+        ASSERT_EQUALS(hll.estimate(), loaded.estimate());
+    }
+
+} // namespace
@@ -0,0 +1,127 @@
+// latency_histogram.cpp
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mongo/platform/bits.h"
+
+namespace mongo {
+
+    namespace {
+        const int64_t kSubBucketHalfCount = 1 << (LatencyHistogram::kSubBucketBits - 1);
+        const int64_t kMaxValue = (1LL << LatencyHistogram::kMaxValueBits) - 1;
+        const size_t kNumBuckets =
+            (LatencyHistogram::kMaxValueBits - LatencyHistogram::kSubBucketBits + 2)
+                * kSubBucketHalfCount;
+    } // namespace
+
+    LatencyHistogram::LatencyHistogram() : _buckets(kNumBuckets) {
+        reset();
+    }
+
+    void LatencyHistogram::reset() {
+        std::fill(_buckets.begin(), _buckets.end(), 0);
+        _count = 0;
+        _min = 0;
+        _max = 0;
+        _sum = 0;
+    }
+
+    size_t LatencyHistogram::bucketFor(int64_t value) {
+        value = std::min(value, kMaxValue);
+        if (value < 2 * kSubBucketHalfCount)
+            return value;
+
+        // Keep the top kSubBucketBits - 1 bits below the leading one as the sub-bucket
+        const int msb = 63 - countLeadingZeros64(value);
+        const int shift = msb - (kSubBucketBits - 1);
+        return shift * kSubBucketHalfCount + (value >> shift);
+    }
+
+    int64_t LatencyHistogram::highestValueIn(size_t bucket) {
+        if (bucket < static_cast<size_t>(2 * kSubBucketHalfCount))
+            return bucket;
+
+        const int shift = bucket / kSubBucketHalfCount - 1;
+        const int64_t subBucket = bucket % kSubBucketHalfCount + kSubBucketHalfCount;
+        return ((subBucket + 1) << shift) - 1;
+    }
+
+    void LatencyHistogram::record(int64_t value) {
+        value = std::max(value, int64_t(0));
+
+        _buckets[bucketFor(value)]++;
+        _min = _count ? std::min(_min, value) : value;
+        _max = std::max(_max, value);
+        _sum += value;
+        _count++;
+    }
+
+    void LatencyHistogram::merge(const LatencyHistogram& other) {
+        if (!other._count)
+            return;
+
+        for (size_t i = 0; i < kNumBuckets; i++)
+            _buckets[i] += other._buckets[i];
+        _min = _count ? std::min(_min, other._min) : other._min;
+        _max = std::max(_max, other._max);
+        _sum += other._sum;
+        _count += other._count;
+    }
+
+    double LatencyHistogram::mean() const {
+        return _count ? _sum / _count : 0;
+    }
+
+    int64_t LatencyHistogram::valueAtPercentile(double percentile) const {
+        if (!_count)
+            return 0;
+
+        percentile = std::min(std::max(percentile, 0.0), 100.0);
+        const uint64_t rank =
+            std::max(uint64_t(1), uint64_t(std::ceil(_count * percentile / 100)));
+
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kNumBuckets; i++) {
+            seen += _buckets[i];
+            if (seen >= rank) {
+                // The last bucket also holds everything too big to track precisely
+                const int64_t highest = i == kNumBuckets - 1 ? _max : highestValueIn(i);
+                return std::max(_min, std::min(highest, _max));
+            }
+        }
+        return _max;
+    }
+
+} // namespace mongo
@@ -0,0 +1,98 @@
+// latency_histogram.h
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "mongo/platform/cstdint.h"
+
+namespace mongo {
+
+    /**
+     * A latency histogram in the style of HdrHistogram, with a fixed relative error over a wide
+     * range of values in a fixed amount of memory.
+     *
+     * Values below 2^kSubBucketBits are counted exactly.  Above that, each power-of-two range
+     * [2^k, 2^(k+1)) is split into 2^(kSubBucketBits - 1) equal buckets, so any reported value is
+     * within 1/64 (about 1.6%) of the true one.  Values of 2^kMaxValueBits and above share the
+     * last bucket; the exact maximum is tracked separately.
+     *
+     * Units are up to the caller; benchRun records microseconds, for which the tracked range is
+     * about 19 hours.
+     *
+     * Not thread safe.  Expected use is one instance per thread, merged when the run is over.
+     */
+    class LatencyHistogram {
+    public:
+        static const int kSubBucketBits = 7;
+        static const int kMaxValueBits = 36;
+
+        LatencyHistogram();
+
+        void record(int64_t value);
+
+        /**
+         * Adds the counts recorded in 'other' into this histogram.
+         */
+        void merge(const LatencyHistogram& other);
+
+        void reset();
+
+        uint64_t count() const { return _count; }
+
+        /**
+         * Exact minimum, maximum and mean of the recorded values, or 0 if there are none.
+         */
+        int64_t min() const { return _count ? _min : 0; }
+        int64_t max() const { return _max; }
+        double mean() const;
+
+        /**
+         * Returns the smallest value such that at least 'percentile' percent of the recorded
+         * values are no greater than it, up to the histogram's precision.  'percentile' is in
+         * [0, 100]; 0 if nothing has been recorded.
+         */
+        int64_t valueAtPercentile(double percentile) const;
+
+    private:
+        static size_t bucketFor(int64_t value);
+
+        // The highest value which is counted in the given bucket.
+        static int64_t highestValueIn(size_t bucket);
+
+        std::vector<uint64_t> _buckets;
+        uint64_t _count;
+        int64_t _min;
+        int64_t _max;
+        double _sum;
+    };
+
+} // namespace mongo
@@ -0,0 +1,144 @@
+// latency_histogram_test.cpp
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "mongo/platform/random.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/latency_histogram.h"
+
+namespace {
+    using namespace mongo;
+
+    // Reported values may be above the true one by the bucket width, at most 1/64 of it
+    void assertWithinPrecision(int64_t expected, int64_t actual) {
+        ASSERT_GREATER_THAN_OR_EQUALS(actual, expected);
+        ASSERT_LESS_THAN_OR_EQUALS(actual, expected + expected / 64);
+    }
+
+    TEST(LatencyHistogramTest, Empty) {
+        LatencyHistogram h;
+        ASSERT_EQUALS(0U, h.count());
+        ASSERT_EQUALS(0, h.min());
+        ASSERT_EQUALS(0, h.max());
+        ASSERT_EQUALS(0.0, h.mean());
+        ASSERT_EQUALS(0, h.valueAtPercentile(50));
+    }
+
+    TEST(LatencyHistogramTest, SmallValuesAreExact) {
+        LatencyHistogram h;
+        for (int i = 1; i <= 100; i++)
+            h.record(i);
+
+        ASSERT_EQUALS(100U, h.count());
+        ASSERT_EQUALS(1, h.min());
+        ASSERT_EQUALS(100, h.max());
+        ASSERT_EQUALS(50.5, h.mean());
+        ASSERT_EQUALS(1, h.valueAtPercentile(0));
+        ASSERT_EQUALS(50, h.valueAtPercentile(50));
+        ASSERT_EQUALS(99, h.valueAtPercentile(99));
+        ASSERT_EQUALS(100, h.valueAtPercentile(99.9));
+        ASSERT_EQUALS(100, h.valueAtPercentile(100));
+    }
+
+    TEST(LatencyHistogramTest, NegativeValuesCountAsZero) {
+        LatencyHistogram h;
+        h.record(-5);
+        ASSERT_EQUALS(1U, h.count());
+        ASSERT_EQUALS(0, h.max());
+        ASSERT_EQUALS(0, h.valueAtPercentile(100));
+    }
+
+    TEST(LatencyHistogramTest, PercentilesMatchSortedValues) {
+        PseudoRandom rand(1234);
+        LatencyHistogram h;
+        std::vector<int64_t> values;
+
+        // Log-uniform from 1us to about 1s, like a heavy tailed latency distribution
+        for (int i = 0; i < 100 * 1000; i++) {
+            int64_t v = static_cast<int64_t>(std::exp((rand.nextInt32(1 << 20) / double(1 << 20))
+                                                      * std::log(1e6)));
+            h.record(v);
+            values.push_back(v);
+        }
+        std::sort(values.begin(), values.end());
+
+        const double percentiles[] = { 1, 50, 90, 99, 99.9, 99.99 };
+        for (size_t i = 0; i < sizeof(percentiles) / sizeof(percentiles[0]); i++) {
+            const size_t rank = static_cast<size_t>(std::ceil(values.size() * percentiles[i]
+                                                              / 100));
+            assertWithinPrecision(values[rank - 1], h.valueAtPercentile(percentiles[i]));
+        }
+
+        ASSERT_EQUALS(values.front(), h.min());
+        ASSERT_EQUALS(values.back(), h.max());
+        ASSERT_EQUALS(values.back(), h.valueAtPercentile(100));
+    }
+
+    TEST(LatencyHistogramTest, HugeValuesKeepExactMax) {
+        LatencyHistogram h;
+        const int64_t huge = 1LL << 50;
+        h.record(10);
+        h.record(huge);
+
+        ASSERT_EQUALS(huge, h.max());
+        ASSERT_EQUALS(huge, h.valueAtPercentile(100));
+        ASSERT_EQUALS(10, h.valueAtPercentile(50));
+    }
+
+    TEST(LatencyHistogramTest, MergeMatchesSingleHistogram) {
+        LatencyHistogram a;
+        LatencyHistogram b;
+        LatencyHistogram all;
+        for (int i = 0; i < 10000; i++) {
+            (i % 3 ? a : b).record(i * 7);
+            all.record(i * 7);
+        }
+
+        LatencyHistogram merged;
+        merged.merge(a);
+        merged.merge(b);
+
+        ASSERT_EQUALS(all.count(), merged.count());
+        ASSERT_EQUALS(all.min(), merged.min());
+        ASSERT_EQUALS(all.max(), merged.max());
+        ASSERT_EQUALS(all.mean(), merged.mean());
+        ASSERT_EQUALS(all.valueAtPercentile(50), merged.valueAtPercentile(50));
+        ASSERT_EQUALS(all.valueAtPercentile(99.9), merged.valueAtPercentile(99.9));
+
+        merged.reset();
+        ASSERT_EQUALS(0U, merged.count());
+        ASSERT_EQUALS(0, merged.valueAtPercentile(50));
+    }
+
+} // namespace
@@ -0,0 +1,446 @@
+// persistent_map.h
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <boost/make_shared.hpp>
+#include <boost/shared_ptr.hpp>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+    /**
+     * An ordered map with the std::map lookup interface whose copies share structure.
+     *
+     * The map is a balanced (AVL) tree of immutable nodes.  Copying a PersistentMap copies a
+     * single pointer, and every mutation copies only the O(log n) nodes on the path from the root
+     * to the changed entry; all other nodes stay shared with the maps it was copied from.  This
+     * makes it cheap to derive a new version of a large map which differs in a few entries, while
+     * readers of the old version are unaffected.
+     *
+     * Because nodes are never modified once published, const access to a map is thread safe in
+     * the same way as for std::map, and distinct copies may be used from different threads.
+     *
+     * Differences from std::map:
+     *  - there is no mutable access to values; use set() to insert or replace an entry.
+     *  - iterators hold a reference to the version of the map they were obtained from, so they
+     *    stay valid (and keep iterating that version) after the map is modified.  Only compare
+     *    iterators obtained from the same version.
+     *  - iterators keep the path from the root to their entry, since nodes have no parent
+     *    pointers.  Stepping is O(1) amortized, but copying an iterator copies the path.
+     */
+    template< typename K, typename V, typename Compare = std::less<K> >
+    class PersistentMap {
+    public:
+
+        typedef K key_type;
+        typedef V mapped_type;
+        typedef std::pair<const K, V> value_type;
+        typedef Compare key_compare;
+        typedef std::size_t size_type;
+
+    private:
+
+        struct Node;
+        typedef boost::shared_ptr<const Node> NodePtr;
+
+        struct Node {
+            Node( const value_type& value, const NodePtr& left, const NodePtr& right )
+                : value( value ),
+                  left( left ),
+                  right( right ),
+                  height( 1 + std::max( heightOf( left ), heightOf( right ) ) ) {
+            }
+
+            const value_type value;
+            const NodePtr left;
+            const NodePtr right;
+            const int height;
+        };
+
+    public:
+
+        class const_iterator {
+        public:
+            typedef std::bidirectional_iterator_tag iterator_category;
+            typedef typename PersistentMap::value_type value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const value_type* pointer;
+            typedef const value_type& reference;
+
+            const_iterator() : _depth( 0 ) {}
+
+            const_iterator( const const_iterator& other )
+                : _root( other._root ), _depth( other._depth ) {
+                std::copy( other._path, other._path + other._depth, _path );
+            }
+
+            const_iterator& operator=( const const_iterator& other ) {
+                _root = other._root;
+                _depth = other._depth;
+                std::copy( other._path, other._path + other._depth, _path );
+                return *this;
+            }
+
+            reference operator*() const { return _node()->value; }
+            pointer operator->() const { return &_node()->value; }
+
+            const_iterator& operator++() {
+                const Node* n = _node();
+                if ( n->right ) {
+                    // Successor: the lowest node of the right subtree
+                    _pushLeftmost( n->right.get() );
+                    return *this;
+                }
+
+                // Successor: the nearest ancestor whose left subtree we are in, or end()
+                const Node* child = _path[--_depth];
+                while ( _depth > 0 && _path[_depth - 1]->right.get() == child ) {
+                    child = _path[--_depth];
+                }
+                return *this;
+            }
+
+            const_iterator operator++( int ) {
+                const_iterator old = *this;
+                ++*this;
+                return old;
+            }
+
+            const_iterator& operator--() {
+                if ( _depth == 0 ) {
+                    // Predecessor of end(): the last node
+                    _pushRightmost( _root.get() );
+                    return *this;
+                }
+
+                const Node* n = _node();
+                if ( n->left ) {
+                    // Predecessor: the highest node of the left subtree
+                    _pushRightmost( n->left.get() );
+                    return *this;
+                }
+
+                // Predecessor: the nearest ancestor whose right subtree we are in
+                const Node* child = _path[--_depth];
+                while ( _depth > 0 && _path[_depth - 1]->left.get() == child ) {
+                    child = _path[--_depth];
+                }
+                return *this;
+            }
+
+            const_iterator operator--( int ) {
+                const_iterator old = *this;
+                --*this;
+                return old;
+            }
+
+            bool operator==( const const_iterator& other ) const {
+                return _node() == other._node();
+            }
+            bool operator!=( const const_iterator& other ) const {
+                return _node() != other._node();
+            }
+
+        private:
+            friend class PersistentMap;
+
+            // A longer path needs an AVL tree of F(kMaxDepth + 3) - 1, over 4e13, nodes
+            static const int kMaxDepth = 64;
+
+            explicit const_iterator( const NodePtr& root ) : _root( root ), _depth( 0 ) {}
+
+            // The current node, or NULL at end()
+            const Node* _node() const { return _depth ? _path[_depth - 1] : NULL; }
+
+            void _push( const Node* n ) {
+                invariant( _depth < kMaxDepth );
+                _path[_depth++] = n;
+            }
+
+            void _pushLeftmost( const Node* n ) {
+                for ( ; n; n = n->left.get() ) _push( n );
+            }
+
+            void _pushRightmost( const Node* n ) {
+                for ( ; n; n = n->right.get() ) _push( n );
+            }
+
+            // Keeps the version we are iterating alive
+            NodePtr _root;
+
+            // The nodes from the root down to the current one, which is last. Nodes have no
+            // parent pointers, so this is what makes stepping O(1) amortized.
+            const Node* _path[kMaxDepth];
+            int _depth;
+        };
+
+        // All access is read-only
+        typedef const_iterator iterator;
+
+        PersistentMap() : _size( 0 ) {}
+
+        explicit PersistentMap( const Compare& cmp ) : _size( 0 ), _cmp( cmp ) {}
+
+        template< typename InputIterator >
+        PersistentMap( InputIterator first, InputIterator last ) : _size( 0 ) {
+            for ( ; first != last; ++first ) insert( *first );
+        }
+
+        //
+        // Lookup
+        //
+
+        const_iterator begin() const {
+            const_iterator it( _root );
+            it._pushLeftmost( _root.get() );
+            return it;
+        }
+
+        const_iterator end() const { return const_iterator( _root ); }
+
+        size_type size() const { return _size; }
+        bool empty() const { return _size == 0; }
+
+        const_iterator find( const K& key ) const {
+            const_iterator it = lower_bound( key );
+            if ( it == end() || _cmp( key, it->first ) ) return end();
+            return it;
+        }
+
+        size_type count( const K& key ) const { return find( key ) == end() ? 0 : 1; }
+
+        /**
+         * Returns the first entry whose key is not less than 'key'.
+         */
+        const_iterator lower_bound( const K& key ) const {
+            // Record the whole descent, then cut the path back to the last node not less than
+            // 'key'. Everything below it is less than 'key' and not on the path to it.
+            const_iterator it( _root );
+            int foundDepth = 0;
+            for ( const Node* n = _root.get(); n; ) {
+                it._push( n );
+                if ( !_cmp( n->value.first, key ) ) {
+                    foundDepth = it._depth;
+                    n = n->left.get();
+                }
+                else {
+                    n = n->right.get();
+                }
+            }
+            it._depth = foundDepth;
+            return it;
+        }
+
+        /**
+         * Returns the first entry whose key is greater than 'key'.
+         */
+        const_iterator upper_bound( const K& key ) const {
+            const_iterator it( _root );
+            int foundDepth = 0;
+            for ( const Node* n = _root.get(); n; ) {
+                it._push( n );
+                if ( _cmp( key, n->value.first ) ) {
+                    foundDepth = it._depth;
+                    n = n->left.get();
+                }
+                else {
+                    n = n->right.get();
+                }
+            }
+            it._depth = foundDepth;
+            return it;
+        }
+
+        //
+        // Modification - each call copies O(log n) nodes and leaves other versions untouched
+        //
+
+        /**
+         * Inserts 'value' if its key is not already present.  Returns an iterator to the entry
+         * for the key and whether the insert took place, like std::map::insert.
+         */
+        std::pair<const_iterator, bool> insert( const value_type& value ) {
+            const_iterator existing = find( value.first );
+            if ( existing != end() ) return std::make_pair( existing, false );
+
+            _root = insertNode( _root, value );
+            ++_size;
+            return std::make_pair( find( value.first ), true );
+        }
+
+        /**
+         * Inserts the entry, or replaces the value if the key is already present.  This takes the
+         * place of the std::map idiom 'map[key] = value'.
+         */
+        void set( const K& key, const V& value ) {
+            if ( find( key ) == end() ) ++_size;
+            _root = insertNode( _root, value_type( key, value ) );
+        }
+
+        /**
+         * Removes the entry for 'key', if any.  Returns the number of entries removed.
+         */
+        size_type erase( const K& key ) {
+            if ( find( key ) == end() ) return 0;
+
+            _root = eraseNode( _root, key );
+            --_size;
+            return 1;
+        }
+
+        void erase( const_iterator it ) { erase( it->first ); }
+
+        /**
+         * Removes the entries in [first, last), which must be iterators of the current version.
+         */
+        void erase( const_iterator first, const_iterator last ) {
+            if ( first == begin() && last == end() ) {
+                clear();
+                return;
+            }
+
+            std::vector<K> keys;
+            for ( ; first != last; ++first ) keys.push_back( first->first );
+            for ( typename std::vector<K>::const_iterator it = keys.begin(); it != keys.end();
+                    ++it ) {
+                erase( *it );
+            }
+        }
+
+        void clear() {
+            _root.reset();
+            _size = 0;
+        }
+
+        void swap( PersistentMap& other ) {
+            _root.swap( other._root );
+            std::swap( _size, other._size );
+            std::swap( _cmp, other._cmp );
+        }
+
+    private:
+
+        static int heightOf( const NodePtr& node ) { return node ? node->height : 0; }
+
+        static NodePtr makeNode( const value_type& value,
+                                 const NodePtr& left,
+                                 const NodePtr& right ) {
+            return boost::make_shared<const Node>( value, left, right );
+        }
+
+        /**
+         * Builds a node over the given subtrees, rotating to restore the AVL invariant if their
+         * heights differ by two.
+         */
+        static NodePtr balance( const value_type& value,
+                                const NodePtr& left,
+                                const NodePtr& right ) {
+
+            const int hl = heightOf( left );
+            const int hr = heightOf( right );
+
+            if ( hl > hr + 1 ) {
+                if ( heightOf( left->left ) >= heightOf( left->right ) ) {
+                    return makeNode( left->value,
+                                     left->left,
+                                     makeNode( value, left->right, right ) );
+                }
+
+                const NodePtr& lr = left->right;
+                return makeNode( lr->value,
+                                 makeNode( left->value, left->left, lr->left ),
+                                 makeNode( value, lr->right, right ) );
+            }
+
+            if ( hr > hl + 1 ) {
+                if ( heightOf( right->right ) >= heightOf( right->left ) ) {
+                    return makeNode( right->value,
+                                     makeNode( value, left, right->left ),
+                                     right->right );
+                }
+
+                const NodePtr& rl = right->left;
+                return makeNode( rl->value,
+                                 makeNode( value, left, rl->left ),
+                                 makeNode( right->value, rl->right, right->right ) );
+            }
+
+            return makeNode( value, left, right );
+        }
+
+        // Inserts or replaces the entry for value.first
+        NodePtr insertNode( const NodePtr& node, const value_type& value ) const {
+            if ( !node ) return makeNode( value, NodePtr(), NodePtr() );
+
+            if ( _cmp( value.first, node->value.first ) ) {
+                return balance( node->value, insertNode( node->left, value ), node->right );
+            }
+            if ( _cmp( node->value.first, value.first ) ) {
+                return balance( node->value, node->left, insertNode( node->right, value ) );
+            }
+            return makeNode( value, node->left, node->right );
+        }
+
+        // Removes the entry for key, which must be present
+        NodePtr eraseNode( const NodePtr& node, const K& key ) const {
+            if ( _cmp( key, node->value.first ) ) {
+                return balance( node->value, eraseNode( node->left, key ), node->right );
+            }
+            if ( _cmp( node->value.first, key ) ) {
+                return balance( node->value, node->left, eraseNode( node->right, key ) );
+            }
+
+            if ( !node->left ) return node->right;
+            if ( !node->right ) return node->left;
+
+            // Replace the erased entry with its successor
+            const Node* successor = node->right.get();
+            while ( successor->left ) successor = successor->left.get();
+            return balance( successor->value, node->left, eraseMin( node->right ) );
+        }
+
+        static NodePtr eraseMin( const NodePtr& node ) {
+            if ( !node->left ) return node->right;
+            return balance( node->value, eraseMin( node->left ), node->right );
+        }
+
+        NodePtr _root;
+        size_type _size;
+        Compare _cmp;
+    };
+
+} // namespace mongo
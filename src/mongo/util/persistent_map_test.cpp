@@ -0,0 +1,300 @@
+// persistent_map_test.cpp
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kDefault
+
+#include "mongo/platform/basic.h"
+
+#include <map>
+
+#include "mongo/config.h"
+#include "mongo/platform/random.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/log.h"
+#include "mongo/util/persistent_map.h"
+#include "mongo/util/timer.h"
+
+namespace {
+    using namespace mongo;
+
+    typedef PersistentMap<int, int> IntMap;
+    typedef std::map<int, int> StdIntMap;
+
+    void assertSameContents( const StdIntMap& expected, const IntMap& actual ) {
+        ASSERT_EQUALS( expected.size(), actual.size() );
+
+        StdIntMap::const_iterator e = expected.begin();
+        IntMap::const_iterator a = actual.begin();
+        for ( ; e != expected.end(); ++e, ++a ) {
+            ASSERT( a != actual.end() );
+            ASSERT_EQUALS( e->first, a->first );
+            ASSERT_EQUALS( e->second, a->second );
+        }
+        ASSERT( a == actual.end() );
+
+        // Walk backwards as well
+        StdIntMap::const_reverse_iterator re = expected.rbegin();
+        IntMap::const_iterator ra = actual.end();
+        for ( ; re != expected.rend(); ++re ) {
+            --ra;
+            ASSERT_EQUALS( re->first, ra->first );
+        }
+        ASSERT( ra == actual.begin() );
+    }
+
+    TEST(PersistentMapTest, Empty) {
+        IntMap m;
+        ASSERT( m.empty() );
+        ASSERT_EQUALS( 0U, m.size() );
+        ASSERT( m.begin() == m.end() );
+        ASSERT( m.find( 1 ) == m.end() );
+        ASSERT( m.lower_bound( 1 ) == m.end() );
+        ASSERT( m.upper_bound( 1 ) == m.end() );
+        ASSERT_EQUALS( 0U, m.erase( 1 ) );
+    }
+
+    TEST(PersistentMapTest, InsertFindErase) {
+        IntMap m;
+        ASSERT( m.insert( std::make_pair( 2, 20 ) ).second );
+        ASSERT( m.insert( std::make_pair( 1, 10 ) ).second );
+        ASSERT( m.insert( std::make_pair( 3, 30 ) ).second );
+
+        // Insert does not overwrite, set does
+        ASSERT_FALSE( m.insert( std::make_pair( 2, 21 ) ).second );
+        ASSERT_EQUALS( 20, m.find( 2 )->second );
+        m.set( 2, 22 );
+        ASSERT_EQUALS( 22, m.find( 2 )->second );
+        ASSERT_EQUALS( 3U, m.size() );
+
+        ASSERT_EQUALS( 2, m.lower_bound( 2 )->first );
+        ASSERT_EQUALS( 3, m.upper_bound( 2 )->first );
+        ASSERT( m.upper_bound( 3 ) == m.end() );
+
+        ASSERT_EQUALS( 1U, m.erase( 2 ) );
+        ASSERT( m.find( 2 ) == m.end() );
+        ASSERT_EQUALS( 2U, m.size() );
+        ASSERT_EQUALS( 3, m.lower_bound( 2 )->first );
+    }
+
+    TEST(PersistentMapTest, CopiesAreIndependent) {
+        IntMap original;
+        for ( int i = 0; i < 100; i++ ) original.insert( std::make_pair( i, i ) );
+
+        IntMap copy = original;
+        copy.erase( 50 );
+        copy.set( 10, -10 );
+        copy.insert( std::make_pair( 1000, 1000 ) );
+
+        ASSERT_EQUALS( 100U, original.size() );
+        ASSERT_EQUALS( 50, original.find( 50 )->second );
+        ASSERT_EQUALS( 10, original.find( 10 )->second );
+        ASSERT( original.find( 1000 ) == original.end() );
+
+        ASSERT_EQUALS( 100U, copy.size() );
+        ASSERT( copy.find( 50 ) == copy.end() );
+        ASSERT_EQUALS( -10, copy.find( 10 )->second );
+    }
+
+    TEST(PersistentMapTest, IteratorSurvivesErase) {
+        IntMap m;
+        for ( int i = 0; i < 10; i++ ) m.insert( std::make_pair( i, i ) );
+
+        // Erase the odd entries while walking the map
+        for ( IntMap::iterator it = m.begin(); it != m.end(); ) {
+            if ( it->first % 2 ) m.erase( it++ );
+            else ++it;
+        }
+
+        StdIntMap expected;
+        for ( int i = 0; i < 10; i += 2 ) expected[i] = i;
+        assertSameContents( expected, m );
+    }
+
+    TEST(PersistentMapTest, EraseRange) {
+        IntMap m;
+        StdIntMap expected;
+        for ( int i = 0; i < 20; i++ ) {
+            m.insert( std::make_pair( i, i ) );
+            expected[i] = i;
+        }
+
+        m.erase( m.lower_bound( 5 ), m.lower_bound( 15 ) );
+        expected.erase( expected.lower_bound( 5 ), expected.lower_bound( 15 ) );
+        assertSameContents( expected, m );
+
+        m.erase( m.begin(), m.end() );
+        ASSERT( m.empty() );
+    }
+
+    TEST(PersistentMapTest, RandomOpsMatchStdMap) {
+        PseudoRandom rand( 12345 );
+
+        IntMap m;
+        StdIntMap expected;
+        std::vector<IntMap> versions;
+        std::vector<StdIntMap> expectedVersions;
+
+        for ( int i = 0; i < 5000; i++ ) {
+            int key = rand.nextInt32( 500 );
+            switch ( rand.nextInt32( 3 ) ) {
+            case 0:
+                m.insert( std::make_pair( key, i ) );
+                expected.insert( std::make_pair( key, i ) );
+                break;
+            case 1:
+                m.set( key, i );
+                expected[key] = i;
+                break;
+            default:
+                ASSERT_EQUALS( expected.erase( key ), m.erase( key ) );
+                break;
+            }
+
+            if ( i % 500 == 0 ) {
+                versions.push_back( m );
+                expectedVersions.push_back( expected );
+            }
+        }
+
+        assertSameContents( expected, m );
+
+        // Older versions are unaffected by later changes
+        for ( size_t i = 0; i < versions.size(); i++ ) {
+            assertSameContents( expectedVersions[i], versions[i] );
+        }
+    }
+
+    TEST(PersistentMapTest, IterateFromBounds) {
+        PseudoRandom rand( 6789 );
+
+        IntMap m;
+        StdIntMap expected;
+        for ( int i = 0; i < 300; i++ ) {
+            int key = rand.nextInt32( 400 );
+            m.set( key, i );
+            expected[key] = i;
+        }
+
+        // Iterators returned by lookups must step in both directions like std::map's
+        for ( int key = -1; key <= 400; key++ ) {
+            IntMap::const_iterator it = m.lower_bound( key );
+            StdIntMap::const_iterator e = expected.lower_bound( key );
+            for ( ; e != expected.end(); ++e, ++it ) {
+                ASSERT( it != m.end() );
+                ASSERT_EQUALS( e->first, it->first );
+            }
+            ASSERT( it == m.end() );
+
+            it = m.upper_bound( key );
+            e = expected.upper_bound( key );
+            while ( e != expected.begin() ) {
+                --e;
+                --it;
+                ASSERT_EQUALS( e->first, it->first );
+            }
+            ASSERT( it == m.begin() );
+        }
+    }
+
+#ifndef MONGO_CONFIG_DEBUG_BUILD
+    TEST(PersistentMapTest, PerformanceIterate) {
+        const int numEntries = 1000 * 1000;
+        const int numPasses = 10;
+
+        IntMap m;
+        StdIntMap stdMap;
+        for ( int i = 0; i < numEntries; i++ ) {
+            m.insert( std::make_pair( i, i ) );
+            stdMap.insert( std::make_pair( i, i ) );
+        }
+
+        // Full walks, as cloning or serializing chunk metadata does
+        {
+            long long sum = 0;
+            Timer t;
+            for ( int i = 0; i < numPasses; i++ ) {
+                for ( IntMap::const_iterator it = m.begin(); it != m.end(); ++it ) {
+                    sum += it->second;
+                }
+            }
+            log() << "PersistentMap: " << numPasses << " walks of " << numEntries
+                  << " entries took " << t.millis() << " ms (sum " << sum << ")";
+        }
+
+        {
+            long long sum = 0;
+            Timer t;
+            for ( int i = 0; i < numPasses; i++ ) {
+                for ( StdIntMap::const_iterator it = stdMap.begin(); it != stdMap.end(); ++it ) {
+                    sum += it->second;
+                }
+            }
+            log() << "std::map: " << numPasses << " walks of " << numEntries
+                  << " entries took " << t.millis() << " ms (sum " << sum << ")";
+        }
+    }
+
+    TEST(PersistentMapTest, PerformanceCopyAndModify) {
+        const int numEntries = 100 * 1000;
+        const int numVersions = 10 * 1000;
+
+        IntMap base;
+        StdIntMap stdBase;
+        for ( int i = 0; i < numEntries; i++ ) {
+            base.insert( std::make_pair( i, i ) );
+            stdBase.insert( std::make_pair( i, i ) );
+        }
+
+        // Derive new versions which differ by a single entry, as a metadata refresh would
+        {
+            Timer t;
+            for ( int i = 0; i < numVersions; i++ ) {
+                IntMap next = base;
+                next.set( i % numEntries, -i );
+                base = next;
+            }
+            log() << "PersistentMap: " << numVersions << " copy+set on " << numEntries
+                  << " entries took " << t.millis() << " ms";
+        }
+
+        {
+            const int numStdVersions = numVersions / 100;
+            Timer t;
+            for ( int i = 0; i < numStdVersions; i++ ) {
+                StdIntMap next = stdBase;
+                next[i % numEntries] = -i;
+                stdBase.swap( next );
+            }
+            log() << "std::map: " << numStdVersions << " copy+set on " << numEntries
+                  << " entries took " << t.millis() << " ms";
+        }
+    }
+#endif
+
+} // namespace
@@ -71,6 +71,10 @@ namespace mongo {
             return static_cast<long long>((now() - _old) * _microsPerCount);
         }
 
+        inline long long nanos() const {
+            return static_cast<long long>((now() - _old) * _microsPerCount * 1000);
+        }
+
         inline void reset() { _old = now(); }
 
         inline static void setCountsPerSecond(long long countsPerSecond) {
@@ -0,0 +1,84 @@
+// token_bucket.cpp
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/util/token_bucket.h"
+
+#include <algorithm>
+
+namespace mongo {
+
+    TokenBucket::TokenBucket(double rate, double burst)
+        : _mutex("TokenBucket"),
+          _rate(rate),
+          _burst(burst),
+          _tokens(burst),
+          _lastRefillMicros(-1) {
+    }
+
+    void TokenBucket::setRate(double rate, double burst) {
+        SimpleMutex::scoped_lock lk(_mutex);
+        _rate = rate;
+        _burst = burst;
+        _tokens = std::min(_tokens, _burst);
+    }
+
+    double TokenBucket::getRate() const {
+        SimpleMutex::scoped_lock lk(_mutex);
+        return _rate;
+    }
+
+    void TokenBucket::_refill_inlock(long long nowMicros) {
+        if (_lastRefillMicros >= 0 && nowMicros > _lastRefillMicros) {
+            _tokens = std::min(_burst,
+                               _tokens + _rate * (nowMicros - _lastRefillMicros) / 1000000.0);
+        }
+        if (nowMicros > _lastRefillMicros) {
+            _lastRefillMicros = nowMicros;
+        }
+    }
+
+    long long TokenBucket::take(double tokens, long long nowMicros) {
+        SimpleMutex::scoped_lock lk(_mutex);
+
+        if (_rate <= 0) {
+            return 0;
+        }
+
+        _refill_inlock(nowMicros);
+        _tokens -= tokens;
+
+        if (_tokens >= 0) {
+            return 0;
+        }
+        return static_cast<long long>(-_tokens * 1000000.0 / _rate) + 1;
+    }
+
+} // namespace mongo
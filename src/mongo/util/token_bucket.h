@@ -0,0 +1,82 @@
+// token_bucket.h
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/util/concurrency/mutex.h"
+
+namespace mongo {
+
+    /**
+     * A token bucket rate limiter.  Tokens accrue at 'rate' per second up to 'burst' tokens, and
+     * each unit of work (a document, a byte) takes one token.
+     *
+     * take() never blocks and never refuses: it always debits the bucket, which may go negative,
+     * and returns how long the caller should pause before doing more work.  That lets callers
+     * charge for work after the fact, when the cost (e.g. bytes deleted) is only then known, and
+     * keeps a single large request from being starved.
+     *
+     * A rate of zero or less means unlimited.  This class is thread safe.
+     */
+    class TokenBucket {
+        MONGO_DISALLOW_COPYING(TokenBucket);
+    public:
+
+        TokenBucket(double rate, double burst);
+
+        /**
+         * Changes the rate and burst size.  Tokens already in the bucket are kept, up to the new
+         * burst size.
+         */
+        void setRate(double rate, double burst);
+
+        /**
+         * Takes 'tokens' from the bucket at time 'nowMicros' (any monotonic clock) and returns the
+         * number of microseconds until the bucket is back out of debt, or 0 if it has not gone
+         * into debt.
+         */
+        long long take(double tokens, long long nowMicros);
+
+        double getRate() const;
+
+    private:
+        void _refill_inlock(long long nowMicros);
+
+        mutable SimpleMutex _mutex;
+
+        double _rate;
+        double _burst;
+        double _tokens;
+
+        // Time of the last refill; negative until the first call to take().
+        long long _lastRefillMicros;
+    };
+
+} // namespace mongo
@@ -0,0 +1,96 @@
+// token_bucket_test.cpp
+
+/*    Copyright 2015 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/token_bucket.h"
+
+namespace {
+    using namespace mongo;
+
+    const long long kSecond = 1000 * 1000;
+
+    TEST(TokenBucketTest, Unlimited) {
+        TokenBucket bucket(0, 0);
+        ASSERT_EQUALS(0, bucket.take(1e9, 0));
+        ASSERT_EQUALS(0, bucket.take(1e9, 0));
+    }
+
+    TEST(TokenBucketTest, BurstIsFree) {
+        TokenBucket bucket(100, 100);
+        ASSERT_EQUALS(0, bucket.take(60, 0));
+        ASSERT_EQUALS(0, bucket.take(40, 0));
+
+        // Bucket is empty; the next 50 tokens take half a second to accrue
+        long long wait = bucket.take(50, 0);
+        ASSERT_GREATER_THAN_OR_EQUALS(wait, kSecond / 2);
+        ASSERT_LESS_THAN_OR_EQUALS(wait, kSecond / 2 + 1);
+    }
+
+    TEST(TokenBucketTest, RefillsOverTime) {
+        TokenBucket bucket(10, 10);
+        ASSERT_EQUALS(0, bucket.take(10, 0));
+        ASSERT_NOT_EQUALS(0, bucket.take(1, 0));
+
+        // After the debt is paid off and another second passes there are 10 tokens again
+        ASSERT_EQUALS(0, bucket.take(10, kSecond + kSecond / 10));
+
+        // Refill never exceeds the burst size
+        ASSERT_EQUALS(0, bucket.take(10, 100 * kSecond));
+        ASSERT_NOT_EQUALS(0, bucket.take(1, 100 * kSecond));
+    }
+
+    TEST(TokenBucketTest, SustainedRate) {
+        // A caller which always waits as told achieves the configured rate
+        TokenBucket bucket(1000, 100);
+        long long now = 0;
+        for (int i = 0; i < 100; i++) {
+            now += bucket.take(100, now);
+        }
+
+        // 10000 tokens, the first 100 free: ~9.9 seconds
+        ASSERT_GREATER_THAN_OR_EQUALS(now, 99 * kSecond / 10);
+        ASSERT_LESS_THAN_OR_EQUALS(now, 99 * kSecond / 10 + 1000);
+    }
+
+    TEST(TokenBucketTest, SetRate) {
+        TokenBucket bucket(1, 1000);
+        ASSERT_EQUALS(0, bucket.take(500, 0));
+
+        // Shrinking the burst drops surplus tokens
+        bucket.setRate(1, 10);
+        ASSERT_EQUALS(0, bucket.take(10, 0));
+        ASSERT_NOT_EQUALS(0, bucket.take(1, 0));
+
+        bucket.setRate(0, 0);
+        ASSERT_EQUALS(0, bucket.take(1e6, 0));
+    }
+
+} // namespace